@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Tiny benchmark harness: each bench_*.cpp registers cases with
+// LCD_BENCH(name), and lcd_bench runs them (optionally filtered by
+// substring). No external dependencies so it builds on the target board.
+
+struct BenchContext {
+    std::string font_path;
+};
+
+using BenchFn = void (*)(const BenchContext&);
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFn fn);
+};
+
+struct BenchCase {
+    const char* name;
+    BenchFn fn;
+};
+
+std::vector<BenchCase>& bench_registry();
+
+#define LCD_BENCH(name)                                              \
+    static void name(const BenchContext&);                           \
+    static BenchRegistrar name##_registrar(#name, name);             \
+    static void name(const BenchContext& ctx)
+
+// Keep the optimizer from dropping a computed value.
+template <class T>
+inline void bench_keep(const T& v) {
+    asm volatile("" : : "g"(&v) : "memory");
+}
+
+// Run fn repeatedly for roughly min_ms and print ns per iteration.
+template <class F>
+double bench_run(const char* label, F&& fn, int min_ms = 200) {
+    using clock = std::chrono::steady_clock;
+    long iters = 0;
+    auto start = clock::now();
+    auto deadline = start + std::chrono::milliseconds(min_ms);
+    clock::time_point now;
+    do {
+        for (int k = 0; k < 16; ++k) fn();
+        iters += 16;
+        now = clock::now();
+    } while (now < deadline);
+    const double ns = std::chrono::duration<double, std::nano>(now - start).count() / (double)iters;
+    std::printf("  %-44s %12.1f ns/iter\n", label, ns);
+    return ns;
+}
@@ -0,0 +1,111 @@
+#include "bench.h"
+#include "ft_text.h"
+#include "ili9488.h"
+#include "mono_gfx_fixed.h"
+
+#include <array>
+#include <memory>
+
+// Runtime-sized MonoGfx against MonoGfxT with the same geometry: the same
+// kernels, with the stride and bounds as variables or as constants.
+
+namespace {
+
+template <class Gfx>
+void draw_shapes(Gfx& g) {
+    g.clear();
+    for (int i = 0; i < 16; ++i) {
+        g.fill_rect(i * 7, i * 3, i * 7 + 40, i * 3 + 21);
+        g.rect(i, i, g.width() - 1 - i, g.height() - 1 - i, (i & 1) != 0);
+    }
+}
+
+template <class Gfx>
+void draw_pixels(Gfx& g) {
+    for (int y = 0; y < g.height(); y += 3)
+        for (int x = 0; x < g.width(); ++x) g.pixel(x, y, ((x ^ y) & 4) != 0);
+}
+
+template <int W, int H>
+void compare_shapes(const char* size) {
+    char label[64];
+    MonoGfx dynamic(W, H);
+    auto fixed = std::make_unique<MonoGfxT<W, H>>();
+
+    std::snprintf(label, sizeof(label), "shapes %s, MonoGfx", size);
+    const double d = bench_run(label, [&] {
+        draw_shapes(dynamic);
+        bench_keep(dynamic.fb()[0]);
+    });
+    std::snprintf(label, sizeof(label), "shapes %s, MonoGfxT", size);
+    const double f = bench_run(label, [&] {
+        draw_shapes(*fixed);
+        bench_keep(fixed->fb()[0]);
+    });
+    std::printf("  %-44s %12.2fx\n", "fixed-size speedup", d / f);
+
+    std::snprintf(label, sizeof(label), "pixels %s, MonoGfx", size);
+    const double dp = bench_run(label, [&] {
+        draw_pixels(dynamic);
+        bench_keep(dynamic.fb()[0]);
+    });
+    std::snprintf(label, sizeof(label), "pixels %s, MonoGfxT", size);
+    const double fp = bench_run(label, [&] {
+        draw_pixels(*fixed);
+        bench_keep(fixed->fb()[0]);
+    });
+    std::printf("  %-44s %12.2fx\n", "fixed-size speedup", dp / fp);
+}
+
+} // namespace
+
+LCD_BENCH(gfx_fixed_vs_runtime) {
+    (void)ctx;
+    compare_shapes<128, 64>("128x64");
+    compare_shapes<480, 320>("480x320");
+}
+
+LCD_BENCH(gfx_fixed_rgb666) {
+    (void)ctx;
+    auto fixed = std::make_unique<MonoGfxT<480, 320>>();
+    draw_shapes(*fixed);
+    const std::vector<uint8_t> mono(fixed->fb().begin(), fixed->fb().end());
+    auto out = std::make_unique<std::array<uint8_t, 480 * 320 * 3>>();
+
+    // Both into a buffer kept across frames, so only the expansion is timed
+    const double d = bench_run("expand 480x320 to RGB666, runtime size", [&] {
+        TftPanel::expand_mono(mono.data(), 480, Rect{0, 0, 480, 320}, 3, 0xFFFF, 0x0000, out->data());
+        bench_keep((*out)[0]);
+    });
+    const double f = bench_run("expand 480x320 to RGB666, MonoGfxT", [&] {
+        Ili9488::mono_to_rgb666(*fixed, *out);
+        bench_keep((*out)[0]);
+    });
+    std::printf("  %-44s %12.2fx\n", "fixed-size speedup", d / f);
+}
+
+LCD_BENCH(gfx_fixed_ft_text) {
+    FtText ft;
+    try {
+        ft.load_font(ctx.font_path);
+    } catch (const std::exception& e) {
+        std::printf("  skipped: %s\n", e.what());
+        return;
+    }
+    ft.set_pixel_size(80);
+    MonoGfx dynamic(480, 320);
+    auto fixed = std::make_unique<MonoGfxT<480, 320>>();
+    ft.draw_utf8(dynamic, 0, 100, "Счётчик: 1234");  // shape once, cached
+
+    // Glyph bitmaps come from the cache; the blit is the part the geometry
+    // affects
+    const double d = bench_run("draw_utf8 80 px, MonoGfx 480x320", [&] {
+        ft.draw_utf8(dynamic, 0, 100, "Счётчик: 1234");
+        bench_keep(dynamic.fb()[0]);
+    });
+    const double f = bench_run("draw_utf8 80 px, MonoGfxT<480, 320>", [&] {
+        ft.draw_utf8(*fixed, 0, 100, "Счётчик: 1234");
+        bench_keep(fixed->fb()[0]);
+    });
+    std::printf("  %-44s %12.2fx\n", "fixed-size speedup", d / f);
+}
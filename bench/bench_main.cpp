@@ -0,0 +1,31 @@
+#include "bench.h"
+#include <cstring>
+
+std::vector<BenchCase>& bench_registry() {
+    static std::vector<BenchCase> cases;
+    return cases;
+}
+
+BenchRegistrar::BenchRegistrar(const char* name, BenchFn fn) {
+    bench_registry().push_back({name, fn});
+}
+
+static const char* argval(int argc, char** argv, const char* key, const char* defv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == key && i + 1 < argc) return argv[i + 1];
+    }
+    return defv;
+}
+
+int main(int argc, char** argv) {
+    BenchContext ctx;
+    ctx.font_path = argval(argc, argv, "--font", "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf");
+    const char* filter = argval(argc, argv, "--filter", "");
+
+    for (const auto& c : bench_registry()) {
+        if (*filter && !std::strstr(c.name, filter)) continue;
+        std::printf("%s\n", c.name);
+        c.fn(ctx);
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "display_queue.h"
+#include "four_line_display.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+LCD_BENCH(display_queue_push) {
+    (void)ctx;
+    DisplayQueue q(1024);
+    // Producer side only: fill the ring, then empty it off the clock
+    DisplayCommand c;
+    double push_ns = 0.0;
+    long pushes = 0;
+    for (int round = 0; round < 2000; ++round) {
+        const auto t0 = std::chrono::steady_clock::now();
+        while (q.set_line(1, "Count: 1234")) ++pushes;
+        push_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        while (q.pop(c)) bench_keep(c);
+    }
+    std::printf("  %-44s %12.1f ns/push\n", "DisplayQueue::set_line (uncontended)", push_ns / pushes);
+
+    // What producers pay today: a global mutex around puts()
+    FourLineDisplay display;
+    std::mutex display_mutex;
+    int n = 0;
+    bench_run("mutex + FourLineDisplay::puts (baseline)", [&] {
+        std::lock_guard<std::mutex> lock(display_mutex);
+        display.puts(1, (n++ & 1) ? "Count: 1234" : "Count: 1235");
+    });
+
+    // Four producers against one draining consumer
+    constexpr int kPerThread = 200000;
+    std::atomic<bool> stop{false};
+    std::thread consumer([&] {
+        while (!stop.load(std::memory_order_relaxed)) q.drain(display);
+    });
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (unsigned int line = 0; line < 4; ++line) {
+        producers.emplace_back([&, line] {
+            for (int i = 0; i < kPerThread; ++i) q.set_line(line, "Count: 1234");
+        });
+    }
+    for (auto& t : producers) t.join();
+    const auto t1 = std::chrono::steady_clock::now();
+    stop.store(true);
+    consumer.join();
+
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (4.0 * kPerThread);
+    const DisplayQueueStats s = q.stats();
+    std::printf("  %-44s %12.1f ns/push (%llu dropped, %llu coalesced)\n",
+                "DisplayQueue::set_line (4 producers)", ns,
+                static_cast<unsigned long long>(s.dropped),
+                static_cast<unsigned long long>(s.coalesced));
+}
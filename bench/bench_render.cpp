@@ -0,0 +1,29 @@
+#include "bench.h"
+#include "four_line_display.h"
+
+#include <thread>
+
+LCD_BENCH(render_parallel_480x320) {
+    std::printf("  %-44s %12u\n", "hardware threads", std::thread::hardware_concurrency());
+
+    double serial_ns = 0.0;
+    for (unsigned int threads : {1u, 2u, 4u}) {
+        FourLineDisplay display(480, 320, 40, 80);
+        display.set_render_threads(threads);
+        if (!display.initialize(ctx.font_path)) return;
+        display.puts(0, "Статус: Выполняется");
+        display.puts(1, "Счётчик: 1234");
+        display.puts(2, "FuelFlux ILI9488");
+        display.puts(3, "Версия 2.1");
+        display.render();
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "render, %u thread%s", threads, threads == 1 ? "" : "s");
+        const double ns = bench_run(label, [&] { bench_keep(display.render()); });
+        if (threads == 1) {
+            serial_ns = ns;
+        } else {
+            std::printf("  %-44s %12.2fx\n", "speedup over serial", serial_ns / ns);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "bench.h"
+#include "spi_linux.h"
+
+namespace {
+
+// Counts SPI_IOC_MESSAGE submissions without a device
+class CountingSpi : public SpiLinux {
+public:
+    CountingSpi() : SpiLinux("/dev/null") {}
+
+protected:
+    void transfer_message(const SpiSegment*, size_t) override {}
+};
+
+} // namespace
+
+LCD_BENCH(spi_syscalls_per_frame) {
+    (void)ctx;
+    const int w = 480;
+    const int h = 320;
+    const size_t line_bytes = static_cast<size_t>(w) * 3;
+    std::vector<uint8_t> frame(line_bytes * h, 0x5A);
+
+    // Before: set_mono_framebuffer/fill issued one write() per scanline
+    std::printf("  %-44s %12d syscalls/frame\n", "before: one write per scanline", h);
+
+    std::printf("  %-44s %12d syscalls/frame\n", "host bufsiz (sysfs)",
+                static_cast<int>((frame.size() + SpiLinux::query_spidev_bufsiz() - 1) /
+                                 SpiLinux::query_spidev_bufsiz()));
+
+    for (size_t bufsiz : {size_t{4096}, size_t{65536}, size_t{524288}}) {
+        CountingSpi spi;
+        spi.set_max_transfer(bufsiz);
+        spi.write(frame);
+        char label[64];
+        std::snprintf(label, sizeof(label), "after: bufsiz %zu, frame write", bufsiz);
+        std::printf("  %-44s %12llu syscalls/frame (%llu segments)\n", label,
+                    static_cast<unsigned long long>(spi.stats().messages),
+                    static_cast<unsigned long long>(spi.stats().transfers));
+
+        spi.reset_stats();
+        std::vector<SpiSegment> lines(h, SpiSegment{frame.data(), line_bytes});
+        spi.write_segments(lines.data(), lines.size());
+        std::snprintf(label, sizeof(label), "after: bufsiz %zu, fill (gathered)", bufsiz);
+        std::printf("  %-44s %12llu syscalls/frame\n", label,
+                    static_cast<unsigned long long>(spi.stats().messages));
+    }
+
+    CountingSpi spi;
+    spi.set_max_transfer(65536);
+    bench_run("packing cost, 460800 B frame", [&] { spi.write(frame); });
+}
@@ -0,0 +1,47 @@
+#include "bench.h"
+#include "four_line_display.h"
+#include "ft_text.h"
+#include "graphics.h"
+#include "sprite.h"
+
+LCD_BENCH(sprite_label_vs_freetype) {
+    FtText ft;
+    ft.load_font(ctx.font_path);
+    ft.set_pixel_size(12);
+    const std::string label = "Статус: Выполняется";
+
+    MonoGfx gfx(128, 64);
+    bench_run("FtText::draw_utf8 (shaped run cached)", [&] {
+        ft.draw_utf8(gfx, 0, 13, label);
+        bench_keep(gfx.fb());
+    });
+
+    const MonoSprite sprite = MonoSprite::from_text(ft, label);
+    bench_run("MonoSprite::blit page-aligned (y=16)", [&] {
+        sprite.blit(gfx, 0, 16, BlitMode::Transparent);
+        bench_keep(gfx.fb());
+    });
+    bench_run("MonoSprite::blit shifted (y=13)", [&] {
+        sprite.blit(gfx, 0, 13, BlitMode::Transparent);
+        bench_keep(gfx.fb());
+    });
+}
+
+LCD_BENCH(marquee_tick_vs_render) {
+    FourLineDisplay display(128, 64, 12, 28);
+    if (!display.initialize(ctx.font_path)) return;
+    display.set_marquee(3, true, 30.0);
+    display.puts(0, "Статус: Выполняется");
+    display.puts(3, "Дизельное топливо ДТ-Л-К5 зимнее, класс 2");
+    display.render();
+
+    double t = 0.0;
+    bench_run("FourLineDisplay::render (FreeType, 4 lines)", [&] {
+        bench_keep(display.render());
+    });
+    bench_run("FourLineDisplay::tick (marquee window copy)", [&] {
+        t += 1.0 / 30.0;  // a new offset every call
+        display.tick(t);
+        bench_keep(display.get_framebuffer());
+    });
+}
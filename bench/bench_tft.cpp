@@ -0,0 +1,85 @@
+#include "bench.h"
+#include "tft_panel.h"
+#include "tft_presenter.h"
+
+#include <chrono>
+#include <thread>
+
+LCD_BENCH(tft_expand_565_vs_666) {
+    (void)ctx;
+    const int w = 480;
+    const int h = 320;
+    std::vector<uint8_t> mono(static_cast<size_t>(w * h / 8));
+    for (size_t i = 0; i < mono.size(); ++i) mono[i] = static_cast<uint8_t>(i * 37u);
+    std::vector<uint8_t> out(static_cast<size_t>(w * h * 3));
+    const Rect all{0, 0, w, h};
+
+    // Wire time at a 32 MHz SPI clock, the usual ceiling for these modules
+    const double clock_hz = 32e6;
+    for (int bpp : {3, 2}) {
+        const double bytes = static_cast<double>(w) * h * bpp;
+        char label[64];
+        std::snprintf(label, sizeof(label), "RGB%s frame %dx%d", bpp == 3 ? "666" : "565", w, h);
+        std::printf("  %-44s %12.0f bytes, %6.1f ms on the wire\n", label, bytes,
+                    bytes * 8.0 / clock_hz * 1000.0);
+    }
+
+    bench_run("expand 480x320 to RGB666", [&] {
+        TftPanel::expand_mono(mono.data(), w, all, 3, 0xFFFF, 0x0000, out.data());
+        bench_keep(out[0]);
+    });
+    bench_run("expand 480x320 to RGB565", [&] {
+        TftPanel::expand_mono(mono.data(), w, all, 2, 0xFFFF, 0x0000, out.data());
+        bench_keep(out[0]);
+    });
+    bench_run("expand 96x32 region to RGB565", [&] {
+        TftPanel::expand_mono(mono.data(), w, Rect{200, 144, 96, 32}, 2, 0xFFFF, 0x0000, out.data());
+        bench_keep(out[0]);
+    });
+}
+
+LCD_BENCH(tft_present_pipelined) {
+    (void)ctx;
+    const int w = 480;
+    const int h = 320;
+    const int bpp = 3;
+    std::vector<uint8_t> mono(static_cast<size_t>(w * h / 8));
+    for (size_t i = 0; i < mono.size(); ++i) mono[i] = static_cast<uint8_t>(i * 37u);
+
+    // Stand-in for the bus: sleeps for the wire time at 32 MHz, which is
+    // what a blocking spidev write costs the caller
+    const double clock_hz = 32e6;
+    auto wire = [&](const uint8_t*, size_t n) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(static_cast<double>(n) * 8.0 / clock_hz));
+    };
+
+    using clock = std::chrono::steady_clock;
+    std::vector<uint8_t> frame(static_cast<size_t>(w * h * bpp));
+    const int runs = 10;
+    const auto t0 = clock::now();
+    for (int k = 0; k < runs; ++k) {
+        TftPanel::expand_mono(mono.data(), w, Rect{0, 0, w, h}, bpp, 0xFFFF, 0x0000, frame.data());
+        wire(frame.data(), frame.size());
+    }
+    const double serial_ms =
+        std::chrono::duration<double, std::milli>(clock::now() - t0).count() / runs;
+    std::printf("  %-44s %12.2f ms/frame\n", "expand, then send", serial_ms);
+
+    for (int rows : {8, 32}) {
+        BandPipeline pipeline(static_cast<size_t>(w * rows * bpp), wire);
+        double total = 0.0;
+        for (int k = 0; k < runs; ++k) {
+            pipeline.run(static_cast<size_t>(h / rows), [&](size_t i, uint8_t* out) {
+                TftPanel::expand_mono(mono.data(), w, Rect{0, static_cast<int>(i) * rows, w, rows}, bpp,
+                                      0xFFFF, 0x0000, out);
+                return static_cast<size_t>(w * rows * bpp);
+            });
+            total += pipeline.stats().total_ms;
+        }
+        const PipelineStats& st = pipeline.stats();
+        char label[64];
+        std::snprintf(label, sizeof(label), "pipelined, %d-row bands", rows);
+        std::printf("  %-44s %12.2f ms/frame (expand %.2f, send %.2f)\n", label, total / runs,
+                    st.convert_ms, st.send_ms);
+    }
+}
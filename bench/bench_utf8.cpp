@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "utf8.h"
+
+namespace {
+
+// Byte-at-a-time decoder equivalent to the one FtText used before utf8.h
+// (no validation), kept as the baseline.
+uint32_t legacy_next_cp(const std::string& s, size_t& i) {
+    unsigned char c = (unsigned char)s[i++];
+    if (c < 0x80) return c;
+    if ((c & 0xE0) == 0xC0 && i < s.size()) {
+        return ((uint32_t)(c & 0x1F) << 6) | ((uint32_t)(s[i++] & 0x3F));
+    }
+    if ((c & 0xF0) == 0xE0 && i + 1 < s.size()) {
+        uint32_t b1 = s[i++] & 0x3F;
+        uint32_t b2 = s[i++] & 0x3F;
+        return ((uint32_t)(c & 0x0F) << 12) | (b1 << 6) | b2;
+    }
+    if ((c & 0xF8) == 0xF0 && i + 2 < s.size()) {
+        uint32_t b1 = s[i++] & 0x3F;
+        uint32_t b2 = s[i++] & 0x3F;
+        uint32_t b3 = s[i++] & 0x3F;
+        return ((uint32_t)(c & 0x07) << 18) | (b1 << 12) | (b2 << 6) | b3;
+    }
+    return 0xFFFD;
+}
+
+void run_pair(const char* name, const std::string& s) {
+    std::u32string out;
+    std::string label = std::string("legacy   ") + name;
+    bench_run(label.c_str(), [&] {
+        out.clear();
+        for (size_t i = 0; i < s.size();) out.push_back(legacy_next_cp(s, i));
+        bench_keep(out);
+    });
+    label = std::string("validate ") + name;
+    bench_run(label.c_str(), [&] {
+        utf8_decode(s, out);
+        bench_keep(out);
+    });
+}
+
+} // namespace
+
+LCD_BENCH(utf8_decode_status_strings) {
+    (void)ctx;
+    run_pair("ascii label", "FuelFlux NHD Ver 2.0 Status: Running");
+    run_pair("cyrillic label", "Статус: Выполняется");
+    run_pair("mixed label", "Счётчик: 12345 L  Colonka 4  АИ-95 54.30 RUB");
+
+    std::string feed;
+    for (int k = 0; k < 64; ++k) feed += "PUMP 04 STATE=FUELLING Заправка 000123.45 L; ";
+    run_pair("mixed POS feed 3KB", feed);
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "graphics.h"
+#include "sprite.h"
+
+// Time-driven animation helpers. Everything takes absolute time in seconds
+// (FrameTick::time), so a skipped frame never slows an animation down.
+// Animations redraw only their own rectangle through MonoGfx; Animator
+// reports which rectangles changed so the caller can skip or narrow the
+// flush.
+
+enum class Easing { Linear, EaseIn, EaseOut, EaseInOut };
+
+// Map u in [0, 1] through the easing curve (clamped).
+double ease(Easing e, double u);
+
+// Interpolates from -> to over [start, start + duration).
+struct Tween {
+    double from{0.0};
+    double to{0.0};
+    double start{0.0};
+    double duration{0.0};
+    Easing easing{Easing::Linear};
+
+    double progress(double t) const;  // eased, 0..1
+    double value(double t) const;
+    bool done(double t) const { return t >= start + duration; }
+};
+
+// Scroll position in [0, period) after t seconds at px_per_s.
+int marquee_offset(double t, double px_per_s, int period);
+
+// On for the first `duty` fraction of each period.
+bool blink_on(double t, double period_s, double duty = 0.5);
+
+class Animation {
+public:
+    virtual ~Animation() = default;
+
+    // Advance to time t. Return true if the drawn output changed.
+    virtual bool update(double t) = 0;
+    // Redraw the whole of bounds() (clear, then draw) into gfx.
+    virtual void draw(MonoGfx& gfx) const = 0;
+    virtual Rect bounds() const = 0;
+};
+
+// Shows a sprite during the "on" part of each period, clears it otherwise.
+class BlinkAnimation : public Animation {
+public:
+    BlinkAnimation(MonoSprite sprite, int x, int y, double period_s, double duty = 0.5);
+
+    bool update(double t) override;
+    void draw(MonoGfx& gfx) const override;
+    Rect bounds() const override;
+
+private:
+    MonoSprite sprite_;
+    int x_, y_;
+    double period_, duty_;
+    bool on_{false};
+    bool first_{true};
+};
+
+// Scrolls a pre-rendered strip through a window, wrapping with a gap.
+// A strip that fits the window is drawn once and stays still. The strip is
+// cropped to the window height; each frame is a column-window copy.
+class MarqueeAnimation : public Animation {
+public:
+    MarqueeAnimation(MonoSprite strip, Rect window, double px_per_s, int gap = 16);
+
+    bool update(double t) override;
+    void draw(MonoGfx& gfx) const override;
+    Rect bounds() const override { return window_; }
+
+    int offset() const { return offset_; }
+
+private:
+    MonoSprite strip_;
+    Rect window_;
+    double speed_;
+    int gap_;
+    int offset_{-1};
+};
+
+enum class SlideDirection { Left, Right };
+
+// Slides the current sprite out of an area while the next one slides in.
+class SlideAnimation : public Animation {
+public:
+    SlideAnimation(Rect area, double duration_s, SlideDirection dir = SlideDirection::Left,
+                   Easing easing = Easing::EaseInOut);
+
+    // Show `sprite` immediately (no transition).
+    void show(MonoSprite sprite);
+    // Transition from what is shown now to `next`, starting at time t.
+    void slide_to(MonoSprite next, double t);
+    bool sliding() const { return sliding_; }
+
+    bool update(double t) override;
+    void draw(MonoGfx& gfx) const override;
+    Rect bounds() const override { return area_; }
+
+private:
+    Rect area_;
+    Tween tween_;
+    SlideDirection dir_;
+    MonoSprite from_;
+    MonoSprite to_;
+    int shift_{0};
+    bool sliding_{false};
+    bool changed_{true};
+
+    void draw_at(MonoGfx& gfx, const MonoSprite& s, int left) const;
+};
+
+// Owns a set of animations and redraws only those that changed.
+class Animator {
+public:
+    Animation* add(std::unique_ptr<Animation> a);
+    template <class T, class... Args>
+    T* emplace(Args&&... args) {
+        auto p = std::make_unique<T>(std::forward<Args>(args)...);
+        T* raw = p.get();
+        add(std::move(p));
+        return raw;
+    }
+    void remove(const Animation* a);
+    void clear();
+
+    // Force every animation to redraw on the next tick (e.g. after the
+    // background was re-rendered).
+    void invalidate() { invalidated_ = true; }
+
+    // Advance all animations to t and redraw the changed ones. Returns the
+    // changed rectangles; empty when the frame needs no flush.
+    const std::vector<Rect>& tick(double t, MonoGfx& gfx);
+
+private:
+    std::vector<std::unique_ptr<Animation>> anims_;
+    std::vector<Rect> dirty_;
+    bool invalidated_{true};
+};
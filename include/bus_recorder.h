@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct SpiSegment;
+
+// Bus capture for field diagnostics.
+//
+// SpiLinux and GpioLine feed an attached BusRecorder with every SPI write
+// and every level change (D/C, RESET, ...), timestamped on CLOCK_MONOTONIC.
+// Records go into a fixed-size byte ring; when it is full the oldest
+// records are dropped, so the recorder can stay attached for the life of
+// the process and dump() the most recent traffic at any time.
+//
+// Dump format (little-endian):
+//   file header   "LCDBUS1\n", u32 version (1), u32 record count
+//   record        u64 t_ns, u8 channel, u8 level, u16 reserved, u32 len,
+//                 then len payload bytes (SPI only)
+// lcd_replay turns a dump back into panel frames.
+
+enum class BusChannel : uint8_t { Spi = 0, Dc = 1, Reset = 2, Cs = 3, Other = 4 };
+
+struct BusEvent {
+    uint64_t t_ns{0};
+    BusChannel channel{BusChannel::Spi};
+    bool level{false};          // GPIO channels
+    std::vector<uint8_t> data;  // Spi
+};
+
+class BusRecorder {
+public:
+    static constexpr size_t kDefaultCapacity = 4u << 20;  // bytes
+    static constexpr size_t kRecordHeader = 16;
+
+    explicit BusRecorder(size_t capacity_bytes = kDefaultCapacity);
+
+    BusRecorder(const BusRecorder&) = delete;
+    BusRecorder& operator=(const BusRecorder&) = delete;
+
+    // Pause/resume capture without detaching.
+    void set_enabled(bool on) { enabled_ = on; }
+    bool enabled() const { return enabled_.load(); }
+
+    // Hooks (called by SpiLinux/GpioLine; thread-safe).
+    void record_spi(const SpiSegment* segs, size_t n);
+    void record_spi(const uint8_t* data, size_t len);
+    void record_gpio(BusChannel channel, bool level);
+
+    // Dump image of the current ring contents (oldest first).
+    std::vector<uint8_t> snapshot() const;
+    // Write snapshot() to a file; throws std::runtime_error on I/O errors.
+    void dump(const std::string& path) const;
+    void clear();
+
+    size_t capacity() const { return buf_.size(); }
+    size_t used() const;
+    size_t records() const;
+    // Records evicted to make room, or rejected as larger than the ring.
+    uint64_t dropped() const;
+
+    // Parse a dump image / file back into events.
+    static std::vector<BusEvent> parse(const std::vector<uint8_t>& dump);
+    static std::vector<BusEvent> load(const std::string& path);
+
+private:
+    void append(BusChannel channel, bool level, const SpiSegment* segs, size_t n, size_t len);
+    void make_room(size_t need);
+    void ring_write(size_t pos, const void* src, size_t n);
+    void ring_read(size_t pos, void* dst, size_t n) const;
+
+    mutable std::mutex mu_;
+    std::vector<uint8_t> buf_;
+    size_t head_{0};  // write position
+    size_t tail_{0};  // oldest record
+    size_t used_{0};
+    size_t count_{0};
+    uint64_t dropped_{0};
+    std::atomic<bool> enabled_{true};
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "graphics.h"
+
+class FourLineDisplay;
+
+// Update commands for a FourLineDisplay owned by one render thread.
+//
+// Any number of producer threads push into DisplayQueue; it is a bounded
+// lock-free ring (fixed slots, one CAS per push, text copied inline so
+// producers never allocate). Producers never wait for the consumer or for
+// SPI: a push into a full queue fails and is counted in stats().dropped.
+//
+// The consumer drains everything pending at once and coalesces it: only
+// the newest text update per line survives, a clear_all() discards the
+// line updates queued before it, and only the newest marquee/orientation
+// setting is applied.
+
+enum class DisplayOp : uint8_t { SetLine, ClearLine, ClearAll, SetMarquee, SetOrientation };
+
+struct DisplayCommand {
+    static constexpr size_t kMaxText = 118;  // bytes; longer text is cut at a code point
+
+    DisplayOp op{DisplayOp::SetLine};
+    uint8_t line{0};
+    uint8_t flags{0};   // SetMarquee: enabled; SetOrientation: bit0 mirror_x, bit1 mirror_y
+    uint8_t arg{0};     // SetOrientation: Rotation
+    uint16_t len{0};    // text bytes
+    float speed{0.0f};  // SetMarquee: px/s
+    char text[kMaxText];
+
+    std::string_view view() const { return {text, len}; }
+};
+
+struct DisplayQueueStats {
+    uint64_t pushed{0};
+    uint64_t dropped{0};    // pushes rejected because the queue was full
+    uint64_t applied{0};    // commands applied to the display
+    uint64_t coalesced{0};  // commands skipped as superseded
+};
+
+class DisplayQueue {
+public:
+    // Capacity is rounded up to a power of two.
+    explicit DisplayQueue(size_t capacity = 256);
+    ~DisplayQueue();
+
+    DisplayQueue(const DisplayQueue&) = delete;
+    DisplayQueue& operator=(const DisplayQueue&) = delete;
+
+    // Producer side: any thread, never blocks. false = queue full (or an
+    // invalid line id).
+    bool set_line(unsigned int line_id, std::string_view utf8);
+    bool clear_line(unsigned int line_id);
+    bool clear_all();
+    bool set_marquee(unsigned int line_id, bool enabled, double px_per_s = 30.0);
+    bool set_orientation(Rotation rotation, bool mirror_x = false, bool mirror_y = false);
+    bool push(const DisplayCommand& cmd);
+
+    // Consumer side: one thread only.
+    bool pop(DisplayCommand& out);
+    // Apply all pending commands (coalesced) and return how many were
+    // applied; 0 means the display did not change.
+    size_t drain(FourLineDisplay& display);
+
+    size_t capacity() const { return mask_ + 1; }
+    bool empty() const;
+    DisplayQueueStats stats() const;
+
+private:
+    struct Cell;
+
+    template <class Fill>
+    bool emplace(Fill&& fill);
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};  // next slot to claim; = successful pushes
+    alignas(64) size_t tail_{0};               // next slot to read (consumer)
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> applied_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::vector<DisplayCommand> batch_;  // drain() scratch, sized once
+    std::string text_;                   // drain() scratch, kMaxText reserved
+};
+
+// The single consumer: drains the queue once per frame, re-renders only
+// when something changed (or a marquee moved) and hands the framebuffer
+// to `flush`. Rendering and SPI run on this thread only.
+class DisplayRenderThread {
+public:
+    using Flush = std::function<void(const std::vector<unsigned char>&)>;
+
+    DisplayRenderThread(DisplayQueue& queue, FourLineDisplay& display, double fps, Flush flush);
+    ~DisplayRenderThread();
+
+    DisplayRenderThread(const DisplayRenderThread&) = delete;
+    DisplayRenderThread& operator=(const DisplayRenderThread&) = delete;
+
+    void start();
+    void stop();
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    // Frames flushed so far.
+    uint64_t flushes() const { return flushes_.load(std::memory_order_relaxed); }
+
+private:
+    void loop();
+
+    DisplayQueue& queue_;
+    FourLineDisplay& display_;
+    double fps_;
+    Flush flush_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> flushes_{0};
+};
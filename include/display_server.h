@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "graphics.h"
+
+// One process owns the panel (SPI, GPIO lines); others draw through it.
+//
+// Each client connects to a Unix socket (SOCK_SEQPACKET) and asks for a
+// surface: a rectangle of the screen. The server backs it with a memfd in
+// MonoGfx page layout, seals its size and passes the descriptor back
+// (SCM_RIGHTS), so both sides map the same pixels. A client draws into
+// its mapping and sends a damage rectangle; the server composites the
+// damaged part of every surface into the frame and flushes that area.
+// Only rectangles cross the socket, never pixels.
+//
+// Coordinates are native framebuffer pixels. Surfaces are opaque and
+// stacked in connection order, later ones on top; screen area no surface
+// covers is blank.
+
+enum class DisplayMsgType : uint32_t {
+    Create = 1,   // client: surface rect (screen coordinates)
+    Damage = 2,   // client: changed rect (surface coordinates)
+    Created = 3,  // server: surface rect, memfd attached
+    Done = 4,     // server: damage composited and flushed
+    Error = 5,    // server: request refused
+};
+
+struct DisplayMsg {
+    DisplayMsgType type;
+    int32_t x, y, w, h;
+};
+
+struct DisplayServerStats {
+    uint64_t damage{0};   // damage messages received
+    uint64_t flushes{0};  // rects handed to the flush callback
+};
+
+class DisplayServer {
+public:
+    // Called with the composed frame and the native rect that changed.
+    using Flush = std::function<void(const std::vector<unsigned char>& fb, const Rect& r)>;
+
+    // Binds socket_path (a stale socket file is replaced). Throws
+    // std::runtime_error on failure.
+    DisplayServer(const std::string& socket_path, int width, int height, Flush flush);
+    ~DisplayServer();
+
+    DisplayServer(const DisplayServer&) = delete;
+    DisplayServer& operator=(const DisplayServer&) = delete;
+
+    // Serve until stop().
+    void run();
+    // One round: wait up to timeout_ms (-1 = forever) for activity, handle
+    // every pending request, then composite and flush the damage of the
+    // whole round at once. false when stop() was called.
+    bool poll_once(int timeout_ms);
+    // Any thread, and async-signal-safe.
+    void stop();
+
+    int width() const { return w_; }
+    int height() const { return h_; }
+    // Server thread only.
+    size_t clients() const { return clients_.size(); }
+    const std::vector<unsigned char>& framebuffer() const { return fb_; }
+    // Any thread.
+    DisplayServerStats stats() const;
+
+private:
+    struct Client;
+
+    void accept_clients();
+    // false when the client is gone or broke the protocol
+    bool handle(Client& c);
+    void drop(size_t index);
+    void compose(const Rect& r);
+
+    std::string path_;
+    int w_, h_;
+    Flush flush_;
+    int listen_fd_{-1};
+    int wake_fd_{-1};  // eventfd written by stop()
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::vector<unsigned char> fb_;
+    std::vector<Rect> damage_;  // this round, screen coordinates
+    std::atomic<uint64_t> damage_msgs_{0};
+    std::atomic<uint64_t> flushes_{0};
+};
+
+class DisplayClient {
+public:
+    // Connects and creates a surface over `area` of the screen. Throws
+    // std::runtime_error when the server is unreachable or refuses.
+    DisplayClient(const std::string& socket_path, const Rect& area);
+    ~DisplayClient();
+
+    DisplayClient(const DisplayClient&) = delete;
+    DisplayClient& operator=(const DisplayClient&) = delete;
+
+    const Rect& area() const { return area_; }
+    int width() const { return area_.w; }
+    int height() const { return area_.h; }
+
+    // Shared pixels: width() * ceil(height() / 8) bytes, MonoGfx layout.
+    unsigned char* pixels() { return map_; }
+    size_t size() const { return size_; }
+
+    // Report `r` (surface coordinates) as changed and wait until the
+    // server has flushed it; the pixels may be rewritten after that.
+    void damage(const Rect& r);
+    void damage() { damage(Rect{0, 0, area_.w, area_.h}); }
+    // Copy the pages spanning `r` from a MonoGfx of the surface size into
+    // the shared pixels, then damage(r).
+    void commit(const MonoGfx& gfx, const Rect& r);
+    void commit(const MonoGfx& gfx) { commit(gfx, Rect{0, 0, area_.w, area_.h}); }
+
+private:
+    int fd_{-1};
+    Rect area_;
+    unsigned char* map_{nullptr};
+    size_t size_{0};
+};
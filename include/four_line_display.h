@@ -4,6 +4,10 @@
 #include <vector>
 #include <memory>
 
+#include "graphics.h"
+
+class MarqueeAnimation;
+
 /**
  * Four Line Display Library
  * 
@@ -82,22 +86,87 @@ public:
 
     /**
      * Render all lines to the framebuffer
-     * @return Reference to the framebuffer (page-packed 1bpp format)
+     * @return Reference to the framebuffer (page-packed 1bpp format): the
+     *         buffer drawn into, not a copy, so it changes with the next
+     *         render() or tick()
      */
     const std::vector<unsigned char>& render();
 
+    /**
+     * Scroll a line horizontally when its text is wider than the layout.
+     * The text is rasterized once into an off-screen strip (on the next
+     * render after puts()); tick() then copies a shifted window of it.
+     * Lines that fit are drawn normally. Disabled by default (text clips).
+     * @param line_id Line identifier (0-3)
+     * @param enabled Enable or disable the marquee
+     * @param px_per_s Scroll speed in pixels per second
+     */
+    void set_marquee(unsigned int line_id, bool enabled, double px_per_s = 30.0);
+    bool is_marquee(unsigned int line_id) const;
+
+    /**
+     * Advance marquee lines to time t (seconds, e.g. FrameTick::time) and
+     * update the framebuffer in place. Cheaper than render(): no FreeType
+     * work, only the scrolling line windows are redrawn.
+     * @return true if the framebuffer changed and needs a flush
+     */
+    bool tick(double t);
+
+    /**
+     * Rectangles changed by the last render() or tick(), in layout
+     * (rotated view) coordinates; map them with
+     * PixelMap::native_rect() for a partial flush. render() diffs each
+     * line against what the framebuffer shows: with a monospace font only
+     * the changed character cells are cleared and redrawn, other fonts
+     * redraw the changed lines. The whole layout is reported after
+     * initialize(), orientation or marquee changes.
+     */
+    const std::vector<Rect>& get_dirty_rects() const;
+
+    /**
+     * Rasterize lines in parallel on a persistent worker pool.
+     * Each line is drawn by one task into a layer of its own with its own
+     * FreeType face (faces are not thread-safe); the layers are merged in
+     * line order, so the frame is byte-identical to serial rendering.
+     * Worth it for large fonts (e.g. 40/80 px on 480x320); small panels
+     * are faster serial.
+     * @param threads Threads including the caller, at most 4 (one per
+     *        line); 0 = hardware concurrency, 1 = serial (default)
+     */
+    void set_render_threads(unsigned int threads);
+    unsigned int get_render_threads() const { return render_threads_; }
+
     /**
      * Get the framebuffer without re-rendering
      * @return Reference to the current framebuffer
      */
     const std::vector<unsigned char>& get_framebuffer() const;
 
+    /**
+     * Set panel orientation applied while rasterizing.
+     * Width/height passed to the constructor stay the native panel geometry
+     * (framebuffer layout); the line layout uses the rotated view.
+     * Prefer hardware rotation (e.g. ILI9488 MADCTL) where the controller
+     * has it and use this for the remaining cases.
+     * @param rotation Clockwise rotation
+     * @param mirror_x Mirror horizontally (in the rotated view)
+     * @param mirror_y Mirror vertically (in the rotated view)
+     */
+    void set_orientation(Rotation rotation, bool mirror_x = false, bool mirror_y = false);
+    Rotation get_rotation() const { return rotation_; }
+
     /**
      * Get display dimensions
      */
     int get_width() const { return width_; }
     int get_height() const { return height_; }
 
+    /**
+     * Get layout dimensions (display dimensions after rotation)
+     */
+    int get_layout_width() const;
+    int get_layout_height() const;
+
     /**
      * Get font sizes
      */
@@ -114,8 +183,13 @@ private:
     int large_font_size_;
 
     bool initialized_;
+    Rotation rotation_{Rotation::Deg0};
+    bool mirror_x_{false};
+    bool mirror_y_{false};
+    unsigned int render_threads_{1};
     std::string lines_[4];
-    std::vector<unsigned char> framebuffer_;
+    std::u32string codepoints_[4]; // lines_ decoded once per puts()
+    std::vector<unsigned char> framebuffer_; // before initialize(), after uninitialize()
 
     // Calculate Y position for each line
     int get_line_y_position(unsigned int line_id) const;
@@ -125,4 +199,21 @@ private:
     
     // Estimate character width for a given font size
     int estimate_char_width(int font_size) const;
+    
+    // Per-line faces and layers for parallel rendering
+    void prepare_parallel();
+
+    // Draw everything from scratch
+    void render_full();
+    // Redraw only what changed since the last render; false (with the
+    // framebuffer untouched) when that cannot be done exactly
+    bool render_changes();
+    // Areas to clear and repaint for a line whose text changed
+    void line_changes(unsigned int line_id, std::vector<Rect>& areas);
+    // Redraw static lines from first_line on, clipped to area
+    void repaint(const Rect& area, unsigned int first_line);
+
+    // Marquee for a line, rebuilt if its text or layout changed;
+    // nullptr when the line is not scrolling
+    MarqueeAnimation* marquee_for(unsigned int line_id);
 };
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+// Deadline-based frame pacing.
+//
+// Frame k is due at start + k * period (absolute CLOCK_MONOTONIC time,
+// slept with clock_nanosleep(TIMER_ABSTIME)), so pacing does not drift with
+// render time the way sleep_for() after each frame does. When a frame runs
+// long, whole periods that are already past are skipped rather than
+// rendered late, and animations driven by FrameTick::time keep their speed.
+
+struct FrameTick {
+    uint64_t frame{0};     // index of this frame since start (skips included)
+    uint32_t skipped{0};   // frames dropped right before this one
+    double time{0.0};      // seconds since start, at this frame's deadline
+};
+
+struct FrameStats {
+    uint64_t frames{0};       // frames delivered by wait_next()
+    uint64_t skipped{0};      // frames dropped because we were late
+    uint64_t over_budget{0};  // frames whose busy time exceeded the period
+    double last_busy_ms{0.0};
+    double max_busy_ms{0.0};
+    double avg_busy_ms{0.0};
+};
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(double fps);
+    virtual ~FrameScheduler() = default;
+
+    // Restart the timeline: frame 0 is due now.
+    void start();
+
+    // Sleep until the next frame is due and describe it. Starts the
+    // timeline on first use.
+    FrameTick wait_next();
+
+    // Call when the frame's work (render + flush) is done; accounts its
+    // busy time against the budget.
+    void end_frame();
+
+    double fps() const { return fps_; }
+    // Takes effect from the next frame; FrameTick::time stays seconds
+    // since start, only the spacing of later frames changes.
+    void set_fps(double fps);
+    double budget_ms() const { return static_cast<double>(period_ns_) / 1e6; }
+    const FrameStats& stats() const { return stats_; }
+
+protected:
+    // Clock hooks (CLOCK_MONOTONIC); overridden by tests.
+    virtual int64_t now_ns() const;
+    virtual void sleep_until_ns(int64_t deadline_ns);
+
+private:
+    double fps_;
+    int64_t period_ns_;
+    int64_t origin_ns_{0};     // frame 0, the zero of FrameTick::time
+    int64_t rebase_ns_{0};     // deadline of frame rebase_frame_; the
+    uint64_t rebase_frame_{0}; // current period counts from here
+    int64_t next_ns_{0};
+    int64_t frame_start_ns_{0};
+    uint64_t frame_{0};
+    bool started_{false};
+    bool in_frame_{false};
+    FrameStats stats_;
+};
@@ -1,8 +1,12 @@
 #pragma once
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
 
+#include "mono_gfx_fixed.h"
+
 // Minimal FreeType-based UTF-8 text renderer into a 1bpp framebuffer (page layout)
 // Intended for 128x64 LCDs. Use a monospace font for predictable layout.
 
@@ -14,19 +18,119 @@ public:
     FtText(const FtText&) = delete;
     FtText& operator=(const FtText&) = delete;
 
+    // Font file contents, shared between FtText instances so a font used
+    // at several sizes is read from disk and parsed for its tables once.
+    using FontData = std::shared_ptr<const std::vector<unsigned char>>;
+
+    // Read a TTF/OTF file into memory (throws std::runtime_error).
+    static FontData read_font_file(const std::string& font_path);
+
     // Load a TTF/OTF font from filesystem.
     void load_font(const std::string& font_path);
+    // Load from memory; the data stays referenced while the font is used.
+    void load_font(FontData data);
 
     // Set pixel size (height). For 8x16 style, use 16.
     void set_pixel_size(int px);
+    int pixel_size() const;
+
+    // Ascender-to-descender height of the current size, in pixels.
+    int line_height() const;
+
+    // Advance width in pixels of the widest line (shaped and cached like
+    // draw_utf8, so measuring then drawing shapes once).
+    int measure_utf8(const std::string& utf8);
+    int measure_codepoints(const std::u32string& text);
+
+    // Enable/disable pair kerning (FT_Get_Kerning). On by default; has no
+    // effect for fonts without a kerning table (most monospace fonts).
+    void set_kerning(bool enabled);
+    bool kerning() const;
 
     // Render UTF-8 string into a page-packed 1bpp framebuffer.
     // fb: size must be width * (height/8), same as MonoGfx.
     // x,y: top-left in pixels.
+    // Glyph positions (kerning, combining marks) are cached per (string, size),
+    // so redrawing an unchanged label skips shaping.
     void draw_utf8(std::vector<unsigned char>& fb, int width, int height,
                    int x, int y, const std::string& utf8, bool on=true);
 
+    // Same as draw_utf8 for text already decoded (see utf8.h), so callers
+    // that redraw the same label can decode it once.
+    void draw_codepoints(std::vector<unsigned char>& fb, int width, int height,
+                         int x, int y, const std::u32string& text, bool on=true);
+
+    // Render into a MonoGfx in its logical coordinates, honoring its
+    // orientation (pixels are written pre-rotated into the native layout).
+    void draw_utf8(MonoGfx& gfx, int x, int y, const std::string& utf8, bool on=true);
+    void draw_codepoints(MonoGfx& gfx, int x, int y, const std::u32string& text, bool on=true);
+
+    // The same for a fixed-size frame: glyph rows are blitted with its
+    // constant stride.
+    template <int W, int H>
+    void draw_utf8(MonoGfxT<W, H>& gfx, int x, int y, const std::string& utf8, bool on = true) {
+        draw_codepoints(gfx, x, y, decode(utf8), on);
+    }
+    template <int W, int H>
+    void draw_codepoints(MonoGfxT<W, H>& gfx, int x, int y, const std::u32string& text, bool on = true);
+
+    // Each rendered glyph of `text` in order: its 1bpp bitmap and top-left
+    // in logical pixels. Glyphs that start at or past clip_width are not
+    // rendered. The draw_* calls are built on this.
+    using GlyphSink = std::function<void(const MonoBitmap& bitmap, int x, int y)>;
+    void for_each_glyph(const std::u32string& text, int x, int y, int clip_width,
+                        const GlyphSink& sink);
+
+    // Font-wide extents at the current size, in pixels. Every glyph drawn
+    // at pen position x (the x passed to draw_*, plus its advance) and
+    // line top y has its ink within [x + ink_left, x + ink_right) and
+    // [y + ink_top, y + ink_bottom). advance is the cell width when every
+    // glyph sits on a fixed grid (monospace font, no kerning), else 0.
+    struct CellMetrics {
+        int advance;
+        int ink_left;
+        int ink_right;
+        int ink_top;
+        int ink_bottom;
+    };
+    CellMetrics cell_metrics();
+
+    // Ink box of one glyph relative to its pen position and the line top
+    // y, with a pixel of slack; empty for blank glyphs such as space.
+    Rect glyph_box(char32_t cp);
+
+    // draw_codepoints() restricted to `clip` (logical coordinates): glyphs
+    // whose ink cannot reach it are not rasterized and pixels outside it
+    // are left alone. Used to repaint a cleared area.
+    void draw_codepoints(MonoGfx& gfx, int x, int y, const std::u32string& text, bool on,
+                         const Rect& clip);
+
+    // Number of shaped runs currently cached (all sizes).
+    size_t cached_runs() const;
+    void clear_cache();
+
 private:
+    // UTF-8 to the reused decode buffer (throws when no font is loaded)
+    const std::u32string& decode(const std::string& utf8);
+
     struct Impl;
     std::unique_ptr<Impl> impl_;
 };
+
+template <int W, int H>
+void FtText::draw_codepoints(MonoGfxT<W, H>& gfx, int x, int y, const std::u32string& text, bool on) {
+    if (gfx.pixel_map().identity) {
+        for_each_glyph(text, x, y, W, [&gfx, on](const MonoBitmap& bm, int gx, int gy) {
+            mono_blit(gfx.fb().data(), MonoStride<W>{}, H, bm, gx, gy, on);
+        });
+        return;
+    }
+    for_each_glyph(text, x, y, gfx.width(), [&gfx, on](const MonoBitmap& bm, int gx, int gy) {
+        for (int row = 0; row < bm.height; ++row) {
+            const unsigned char* src = bm.rows + static_cast<size_t>(row) * static_cast<size_t>(bm.pitch);
+            for (int col = 0; col < bm.width; ++col) {
+                if ((src[col >> 3] >> (7 - (col & 7))) & 1) gfx.pixel(gx + col, gy + row, on);
+            }
+        }
+    });
+}
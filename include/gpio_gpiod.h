@@ -1,11 +1,32 @@
 #pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "bus_recorder.h"
+
+enum class GpioEdge { Rising, Falling, Both };
+
+struct GpioEdgeEvent {
+    bool rising{false};
+    std::chrono::nanoseconds time{0};  // kernel timestamp
+};
+
+class GpioBulk;
 
 class GpioLine {
 public:
     GpioLine(int line_offset, bool output, bool initial_value,
              std::string chip_path = "/dev/gpiochip0",
              std::string consumer = "nhd12864");
+    // Input requested for edge events (e.g. a panel's TE output).
+    GpioLine(int line_offset, GpioEdge edges,
+             std::string chip_path = "/dev/gpiochip0",
+             std::string consumer = "nhd12864");
     ~GpioLine();
 
     GpioLine(const GpioLine&) = delete;
@@ -14,11 +35,113 @@ public:
     void set(bool value);
     bool get() const;
 
+    // Edge-event lines only: true when an edge is queued, waiting up to
+    // `timeout` for one (zero polls); read_edge() then takes it.
+    bool wait_edge(std::chrono::nanoseconds timeout);
+    GpioEdgeEvent read_edge();
+    // Readable when an edge is queued (for poll/epoll).
+    int event_fd() const;
+
+    // Record every set() into `recorder` on `channel` (nullptr detaches).
+    void set_recorder(BusRecorder* recorder, BusChannel channel);
+
+private:
+    friend class GpioBulk;
+    GpioLine(GpioBulk& bulk, size_t index);
+
+    struct Impl;
+    Impl* impl_;
+};
+
+// Several output lines of one chip in a single request: one chip handle,
+// one line-handle descriptor, and every update is one ioctl however many
+// lines it changes. line(i) is a GpioLine view for drivers (D/C, RST);
+// its set() goes through the bulk request.
+class GpioBulk {
+public:
+    GpioBulk(const std::vector<int>& line_offsets, const std::vector<bool>& initial_values,
+             std::string chip_path = "/dev/gpiochip0",
+             std::string consumer = "nhd12864");
+    ~GpioBulk();
+
+    GpioBulk(const GpioBulk&) = delete;
+    GpioBulk& operator=(const GpioBulk&) = delete;
+
+    size_t size() const;
+    GpioLine& line(size_t index);
+
+    void set(size_t index, bool value);
+    // Lines whose bit is set in `mask` take the matching bit of `values`
+    // (bit i = line i), all in one ioctl; the others keep their level.
+    void set_mask(uint64_t mask, uint64_t values);
+    void set_all(const std::vector<bool>& values);
+    // Levels as last set.
+    bool get(size_t index) const;
+
 private:
     struct Impl;
     Impl* impl_;
 };
 
+// A debounced level change reported by GpioInputs.
+struct GpioInputEvent {
+    int id{0};                         // from GpioInputs::add()
+    bool level{false};
+    std::chrono::nanoseconds time{0};  // kernel timestamp of the settling edge
+};
+
+// Many edge-event inputs (keypad, door sensors) in one wait. Idle inputs
+// cost nothing: dispatch() sleeps in epoll_wait() until an edge arrives
+// or a debounce window ends, and fd() lets an existing poll/epoll loop
+// wait on all of them at once.
+//
+// Debouncing: after an edge, the input must hold its new level for the
+// debounce window before the change is reported; further edges restart
+// the window, so contact bounce and short glitches are swallowed. A zero
+// window reports every level change as it arrives.
+class GpioInputs {
+public:
+    using Handler = std::function<void(const GpioInputEvent&)>;
+    // Takes one queued edge without blocking; false when there is none.
+    using ReadEdge = std::function<bool(GpioEdgeEvent&)>;
+
+    GpioInputs();
+    ~GpioInputs();
+
+    GpioInputs(const GpioInputs&) = delete;
+    GpioInputs& operator=(const GpioInputs&) = delete;
+
+    // `line` must be requested for edge events (GpioEdge::Both to see
+    // both levels) and outlive its registration. Returns the input's id.
+    int add(GpioLine& line, std::chrono::milliseconds debounce, Handler handler);
+    // Any edge source: `fd` readable when read_edge() has something.
+    int add(int fd, bool level, ReadEdge read_edge, std::chrono::milliseconds debounce,
+            Handler handler);
+    void remove(int id);
+    size_t size() const { return inputs_.size(); }
+
+    // Debounced level as last reported (the initial level until then).
+    bool level(int id) const;
+
+    // Wait up to timeout (-1 = forever) and run the handlers of the
+    // changes that settled. Returns how many ran. Handlers may add() and
+    // remove().
+    int dispatch(std::chrono::milliseconds timeout);
+    // epoll descriptor: readable when dispatch() has work.
+    int fd() const { return epoll_fd_; }
+
+private:
+    struct Input;
+
+    Input* find(int id) const;
+    void arm_timer();
+
+    int epoll_fd_{-1};
+    int timer_fd_{-1};
+    int next_id_{1};
+    std::vector<std::unique_ptr<Input>> inputs_;
+};
+
 class SoftPwm {
 public:
     SoftPwm(GpioLine& line, int frequency_hz);
@@ -1,7 +1,49 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
+// Panel orientation, clockwise. Applied while rasterizing: drawing calls take
+// logical coordinates and pixels land pre-rotated in the panel's native
+// page layout, so a rotated screen costs no extra pass over the frame.
+enum class Rotation { Deg0 = 0, Deg90 = 1, Deg180 = 2, Deg270 = 3 };
+
+// Axis-aligned rectangle in pixels (x, y = top-left). Used for dirty regions.
+struct Rect {
+    int x{0};
+    int y{0};
+    int w{0};
+    int h{0};
+
+    bool empty() const { return w <= 0 || h <= 0; }
+    // Smallest rectangle covering both (an empty operand is ignored).
+    Rect united(const Rect& o) const;
+    Rect intersected(const Rect& o) const;
+};
+
+// Maps logical (x, y) to native framebuffer coordinates.
+// Mirroring is applied in logical space, then the rotation.
+struct PixelMap {
+    int xx{1}, xy{0}, x0{0};  // native x = xx*x + xy*y + x0
+    int yx{0}, yy{1}, y0{0};  // native y = yx*x + yy*y + y0
+    bool identity{true};
+
+    static PixelMap make(int native_w, int native_h, Rotation r,
+                         bool mirror_x = false, bool mirror_y = false);
+
+    int native_x(int x, int y) const { return xx * x + xy * y + x0; }
+    int native_y(int x, int y) const { return yx * x + yy * y + y0; }
+    // Native rectangle covering a logical one (e.g. a dirty rect for a
+    // partial flush).
+    Rect native_rect(const Rect& r) const;
+};
+
+// Built-in 5x7 font used by text(): five column bytes (bit 0 on top) for
+// ASCII 32..127, '?' for anything else. Characters step 6 pixels.
+const uint8_t* font5x7_glyph(char c);
+
+// Runtime-sized frame. For one fixed panel size see MonoGfxT
+// (mono_gfx_fixed.h), the same API with the geometry as constants.
 class MonoGfx {
 public:
     MonoGfx(int width, int height);
@@ -9,6 +51,18 @@ public:
     std::vector<unsigned char>& fb() { return fb_; }
     const std::vector<unsigned char>& fb() const { return fb_; }
 
+    // Native (panel/framebuffer) geometry.
+    int native_width() const { return w_; }
+    int native_height() const { return h_; }
+
+    // Logical geometry as seen by drawing calls (swapped for 90/270).
+    int width() const { return lw_; }
+    int height() const { return lh_; }
+
+    void set_orientation(Rotation r, bool mirror_x = false, bool mirror_y = false);
+    Rotation rotation() const { return rot_; }
+    const PixelMap& pixel_map() const { return map_; }
+
     void clear();
     void pixel(int x, int y, bool on=true);
     void hline(int x0, int x1, int y, bool on=true);
@@ -19,6 +73,11 @@ public:
 
 private:
     int w_, h_;
+    int lw_, lh_;
+    Rotation rot_{Rotation::Deg0};
+    PixelMap map_;
     std::vector<unsigned char> fb_;
     void draw_char(int x, int y, char c, bool on);
+    // Logical rect (inclusive corners), clipped, as one native rect fill
+    void fill_span(int x0, int y0, int x1, int y1, bool on);
 };
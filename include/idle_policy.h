@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+enum class IdleState {
+    Active,   // rendering, full backlight
+    Dimmed,   // nothing changed for a while: backlight down, no rendering
+    Asleep,   // panel in its sleep mode, backlight off
+};
+
+// Power policy for a unit that mostly shows the same screen, e.g. on
+// backup battery. Activity (new content, a touch, a key) keeps it Active;
+// after dim_after without any it goes Dimmed, after sleep_after Asleep.
+// The next activity brings it straight back to Active.
+//
+// on_change carries out each transition (backlight, panel sleep/wake) on
+// the thread that calls update(), which should be the one that drives the
+// panel. Between transitions wait() blocks in poll(): asleep, with no
+// activity, the loop has no wakeups at all.
+class IdlePolicy {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Change = std::function<void(IdleState from, IdleState to)>;
+
+    // Timeouts count from the last activity; zero skips that state.
+    // Throws std::runtime_error when the eventfd cannot be created.
+    IdlePolicy(std::chrono::milliseconds dim_after, std::chrono::milliseconds sleep_after,
+               Change on_change);
+    ~IdlePolicy();
+
+    IdlePolicy(const IdlePolicy&) = delete;
+    IdlePolicy& operator=(const IdlePolicy&) = delete;
+
+    // Any thread, and async-signal-safe.
+    void activity();
+    // Make a blocked wait() return without counting as activity, so the
+    // loop can serve other requests (e.g. a signal) and go back to wait.
+    // Any thread, and async-signal-safe.
+    void wake();
+
+    // Take pending activity and apply the transitions due by now. Returns
+    // true when there was activity since the last call.
+    bool update();
+    IdleState state() const { return state_; }
+
+    // Block until activity() or the next transition is due, at most
+    // `timeout` (-1 = no limit). Returns at once if activity is pending.
+    void wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+    // Readable when activity is pending, for an existing poll/epoll loop.
+    int fd() const { return fd_; }
+
+    // Due time of the next transition; time_point::max() when Asleep (or
+    // nothing further is configured).
+    Clock::time_point next_transition() const;
+
+private:
+    void enter(IdleState s);
+
+    std::chrono::milliseconds dim_after_;
+    std::chrono::milliseconds sleep_after_;
+    Change on_change_;
+    int fd_{-1};  // eventfd, written by activity() and wake()
+    std::atomic<bool> active_{false};  // set by activity() only
+    IdleState state_{IdleState::Active};
+    Clock::time_point last_activity_;
+};
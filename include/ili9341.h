@@ -0,0 +1,13 @@
+#pragma once
+
+#include "tft_panel.h"
+
+// ILI9341: 240x320 GRAM, RGB565.
+class Ili9341 : public TftPanel {
+public:
+    static const TftController kController;
+
+    // Rotations 1 and 3 swap width and height.
+    Ili9341(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width = 240, int height = 320,
+            uint8_t rotation = 0);
+};
@@ -1,38 +1,44 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
-#include "gpio_gpiod.h"
-#include "spi_linux.h"
+#include "mono_gfx_fixed.h"
+#include "tft_panel.h"
 
-class Ili9488 {
+// ILI9488: 320x480 GRAM, RGB666 over SPI (the controller has no 16 bit
+// pixel format on its serial interface).
+class Ili9488 : public TftPanel {
 public:
-    Ili9488(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width = 480, int height = 320);
+    static const TftController kController;
 
-    void reset();
-    void init();
-    void set_rotation(uint8_t rotation);
-
-    void fill(uint16_t color565);
-    void set_mono_framebuffer(const std::vector<uint8_t>& fb,
-                              uint16_t fg_color565 = 0xFFFF,
-                              uint16_t bg_color565 = 0x0000);
+    // Default geometry is landscape: rotation 3 (270 degrees), 480x320.
+    // Rotations 1 and 3 are 480x320, 0 and 2 are 320x480.
+    Ili9488(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width = 480, int height = 320,
+            uint8_t rotation = 3);
 
     static std::vector<uint8_t> mono_to_rgb666(const std::vector<uint8_t>& mono_fb,
                                                int width,
                                                int height,
                                                uint16_t fg_color565 = 0xFFFF,
                                                uint16_t bg_color565 = 0x0000);
-
-private:
-    void cmd(uint8_t b);
-    void data(const uint8_t* p, size_t n);
-    void set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
-
-    SpiLinux& spi_;
-    GpioLine& dc_;
-    GpioLine& rst_;
-    int w_;
-    int h_;
+    // Into `out`, resized to width * height * 3; a buffer kept across
+    // frames keeps its capacity, so this does not allocate after the first
+    static void mono_to_rgb666(const std::vector<uint8_t>& mono_fb, int width, int height,
+                               std::vector<uint8_t>& out, uint16_t fg_color565 = 0xFFFF,
+                               uint16_t bg_color565 = 0x0000);
+
+    // Fixed-size form: a MonoGfxT frame into `out`, which the caller keeps
+    // across frames. Bounds and strides are constants here.
+    template <int W, int H>
+    static void mono_to_rgb666(const MonoGfxT<W, H>& gfx,
+                               std::array<uint8_t, static_cast<size_t>(W) * H * 3>& out,
+                               uint16_t fg_color565 = 0xFFFF,
+                               uint16_t bg_color565 = 0x0000) {
+        uint8_t fg[3], bg[3];
+        mono_encode_pixel(fg_color565, 3, fg);
+        mono_encode_pixel(bg_color565, 3, bg);
+        mono_expand<3>(gfx.fb().data(), MonoStride<W>{}, Rect{0, 0, W, H}, fg, bg, out.data());
+    }
 };
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graphics.h"
+
+// Headless image output for replay frames, test artifacts and golden-image
+// regression tests.
+//
+// PNG: 8-bit grayscale (channels = 1) or RGB (channels = 3), rows top to
+// bottom. Image data goes into stored (uncompressed) deflate blocks, so there
+// is no zlib dependency; files are about the size of the raw pixels.
+//
+// PNM: P4 (bitmap), P5 (gray) and P6 (RGB), binary variants only. These are
+// the golden-file format: trivial to parse, diffable by size, and P4 stores a
+// 128x64 mono frame in 1 KiB.
+
+// 8-bit image, rows top to bottom, `channels` bytes per pixel.
+struct Image {
+    int width{0};
+    int height{0};
+    int channels{1};
+    std::vector<uint8_t> pixels;
+
+    Image() = default;
+    Image(int w, int h, int ch, uint8_t fill = 0);
+
+    bool empty() const { return width <= 0 || height <= 0; }
+    uint8_t* at(int x, int y) { return pixels.data() + (static_cast<size_t>(y) * width + x) * channels; }
+    const uint8_t* at(int x, int y) const {
+        return pixels.data() + (static_cast<size_t>(y) * width + x) * channels;
+    }
+    // Gray with only 0 and 255 (written as P4).
+    bool bilevel() const;
+};
+
+// Page-packed 1bpp framebuffer (MonoGfx / St7565 layout) to gray. Set bits
+// are ink: black on white, the way the ST7565 glass shows them.
+Image image_from_mono(const std::vector<uint8_t>& pages, int width, int height);
+// The native framebuffer, i.e. exactly what is sent to the panel.
+Image image_from_mono(const MonoGfx& gfx);
+// RGB666 (3 bytes per pixel, top 6 bits used, as Ili9488::mono_to_rgb666
+// produces) to RGB888 with the low bits filled in.
+Image image_from_rgb666(const std::vector<uint8_t>& rgb666, int width, int height);
+
+std::vector<uint8_t> encode_png(int width, int height, int channels, const uint8_t* pixels);
+std::vector<uint8_t> encode_png(const Image& img);
+
+// P4 when img.bilevel(), otherwise P5/P6.
+std::vector<uint8_t> encode_pnm(const Image& img);
+// P4 straight from a page-packed framebuffer.
+std::vector<uint8_t> encode_pbm(const std::vector<uint8_t>& pages, int width, int height);
+// P4 becomes gray 0/255. Throws std::runtime_error on anything else.
+Image decode_pnm(const std::vector<uint8_t>& data);
+
+// File variants. Throw std::runtime_error on I/O errors.
+void write_png(const std::string& path, int width, int height, int channels,
+               const uint8_t* pixels);
+void write_png(const std::string& path, const Image& img);
+void write_pnm(const std::string& path, const Image& img);
+void write_pbm(const std::string& path, const std::vector<uint8_t>& pages, int width, int height);
+Image read_pnm(const std::string& path);
+
+// Result of comparing an image against its expected (golden) version.
+struct ImageDiff {
+    bool size_mismatch{false};
+    uint64_t pixels{0};     // compared
+    uint64_t differing{0};  // pixels with any channel off by more than the tolerance
+    int max_delta{0};
+    Rect bounds;            // box around the differing pixels
+
+    bool identical() const { return !size_mismatch && differing == 0; }
+    // One line, e.g. "37 of 8192 pixels differ (max delta 255) in 12x9 at (40,20)".
+    std::string summary() const;
+};
+
+// Gray and RGB images compare as RGB. tolerance is per channel.
+ImageDiff compare_images(const Image& expected, const Image& actual, int tolerance = 0);
+
+// Visual diff report (RGB, size of `expected`): the expected image faded
+// out, pixels the actual image gained in red and lost in blue (by
+// brightness), other changes in magenta.
+Image diff_image(const Image& expected, const Image& actual, int tolerance = 0);
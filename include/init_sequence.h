@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Controller bring-up described as data.
+//
+// Each step is a command byte, its parameter bytes and the time the
+// controller needs after it before it accepts the next command. Delays are
+// not slept where they occur: they move a CommandPacer deadline and the
+// driver's next command waits out whatever is left. A trailing delay (after
+// reset, after Sleep Out) therefore overlaps with whatever the caller does
+// next, e.g. loading fonts or rasterizing the first frame.
+
+struct InitStep {
+    static constexpr size_t kMaxParams = 16;
+
+    uint8_t cmd;
+    uint8_t n;                    // parameter count
+    uint8_t params[kMaxParams];
+    uint16_t delay_ms;            // before the next command
+};
+
+// Where a command's parameter bytes go. MIPI DCS controllers (ILI9488,
+// ST7789, ILI9341) take them as data (D/C high); ST756x controllers take
+// every byte, parameters included, on the command path (D/C low).
+enum class ParamPath { Data, Command };
+
+class CommandPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Earliest time for the next command is at least `d` from now.
+    void delay(std::chrono::milliseconds d);
+    // Sleep until the deadline (no-op when it has passed).
+    void wait();
+    bool pending() const { return pending_; }
+    Clock::time_point ready_at() const { return ready_at_; }
+
+private:
+    Clock::time_point ready_at_{};
+    bool pending_{false};
+};
+
+// One bus write: set D/C to `dc`, then send the bytes.
+using BusWrite = std::function<void(bool dc, const uint8_t* p, size_t n)>;
+
+// Send `steps` with as few bus writes as the D/C line allows: consecutive
+// bytes at the same D/C level go out in one write, split only where a step
+// has a delay. With ParamPath::Command a whole ST7565 init is one write;
+// with ParamPath::Data parameterless commands share a write. Waits on
+// `pacer` before each write; the last step's delay is left pending.
+// Returns the number of writes.
+size_t run_init_steps(const InitStep* steps, size_t count, ParamPath path,
+                      CommandPacer& pacer, const BusWrite& write);
+
+inline size_t run_init_steps(const std::vector<InitStep>& steps, ParamPath path,
+                             CommandPacer& pacer, const BusWrite& write) {
+    return run_init_steps(steps.data(), steps.size(), path, pacer, write);
+}
+
+// Register steps of `steps` to put back on a running controller (the panel
+// watchdog): software resets (`reset_cmd`: 0x01 for MIPI DCS, 0xE2 for
+// ST756x) are dropped, since they would return every register to its
+// default for as long as the rest takes. Without keep_delays the delays go
+// too: registers re-sent to a powered controller need no settling time.
+std::vector<InitStep> resend_steps(const std::vector<InitStep>& steps, uint8_t reset_cmd,
+                                   bool keep_delays);
+
+// Init scripts, so panel variants can be brought up without code changes.
+// One step per line: the command byte, then its parameter bytes, all hex
+// (with or without 0x), and optionally "delay <ms>". '#' starts a comment.
+//
+//   # ILI9488 power control
+//   C0 17 15
+//   11 delay 5      # Sleep out
+//
+// Throws std::runtime_error naming the line on malformed input.
+std::vector<InitStep> parse_init_script(const std::string& text);
+std::vector<InitStep> load_init_script(const std::string& path);
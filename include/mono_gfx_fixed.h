@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include "graphics.h"
+#include "mono_kernels.h"
+
+// MonoGfx with the panel geometry fixed at compile time, for builds that
+// drive one panel size (MonoGfxT<128, 64> for the ST7565, MonoGfxT<480,
+// 320> for the ILI9488 in landscape). Same drawing API and frame layout;
+// the frame is a std::array and every stride is a constant, so the inner
+// loops (see mono_kernels.h) unroll and vectorize. MonoGfx stays the type
+// for sizes only known at run time.
+//
+// The frame lives inside the object: W * H / 8 bytes, 19 KB at 480x320,
+// so large ones belong on the heap or in static storage, not on a small
+// thread stack.
+template <int W, int H>
+class MonoGfxT {
+    static_assert(W > 0 && H > 0 && H % 8 == 0, "MonoGfxT: height must be a multiple of 8");
+
+public:
+    static constexpr int kWidth = W;
+    static constexpr int kHeight = H;
+    static constexpr size_t kBytes = static_cast<size_t>(W) * static_cast<size_t>(H / 8);
+    using Frame = std::array<unsigned char, kBytes>;
+
+    MonoGfxT() { fb_.fill(0x00); }
+
+    Frame& fb() { return fb_; }
+    const Frame& fb() const { return fb_; }
+
+    static constexpr int native_width() { return W; }
+    static constexpr int native_height() { return H; }
+    int width() const { return lw_; }
+    int height() const { return lh_; }
+
+    void set_orientation(Rotation r, bool mirror_x = false, bool mirror_y = false) {
+        rot_ = r;
+        const bool swap = (r == Rotation::Deg90 || r == Rotation::Deg270);
+        lw_ = swap ? H : W;
+        lh_ = swap ? W : H;
+        map_ = PixelMap::make(W, H, r, mirror_x, mirror_y);
+    }
+    Rotation rotation() const { return rot_; }
+    const PixelMap& pixel_map() const { return map_; }
+
+    void clear() { fb_.fill(0x00); }
+
+    void pixel(int x, int y, bool on = true) {
+        if (x < 0 || y < 0 || x >= lw_ || y >= lh_) return;
+        if (map_.identity) mono_set(fb_.data(), MonoStride<W>{}, x, y, on);
+        else mono_set(fb_.data(), MonoStride<W>{}, map_.native_x(x, y), map_.native_y(x, y), on);
+    }
+    void hline(int x0, int x1, int y, bool on = true) {
+        if (x0 > x1) std::swap(x0, x1);
+        fill_span(x0, y, x1, y, on);
+    }
+    void vline(int x, int y0, int y1, bool on = true) {
+        if (y0 > y1) std::swap(y0, y1);
+        fill_span(x, y0, x, y1, on);
+    }
+    void rect(int x0, int y0, int x1, int y1, bool on = true) {
+        if (x0 > x1) std::swap(x0, x1);
+        if (y0 > y1) std::swap(y0, y1);
+        hline(x0, x1, y0, on);
+        hline(x0, x1, y1, on);
+        vline(x0, y0, y1, on);
+        vline(x1, y0, y1, on);
+    }
+    void fill_rect(int x0, int y0, int x1, int y1, bool on = true) {
+        if (x0 > x1) std::swap(x0, x1);
+        if (y0 > y1) std::swap(y0, y1);
+        fill_span(x0, y0, x1, y1, on);
+    }
+    // Built-in 5x7 font, as MonoGfx::text()
+    void text(int x, int y, const std::string& s, bool on = true) {
+        for (char c : s) {
+            const uint8_t* g = font5x7_glyph(c);
+            for (int col = 0; col < 5; ++col) {
+                for (int row = 0; row < 7; ++row) {
+                    if ((g[col] >> row) & 1u) pixel(x + col, y + row, on);
+                }
+            }
+            x += 6;
+            if (x >= lw_) break;
+        }
+    }
+
+private:
+    void fill_span(int x0, int y0, int x1, int y1, bool on) {
+        const Rect r = Rect{x0, y0, x1 - x0 + 1, y1 - y0 + 1}.intersected(Rect{0, 0, lw_, lh_});
+        if (r.empty()) return;
+        mono_fill(fb_.data(), MonoStride<W>{}, map_.identity ? r : map_.native_rect(r), on);
+    }
+
+    int lw_{W};
+    int lh_{H};
+    Rotation rot_{Rotation::Deg0};
+    PixelMap map_;
+    Frame fb_;
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "graphics.h"
+
+// Inner loops over page-packed 1bpp frames (the MonoGfx layout: byte
+// page * width + x holds rows 8*page .. 8*page+7 of column x, LSB on top),
+// shared by the runtime-sized types and their fixed-size variants.
+//
+// `Stride` is the frame width: an int, or std::integral_constant<int, W>
+// (MonoStride<W>) when the geometry is fixed at compile time. With the
+// latter `page * width` is a constant multiply or a shift and loop bounds
+// are known, so the compiler can unroll and vectorize.
+
+template <int W>
+using MonoStride = std::integral_constant<int, W>;
+
+// Byte holding native (x, y); no bounds checks.
+template <class Stride>
+inline size_t mono_index(Stride width, int x, int y) {
+    return static_cast<size_t>(static_cast<unsigned>(y) / 8u) * static_cast<size_t>(static_cast<int>(width)) +
+           static_cast<size_t>(x);
+}
+
+template <class Stride>
+inline void mono_set(unsigned char* fb, Stride width, int x, int y, bool on) {
+    const unsigned char mask = static_cast<unsigned char>(1u << (static_cast<unsigned>(y) % 8u));
+    unsigned char& b = fb[mono_index(width, x, y)];
+    if (on) b |= mask;
+    else b &= static_cast<unsigned char>(~mask);
+}
+
+// Sets or clears native rect r, which the caller has clipped to the frame:
+// a page at a time, one masked byte per column.
+template <class Stride>
+inline void mono_fill(unsigned char* fb, Stride width, const Rect& r, bool on) {
+    if (r.empty()) return;
+    const int y1 = r.y + r.h;
+    for (int page = r.y / 8; page <= (y1 - 1) / 8; ++page) {
+        const int lo = std::max(r.y - page * 8, 0);
+        const int hi = std::min(y1 - page * 8, 8);
+        const unsigned char mask = static_cast<unsigned char>((0xFFu << lo) & (0xFFu >> (8 - hi)));
+        unsigned char* row = fb + mono_index(width, r.x, page * 8);
+        if (on) {
+            for (int x = 0; x < r.w; ++x) row[x] |= mask;
+        } else {
+            const unsigned char keep = static_cast<unsigned char>(~mask);
+            for (int x = 0; x < r.w; ++x) row[x] &= keep;
+        }
+    }
+}
+
+// 1bpp MSB-first bitmap (FreeType FT_RENDER_MODE_MONO) at native (x, y),
+// clipped to width x height.
+struct MonoBitmap {
+    const unsigned char* rows;
+    int pitch;  // bytes per row
+    int width;
+    int height;
+};
+
+template <class Stride>
+inline void mono_blit(unsigned char* fb, Stride width, int height, const MonoBitmap& bm, int x, int y,
+                      bool on) {
+    const int c0 = std::max(0, -x);
+    const int c1 = std::min(bm.width, static_cast<int>(width) - x);
+    const int r0 = std::max(0, -y);
+    const int r1 = std::min(bm.height, height - y);
+    for (int row = r0; row < r1; ++row) {
+        const unsigned char* src = bm.rows + static_cast<size_t>(row) * static_cast<size_t>(bm.pitch);
+        const int py = y + row;
+        unsigned char* page = fb + mono_index(width, 0, py);
+        const unsigned char mask = static_cast<unsigned char>(1u << (static_cast<unsigned>(py) % 8u));
+        if (on) {
+            for (int col = c0; col < c1; ++col) {
+                if ((src[col >> 3] >> (7 - (col & 7))) & 1) page[x + col] |= mask;
+            }
+        } else {
+            const unsigned char keep = static_cast<unsigned char>(~mask);
+            for (int col = c0; col < c1; ++col) {
+                if ((src[col >> 3] >> (7 - (col & 7))) & 1) page[x + col] &= keep;
+            }
+        }
+    }
+}
+
+// Controller wire format of an RGB565 color: 2 bytes (RGB565, big-endian
+// as sent) or 3 (RGB666, each component left-aligned in its byte).
+inline void mono_encode_pixel(uint16_t c565, int bytes_per_pixel, uint8_t out[3]) {
+    if (bytes_per_pixel == 2) {
+        out[0] = static_cast<uint8_t>(c565 >> 8);
+        out[1] = static_cast<uint8_t>(c565 & 0xFF);
+        return;
+    }
+    out[0] = static_cast<uint8_t>(((c565 >> 11) & 0x1F) << 3);
+    out[1] = static_cast<uint8_t>(((c565 >> 5) & 0x3F) << 2);
+    out[2] = static_cast<uint8_t>((c565 & 0x1F) << 3);
+}
+
+// Rect r of the frame to row-major pixels of BPP bytes, fg where a bit is
+// set; the fixed pixel size makes the copies plain stores.
+template <int BPP, class Stride>
+inline void mono_expand(const unsigned char* fb, Stride width, const Rect& r, const uint8_t* fg,
+                        const uint8_t* bg, uint8_t* out) {
+    for (int y = r.y; y < r.y + r.h; ++y) {
+        const unsigned char* page = fb + mono_index(width, 0, y);
+        const unsigned char mask = static_cast<unsigned char>(1u << (static_cast<unsigned>(y) % 8u));
+        for (int x = r.x; x < r.x + r.w; ++x) {
+            std::memcpy(out, (page[x] & mask) ? fg : bg, BPP);
+            out += BPP;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "bus_recorder.h"
+
+// Offline panel models for replaying captured bus traffic.
+//
+// A model interprets the command/data stream the way the controller does
+// (addressing, scan direction, pixel format) and renders what the glass
+// would show as 8-bit RGB. A "frame" is counted whenever a write fills the
+// last pixel of the addressed area (the whole screen for full-frame
+// updates).
+
+class PanelSim {
+public:
+    virtual ~PanelSim() = default;
+
+    // Bytes sent with D/C low are commands (and their parameters for
+    // controllers that take them on the command path), D/C high is data.
+    // Returns the number of frames completed by these bytes.
+    virtual int feed(bool dc, const uint8_t* p, size_t n) = 0;
+    // Hardware reset (RESET line pulled low).
+    virtual void reset() = 0;
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    // Current panel image, width() * height() * 3 bytes, RGB888.
+    virtual void render_rgb(std::vector<uint8_t>& rgb) const = 0;
+};
+
+// ST7565 (132x65 GRAM, 128x64 visible). The image is upright when the scan
+// directions match St7565's defaults (SEG normal, COM reversed).
+class St7565Sim : public PanelSim {
+public:
+    St7565Sim(int width = 128, int height = 64);
+
+    int feed(bool dc, const uint8_t* p, size_t n) override;
+    void reset() override;
+    int width() const override { return w_; }
+    int height() const override { return h_; }
+    void render_rgb(std::vector<uint8_t>& rgb) const override;
+
+    bool display_on() const { return on_; }
+    uint8_t contrast() const { return contrast_; }
+
+private:
+    static constexpr int kCols = 132;
+    static constexpr int kPages = 9;
+
+    void command(uint8_t c);
+
+    int w_, h_;
+    std::vector<uint8_t> gram_;
+    int page_{0};
+    int col_{0};
+    int start_line_{0};
+    bool on_{false};
+    bool seg_reverse_{false};
+    bool com_reverse_{false};
+    bool inverse_{false};
+    bool all_on_{false};
+    uint8_t contrast_{0x20};
+    uint8_t pending_{0};  // two-byte command waiting for its parameter
+};
+
+// ILI9488 over 4-wire SPI (320x480 GRAM). Handles CASET/PASET/RAMWR/
+// RAMWRC, MADCTL and COLMOD (RGB666 and RGB565). The image is the logical
+// view under the current MADCTL, i.e. what the driver's width x height
+// frame looks like, so landscape rotations give a landscape image.
+class Ili9488Sim : public PanelSim {
+public:
+    Ili9488Sim();
+
+    int feed(bool dc, const uint8_t* p, size_t n) override;
+    void reset() override;
+    int width() const override;
+    int height() const override;
+    void render_rgb(std::vector<uint8_t>& rgb) const override;
+
+    bool display_on() const { return on_; }
+    uint8_t madctl() const { return madctl_; }
+
+private:
+    static constexpr int kW = 320;
+    static constexpr int kH = 480;
+
+    bool write_pixel(const uint8_t* px);
+    void physical(int x, int y, int& px, int& py) const;
+
+    std::vector<uint8_t> gram_;  // physical RGB888
+    uint8_t cmd_{0};
+    size_t param_{0};
+    uint8_t params_[4]{};
+    int x0_{0}, x1_{kW - 1}, y0_{0}, y1_{kH - 1};
+    int cx_{0}, cy_{0};
+    uint8_t madctl_{0};
+    uint8_t colmod_{0x66};
+    bool on_{false};
+    bool writing_{false};
+    uint8_t partial_[3]{};
+    size_t partial_len_{0};
+};
+
+struct ReplayStats {
+    uint64_t events{0};
+    uint64_t spi_writes{0};
+    uint64_t spi_bytes{0};
+    uint64_t dc_toggles{0};
+    uint64_t resets{0};
+    uint64_t frames{0};
+    double duration_ms{0.0};      // first to last event
+    double frame_interval_min_ms{0.0};
+    double frame_interval_avg_ms{0.0};
+    double frame_interval_max_ms{0.0};
+    double frame_write_avg_ms{0.0};  // first byte after previous frame to frame end
+    double frame_write_max_ms{0.0};
+    double fps() const { return frame_interval_avg_ms > 0.0 ? 1000.0 / frame_interval_avg_ms : 0.0; }
+    double throughput_kbps() const {
+        return duration_ms > 0.0 ? static_cast<double>(spi_bytes) * 8.0 / duration_ms : 0.0;
+    }
+};
+
+// Drive `sim` with recorded events. on_frame(index, t_ns) runs after each
+// completed frame (the sim holds that frame's image at that point).
+ReplayStats replay_bus(const std::vector<BusEvent>& events, PanelSim& sim,
+                       const std::function<void(uint64_t, uint64_t)>& on_frame = {});
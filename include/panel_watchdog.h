@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// What a health check found.
+enum class PanelHealth {
+    Ok,
+    Registers,  // settings flipped, display memory intact: reassert them
+    Lost,       // the controller reset itself: registers and frame are gone
+};
+
+struct WatchdogStats {
+    uint64_t checks{0};     // periods acted on
+    uint64_t reasserts{0};  // reassert() calls
+    uint64_t restores{0};   // restore() calls
+};
+
+// Keeps a panel alive through electrostatic discharges, which can flip
+// controller settings or reset the controller outright. Once a period,
+// between frames:
+//
+// - with a check (the panel's status can be read back), reassert() the
+//   registers when they are off and restore() registers plus the last
+//   frame when the controller lost everything. A healthy panel costs one
+//   status read.
+// - without one (write-only bus), reassert() every period, which is a few
+//   bytes and harmless when nothing is wrong, and restore() every
+//   repaint_every-th period to repair the frame too.
+//
+// Both actions skip the reset pulse and the init delays (see
+// TftPanel::restore(), St7565::restore()), so the screen comes back in
+// one frame's bus time instead of a restart.
+class PanelWatchdog {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Check = std::function<PanelHealth()>;
+    using Action = std::function<void()>;
+
+    // check may be empty. repaint_every = 0 never restores blindly.
+    PanelWatchdog(std::chrono::milliseconds period, Check check, Action reassert, Action restore,
+                  unsigned repaint_every = 0);
+
+    // Call from the thread that drives the panel, between frames. Does
+    // nothing until a period has passed since the last time it acted.
+    // Returns what the check found (Ok when not due or without a check).
+    PanelHealth poll();
+    // When poll() will next act, for loops that sleep until then.
+    Clock::time_point next_due() const { return next_; }
+
+    const WatchdogStats& stats() const { return stats_; }
+
+private:
+    std::chrono::milliseconds period_;
+    Check check_;
+    Action reassert_;
+    Action restore_;
+    unsigned repaint_every_;
+    unsigned blind_count_{0};
+    Clock::time_point next_;
+    WatchdogStats stats_;
+};
@@ -1,12 +1,38 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
+class BusRecorder;
+
+// One contiguous piece of a write; several are queued per SPI_IOC_MESSAGE.
+// rx, when set, receives the len bytes clocked in while tx goes out.
+struct SpiSegment {
+    const uint8_t* tx;
+    size_t len;
+    uint8_t* rx{nullptr};
+    uint32_t speed_hz{0};  // 0 = the clock given to open()
+};
+
+struct SpiStats {
+    uint64_t messages{0};   // SPI_IOC_MESSAGE ioctls (syscalls)
+    uint64_t transfers{0};  // spi_ioc_transfer segments
+    uint64_t bytes{0};
+};
+
 class SpiLinux {
 public:
+    // spidev's default bufsiz. spidev rejects a message whose transfers add
+    // up to more than bufsiz, so open() reads the real value from
+    // /sys/module/spidev/parameters/bufsiz (raise it with spidev.bufsiz=).
+    static constexpr size_t kDefaultMaxTransfer = 4096;
+    // Default DMA-friendly segment (one page); transfers never exceed it.
+    static constexpr size_t kDefaultSegmentSize = 4096;
+    static constexpr size_t kMaxSegmentsPerMessage = 64;
+
     explicit SpiLinux(std::string dev);
-    ~SpiLinux();
+    virtual ~SpiLinux();
 
     SpiLinux(const SpiLinux&) = delete;
     SpiLinux& operator=(const SpiLinux&) = delete;
@@ -14,10 +40,56 @@ public:
     void open(uint32_t speed_hz = 8000000, uint8_t mode = 0);
     void close();
 
+    // Writes are split into segments of at most segment_size() bytes, and
+    // consecutive segments are packed into one SPI_IOC_MESSAGE up to
+    // max_transfer() bytes, so a full frame costs len / max_transfer()
+    // syscalls regardless of how the caller chunks it.
     void write(const uint8_t* data, size_t len);
     void write(const std::vector<uint8_t>& v) { write(v.data(), v.size()); }
 
+    // Gather-write: queue several buffers (e.g. the same scanline repeated)
+    // with the same packing as write().
+    void write_segments(const SpiSegment* segs, size_t n);
+
+    // Full duplex: clocks out tx and captures as many bytes into rx, as
+    // one message with CS held throughout. len must fit max_transfer().
+    // Devices on other chip selects of the same controller (e.g. a touch
+    // controller next to the panel) are queued by the kernel between
+    // whole messages, so a long write() lets them in every max_transfer()
+    // bytes.
+    // speed_hz overrides the clock for this message (reads are often
+    // slower than writes); 0 keeps open()'s.
+    void transfer(const uint8_t* tx, uint8_t* rx, size_t len, uint32_t speed_hz = 0);
+
+    size_t max_transfer() const { return max_transfer_; }
+    // Override the per-message limit (e.g. when bufsiz cannot be read).
+    void set_max_transfer(size_t bytes);
+    size_t segment_size() const { return segment_size_; }
+    void set_segment_size(size_t bytes);
+
+    const SpiStats& stats() const { return stats_; }
+    void reset_stats() { stats_ = SpiStats{}; }
+
+    // Capture every write into `recorder` (nullptr detaches). The recorder
+    // must outlive this object or be detached first.
+    void set_recorder(BusRecorder* recorder) { recorder_ = recorder; }
+    BusRecorder* recorder() const { return recorder_; }
+
+    // Reads spidev's bufsiz module parameter; kDefaultMaxTransfer if absent.
+    static size_t query_spidev_bufsiz();
+
+protected:
+    // Submit segments as one message with CS held across them, filling the
+    // rx buffers of the segments that have one. The default issues
+    // SPI_IOC_MESSAGE(n) on the spidev fd.
+    virtual void transfer_message(const SpiSegment* segs, size_t n);
+
 private:
     std::string dev_;
     int fd_{-1};
+    uint32_t speed_hz_{0};
+    size_t max_transfer_{kDefaultMaxTransfer};
+    size_t segment_size_{kDefaultSegmentSize};
+    SpiStats stats_;
+    BusRecorder* recorder_{nullptr};
 };
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FtText;
+class MonoGfx;
+
+// How a sprite combines with what is already in the framebuffer.
+enum class BlitMode {
+    Opaque,       // sprite rectangle replaces the destination
+    Transparent,  // only set pixels are drawn (OR); zeros leave the destination
+    Masked,       // pixels under the sprite mask replace the destination
+};
+
+// Pre-rasterized 1bpp bitmap stored in the same page-packed layout as
+// MonoGfx (byte = 8 vertical pixels, LSB on top). Blitting copies whole
+// bytes per column, shifting across page boundaries for arbitrary y, so
+// icons and static labels skip MonoGfx::pixel and FreeType on redraw.
+class MonoSprite {
+public:
+    MonoSprite() = default;
+    MonoSprite(int width, int height);
+
+    // From page-packed data (width * ceil(height/8) bytes).
+    static MonoSprite from_pages(int width, int height, const uint8_t* pages);
+
+    // From row-major 1bpp data, MSB first (XBM-style icons use LSB first:
+    // pass lsb_first=true). stride is bytes per row.
+    static MonoSprite from_rows(int width, int height, const uint8_t* rows, int stride,
+                                bool lsb_first = false);
+
+    // Copy a MonoGfx's native framebuffer.
+    static MonoSprite from_gfx(const MonoGfx& gfx);
+
+    // Rasterize a label once with the FtText's current size. The sprite is
+    // as wide as the text advance and line_height() tall.
+    static MonoSprite from_text(FtText& ft, const std::string& utf8);
+
+    int width() const { return w_; }
+    int height() const { return h_; }
+    int pages() const { return (h_ + 7) / 8; }
+    bool empty() const { return w_ <= 0 || h_ <= 0; }
+
+    std::vector<uint8_t>& data() { return pix_; }
+    const std::vector<uint8_t>& data() const { return pix_; }
+
+    bool has_mask() const { return !mask_.empty(); }
+    const std::vector<uint8_t>& mask() const { return mask_; }
+    // Set mask from page-packed data (same size as data()).
+    void set_mask(std::vector<uint8_t> mask);
+    // Mask = set pixels grown by `outline` pixels (0 = exact shape), so
+    // masked blits punch a clean halo around glyphs on busy backgrounds.
+    void mask_from_pixels(int outline = 0);
+
+    bool get(int x, int y) const;
+    void set(int x, int y, bool on = true);
+
+    // Draw at (x, y) in the destination's logical coordinates, clipped.
+    void blit(MonoGfx& dst, int x, int y, BlitMode mode = BlitMode::Opaque) const;
+
+    // Draw columns [src_x, src_x + w) of the sprite at (x, y).
+    void blit_region(MonoGfx& dst, int x, int y, int src_x, int w,
+                     BlitMode mode = BlitMode::Opaque) const;
+
+private:
+    int w_{0};
+    int h_{0};
+    std::vector<uint8_t> pix_;
+    std::vector<uint8_t> mask_;
+
+    uint8_t rows_mask(int page) const;
+};
+
+// RGB666 sprite (3 bytes per pixel, same byte order as
+// Ili9488::mono_to_rgb666) with optional per-pixel transparency.
+class ColorSprite {
+public:
+    ColorSprite() = default;
+    ColorSprite(int width, int height);
+
+    // Expand a mono sprite once. With transparent_bg, clear pixels are
+    // transparent instead of bg_color565.
+    static ColorSprite from_mono(const MonoSprite& mono, uint16_t fg_color565,
+                                 uint16_t bg_color565 = 0x0000, bool transparent_bg = false);
+
+    int width() const { return w_; }
+    int height() const { return h_; }
+
+    void set_pixel(int x, int y, uint16_t color565);
+    void set_transparent(int x, int y);
+
+    // Blit into an RGB666 buffer of width * height * 3 bytes, clipped.
+    // Fully opaque rows are copied with memcpy.
+    void blit(std::vector<uint8_t>& rgb666, int width, int height, int x, int y) const;
+
+private:
+    int w_{0};
+    int h_{0};
+    std::vector<uint8_t> rgb_;
+    std::vector<uint8_t> alpha_;       // 1 = opaque, per pixel
+    std::vector<uint8_t> row_opaque_;  // 1 if the whole row is opaque
+};
+
+// Pre-rendered label cache: one MonoSprite per (font size, text) for a
+// given FtText, least recently used entries evicted beyond capacity.
+class TextSpriteCache {
+public:
+    explicit TextSpriteCache(FtText& ft, size_t capacity = 32);
+
+    const MonoSprite& get(const std::string& utf8);
+    size_t size() const { return lru_.size(); }
+    void clear();
+
+private:
+    struct Entry {
+        std::string key;
+        MonoSprite sprite;
+    };
+
+    FtText& ft_;
+    size_t capacity_;
+    std::list<Entry> lru_;  // front = most recent
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
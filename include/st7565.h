@@ -3,21 +3,55 @@
 #include <vector>
 #include "spi_linux.h"
 #include "gpio_gpiod.h"
+#include "init_sequence.h"
 
 class St7565 {
 public:
     St7565(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width=128, int height=64);
 
+    // Reset pulse; the settle time overlaps with the caller's next work
+    // (see init_sequence.h). A panel that kept power and configuration can
+    // skip reset() and go straight to init().
     void reset();
-    void init();
+    // With on = false the display stays off so the first frame can be
+    // written before it is shown with display_on(true).
+    void init(bool on = true);
+    // Replace the bias/power/contrast part of init() (display off, SEG/COM
+    // direction and display on are added around it), e.g. for an ST7567 or
+    // a glass that needs a different resistor ratio. See load_init_script().
+    void set_init_sequence(std::vector<InitStep> steps);
     void set_contrast(uint8_t v);
     void display_on(bool on);
+    // Power save: display off (AE) then all points on (A5), which the
+    // controller takes as sleep, shutting down its LCD power circuits and
+    // keeping the display RAM. sleep(false) is A4 then, if the display was
+    // on, AF; the retained frame shows again with nothing rewritten.
+    // reassert()/restore() do nothing while asleep.
+    void sleep(bool on);
+    bool sleeping() const { return sleeping_; }
+
+    // Scan direction (hardware mirroring). Defaults: SEG normal (A0),
+    // COM reversed (C8). Flipping both turns the image 180 degrees at no
+    // cost; 90/270 need MonoGfx rotation. 132-column controllers driving a
+    // 128-pixel glass usually need column_offset 4 with SEG reversed.
+    // Remembered and re-applied by init().
+    void set_scan_direction(bool seg_reverse, bool com_reverse, uint8_t column_offset = 0);
 
     void set_framebuffer(const std::vector<uint8_t>& fb);
     void clear();
 
+    // Recovery from discharges (see PanelWatchdog). The serial interface
+    // is write-only, so there is no status to check: reassert() re-sends
+    // the configuration, scan direction, contrast, start line, normal and
+    // display on/off state (a dozen bytes, no sleeps); restore() adds the
+    // last frame written, kept in a shadow copy.
+    void reassert();
+    void restore();
+    const std::vector<uint8_t>& shadow() const { return shadow_; }
+
 private:
     void cmd(uint8_t b);
+    void cmds(const uint8_t* p, size_t n);
     void data(const uint8_t* p, size_t n);
 
     SpiLinux& spi_;
@@ -25,4 +59,13 @@ private:
     GpioLine& rst_;
     int w_;
     int h_;
+    bool seg_reverse_{false};
+    bool com_reverse_{true};
+    uint8_t col_offset_{0};
+    bool on_{false};
+    bool sleeping_{false};
+    int contrast_{-1};  // set_contrast() value, -1 = the configuration's
+    std::vector<uint8_t> shadow_;
+    std::vector<InitStep> config_;
+    CommandPacer pacer_;
 };
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "tft_panel.h"
+
+// ST7789(V): 240x320 GRAM, RGB565. Also drives the common 240x240 modules;
+// the address window is offset for rotations that mirror the short glass
+// onto the far end of the GRAM.
+class St7789 : public TftPanel {
+public:
+    static const TftController kController;
+
+    // Rotations 1 and 3 swap width and height.
+    St7789(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width = 240, int height = 320,
+           uint8_t rotation = 0);
+};
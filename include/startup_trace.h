@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Boot-to-first-frame timeline. mark() stamps named milestones from any
+// thread; print() lists them with the time since process start and the step
+// from the previous mark.
+//
+// The origin is the process start time from /proc/self/stat, so time spent
+// in the loader and static initialization is included (to the resolution of
+// the scheduler tick, usually 10 ms). Without procfs the origin is the
+// construction of the trace.
+class StartupTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Mark {
+        double t_ms;
+        std::string what;
+    };
+
+    StartupTrace();
+
+    void mark(const std::string& what);
+    // Milliseconds since the origin.
+    double elapsed_ms() const;
+    // Offset of the construction from the process start (0 if unknown).
+    double construct_ms() const { return construct_ms_; }
+
+    std::vector<Mark> marks() const;
+    // Time of the first mark named `what`, -1 if absent.
+    double time_of(const std::string& what) const;
+
+    void print(std::ostream& os) const;
+
+private:
+    Clock::time_point origin_;
+    double construct_ms_{0.0};
+    mutable std::mutex mutex_;
+    std::vector<Mark> marks_;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gpio_gpiod.h"
+#include "graphics.h"
+#include "init_sequence.h"
+#include "panel_watchdog.h"
+#include "spi_linux.h"
+
+// What distinguishes one MIPI DCS TFT controller from another. The command
+// set (CASET/PASET/RAMWR, MADCTL, COLMOD, Sleep Out, Display On) is shared.
+struct TftController {
+    const char* name;
+    int gram_width;              // native (portrait) GRAM size
+    int gram_height;
+    int bytes_per_pixel;         // 2 = RGB565 (COLMOD 0x55), 3 = RGB666 (0x66)
+    uint8_t madctl[4];           // MADCTL per rotation 0..3
+    const InitStep* config;      // default steps between Sleep Out and MADCTL
+    size_t config_count;
+    uint16_t reset_ms;           // after reset/SWRESET, before Sleep Out
+    uint16_t sleep_out_ms;       // after Sleep Out, before the next command
+};
+
+// GRAM rows the refresh passes over a logical rect. The controller scans
+// GRAM rows 0 .. gram_height - 1 once per frame whatever MADCTL does to
+// the address mapping, so with MV set the scan runs along logical x.
+struct ScanSpan {
+    int first{0};          // lowest GRAM row
+    int last{-1};          // highest GRAM row
+    bool along_y{true};    // logical y is the scan axis (else x)
+    bool reversed{false};  // scan rows fall as the logical coordinate grows
+};
+
+// Common driver for SPI TFT controllers (4-wire, D/C line). Frames come in
+// as page-packed 1bpp buffers (MonoGfx layout) and are expanded to the
+// controller's pixel format on the way out.
+//
+// width/height are the logical size for the configured rotation (e.g.
+// 480x320 for a landscape ILI9488). Panels smaller than the GRAM (240x240
+// ST7789) get the address window offset that MADCTL mirroring requires.
+class TftPanel {
+public:
+    TftPanel(const TftController& controller, SpiLinux& spi, GpioLine& dc, GpioLine& rst,
+             int width, int height, uint8_t rotation);
+    virtual ~TftPanel() = default;
+
+    TftPanel(const TftPanel&) = delete;
+    TftPanel& operator=(const TftPanel&) = delete;
+
+    // Hardware reset pulse. The settle time is not slept here; the next
+    // command waits out what is left of it.
+    void reset();
+    // Full configuration. SWRESET is skipped right after reset(). With
+    // on = false the panel stays dark, so the first frame can be written
+    // before it is shown with display_on(true).
+    void init(bool on = true);
+    // Fast path for a panel that is already configured (the process was
+    // restarted, the panel kept power): no reset, no SWRESET, no sleep-out
+    // wait; the configuration is re-sent since all of it is idempotent.
+    void resume(bool on = true);
+    void display_on(bool on);
+    // Power saving: Display Off then Sleep In (SLPIN 0x10), which stops the
+    // panel's oscillator and drivers but keeps GRAM. sleep(false) is Sleep
+    // Out and, if the display was on, Display On: the retained frame is
+    // back without a pixel sent. While asleep the recovery calls below do
+    // nothing, since a sleeping panel reads as reset.
+    void sleep(bool on);
+    bool sleeping() const { return sleeping_; }
+    // Replace the controller's default configuration (sent between Sleep
+    // Out and MADCTL), e.g. with load_init_script() output for a module that
+    // needs power and gamma settings. Keep COLMOD matching the pixel format.
+    void set_init_sequence(std::vector<InitStep> steps);
+    // Tearing effect output (TEON 0x35, V-blank pulses only / TEOFF 0x34).
+    // Remembered and re-applied by init() and resume().
+    void set_tear_effect(bool on);
+    bool tear_effect() const { return tear_effect_; }
+    // Block until pending controller delays have passed.
+    void wait_ready() { pacer_.wait(); }
+
+    // Recovery from discharges (see PanelWatchdog). read_status() is
+    // RDDST (0x09) over MISO at a read-safe clock; modules that leave the
+    // controller's SDO unconnected read 0 or all ones, which health()
+    // takes for Lost, so check right after init() whether reads work.
+    uint32_t read_status();
+    PanelHealth check_health() { return sleeping_ ? PanelHealth::Ok : health(read_status()); }
+    PanelHealth health(uint32_t status) const {
+        return health(ctl_, rotation_, on_, tear_effect_, status);
+    }
+    static PanelHealth health(const TftController& ctl, uint8_t rotation, bool on,
+                              bool tear_effect, uint32_t status);
+    // Re-send the settings a discharge can flip (configuration, MADCTL,
+    // TE, normal mode, display on/off). GRAM is left alone; no sleeps.
+    void reassert();
+    // For a controller that reset itself: Sleep Out, the configuration,
+    // the shadow frame, then display on. No reset pulse, no SWRESET.
+    void restore();
+
+    // The last mono frame on the glass, which restore() writes back.
+    // set_mono_framebuffer() and set_mono_region() keep it; writers that
+    // stream pixels themselves (TftPresenter) record theirs here.
+    void keep_shadow(const std::vector<uint8_t>& fb, const Rect& r, uint16_t fg_color565,
+                     uint16_t bg_color565);
+    const std::vector<uint8_t>& shadow() const { return shadow_; }
+
+    // MADCTL rotation 0..3. Remembered and re-applied by init(). Rotations
+    // 1 and 3 swap the geometry: pass width/height to match.
+    void set_rotation(uint8_t rotation);
+    uint8_t rotation() const { return rotation_; }
+
+    int width() const { return w_; }
+    int height() const { return h_; }
+    const TftController& controller() const { return ctl_; }
+    ScanSpan scan_span(const Rect& r) const { return scan_span(ctl_, rotation_, w_, h_, r); }
+    static ScanSpan scan_span(const TftController& ctl, uint8_t rotation, int width, int height,
+                              const Rect& r);
+    int bytes_per_pixel() const { return ctl_.bytes_per_pixel; }
+
+    void fill(uint16_t color565);
+    void fill_rect(const Rect& r, uint16_t color565);
+
+    // Whole frame: width * height / 8 bytes.
+    void set_mono_framebuffer(const std::vector<uint8_t>& fb,
+                              uint16_t fg_color565 = 0xFFFF,
+                              uint16_t bg_color565 = 0x0000);
+    // Partial update: only `r` (clipped to the panel) of the full-size
+    // frame is expanded and sent.
+    void set_mono_region(const std::vector<uint8_t>& fb, const Rect& r,
+                         uint16_t fg_color565 = 0xFFFF,
+                         uint16_t bg_color565 = 0x0000);
+    // RAMWR streaming of pixels already in the controller's format,
+    // row-major within r (r.w * r.h * bytes_per_pixel() bytes).
+    void write_pixels(const Rect& r, const uint8_t* pixels, size_t n);
+    // Streaming form of write_pixels(): open the window (CASET/PASET/
+    // RAMWR), then send its pixels in order in as many pieces as suits the
+    // caller, e.g. one band at a time from another thread.
+    void begin_pixels(const Rect& r);
+    void stream_pixels(const uint8_t* pixels, size_t n) { data(pixels, n); }
+
+    // Expansion kernel: rect `r` of a page-packed frame `fb_width` pixels
+    // wide to row-major pixels, 2 bytes (RGB565, big-endian as sent) or
+    // 3 bytes (RGB666, left-aligned) each. `out` holds r.w * r.h * bpp bytes.
+    static void expand_mono(const uint8_t* fb, int fb_width, const Rect& r, int bytes_per_pixel,
+                            uint16_t fg_color565, uint16_t bg_color565, uint8_t* out);
+
+    static std::vector<uint8_t> mono_to_rgb565(const std::vector<uint8_t>& mono_fb,
+                                               int width,
+                                               int height,
+                                               uint16_t fg_color565 = 0xFFFF,
+                                               uint16_t bg_color565 = 0x0000);
+    // Into `out`, resized to width * height * 2 (no allocation once it has
+    // held a frame of that size)
+    static void mono_to_rgb565(const std::vector<uint8_t>& mono_fb, int width, int height,
+                               std::vector<uint8_t>& out, uint16_t fg_color565 = 0xFFFF,
+                               uint16_t bg_color565 = 0x0000);
+
+protected:
+    void cmd(uint8_t b);
+    void data(const uint8_t* p, size_t n);
+    void set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    void run_steps(const std::vector<InitStep>& steps);
+    InitStep madctl_step() const;
+    InitStep tear_step() const;
+
+    // Expanded-frame check shared by the mono entry points
+    static void check_mono_geometry(const std::vector<uint8_t>& mono_fb, int width, int height,
+                                    const char* who);
+
+    const TftController& ctl_;
+    SpiLinux& spi_;
+    GpioLine& dc_;
+    GpioLine& rst_;
+    int w_;
+    int h_;
+    uint8_t rotation_;
+    std::vector<InitStep> config_;
+    CommandPacer pacer_;
+    bool hw_reset_{false};  // reset() since the last init()
+    bool tear_effect_{false};
+    bool on_{false};                // display on, as last set
+    bool sleeping_{false};
+    std::vector<uint8_t> scratch_;  // expanded pixels, reused across frames
+    std::vector<uint8_t> shadow_;   // mono frame, MonoGfx layout
+    uint16_t shadow_fg_{0xFFFF};
+    uint16_t shadow_bg_{0x0000};
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "graphics.h"
+#include "tft_panel.h"
+
+// Timing of the last BandPipeline::run(), in milliseconds.
+struct PipelineStats {
+    size_t bands{0};
+    double convert_ms{0.0};  // caller thread, summed over bands
+    double send_ms{0.0};     // sender thread, summed over bands
+    double total_ms{0.0};    // run() entry to the last byte handed to send
+};
+
+// Two-stage pipeline: bands are produced on the calling thread into one of
+// two staging buffers while a persistent sender thread writes the other
+// one out. A run takes about max(convert, send) plus one band instead of
+// convert + send.
+class BandPipeline {
+public:
+    // Fill `out` (band_capacity bytes) with band `index`; return the byte count.
+    using Convert = std::function<size_t(size_t index, uint8_t* out)>;
+    using Send = std::function<void(const uint8_t* p, size_t n)>;
+
+    BandPipeline(size_t band_capacity, Send send);
+    ~BandPipeline();
+
+    BandPipeline(const BandPipeline&) = delete;
+    BandPipeline& operator=(const BandPipeline&) = delete;
+
+    // Convert and send bands 0 .. bands - 1, in order. Returns when the last
+    // band is sent. An exception from either stage is rethrown here after
+    // the sender has gone idle; the bands after it are not sent.
+    void run(size_t bands, const Convert& convert);
+
+    size_t band_capacity() const { return capacity_; }
+    const PipelineStats& stats() const { return stats_; }
+
+private:
+    void loop();
+
+    size_t capacity_;
+    Send send_;
+    std::vector<uint8_t> staging_[2];
+    size_t len_[2]{0, 0};
+    bool full_[2]{false, false};  // handed to the sender, not yet sent
+    size_t slot_{0};              // next buffer run() fills
+
+    std::mutex mutex_;
+    std::condition_variable filled_;
+    std::condition_variable drained_;
+    bool stop_{false};
+    std::exception_ptr error_;
+    double send_ms_{0.0};
+    PipelineStats stats_;
+    std::thread thread_;  // last: starts after the state above exists
+};
+
+// Vertical sync edges, e.g. a panel's TE output.
+class VsyncSource {
+public:
+    virtual ~VsyncSource() = default;
+    // Skip edges that are already past and block until the next one;
+    // false when none comes within timeout.
+    virtual bool next_edge(std::chrono::milliseconds timeout,
+                           std::chrono::steady_clock::time_point& at) = 0;
+};
+
+// TE wired to a GpioLine requested for rising-edge events.
+class GpioVsync : public VsyncSource {
+public:
+    explicit GpioVsync(GpioLine& te) : te_(te) {}
+    bool next_edge(std::chrono::milliseconds timeout,
+                   std::chrono::steady_clock::time_point& at) override;
+
+private:
+    GpioLine& te_;
+};
+
+struct TearStats {
+    uint64_t synced_frames{0};
+    uint64_t unsynced_frames{0};  // no edge in time: written unsynchronized
+    uint64_t delayed_bands{0};    // held back for the scan to pass
+    uint64_t missed_bands{0};     // too slow to fit between two scans
+    double period_ms{0.0};        // measured refresh period
+};
+
+// Beam chasing. A band of GRAM rows is written only after the refresh
+// has scanned past it and must be done before the next refresh reaches
+// it, so no refresh shows it half old, half new. The refresh period comes
+// from the edges, the write time from the bytes sent so far.
+class TearSync {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Time as wait_band() sees it; empty members mean steady_clock and
+    // std::this_thread::sleep_until. Tests substitute a simulated clock.
+    struct Timing {
+        std::function<Clock::time_point()> now;
+        std::function<void(Clock::time_point)> sleep_until;
+    };
+
+    // Edges taken to measure the period; the smallest gap wins, so a
+    // missed edge does not double it.
+    static constexpr int kMeasureEdges = 4;
+
+    TearSync(VsyncSource& source, int scan_rows, Timing timing = {});
+
+    // Frame start: wait for a fresh edge (kMeasureEdges on first use, to
+    // measure the period). false means no TE: the frame goes out
+    // unsynchronized.
+    bool begin_frame(std::chrono::milliseconds timeout = std::chrono::milliseconds(50));
+    // Sleep until GRAM rows [first, last] can take `bytes`; no-op in an
+    // unsynchronized frame.
+    void wait_band(int first, int last, size_t bytes);
+    // A band write that took `took`; refines the write-time estimate.
+    void band_sent(size_t bytes, Clock::duration took);
+
+    // Earliest start at or after `now` for a write of `write` to rows
+    // [first, last] out of `scan_rows`, given an edge and the period;
+    // nullopt when the write is longer than the scan leaves the rows alone.
+    static std::optional<Clock::time_point> band_start(Clock::time_point now, Clock::time_point edge,
+                                                       Clock::duration period, int scan_rows,
+                                                       int first, int last, Clock::duration write,
+                                                       Clock::duration margin);
+
+    const TearStats& stats() const { return stats_; }
+
+private:
+    bool measure_period(Clock::time_point& edge, std::chrono::milliseconds timeout);
+
+    VsyncSource& source_;
+    int scan_rows_;
+    Timing timing_;
+    bool synced_{false};
+    Clock::time_point edge_{};
+    Clock::duration period_{0};
+    int off_grid_{0};  // frame edges in a row that did not fit period_
+    double ns_per_byte_{0.0};
+    TearStats stats_;
+};
+
+// Pipelined full-frame (or region) presenter for TftPanel drivers.
+//
+// TftPanel::set_mono_framebuffer() expands the whole frame, then sends it,
+// so the CPU and the bus take turns. This splits the window into row
+// bands: band N goes out on a background thread while band N + 1 is
+// expanded. The panel must not be used from other threads while
+// present() runs; between calls it is free.
+class TftPresenter {
+public:
+    // band_rows: rows per band; 8 (one MonoGfx page) by default.
+    explicit TftPresenter(TftPanel& panel, int band_rows = 8);
+
+    void present(const std::vector<uint8_t>& fb,
+                 uint16_t fg_color565 = 0xFFFF,
+                 uint16_t bg_color565 = 0x0000);
+    // Only `r` (clipped to the panel) of the full-size frame.
+    void present_region(const std::vector<uint8_t>& fb, const Rect& r,
+                        uint16_t fg_color565 = 0xFFFF,
+                        uint16_t bg_color565 = 0x0000);
+
+    // Tear-free mode: turns on the panel's TE output and cuts frames into
+    // bands along its scan direction, each written behind the refresh
+    // (see TearSync). A frame without an edge in time is written
+    // unsynchronized. nullptr switches back to plain pipelining.
+    void set_vsync(VsyncSource* source);
+    // nullptr unless set_vsync() is active.
+    const TearStats* tear_stats() const { return tear_ ? &tear_->stats() : nullptr; }
+
+    int band_rows() const { return band_rows_; }
+    const PipelineStats& stats() const { return pipeline_.stats(); }
+
+private:
+    struct Band {
+        Rect rect;
+        ScanSpan scan;
+    };
+
+    void send(const uint8_t* p, size_t n);
+    void present_synced(const std::vector<uint8_t>& fb, const Rect& r,
+                        uint16_t fg_color565, uint16_t bg_color565);
+
+    TftPanel& panel_;
+    int band_rows_;
+    std::unique_ptr<TearSync> tear_;
+    std::vector<Band> plan_;  // synced frame, in scan order
+    size_t next_band_{0};     // sender thread: next entry of plan_
+    BandPipeline pipeline_;   // last: its sender thread calls send()
+};
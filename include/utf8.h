@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Validating UTF-8 decoder.
+//
+// Malformed input (overlong forms, surrogates, codepoints above U+10FFFF,
+// stray or missing continuation bytes) never yields a wrong codepoint: each
+// maximal ill-formed subpart becomes one U+FFFD, as recommended by the
+// Unicode Standard (ch. 3, "U+FFFD Substitution of Maximal Subparts").
+// Runs of ASCII are copied 16 bytes at a time with SSE2/NEON where available.
+
+constexpr char32_t kUtf8Replacement = 0xFFFD;
+
+// Decode `len` bytes into `out` (replacing its contents; capacity is reused).
+// Returns the number of U+FFFD substitutions made for malformed input.
+size_t utf8_decode(const char* data, size_t len, std::u32string& out);
+
+inline size_t utf8_decode(const std::string& in, std::u32string& out) {
+    return utf8_decode(in.data(), in.size(), out);
+}
+
+// True if the whole buffer is well-formed UTF-8.
+bool utf8_valid(const char* data, size_t len);
+
+inline bool utf8_valid(const std::string& in) { return utf8_valid(in.data(), in.size()); }
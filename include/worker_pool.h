@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small persistent pool for fork/join work inside one frame.
+//
+// run(n, task) calls task(0) .. task(n - 1) spread over the workers and
+// the calling thread, and returns when all of them are done. Threads are
+// started once and sleep between runs, so a frame pays a wake-up instead
+// of a thread start. Tasks must not share mutable state with each other;
+// which thread runs which index is not fixed.
+class WorkerPool {
+public:
+    // `workers` threads besides the caller (0 runs everything inline).
+    explicit WorkerPool(size_t workers);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t workers() const { return threads_.size(); }
+
+    // Not reentrant: one run() at a time. The first exception thrown by a
+    // task is rethrown here after the others have finished.
+    void run(size_t n, const std::function<void(size_t)>& task);
+
+private:
+    void loop();
+    void work(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_{nullptr};
+    size_t count_{0};
+    size_t next_{0};       // next index to hand out
+    size_t finished_{0};   // indices completed
+    size_t busy_{0};       // workers inside work()
+    uint64_t generation_{0};
+    bool stop_{false};
+    std::exception_ptr error_;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gpio_gpiod.h"
+#include "spi_linux.h"
+#include "tft_panel.h"
+
+// Screen position in logical pixels.
+struct TouchPoint {
+    int x{0};
+    int y{0};
+};
+
+// One filtered reading, raw 12-bit ADC units.
+struct TouchSample {
+    int x{0};
+    int y{0};
+    int z{0};  // pressure: ~0 released, grows with force
+};
+
+enum class TouchState {
+    Released,
+    Pressed,
+    Unstable,  // pressed, but the readings disagree (pen moving, noise)
+};
+
+// Raw ADC units to screen pixels:
+//   x = ax*raw_x + bx*raw_y + cx,  y = ay*raw_x + by*raw_y + cy
+// clamped to width x height. The screen is the panel's logical one for a
+// given rotation; rotated() carries a calibration to another rotation.
+struct TouchCalibration {
+    double ax{1.0}, bx{0.0}, cx{0.0};
+    double ay{0.0}, by{1.0}, cy{0.0};
+    int width{1};
+    int height{1};
+
+    // Raw x0 .. x1 spans columns 0 .. width - 1 and raw y0 .. y1 rows
+    // 0 .. height - 1 (x1 < x0 flips an axis). With swap_xy raw X gives
+    // the row and raw Y the column, for a plate turned against the screen.
+    static TouchCalibration from_range(int raw_x0, int raw_x1, int raw_y0, int raw_y1,
+                                       int width, int height, bool swap_xy = false);
+    // Three touches at known screen positions, not in a line. Throws
+    // std::runtime_error when the points are degenerate.
+    static TouchCalibration from_points(const TouchPoint raw[3], const TouchPoint screen[3],
+                                        int width, int height);
+
+    // The same calibration for the panel at rotation `to`, given it was
+    // made at rotation `from`. The touch plate is fixed to the glass, so
+    // this follows the controller's MADCTL mapping of logical pixels onto
+    // GRAM, as the panel's writes do.
+    TouchCalibration rotated(const TftController& ctl, uint8_t from, uint8_t to) const;
+
+    TouchPoint map(int raw_x, int raw_y) const;
+};
+
+enum class TouchAction { Down, Move, Up };
+
+struct TouchEvent {
+    TouchAction action{TouchAction::Down};
+    TouchPoint pos;  // Up repeats the last position
+    int pressure{0};
+    std::chrono::steady_clock::time_point time;  // when the sample was taken
+};
+
+// XPT2046 (ADS7846-compatible) resistive touch controller.
+//
+// It sits on the panel's SPI bus with a chip select of its own, so it gets
+// its own spidev device (e.g. /dev/spidev1.1 next to the panel's
+// /dev/spidev1.0) opened at no more than kMaxSpiHz. The kernel queues the
+// two devices' messages one after the other: a touch reading is a single
+// message of ~40 bytes (about 0.2 ms at 2 MHz), and waits for at most the
+// one display message on the wire. Keep those at or below
+// max_shared_message() so a reading never waits long; frames go out the
+// same either way.
+//
+// PENIRQ, when wired, wakes the reader thread on pen-down; without it the
+// controller is polled every interval(). While pressed it is read every
+// interval(); each reading is one burst of pressure and samples() X/Y
+// conversions, trimmed to the middle half and averaged.
+class Xpt2046 {
+public:
+    using Handler = std::function<void(const TouchEvent&)>;
+
+    // DCLK limit at 2.7 V is 2.5 MHz; leave margin.
+    static constexpr uint32_t kMaxSpiHz = 2000000;
+    static constexpr int kMaxSamples = 16;
+
+    // `penirq` is optional: a line requested for GpioEdge::Falling (or
+    // Both) events. Both must outlive this object.
+    explicit Xpt2046(SpiLinux& spi, GpioLine* penirq = nullptr);
+    ~Xpt2046();
+
+    Xpt2046(const Xpt2046&) = delete;
+    Xpt2046& operator=(const Xpt2046&) = delete;
+
+    // Any thread; applies from the next reading.
+    void set_calibration(const TouchCalibration& cal);
+    TouchCalibration calibration() const;
+
+    // Set before start().
+    void set_samples(int n);  // X and Y conversions per reading, 1 .. kMaxSamples (default 5)
+    int samples() const { return samples_; }
+    void set_pressure_threshold(int z) { threshold_ = z; }  // default 300
+    void set_max_spread(int raw) { max_spread_ = raw; }    // kept samples, default 60
+    void set_interval(std::chrono::milliseconds interval) { interval_ = interval; }  // default 10 ms
+    std::chrono::milliseconds interval() const { return interval_; }
+
+    // One reading, as a single SPI message. `out` is filled when Pressed.
+    TouchState read(TouchSample& out);
+
+    // Reader thread: Down, Move (only when the position changes) and Up
+    // events go to `handler`, called on that thread. An SPI error ends the
+    // thread and is rethrown by stop().
+    void start(Handler handler);
+    void stop();
+    bool running() const { return thread_.joinable(); }
+
+    // Longest display message, in bytes, that a touch reading waits behind
+    // for at most `wait` at display_hz: the value for the panel's
+    // SpiLinux::set_max_transfer() when both share the bus.
+    static size_t max_shared_message(uint32_t display_hz, std::chrono::microseconds wait);
+
+private:
+    void loop();
+
+    SpiLinux& spi_;
+    GpioLine* penirq_;
+    int samples_{5};
+    int threshold_{300};
+    int max_spread_{60};
+    std::chrono::milliseconds interval_{10};
+    std::vector<uint8_t> tx_;
+    std::vector<uint8_t> rx_;
+
+    mutable std::mutex mutex_;
+    TouchCalibration cal_;
+    std::condition_variable wake_;
+    bool stop_{false};
+    int stop_fd_{-1};  // eventfd, wakes the reader out of its PENIRQ wait
+    std::exception_ptr error_;
+    Handler handler_;
+    std::thread thread_;
+};
@@ -0,0 +1,202 @@
+#include "animation.h"
+#include <algorithm>
+#include <cmath>
+
+double ease(Easing e, double u) {
+    u = std::min(1.0, std::max(0.0, u));
+    switch (e) {
+        case Easing::Linear: return u;
+        case Easing::EaseIn: return u * u;
+        case Easing::EaseOut: return 1.0 - (1.0 - u) * (1.0 - u);
+        case Easing::EaseInOut:
+            return u < 0.5 ? 2.0 * u * u : 1.0 - 2.0 * (1.0 - u) * (1.0 - u);
+    }
+    return u;
+}
+
+double Tween::progress(double t) const {
+    if (duration <= 0.0) return t >= start ? 1.0 : 0.0;
+    return ease(easing, (t - start) / duration);
+}
+
+double Tween::value(double t) const {
+    return from + (to - from) * progress(t);
+}
+
+int marquee_offset(double t, double px_per_s, int period) {
+    if (period <= 0) return 0;
+    const long long px = static_cast<long long>(std::floor(t * px_per_s));
+    const long long m = px % period;
+    return static_cast<int>(m < 0 ? m + period : m);
+}
+
+bool blink_on(double t, double period_s, double duty) {
+    if (period_s <= 0.0) return true;
+    const double phase = t / period_s - std::floor(t / period_s);
+    return phase < duty;
+}
+
+// BlinkAnimation
+
+BlinkAnimation::BlinkAnimation(MonoSprite sprite, int x, int y, double period_s, double duty)
+    : sprite_(std::move(sprite)), x_(x), y_(y), period_(period_s), duty_(duty) {}
+
+bool BlinkAnimation::update(double t) {
+    const bool on = blink_on(t, period_, duty_);
+    const bool changed = first_ || on != on_;
+    on_ = on;
+    first_ = false;
+    return changed;
+}
+
+void BlinkAnimation::draw(MonoGfx& gfx) const {
+    const Rect b = bounds();
+    gfx.fill_rect(b.x, b.y, b.x + b.w - 1, b.y + b.h - 1, false);
+    if (on_) sprite_.blit(gfx, x_, y_, BlitMode::Transparent);
+}
+
+Rect BlinkAnimation::bounds() const {
+    return {x_, y_, sprite_.width(), sprite_.height()};
+}
+
+// MarqueeAnimation
+
+MarqueeAnimation::MarqueeAnimation(MonoSprite strip, Rect window, double px_per_s, int gap)
+    : strip_(std::move(strip)), window_(window), speed_(px_per_s), gap_(std::max(0, gap)) {
+    // Rows below the window would never be cleared again: crop them once
+    if (strip_.height() > window_.h && window_.h > 0) {
+        strip_ = MonoSprite::from_pages(strip_.width(), window_.h, strip_.data().data());
+    }
+}
+
+bool MarqueeAnimation::update(double t) {
+    int off = 0;
+    if (strip_.width() > window_.w) {
+        off = marquee_offset(t, speed_, strip_.width() + gap_);
+    }
+    const bool changed = off != offset_;
+    offset_ = off;
+    return changed;
+}
+
+void MarqueeAnimation::draw(MonoGfx& gfx) const {
+    const Rect& w = window_;
+    const int sw = strip_.width();
+    auto clear_cols = [&](int c0, int c1) {
+        c1 = std::min(c1, w.w);
+        if (c1 > c0) gfx.fill_rect(w.x + c0, w.y, w.x + c1 - 1, w.y + w.h - 1, false);
+    };
+    if (strip_.height() < w.h) clear_cols(0, w.w);
+
+    if (sw <= w.w) {
+        strip_.blit(gfx, w.x, w.y, BlitMode::Opaque);
+        clear_cols(sw, w.w);
+        return;
+    }
+
+    // Opaque copies of the visible strip columns; only the gap is cleared.
+    // On an unrotated target these are whole-page column copies.
+    const int off = std::max(0, offset_);
+    const int head = std::max(0, sw - off);
+    const int wrap_x = sw + gap_ - off;
+    if (head > 0) strip_.blit_region(gfx, w.x, w.y, off, std::min(head, w.w), BlitMode::Opaque);
+    clear_cols(head, wrap_x);
+    if (wrap_x < w.w) strip_.blit_region(gfx, w.x + wrap_x, w.y, 0, w.w - wrap_x, BlitMode::Opaque);
+}
+
+// SlideAnimation
+
+SlideAnimation::SlideAnimation(Rect area, double duration_s, SlideDirection dir, Easing easing)
+    : area_(area), dir_(dir) {
+    tween_.from = 0.0;
+    tween_.to = static_cast<double>(area.w);
+    tween_.duration = duration_s;
+    tween_.easing = easing;
+}
+
+void SlideAnimation::show(MonoSprite sprite) {
+    from_ = std::move(sprite);
+    to_ = MonoSprite();
+    sliding_ = false;
+    shift_ = 0;
+    changed_ = true;
+}
+
+void SlideAnimation::slide_to(MonoSprite next, double t) {
+    if (sliding_) from_ = std::move(to_);  // finish the running slide
+    to_ = std::move(next);
+    tween_.start = t;
+    sliding_ = true;
+    shift_ = 0;
+    changed_ = true;
+}
+
+bool SlideAnimation::update(double t) {
+    if (sliding_) {
+        const int shift = static_cast<int>(std::lround(tween_.value(t)));
+        if (shift != shift_) changed_ = true;
+        shift_ = shift;
+        if (tween_.done(t)) {
+            from_ = std::move(to_);
+            to_ = MonoSprite();
+            sliding_ = false;
+            shift_ = 0;
+            changed_ = true;
+        }
+    }
+    const bool changed = changed_;
+    changed_ = false;
+    return changed;
+}
+
+void SlideAnimation::draw_at(MonoGfx& gfx, const MonoSprite& s, int left) const {
+    if (s.empty()) return;
+    // Clip the sprite's columns to the area
+    const int x0 = std::max(left, area_.x);
+    const int x1 = std::min(left + s.width(), area_.x + area_.w);
+    if (x1 <= x0) return;
+    s.blit_region(gfx, x0, area_.y, x0 - left, x1 - x0, BlitMode::Transparent);
+}
+
+void SlideAnimation::draw(MonoGfx& gfx) const {
+    gfx.fill_rect(area_.x, area_.y, area_.x + area_.w - 1, area_.y + area_.h - 1, false);
+    if (!sliding_) {
+        draw_at(gfx, from_, area_.x);
+        return;
+    }
+    const int sign = (dir_ == SlideDirection::Left) ? -1 : 1;
+    draw_at(gfx, from_, area_.x + sign * shift_);
+    draw_at(gfx, to_, area_.x + sign * (shift_ - area_.w));
+}
+
+// Animator
+
+Animation* Animator::add(std::unique_ptr<Animation> a) {
+    anims_.push_back(std::move(a));
+    invalidated_ = true;
+    return anims_.back().get();
+}
+
+void Animator::remove(const Animation* a) {
+    anims_.erase(std::remove_if(anims_.begin(), anims_.end(),
+                                [a](const std::unique_ptr<Animation>& p) { return p.get() == a; }),
+                 anims_.end());
+}
+
+void Animator::clear() {
+    anims_.clear();
+    dirty_.clear();
+}
+
+const std::vector<Rect>& Animator::tick(double t, MonoGfx& gfx) {
+    dirty_.clear();
+    for (auto& a : anims_) {
+        const bool changed = a->update(t);
+        if (changed || invalidated_) {
+            a->draw(gfx);
+            dirty_.push_back(a->bounds());
+        }
+    }
+    invalidated_ = false;
+    return dirty_;
+}
@@ -0,0 +1,179 @@
+#include "bus_recorder.h"
+#include "spi_linux.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <time.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'C', 'D', 'B', 'U', 'S', '1', '\n'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kFileHeader = 16;
+
+struct RecordHeader {
+    uint64_t t_ns;
+    uint8_t channel;
+    uint8_t level;
+    uint16_t reserved;
+    uint32_t len;
+};
+static_assert(sizeof(RecordHeader) == BusRecorder::kRecordHeader, "record header layout");
+
+uint64_t monotonic_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace
+
+BusRecorder::BusRecorder(size_t capacity_bytes)
+    : buf_(std::max(capacity_bytes, kRecordHeader * 4)) {}
+
+void BusRecorder::ring_write(size_t pos, const void* src, size_t n) {
+    const size_t first = std::min(n, buf_.size() - pos);
+    std::memcpy(buf_.data() + pos, src, first);
+    if (n > first) std::memcpy(buf_.data(), static_cast<const uint8_t*>(src) + first, n - first);
+}
+
+void BusRecorder::ring_read(size_t pos, void* dst, size_t n) const {
+    const size_t first = std::min(n, buf_.size() - pos);
+    std::memcpy(dst, buf_.data() + pos, first);
+    if (n > first) std::memcpy(static_cast<uint8_t*>(dst) + first, buf_.data(), n - first);
+}
+
+void BusRecorder::make_room(size_t need) {
+    while (buf_.size() - used_ < need) {
+        RecordHeader h;
+        ring_read(tail_, &h, sizeof(h));
+        const size_t rec = sizeof(h) + h.len;
+        tail_ = (tail_ + rec) % buf_.size();
+        used_ -= rec;
+        --count_;
+        ++dropped_;
+    }
+}
+
+void BusRecorder::append(BusChannel channel, bool level, const SpiSegment* segs, size_t n,
+                         size_t len) {
+    const size_t need = sizeof(RecordHeader) + len;
+    const uint64_t t = monotonic_ns();
+
+    std::lock_guard<std::mutex> lock(mu_);
+    if (need > buf_.size()) {
+        ++dropped_;
+        return;
+    }
+    make_room(need);
+
+    RecordHeader h{t, static_cast<uint8_t>(channel), static_cast<uint8_t>(level ? 1 : 0), 0,
+                   static_cast<uint32_t>(len)};
+    ring_write(head_, &h, sizeof(h));
+    size_t pos = (head_ + sizeof(h)) % buf_.size();
+    for (size_t i = 0; i < n; ++i) {
+        ring_write(pos, segs[i].tx, segs[i].len);
+        pos = (pos + segs[i].len) % buf_.size();
+    }
+    head_ = pos;
+    used_ += need;
+    ++count_;
+}
+
+void BusRecorder::record_spi(const SpiSegment* segs, size_t n) {
+    if (!enabled_) return;
+    size_t len = 0;
+    for (size_t i = 0; i < n; ++i) len += segs[i].len;
+    append(BusChannel::Spi, false, segs, n, len);
+}
+
+void BusRecorder::record_spi(const uint8_t* data, size_t len) {
+    const SpiSegment seg{data, len};
+    record_spi(&seg, 1);
+}
+
+void BusRecorder::record_gpio(BusChannel channel, bool level) {
+    if (!enabled_) return;
+    append(channel, level, nullptr, 0, 0);
+}
+
+std::vector<uint8_t> BusRecorder::snapshot() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<uint8_t> out(kFileHeader + used_);
+    std::memcpy(out.data(), kMagic, sizeof(kMagic));
+    const uint32_t version = kVersion;
+    const uint32_t count = static_cast<uint32_t>(count_);
+    std::memcpy(out.data() + 8, &version, 4);
+    std::memcpy(out.data() + 12, &count, 4);
+    ring_read(tail_, out.data() + kFileHeader, used_);
+    return out;
+}
+
+void BusRecorder::dump(const std::string& path) const {
+    const std::vector<uint8_t> img = snapshot();
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("Failed to open bus dump: " + path);
+    f.write(reinterpret_cast<const char*>(img.data()), static_cast<std::streamsize>(img.size()));
+    if (!f) throw std::runtime_error("Failed to write bus dump: " + path);
+}
+
+void BusRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    head_ = tail_ = used_ = count_ = 0;
+}
+
+size_t BusRecorder::used() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return used_;
+}
+
+size_t BusRecorder::records() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return count_;
+}
+
+uint64_t BusRecorder::dropped() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return dropped_;
+}
+
+std::vector<BusEvent> BusRecorder::parse(const std::vector<uint8_t>& dump) {
+    if (dump.size() < kFileHeader || std::memcmp(dump.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a bus dump");
+    }
+    uint32_t version = 0;
+    uint32_t count = 0;
+    std::memcpy(&version, dump.data() + 8, 4);
+    std::memcpy(&count, dump.data() + 12, 4);
+    if (version != kVersion) throw std::runtime_error("Unsupported bus dump version");
+
+    std::vector<BusEvent> events;
+    events.reserve(count);
+    size_t pos = kFileHeader;
+    for (uint32_t i = 0; i < count; ++i) {
+        RecordHeader h;
+        if (dump.size() - pos < sizeof(h)) throw std::runtime_error("Truncated bus dump");
+        std::memcpy(&h, dump.data() + pos, sizeof(h));
+        pos += sizeof(h);
+        if (dump.size() - pos < h.len) throw std::runtime_error("Truncated bus dump");
+
+        BusEvent e;
+        e.t_ns = h.t_ns;
+        e.channel = static_cast<BusChannel>(h.channel);
+        e.level = h.level != 0;
+        e.data.assign(dump.begin() + static_cast<std::ptrdiff_t>(pos),
+                      dump.begin() + static_cast<std::ptrdiff_t>(pos + h.len));
+        pos += h.len;
+        events.push_back(std::move(e));
+    }
+    return events;
+}
+
+std::vector<BusEvent> BusRecorder::load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("Failed to open bus dump: " + path);
+    std::vector<uint8_t> img((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    return parse(img);
+}
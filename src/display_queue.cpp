@@ -0,0 +1,243 @@
+#include "display_queue.h"
+#include "four_line_display.h"
+#include "frame_scheduler.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// Bounded MPMC ring after D. Vyukov, used here with a single consumer.
+// Each cell's sequence number says whose turn it is: seq == pos means free
+// for the producer claiming pos, seq == pos + 1 means filled for the
+// consumer. Producers only contend on the head CAS.
+struct DisplayQueue::Cell {
+    std::atomic<size_t> seq{0};
+    DisplayCommand cmd;
+};
+
+namespace {
+
+size_t round_up_pow2(size_t v) {
+    size_t p = 2;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+// Longest prefix of at most max bytes that does not split a UTF-8 sequence
+size_t utf8_prefix(std::string_view s, size_t max) {
+    if (s.size() <= max) return s.size();
+    size_t n = max;
+    while (n > 0 && (static_cast<unsigned char>(s[n]) & 0xC0) == 0x80) --n;
+    return n;
+}
+
+} // namespace
+
+DisplayQueue::DisplayQueue(size_t capacity)
+    : mask_(round_up_pow2(std::max<size_t>(capacity, 2)) - 1) {
+    cells_ = std::make_unique<Cell[]>(mask_ + 1);
+    for (size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    batch_.resize(mask_ + 1);
+    text_.reserve(DisplayCommand::kMaxText);
+}
+
+DisplayQueue::~DisplayQueue() = default;
+
+template <class Fill>
+bool DisplayQueue::emplace(Fill&& fill) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        const size_t seq = cell->seq.load(std::memory_order_acquire);
+        const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (dif == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            // Slot not consumed yet: full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+    fill(cell->cmd);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool DisplayQueue::set_line(unsigned int line_id, std::string_view utf8) {
+    if (line_id >= 4) return false;
+    const size_t len = utf8_prefix(utf8, DisplayCommand::kMaxText);
+    return emplace([&](DisplayCommand& c) {
+        c.op = DisplayOp::SetLine;
+        c.line = static_cast<uint8_t>(line_id);
+        c.len = static_cast<uint16_t>(len);
+        std::memcpy(c.text, utf8.data(), len);
+    });
+}
+
+bool DisplayQueue::clear_line(unsigned int line_id) {
+    if (line_id >= 4) return false;
+    return emplace([&](DisplayCommand& c) {
+        c.op = DisplayOp::ClearLine;
+        c.line = static_cast<uint8_t>(line_id);
+        c.len = 0;
+    });
+}
+
+bool DisplayQueue::clear_all() {
+    return emplace([](DisplayCommand& c) {
+        c.op = DisplayOp::ClearAll;
+        c.len = 0;
+    });
+}
+
+bool DisplayQueue::set_marquee(unsigned int line_id, bool enabled, double px_per_s) {
+    if (line_id >= 4) return false;
+    return emplace([&](DisplayCommand& c) {
+        c.op = DisplayOp::SetMarquee;
+        c.line = static_cast<uint8_t>(line_id);
+        c.flags = enabled ? 1 : 0;
+        c.speed = static_cast<float>(px_per_s);
+        c.len = 0;
+    });
+}
+
+bool DisplayQueue::set_orientation(Rotation rotation, bool mirror_x, bool mirror_y) {
+    return emplace([&](DisplayCommand& c) {
+        c.op = DisplayOp::SetOrientation;
+        c.arg = static_cast<uint8_t>(rotation);
+        c.flags = static_cast<uint8_t>((mirror_x ? 1 : 0) | (mirror_y ? 2 : 0));
+        c.len = 0;
+    });
+}
+
+bool DisplayQueue::push(const DisplayCommand& cmd) {
+    if (cmd.op != DisplayOp::ClearAll && cmd.op != DisplayOp::SetOrientation && cmd.line >= 4) {
+        return false;
+    }
+    return emplace([&](DisplayCommand& c) {
+        c = cmd;
+        c.len = static_cast<uint16_t>(std::min<size_t>(cmd.len, DisplayCommand::kMaxText));
+    });
+}
+
+bool DisplayQueue::pop(DisplayCommand& out) {
+    Cell& cell = cells_[tail_ & mask_];
+    if (cell.seq.load(std::memory_order_acquire) != tail_ + 1) return false;
+    out = cell.cmd;
+    // Hand the slot back to producers one lap ahead
+    cell.seq.store(tail_ + mask_ + 1, std::memory_order_release);
+    ++tail_;
+    return true;
+}
+
+bool DisplayQueue::empty() const {
+    return cells_[tail_ & mask_].seq.load(std::memory_order_acquire) != tail_ + 1;
+}
+
+DisplayQueueStats DisplayQueue::stats() const {
+    DisplayQueueStats s;
+    s.pushed = head_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.applied = applied_.load(std::memory_order_relaxed);
+    s.coalesced = coalesced_.load(std::memory_order_relaxed);
+    return s;
+}
+
+size_t DisplayQueue::drain(FourLineDisplay& display) {
+    size_t n = 0;
+    while (n < batch_.size() && pop(batch_[n])) ++n;
+    if (n == 0) return 0;
+
+    // Find the surviving command for each region
+    long last_text[4] = {-1, -1, -1, -1};
+    long last_marquee[4] = {-1, -1, -1, -1};
+    long last_orientation = -1;
+    long last_clear_all = -1;
+    for (size_t i = 0; i < n; ++i) {
+        const DisplayCommand& c = batch_[i];
+        switch (c.op) {
+            case DisplayOp::SetLine:
+            case DisplayOp::ClearLine: last_text[c.line] = static_cast<long>(i); break;
+            case DisplayOp::ClearAll: last_clear_all = static_cast<long>(i); break;
+            case DisplayOp::SetMarquee: last_marquee[c.line] = static_cast<long>(i); break;
+            case DisplayOp::SetOrientation: last_orientation = static_cast<long>(i); break;
+        }
+    }
+
+    size_t applied = 0;
+    if (last_clear_all >= 0) {
+        display.clear_all();
+        ++applied;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const DisplayCommand& c = batch_[i];
+        const long idx = static_cast<long>(i);
+        switch (c.op) {
+            case DisplayOp::SetLine:
+                if (idx != last_text[c.line] || idx < last_clear_all) continue;
+                text_.assign(c.view());  // reused: puts() takes a std::string
+                display.puts(c.line, text_);
+                break;
+            case DisplayOp::ClearLine:
+                if (idx != last_text[c.line] || idx < last_clear_all) continue;
+                display.clear_line(c.line);
+                break;
+            case DisplayOp::SetMarquee:
+                if (idx != last_marquee[c.line]) continue;
+                display.set_marquee(c.line, c.flags & 1, c.speed);
+                break;
+            case DisplayOp::SetOrientation:
+                if (idx != last_orientation) continue;
+                display.set_orientation(static_cast<Rotation>(c.arg & 3), c.flags & 1, c.flags & 2);
+                break;
+            case DisplayOp::ClearAll:
+                continue;  // applied above
+        }
+        ++applied;
+    }
+
+    applied_.fetch_add(applied, std::memory_order_relaxed);
+    coalesced_.fetch_add(n - applied, std::memory_order_relaxed);
+    return applied;
+}
+
+// DisplayRenderThread
+
+DisplayRenderThread::DisplayRenderThread(DisplayQueue& queue, FourLineDisplay& display,
+                                         double fps, Flush flush)
+    : queue_(queue), display_(display), fps_(fps), flush_(std::move(flush)) {}
+
+DisplayRenderThread::~DisplayRenderThread() { stop(); }
+
+void DisplayRenderThread::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread([this] { loop(); });
+}
+
+void DisplayRenderThread::stop() {
+    running_.store(false);
+    if (thread_.joinable()) thread_.join();
+}
+
+void DisplayRenderThread::loop() {
+    FrameScheduler scheduler(fps_);
+    bool first = true;
+    while (running_.load(std::memory_order_relaxed)) {
+        const FrameTick tick = scheduler.wait_next();
+
+        bool dirty = display_.tick(tick.time);
+        if (queue_.drain(display_) > 0 || first) {
+            display_.render();
+            dirty = true;
+            first = false;
+        }
+        if (dirty) {
+            flush_(display_.get_framebuffer());
+            flushes_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        scheduler.end_frame();
+    }
+}
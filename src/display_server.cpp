@@ -0,0 +1,374 @@
+#include "display_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct DisplayServer::Client {
+    int fd{-1};
+    Rect area;                      // screen coordinates; empty until Create
+    const unsigned char* map{nullptr};
+    size_t size{0};
+    unsigned int pending_done{0};   // Done replies owed after this round's flush
+
+    ~Client() {
+        if (map) munmap(const_cast<unsigned char*>(map), size);
+        if (fd >= 0) close(fd);
+    }
+};
+
+namespace {
+
+std::runtime_error sys_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid display socket path: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+// Client values can be anything in int32_t: no pos + len in int.
+// True when [pos, pos + len) is non-empty and inside [0, limit).
+bool span_inside(int32_t pos, int32_t len, int limit) {
+    return pos >= 0 && len > 0 && pos <= limit && len <= limit - pos;
+}
+
+// [pos, pos + len) clipped to [0, limit); len 0 when nothing is left
+void clip_span(int32_t& pos, int32_t& len, int limit) {
+    const int64_t lo = std::max<int64_t>(pos, 0);
+    const int64_t hi = std::min<int64_t>(static_cast<int64_t>(pos) + len, limit);
+    pos = static_cast<int32_t>(lo);
+    len = hi > lo ? static_cast<int32_t>(hi - lo) : 0;
+}
+
+// Page-packed surface size: one byte per column per 8 rows
+size_t surface_bytes(int w, int h) {
+    return static_cast<size_t>(w) * static_cast<size_t>((h + 7) / 8);
+}
+
+bool send_msg(int fd, DisplayMsgType type, const Rect& r, int pass_fd = -1) {
+    DisplayMsg msg{type, r.x, r.y, r.w, r.h};
+    iovec iov{&msg, sizeof(msg)};
+    msghdr hdr{};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (pass_fd >= 0) {
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+        cmsghdr* cm = CMSG_FIRSTHDR(&hdr);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cm), &pass_fd, sizeof(int));
+    }
+    return sendmsg(fd, &hdr, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(msg));
+}
+
+// Blocking receive of one message and, if attached, one descriptor
+DisplayMsg recv_msg(int fd, int* got_fd) {
+    DisplayMsg msg{};
+    iovec iov{&msg, sizeof(msg)};
+    msghdr hdr{};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    hdr.msg_control = control;
+    hdr.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &hdr, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) throw sys_error("Display server receive failed");
+    if (n == 0) throw std::runtime_error("Display server closed the connection");
+    if (n != static_cast<ssize_t>(sizeof(msg))) throw std::runtime_error("Malformed display server reply");
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm; cm = CMSG_NXTHDR(&hdr, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+            int passed;
+            std::memcpy(&passed, CMSG_DATA(cm), sizeof(int));
+            if (got_fd && *got_fd < 0) {
+                *got_fd = passed;
+            } else {
+                close(passed);
+            }
+        }
+    }
+    return msg;
+}
+
+inline bool get_bit(const unsigned char* p, int stride, int x, int y) {
+    return (p[static_cast<size_t>(y / 8) * static_cast<size_t>(stride) + static_cast<size_t>(x)] >> (y % 8)) & 1;
+}
+
+inline void set_bit(unsigned char* p, int stride, int x, int y, bool on) {
+    unsigned char& b = p[static_cast<size_t>(y / 8) * static_cast<size_t>(stride) + static_cast<size_t>(x)];
+    const unsigned char mask = static_cast<unsigned char>(1u << (y % 8));
+    b = on ? static_cast<unsigned char>(b | mask) : static_cast<unsigned char>(b & ~mask);
+}
+
+// Merge overlapping rects until none overlap
+void merge_overlapping(std::vector<Rect>& rects) {
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t a = 0; a < rects.size() && !merged; ++a) {
+            for (size_t b = a + 1; b < rects.size(); ++b) {
+                if (!rects[a].intersected(rects[b]).empty()) {
+                    rects[a] = rects[a].united(rects[b]);
+                    rects.erase(rects.begin() + static_cast<std::ptrdiff_t>(b));
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+DisplayServer::DisplayServer(const std::string& socket_path, int width, int height, Flush flush)
+    : path_(socket_path), w_(width), h_(height), flush_(std::move(flush)) {
+    if (w_ <= 0 || h_ <= 0 || (h_ % 8) != 0) {
+        throw std::runtime_error("Invalid display server geometry");
+    }
+    fb_.assign(surface_bytes(w_, h_), 0x00);
+    const sockaddr_un addr = socket_address(path_);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listen_fd_ < 0) throw sys_error("Display socket failed");
+    unlink(path_.c_str());  // left behind by a previous instance
+    if (bind(listen_fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd_, 8) < 0) {
+        const std::runtime_error err = sys_error("Display socket bind failed for " + path_);
+        close(listen_fd_);
+        throw err;
+    }
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+        const std::runtime_error err = sys_error("eventfd failed");
+        close(listen_fd_);
+        unlink(path_.c_str());
+        throw err;
+    }
+}
+
+DisplayServer::~DisplayServer() {
+    clients_.clear();
+    close(wake_fd_);
+    close(listen_fd_);
+    unlink(path_.c_str());
+}
+
+DisplayServerStats DisplayServer::stats() const {
+    DisplayServerStats s;
+    s.damage = damage_msgs_.load(std::memory_order_relaxed);
+    s.flushes = flushes_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void DisplayServer::stop() {
+    const uint64_t one = 1;
+    ssize_t r = write(wake_fd_, &one, sizeof(one));
+    (void)r;
+}
+
+void DisplayServer::run() {
+    while (poll_once(-1)) {
+    }
+}
+
+bool DisplayServer::poll_once(int timeout_ms) {
+    std::vector<pollfd> fds;
+    fds.reserve(clients_.size() + 2);
+    fds.push_back({wake_fd_, POLLIN, 0});
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (const auto& c : clients_) fds.push_back({c->fd, POLLIN, 0});
+
+    if (poll(fds.data(), fds.size(), timeout_ms) < 0) {
+        if (errno == EINTR) return true;
+        throw sys_error("Display server poll failed");
+    }
+    if (fds[0].revents & POLLIN) {
+        uint64_t count;
+        ssize_t r = read(wake_fd_, &count, sizeof(count));
+        (void)r;
+        return false;
+    }
+
+    // Clients first, backwards so drop() keeps the pollfd indices valid;
+    // connections accepted this round are polled in the next one
+    for (size_t i = clients_.size(); i-- > 0;) {
+        const short ev = fds[i + 2].revents;
+        if (ev == 0) continue;
+        if (!(ev & POLLIN) || !handle(*clients_[i])) drop(i);
+    }
+    if (fds[1].revents & POLLIN) accept_clients();
+
+    // All damage of the round in one pass: overlapping rects from several
+    // clients are composited and flushed once
+    merge_overlapping(damage_);
+    for (const Rect& r : damage_) {
+        compose(r);
+        if (flush_) flush_(fb_, r);
+        flushes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    damage_.clear();
+    for (const auto& c : clients_) {
+        for (; c->pending_done > 0; --c->pending_done) send_msg(c->fd, DisplayMsgType::Done, c->area);
+    }
+    return true;
+}
+
+void DisplayServer::accept_clients() {
+    for (;;) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) return;  // EAGAIN: no more; other errors: retried next round
+        auto c = std::make_unique<Client>();
+        c->fd = fd;
+        clients_.push_back(std::move(c));
+    }
+}
+
+bool DisplayServer::handle(Client& c) {
+    for (;;) {
+        DisplayMsg msg;
+        const ssize_t n = recv(c.fd, &msg, sizeof(msg), MSG_DONTWAIT);
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        if (n != static_cast<ssize_t>(sizeof(msg))) return false;  // closed or malformed
+        const Rect r{msg.x, msg.y, msg.w, msg.h};
+
+        if (msg.type == DisplayMsgType::Create) {
+            if (c.map || !span_inside(msg.x, msg.w, w_) || !span_inside(msg.y, msg.h, h_)) {
+                send_msg(c.fd, DisplayMsgType::Error, r);
+                continue;
+            }
+            // Sealed size: a client cannot shrink the memfd under the
+            // server's mapping (SIGBUS here) or grow it
+            const size_t size = surface_bytes(r.w, r.h);
+            const int mfd = memfd_create("lcd-surface", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            if (mfd < 0) {
+                send_msg(c.fd, DisplayMsgType::Error, r);
+                continue;
+            }
+            void* map = MAP_FAILED;
+            if (ftruncate(mfd, static_cast<off_t>(size)) == 0 &&
+                fcntl(mfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == 0) {
+                map = mmap(nullptr, size, PROT_READ, MAP_SHARED, mfd, 0);
+            }
+            if (map == MAP_FAILED) {
+                close(mfd);
+                send_msg(c.fd, DisplayMsgType::Error, r);
+                continue;
+            }
+            c.map = static_cast<const unsigned char*>(map);
+            c.size = size;
+            c.area = r;
+            const bool sent = send_msg(c.fd, DisplayMsgType::Created, r, mfd);
+            close(mfd);
+            if (!sent) return false;
+            damage_.push_back(r);  // a new surface covers what was there
+        } else if (msg.type == DisplayMsgType::Damage) {
+            if (!c.map) return false;
+            damage_msgs_.fetch_add(1, std::memory_order_relaxed);
+            clip_span(msg.x, msg.w, c.area.w);
+            clip_span(msg.y, msg.h, c.area.h);
+            if (msg.w > 0 && msg.h > 0) {
+                damage_.push_back(Rect{msg.x + c.area.x, msg.y + c.area.y, msg.w, msg.h});
+            }
+            ++c.pending_done;
+        } else {
+            return false;
+        }
+    }
+}
+
+void DisplayServer::drop(size_t index) {
+    // Whatever the surface covered shows what is underneath again
+    if (clients_[index]->map) damage_.push_back(clients_[index]->area);
+    clients_.erase(clients_.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+void DisplayServer::compose(const Rect& r) {
+    for (int y = r.y; y < r.y + r.h; ++y) {
+        for (int x = r.x; x < r.x + r.w; ++x) set_bit(fb_.data(), w_, x, y, false);
+    }
+    for (const auto& c : clients_) {
+        if (!c->map) continue;
+        const Rect part = r.intersected(c->area);
+        if (part.empty()) continue;
+        for (int y = part.y; y < part.y + part.h; ++y) {
+            for (int x = part.x; x < part.x + part.w; ++x) {
+                const bool on = get_bit(c->map, c->area.w, x - c->area.x, y - c->area.y);
+                set_bit(fb_.data(), w_, x, y, on);
+            }
+        }
+    }
+}
+
+DisplayClient::DisplayClient(const std::string& socket_path, const Rect& area) {
+    const sockaddr_un addr = socket_address(socket_path);
+    fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) throw sys_error("Display socket failed");
+    try {
+        if (connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw sys_error("Cannot connect to display server at " + socket_path);
+        }
+        if (!send_msg(fd_, DisplayMsgType::Create, area)) throw sys_error("Display surface request failed");
+        int mfd = -1;
+        const DisplayMsg reply = recv_msg(fd_, &mfd);
+        if (reply.type != DisplayMsgType::Created || mfd < 0) {
+            if (mfd >= 0) close(mfd);
+            throw std::runtime_error("Display server refused the surface");
+        }
+        area_ = area;
+        size_ = surface_bytes(area.w, area.h);
+        void* map = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+        close(mfd);
+        if (map == MAP_FAILED) throw sys_error("Display surface mmap failed");
+        map_ = static_cast<unsigned char*>(map);
+    } catch (...) {
+        close(fd_);
+        throw;
+    }
+}
+
+DisplayClient::~DisplayClient() {
+    if (map_) munmap(map_, size_);
+    close(fd_);
+}
+
+void DisplayClient::damage(const Rect& r) {
+    if (!send_msg(fd_, DisplayMsgType::Damage, r)) throw sys_error("Display damage failed");
+    for (;;) {
+        const DisplayMsg reply = recv_msg(fd_, nullptr);
+        if (reply.type == DisplayMsgType::Done) return;
+        if (reply.type == DisplayMsgType::Error) throw std::runtime_error("Display server rejected damage");
+    }
+}
+
+void DisplayClient::commit(const MonoGfx& gfx, const Rect& r) {
+    if (gfx.native_width() != area_.w || gfx.fb().size() != size_) {
+        throw std::runtime_error("MonoGfx size does not match the display surface");
+    }
+    const Rect d = r.intersected(Rect{0, 0, area_.w, area_.h});
+    if (d.empty()) return;
+    for (int page = d.y / 8; page <= (d.y + d.h - 1) / 8; ++page) {
+        const size_t off = static_cast<size_t>(page) * static_cast<size_t>(area_.w) + static_cast<size_t>(d.x);
+        std::memcpy(map_ + off, gfx.fb().data() + off, static_cast<size_t>(d.w));
+    }
+    damage(d);
+}
@@ -1,13 +1,58 @@
 #include "four_line_display.h"
+#include "animation.h"
 #include "ft_text.h"
 #include "graphics.h"
+#include "sprite.h"
+#include "utf8.h"
+#include "worker_pool.h"
 #include <stdexcept>
 #include <algorithm>
+#include <thread>
 
 struct FourLineDisplay::Impl {
     std::unique_ptr<FtText> small_ft;
     std::unique_ptr<FtText> large_ft;
     std::unique_ptr<MonoGfx> gfx;
+    FtText::FontData font;
+
+    // Parallel rendering: lines 0 and 1 use small_ft/large_ft, lines 2 and
+    // 3 get faces of their own, so no face is shared between tasks. Each
+    // line is rasterized into its own layer.
+    std::unique_ptr<WorkerPool> pool;
+    std::unique_ptr<FtText> line_ft[4];
+    std::unique_ptr<MonoGfx> layer[4];
+
+    FtText* font_for(unsigned int line_id) {
+        if (line_ft[line_id]) return line_ft[line_id].get();
+        return (line_id == 1) ? large_ft.get() : small_ft.get();
+    }
+
+    // Marquee state per line. The animation (and its strip) is rebuilt
+    // lazily when marquee_stale is set.
+    bool marquee_on[4] = {false, false, false, false};
+    double marquee_speed[4] = {30.0, 30.0, 30.0, 30.0};
+    bool marquee_stale[4] = {true, true, true, true};
+    std::unique_ptr<MarqueeAnimation> marquee[4];
+    double time = 0.0;
+    
+    // What the framebuffer shows, for incremental render(): the text each
+    // line was drawn with and the marquee that drew it. Cleared by anything
+    // that moves or restyles lines.
+    std::u32string shown[4];
+    MarqueeAnimation* shown_marquee[4] = {nullptr, nullptr, nullptr, nullptr};
+    bool shown_valid = false;
+    bool marquee_rebuilt[4] = {false, false, false, false}; // since shown
+    FtText::CellMetrics metrics[2] = {}; // small, large
+    std::vector<Rect> dirty;
+    std::vector<Rect> areas; // render_changes() scratch, kept between frames
+
+    void invalidate_marquees() {
+        for (int i = 0; i < 4; ++i) {
+            marquee_stale[i] = true;
+            marquee[i].reset();
+        }
+        shown_valid = false;
+    }
 };
 
 FourLineDisplay::FourLineDisplay(int width, int height, 
@@ -30,22 +75,36 @@ bool FourLineDisplay::initialize(const std::string& font_path) {
     try {
         // Create graphics context
         impl_->gfx = std::make_unique<MonoGfx>(width_, height_);
+        impl_->gfx->set_orientation(rotation_, mirror_x_, mirror_y_);
         
+        // Both sizes share one in-memory copy of the font file
+        impl_->font = FtText::read_font_file(font_path);
+
         // Create and configure small font renderer
         impl_->small_ft = std::make_unique<FtText>();
-        impl_->small_ft->load_font(font_path);
+        impl_->small_ft->load_font(impl_->font);
         impl_->small_ft->set_pixel_size(small_font_size_);
         
         // Create and configure large font renderer
         impl_->large_ft = std::make_unique<FtText>();
-        impl_->large_ft->load_font(font_path);
+        impl_->large_ft->load_font(impl_->font);
         impl_->large_ft->set_pixel_size(large_font_size_);
         
+        if (impl_->pool) {
+            prepare_parallel();
+        }
+        
+        // Room for every line's cells plus the marquee windows, so diffing
+        // a frame does not grow them
+        impl_->dirty.reserve(64);
+        impl_->areas.reserve(64);
+        
         initialized_ = true;
         
         // Clear all lines
         for (int i = 0; i < 4; ++i) {
             lines_[i].clear();
+            codepoints_[i].clear();
         }
         
         return true;
@@ -56,16 +115,85 @@ bool FourLineDisplay::initialize(const std::string& font_path) {
 }
 
 void FourLineDisplay::uninitialize() {
+    if (impl_->gfx) {
+        framebuffer_ = impl_->gfx->fb(); // the last frame stays readable
+    }
+    impl_->invalidate_marquees();
     impl_->small_ft.reset();
     impl_->large_ft.reset();
+    for (int i = 0; i < 4; ++i) {
+        impl_->line_ft[i].reset();
+        impl_->layer[i].reset();
+    }
+    impl_->font.reset();
     impl_->gfx.reset();
     initialized_ = false;
 }
 
+void FourLineDisplay::set_render_threads(unsigned int threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, 4u); // one task per line
+    if (threads == render_threads_) {
+        return;
+    }
+    
+    render_threads_ = threads;
+    impl_->pool.reset();
+    for (int i = 0; i < 4; ++i) {
+        impl_->line_ft[i].reset();
+        impl_->layer[i].reset();
+    }
+    if (threads > 1) {
+        impl_->pool = std::make_unique<WorkerPool>(threads - 1);
+        if (initialized_) {
+            prepare_parallel();
+        }
+    }
+}
+
+void FourLineDisplay::prepare_parallel() {
+    for (int i = 2; i < 4; ++i) {
+        impl_->line_ft[i] = std::make_unique<FtText>();
+        impl_->line_ft[i]->load_font(impl_->font);
+        impl_->line_ft[i]->set_pixel_size(small_font_size_);
+    }
+    for (int i = 0; i < 4; ++i) {
+        impl_->layer[i] = std::make_unique<MonoGfx>(width_, height_);
+        impl_->layer[i]->set_orientation(rotation_, mirror_x_, mirror_y_);
+    }
+}
+
 bool FourLineDisplay::is_initialized() const {
     return initialized_;
 }
 
+void FourLineDisplay::set_orientation(Rotation rotation, bool mirror_x, bool mirror_y) {
+    rotation_ = rotation;
+    mirror_x_ = mirror_x;
+    mirror_y_ = mirror_y;
+    impl_->invalidate_marquees(); // layout width may have changed
+    if (impl_->gfx) {
+        impl_->gfx->set_orientation(rotation_, mirror_x_, mirror_y_);
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (impl_->layer[i]) {
+            impl_->layer[i]->set_orientation(rotation_, mirror_x_, mirror_y_);
+        }
+    }
+}
+
+int FourLineDisplay::get_layout_width() const {
+    const bool swap = (rotation_ == Rotation::Deg90 || rotation_ == Rotation::Deg270);
+    return swap ? height_ : width_;
+}
+
+int FourLineDisplay::get_layout_height() const {
+    const bool swap = (rotation_ == Rotation::Deg90 || rotation_ == Rotation::Deg270);
+    return swap ? width_ : height_;
+}
+
 int FourLineDisplay::get_line_font_size(unsigned int line_id) const {
     // Line 1 is large, others are small
     return (line_id == 1) ? large_font_size_ : small_font_size_;
@@ -104,7 +232,7 @@ unsigned int FourLineDisplay::length(unsigned int line_id) const {
         return 0;
     }
     
-    return static_cast<unsigned int>(width_ / char_width);
+    return static_cast<unsigned int>(get_layout_width() / char_width);
 }
 
 void FourLineDisplay::puts(unsigned int line_id, const std::string& text) {
@@ -112,7 +240,13 @@ void FourLineDisplay::puts(unsigned int line_id, const std::string& text) {
         return;
     }
     
+    if (text == lines_[line_id] && !text.empty()) {
+        return; // unchanged: keep the shaped run and marquee strip
+    }
+    
     lines_[line_id] = text;
+    utf8_decode(lines_[line_id], codepoints_[line_id]);
+    impl_->marquee_stale[line_id] = true;
 }
 
 std::string FourLineDisplay::get_text(unsigned int line_id) const {
@@ -126,49 +260,316 @@ std::string FourLineDisplay::get_text(unsigned int line_id) const {
 void FourLineDisplay::clear_all() {
     for (int i = 0; i < 4; ++i) {
         lines_[i].clear();
+        codepoints_[i].clear();
     }
+    impl_->invalidate_marquees();
 }
 
 void FourLineDisplay::clear_line(unsigned int line_id) {
     if (line_id < 4) {
         lines_[line_id].clear();
+        codepoints_[line_id].clear();
+        impl_->marquee_stale[line_id] = true;
+        impl_->marquee[line_id].reset();
+    }
+}
+
+void FourLineDisplay::set_marquee(unsigned int line_id, bool enabled, double px_per_s) {
+    if (line_id >= 4) {
+        return;
+    }
+    
+    impl_->marquee_on[line_id] = enabled;
+    impl_->marquee_speed[line_id] = px_per_s;
+    impl_->marquee_stale[line_id] = true;
+    impl_->marquee[line_id].reset();
+}
+
+bool FourLineDisplay::is_marquee(unsigned int line_id) const {
+    return line_id < 4 && impl_->marquee_on[line_id];
+}
+
+MarqueeAnimation* FourLineDisplay::marquee_for(unsigned int line_id) {
+    if (!impl_->marquee_on[line_id] || codepoints_[line_id].empty()) {
+        return nullptr;
+    }
+    if (!impl_->marquee_stale[line_id]) {
+        return impl_->marquee[line_id].get();
+    }
+    
+    impl_->marquee_stale[line_id] = false;
+    impl_->marquee[line_id].reset();
+    
+    FtText* ft = impl_->font_for(line_id);
+    const int text_width = ft->measure_codepoints(codepoints_[line_id]);
+    const int layout_width = get_layout_width();
+    if (text_width <= layout_width) {
+        return nullptr; // fits: drawn as static text
+    }
+    
+    // Rasterize the whole line once; the strip is one line box tall
+    const int font_size = get_line_font_size(line_id);
+    MonoGfx strip(text_width, ((font_size + 7) / 8) * 8);
+    ft->draw_codepoints(strip, 0, 0, codepoints_[line_id], true);
+    
+    const Rect window{0, get_line_y_position(line_id), layout_width, font_size};
+    impl_->marquee_rebuilt[line_id] = true;
+    impl_->marquee[line_id] = std::make_unique<MarqueeAnimation>(
+        MonoSprite::from_pages(text_width, font_size, strip.fb().data()),
+        window, impl_->marquee_speed[line_id], font_size);
+    return impl_->marquee[line_id].get();
+}
+
+bool FourLineDisplay::tick(double t) {
+    impl_->time = t;
+    impl_->dirty.clear();
+    if (!initialized_) {
+        return false;
+    }
+    
+    bool changed = false;
+    for (unsigned int i = 0; i < 4; ++i) {
+        MarqueeAnimation* m = impl_->marquee_stale[i] ? nullptr : impl_->marquee[i].get();
+        if (m && m->update(t)) {
+            m->draw(*impl_->gfx);
+            repaint(m->bounds(), i + 1); // later lines draw over it
+            impl_->dirty.push_back(m->bounds());
+            changed = true;
+        }
     }
+    
+    return changed;
 }
 
 const std::vector<unsigned char>& FourLineDisplay::render() {
+    impl_->dirty.clear();
     if (!initialized_) {
         // Return empty framebuffer if not initialized
         return framebuffer_;
     }
     
+    if (!impl_->shown_valid || !render_changes()) {
+        impl_->metrics[0] = impl_->small_ft->cell_metrics();
+        impl_->metrics[1] = impl_->large_ft->cell_metrics();
+        render_full();
+        for (unsigned int i = 0; i < 4; ++i) {
+            impl_->shown[i] = codepoints_[i];
+            impl_->shown_marquee[i] = nullptr;
+            try {
+                impl_->shown_marquee[i] = codepoints_[i].empty() ? nullptr : marquee_for(i);
+            } catch (const std::exception&) {
+            }
+        }
+        impl_->shown_valid = true;
+        std::fill(impl_->marquee_rebuilt, impl_->marquee_rebuilt + 4, false);
+        impl_->dirty.push_back(Rect{0, 0, get_layout_width(), get_layout_height()});
+    }
+    
+    return impl_->gfx->fb();
+}
+
+void FourLineDisplay::line_changes(unsigned int line_id, std::vector<Rect>& areas) {
+    const FtText::CellMetrics& m = impl_->metrics[line_id == 1 ? 1 : 0];
+    const std::u32string& was = impl_->shown[line_id];
+    const std::u32string& now = codepoints_[line_id];
+    const Rect layout{0, 0, get_layout_width(), get_layout_height()};
+    const int y = get_line_y_position(line_id);
+    
+    auto add = [&](const Rect& r) {
+        const Rect clipped = r.intersected(layout);
+        if (!clipped.empty()) {
+            areas.push_back(clipped);
+        }
+    };
+    
+    // Cell diffing needs every glyph on the grid: no wide glyphs, line
+    // breaks or combining marks, which all change the measured width
+    FtText* ft = impl_->font_for(line_id);
+    const int adv = m.advance;
+    if (adv <= 0 ||
+        ft->measure_codepoints(was) != adv * static_cast<int>(was.size()) ||
+        ft->measure_codepoints(now) != adv * static_cast<int>(now.size())) {
+        // Whole line, as far as any glyph's ink can reach
+        add(Rect{m.ink_left, y + m.ink_top, layout.w - m.ink_left, m.ink_bottom - m.ink_top});
+        return;
+    }
+    
+    // Changed cell: the ink of the old glyph and of the new one
+    const size_t n = std::max(was.size(), now.size());
+    for (size_t k = 0; k < n; ++k) {
+        const bool in_was = k < was.size();
+        const bool in_now = k < now.size();
+        if (in_was && in_now && was[k] == now[k]) {
+            continue;
+        }
+        Rect box;
+        if (in_was) {
+            box = box.united(ft->glyph_box(was[k]));
+        }
+        if (in_now) {
+            box = box.united(ft->glyph_box(now[k]));
+        }
+        if (!box.empty()) {
+            add(Rect{box.x + static_cast<int>(k) * adv, box.y + y, box.w, box.h});
+        }
+    }
+}
+
+void FourLineDisplay::repaint(const Rect& area, unsigned int first_line) {
+    for (unsigned int i = first_line; i < 4; ++i) {
+        if (codepoints_[i].empty() || impl_->shown_marquee[i]) {
+            continue;
+        }
+        const FtText::CellMetrics& m = impl_->metrics[i == 1 ? 1 : 0];
+        const int y = get_line_y_position(i);
+        if (y + m.ink_bottom <= area.y || y + m.ink_top >= area.y + area.h) {
+            continue;
+        }
+        try {
+            impl_->font_for(i)->draw_codepoints(*impl_->gfx, 0, y, codepoints_[i], true, area);
+        } catch (const std::exception&) {
+            // Silently ignore rendering errors for individual lines
+        }
+    }
+}
+
+bool FourLineDisplay::render_changes() {
+    Impl& d = *impl_;
+    
+    // A line that starts, stops or restarts scrolling changes the layering
+    MarqueeAnimation* marquee[4] = {nullptr, nullptr, nullptr, nullptr};
+    for (unsigned int i = 0; i < 4; ++i) {
+        try {
+            marquee[i] = codepoints_[i].empty() ? nullptr : marquee_for(i);
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (marquee[i] != d.shown_marquee[i] || d.marquee_rebuilt[i]) {
+            return false;
+        }
+    }
+    
+    std::vector<Rect>& areas = d.areas;
+    areas.clear();
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (!marquee[i] && codepoints_[i] != d.shown[i]) {
+            line_changes(i, areas);
+        }
+    }
+    
+    // Merge overlapping areas so no pixel is repainted twice
+    for (size_t a = 0; a < areas.size(); ++a) {
+        for (size_t b = a + 1; b < areas.size();) {
+            if (!areas[a].intersected(areas[b]).empty()) {
+                areas[a] = areas[a].united(areas[b]);
+                areas.erase(areas.begin() + static_cast<std::ptrdiff_t>(b));
+                b = a + 1;
+            } else {
+                ++b;
+            }
+        }
+    }
+    
+    // Text under a marquee window is layered with it; redraw everything
+    for (const Rect& r : areas) {
+        for (unsigned int i = 0; i < 4; ++i) {
+            if (marquee[i] && !r.intersected(marquee[i]->bounds()).empty()) {
+                return false;
+            }
+        }
+    }
+    
+    for (const Rect& r : areas) {
+        d.gfx->fill_rect(r.x, r.y, r.x + r.w - 1, r.y + r.h - 1, false);
+        repaint(r, 0);
+        d.dirty.push_back(r);
+    }
+    for (unsigned int i = 0; i < 4; ++i) {
+        d.shown[i] = codepoints_[i];
+    }
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (marquee[i] && marquee[i]->update(d.time)) {
+            marquee[i]->draw(*d.gfx);
+            repaint(marquee[i]->bounds(), i + 1); // later lines draw over it
+            d.dirty.push_back(marquee[i]->bounds());
+        }
+    }
+    return true;
+}
+
+void FourLineDisplay::render_full() {
     // Clear graphics buffer
     impl_->gfx->clear();
     
+    if (impl_->pool) {
+        // Rasterize lines concurrently, each into its own layer, then merge
+        // in line order exactly as the serial loop below draws them
+        bool drawn[4] = {false, false, false, false};
+        MarqueeAnimation* marquee[4] = {nullptr, nullptr, nullptr, nullptr};
+        impl_->pool->run(4, [&](size_t i) {
+            if (codepoints_[i].empty()) {
+                return;
+            }
+            try {
+                if ((marquee[i] = marquee_for(static_cast<unsigned int>(i)))) {
+                    return;
+                }
+                MonoGfx& layer = *impl_->layer[i];
+                layer.clear();
+                drawn[i] = true;
+                impl_->font_for(static_cast<unsigned int>(i))->draw_codepoints(
+                    layer, 0, get_line_y_position(static_cast<unsigned int>(i)), codepoints_[i], true);
+            } catch (const std::exception&) {
+                // Silently ignore rendering errors for individual lines
+            }
+        });
+        
+        std::vector<unsigned char>& fb = impl_->gfx->fb();
+        for (unsigned int i = 0; i < 4; ++i) {
+            if (marquee[i]) {
+                marquee[i]->update(impl_->time);
+                marquee[i]->draw(*impl_->gfx);
+            } else if (drawn[i]) {
+                // Text only sets pixels, so OR reproduces drawing in place
+                const std::vector<unsigned char>& src = impl_->layer[i]->fb();
+                for (size_t k = 0; k < fb.size(); ++k) {
+                    fb[k] |= src[k];
+                }
+            }
+        }
+        
+        return;
+    }
+    
     // Render each line
     for (unsigned int i = 0; i < 4; ++i) {
-        if (lines_[i].empty()) {
+        if (codepoints_[i].empty()) {
             continue;
         }
         
         int y_pos = get_line_y_position(i);
         
         // Select appropriate font renderer
-        FtText* ft = (i == 1) ? impl_->large_ft.get() : impl_->small_ft.get();
+        FtText* ft = impl_->font_for(i);
         
         // Render the text
         try {
-            ft->draw_utf8(impl_->gfx->fb(), width_, height_, 0, y_pos, lines_[i], true);
+            if (MarqueeAnimation* m = marquee_for(i)) {
+                m->update(impl_->time);
+                m->draw(*impl_->gfx);
+                continue;
+            }
+            ft->draw_codepoints(*impl_->gfx, 0, y_pos, codepoints_[i], true);
         } catch (const std::exception&) {
             // Silently ignore rendering errors for individual lines
         }
     }
-    
-    // Copy framebuffer
-    framebuffer_ = impl_->gfx->fb();
-    
-    return framebuffer_;
+}
+
+const std::vector<Rect>& FourLineDisplay::get_dirty_rects() const {
+    return impl_->dirty;
 }
 
 const std::vector<unsigned char>& FourLineDisplay::get_framebuffer() const {
-    return framebuffer_;
+    return impl_->gfx ? impl_->gfx->fb() : framebuffer_;
 }
@@ -0,0 +1,87 @@
+#include "frame_scheduler.h"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <time.h>
+
+FrameScheduler::FrameScheduler(double fps) : fps_(0.0), period_ns_(0) {
+    set_fps(fps);
+}
+
+void FrameScheduler::set_fps(double fps) {
+    if (!(fps > 0.0)) throw std::runtime_error("FrameScheduler fps must be positive");
+    // The new period applies from the next frame on; the time origin
+    // stays, so FrameTick::time does not jump
+    if (started_) {
+        rebase_frame_ += static_cast<uint64_t>((next_ns_ - rebase_ns_) / period_ns_);
+        rebase_ns_ = next_ns_;
+    }
+    fps_ = fps;
+    period_ns_ = static_cast<int64_t>(1e9 / fps);
+}
+
+void FrameScheduler::start() {
+    origin_ns_ = now_ns();
+    rebase_ns_ = origin_ns_;
+    rebase_frame_ = 0;
+    next_ns_ = origin_ns_;
+    frame_ = 0;
+    started_ = true;
+    in_frame_ = false;
+}
+
+FrameTick FrameScheduler::wait_next() {
+    if (!started_) start();
+    if (in_frame_) end_frame();
+
+    FrameTick tick;
+    const int64_t now = now_ns();
+    if (now > next_ns_ + period_ns_ / 2) {
+        // Late by more than half a period: drop the frames already past
+        // instead of rendering them back to back.
+        const int64_t late = now - next_ns_;
+        const uint64_t skip = static_cast<uint64_t>((late + period_ns_ / 2) / period_ns_);
+        tick.skipped = static_cast<uint32_t>(skip);
+        next_ns_ += static_cast<int64_t>(skip) * period_ns_;
+        stats_.skipped += skip;
+    }
+
+    const uint64_t index = rebase_frame_ + static_cast<uint64_t>((next_ns_ - rebase_ns_) / period_ns_);
+    if (now < next_ns_) sleep_until_ns(next_ns_);
+
+    tick.frame = index;
+    tick.time = static_cast<double>(next_ns_ - origin_ns_) / 1e9;
+    frame_ = index;
+    frame_start_ns_ = std::max(now, next_ns_);
+    next_ns_ += period_ns_;
+    in_frame_ = true;
+    stats_.frames += 1;
+    return tick;
+}
+
+void FrameScheduler::end_frame() {
+    if (!in_frame_) return;
+    in_frame_ = false;
+
+    const double busy_ms = static_cast<double>(now_ns() - frame_start_ns_) / 1e6;
+    stats_.last_busy_ms = busy_ms;
+    stats_.max_busy_ms = std::max(stats_.max_busy_ms, busy_ms);
+    // Running mean over delivered frames
+    stats_.avg_busy_ms += (busy_ms - stats_.avg_busy_ms) / static_cast<double>(stats_.frames);
+    if (busy_ms > budget_ms()) stats_.over_budget += 1;
+}
+
+int64_t FrameScheduler::now_ns() const {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void FrameScheduler::sleep_until_ns(int64_t deadline_ns) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline_ns / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(deadline_ns % 1000000000LL);
+    // Absolute deadline: an EINTR retry does not stretch the sleep
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
@@ -1,16 +1,130 @@
 #include "ft_text.h"
+#include "graphics.h"
+#include "utf8.h"
+#include <algorithm>
 #include <stdexcept>
 #include <cstring>
 #include <cstdint>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <new>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
+
+namespace {
+// Pen position of one glyph relative to the run origin (x, top-left y).
+struct ShapedGlyph {
+    FT_UInt index;
+    int x;
+    int y;
+};
+
+struct ShapedRun {
+    std::vector<ShapedGlyph> glyphs;
+    int width{0};  // widest line advance in pixels
+    int lines{1};
+};
+
+// Shaped runs kept by one instance, all sizes together. The slots are set
+// up with the instance and reused in clock order, so a label that changes
+// every frame (a counter) costs no allocation once the slots have grown to
+// its length.
+constexpr size_t kRunSlots = 32;
+constexpr size_t kRunReserve = 32;  // codepoints per slot before it grows
+
+struct RunSlot {
+    int px{0};
+    std::u32string text;
+    ShapedRun run;
+    bool used{false};
+    bool ref{false};
+};
+
+// Rendered glyph bitmaps by (size, glyph index), so redrawing text copies
+// cached bits instead of rasterizing (FT_Render_Glyph allocates a bitmap
+// per call).
+constexpr size_t kGlyphSlots = 128;
+
+struct GlyphSlot {
+    uint64_t key{0};
+    bool used{false};
+    bool ref{false};
+    int left{0};  // FT bitmap_left, bitmap_top
+    int top{0};
+    int width{0};
+    int rows{0};
+    int pitch{0};
+    std::vector<unsigned char> bits;
+};
+
+// FreeType allocates through operator new/delete like the rest of the
+// library, so a replaced operator new sees (and can count) its blocks too.
+void* ft_alloc(FT_Memory, long size) {
+    return ::operator new(static_cast<size_t>(size), std::nothrow);
+}
+
+void ft_free(FT_Memory, void* block) { ::operator delete(block); }
+
+void* ft_realloc(FT_Memory, long cur_size, long new_size, void* block) {
+    void* p = ::operator new(static_cast<size_t>(new_size), std::nothrow);
+    if (!p) return nullptr;
+    if (block) {
+        std::memcpy(p, block, static_cast<size_t>(std::min(cur_size, new_size)));
+        ::operator delete(block);
+    }
+    return p;
+}
+
+// Clock sweep: the first slot not used since the hand last passed it.
+template <class Slot, size_t N>
+Slot& evict(Slot (&slots)[N], size_t& hand) {
+    for (;;) {
+        Slot& s = slots[hand];
+        hand = (hand + 1) % N;
+        if (!s.used || !s.ref) return s;
+        s.ref = false;
+    }
+}
+}
 
 struct FtText::Impl {
+    FT_MemoryRec_ memory{nullptr, ft_alloc, ft_free, ft_realloc};
     FT_Library lib{nullptr};
     FT_Face face{nullptr};
+    FontData font_data;  // backing store of a memory face
     int px{16};
+    bool kerning{true};
+    RunSlot runs[kRunSlots];
+    size_t run_hand{0};
+    GlyphSlot glyphs[kGlyphSlots];
+    size_t glyph_hand{0};
+    // Reused by draw_utf8 so decoding does not allocate per call
+    std::u32string scratch;
+
+    Impl() {
+        for (RunSlot& s : runs) {
+            s.text.reserve(kRunReserve);
+            s.run.glyphs.reserve(kRunReserve);
+        }
+        scratch.reserve(kRunReserve);
+    }
+
+    void drop_runs() {
+        for (RunSlot& s : runs) s.used = false;
+    }
+    // Glyph indices and hinting belong to the face
+    void drop_glyphs() {
+        for (GlyphSlot& g : glyphs) g.used = false;
+    }
+
+    const ShapedRun& shape(const std::u32string& text);
+    // Rendered glyph at the current size, or nullptr if FreeType fails
+    const GlyphSlot* glyph(FT_UInt index);
+    template <class Keep, class Blit>
+    void render_run(const ShapedRun& run, int clip_width, int x, int y, Keep&& keep, Blit&& blit);
 };
 
 static void set_px(FT_Face face, int px) {
@@ -21,21 +135,51 @@ static void set_px(FT_Face face, int px) {
 
 FtText::FtText() {
     impl_ = std::make_unique<Impl>();
-    if (FT_Init_FreeType(&impl_->lib)) {
-        throw std::runtime_error("FT_Init_FreeType failed");
+    // FT_Init_FreeType with our allocator in place of malloc
+    if (FT_New_Library(&impl_->memory, &impl_->lib)) {
+        throw std::runtime_error("FT_New_Library failed");
     }
+    FT_Add_Default_Modules(impl_->lib);
+    FT_Set_Default_Properties(impl_->lib);
 }
 
 FtText::~FtText() {
     if (!impl_) return;
     if (impl_->face) FT_Done_Face(impl_->face);
-    if (impl_->lib) FT_Done_FreeType(impl_->lib);
+    if (impl_->lib) FT_Done_Library(impl_->lib);
+}
+
+FtText::FontData FtText::read_font_file(const std::string& font_path) {
+    std::ifstream f(font_path, std::ios::binary);
+    if (!f) throw std::runtime_error("Failed to open font: " + font_path);
+    auto data = std::make_shared<std::vector<unsigned char>>(
+        (std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (data->empty()) throw std::runtime_error("Empty font file: " + font_path);
+    return data;
 }
 
 void FtText::load_font(const std::string& font_path) {
     if (impl_->face) { FT_Done_Face(impl_->face); impl_->face = nullptr; }
+    impl_->font_data.reset();
     FT_Error e = FT_New_Face(impl_->lib, font_path.c_str(), 0, &impl_->face);
     if (e) throw std::runtime_error("FT_New_Face failed for: " + font_path);
+    impl_->drop_runs();
+    impl_->drop_glyphs();
+    set_px(impl_->face, impl_->px);
+}
+
+void FtText::load_font(FontData data) {
+    if (!data || data->empty()) throw std::runtime_error("No font data");
+    if (impl_->face) { FT_Done_Face(impl_->face); impl_->face = nullptr; }
+    impl_->font_data = std::move(data);
+    FT_Error e = FT_New_Memory_Face(impl_->lib, impl_->font_data->data(),
+                                    static_cast<FT_Long>(impl_->font_data->size()), 0, &impl_->face);
+    if (e) {
+        impl_->font_data.reset();
+        throw std::runtime_error("FT_New_Memory_Face failed");
+    }
+    impl_->drop_runs();
+    impl_->drop_glyphs();
     set_px(impl_->face, impl_->px);
 }
 
@@ -44,90 +188,292 @@ void FtText::set_pixel_size(int px) {
     if (impl_->face) set_px(impl_->face, impl_->px);
 }
 
-static inline void fb_set(std::vector<unsigned char>& fb, int w, int h, int x, int y, bool on) {
-    if (x < 0 || y < 0 || x >= w || y >= h) return;
-    int page = y / 8;
-    int bit = y % 8;
-    size_t idx = (size_t)page * (size_t)w + (size_t)x;
-    if (idx >= fb.size()) return;
-    unsigned char mask = (unsigned char)(1u << bit);
-    if (on) fb[idx] |= mask;
-    else fb[idx] &= (unsigned char)~mask;
-}
-
-// Minimal UTF-8 decoder: returns next codepoint and advances i
-static uint32_t next_cp(const std::string& s, size_t& i) {
-    if (i >= s.size()) return 0xFFFD; // bounds check before access
-    unsigned char c = (unsigned char)s[i++];
-    if (c < 0x80) return c;
-    if ((c & 0xE0) == 0xC0 && i < s.size()) {
-        uint32_t cp = ((uint32_t)(c & 0x1F) << 6) | ((uint32_t)(s[i++] & 0x3F));
-        return cp;
-    }
-    if ((c & 0xF0) == 0xE0 && i + 1 < s.size()) {
-        uint32_t b1 = s[i++] & 0x3F;
-        uint32_t b2 = s[i++] & 0x3F;
-        uint32_t cp = ((uint32_t)(c & 0x0F) << 12) |
-                      (b1 << 6) |
-                      b2;
-        return cp;
-    }
-    if ((c & 0xF8) == 0xF0 && i + 2 < s.size()) {
-        uint32_t b1 = s[i++] & 0x3F;
-        uint32_t b2 = s[i++] & 0x3F;
-        uint32_t b3 = s[i++] & 0x3F;
-        uint32_t cp = ((uint32_t)(c & 0x07) << 18) |
-                      (b1 << 12) |
-                      (b2 << 6) |
-                      b3;
-        return cp;
-    }
-    return 0xFFFD; // replacement
+void FtText::set_kerning(bool enabled) {
+    if (impl_->kerning == enabled) return;
+    impl_->kerning = enabled;
+    impl_->drop_runs();
 }
 
-void FtText::draw_utf8(std::vector<unsigned char>& fb, int width, int height,
-                       int x, int y, const std::string& utf8, bool on) {
+bool FtText::kerning() const { return impl_->kerning; }
+
+size_t FtText::cached_runs() const {
+    size_t n = 0;
+    for (const RunSlot& s : impl_->runs) n += s.used ? 1 : 0;
+    return n;
+}
+
+void FtText::clear_cache() {
+    impl_->drop_runs();
+    impl_->drop_glyphs();
+}
+
+int FtText::pixel_size() const { return impl_->px; }
+
+int FtText::line_height() const {
     if (!impl_->face) throw std::runtime_error("Font not loaded");
-    int pen_x = x;
-    int pen_y = y;
+    const FT_Size_Metrics& m = impl_->face->size->metrics;
+    return (int)((m.ascender - m.descender) >> 6);
+}
 
-    // Use baseline: place glyphs so that top aligns roughly to y by using ascender
-    int asc = (int)(impl_->face->size->metrics.ascender >> 6); // pixels
-    int base_y = pen_y + asc;
+int FtText::measure_utf8(const std::string& utf8) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    return measure_codepoints(decode(utf8));
+}
 
-    for (size_t i = 0; i < utf8.size();) {
-        uint32_t cp = next_cp(utf8, i);
+int FtText::measure_codepoints(const std::u32string& text) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    return impl_->shape(text).width;
+}
+
+static inline bool keep_all(int, int) { return true; }
+
+// Pixel by pixel, for destinations that map or clip each one
+template <class Plot>
+static void plot_bitmap(const MonoBitmap& bm, int x, int y, Plot&& plot) {
+    for (int row = 0; row < bm.height; ++row) {
+        const unsigned char* src = bm.rows + (size_t)row * (size_t)bm.pitch;
+        for (int col = 0; col < bm.width; ++col) {
+            if ((src[col >> 3] >> (7 - (col & 7))) & 1) plot(x + col, y + row);
+        }
+    }
+}
+
+// Combining diacritical mark blocks. Marks are placed over the preceding
+// base glyph instead of taking their own advance (monospace fonts give them
+// a full cell).
+static bool is_combining_mark(char32_t cp) {
+    return (cp >= 0x0300 && cp <= 0x036F) ||
+           (cp >= 0x0483 && cp <= 0x0489) ||
+           (cp >= 0x1AB0 && cp <= 0x1AFF) ||
+           (cp >= 0x1DC0 && cp <= 0x1DFF) ||
+           (cp >= 0x20D0 && cp <= 0x20FF) ||
+           (cp >= 0xFE20 && cp <= 0xFE2F);
+}
+
+const ShapedRun& FtText::Impl::shape(const std::u32string& text) {
+    for (RunSlot& s : runs) {
+        if (s.used && s.px == px && s.text == text) {
+            s.ref = true;
+            return s.run;
+        }
+    }
+
+    // Refilled in place: assign() and clear() keep the slot's capacity
+    RunSlot& slot = evict(runs, run_hand);
+    slot.used = false;
+    slot.px = px;
+    slot.text.assign(text);
+    ShapedRun& run = slot.run;
+    run.glyphs.clear();
+    run.width = 0;
+    run.lines = 1;
+    const bool use_kerning = kerning && FT_HAS_KERNING(face);
+    int pen_x = 0;
+    int pen_y = 0;
+    FT_UInt prev = 0;
+    int base_x = 0;
+    int base_adv = 0;
+
+    for (char32_t cp : text) {
         if (cp == '\n') {
-            pen_x = x;
-            pen_y += impl_->px; // line step
-            base_y = pen_y + asc;
+            pen_x = 0;
+            pen_y += px; // line step
+            ++run.lines;
+            prev = 0;
+            base_adv = 0;
             continue;
         }
 
-        FT_UInt gi = FT_Get_Char_Index(impl_->face, cp);
-        if (FT_Load_Glyph(impl_->face, gi, FT_LOAD_DEFAULT)) continue;
-        if (FT_Render_Glyph(impl_->face->glyph, FT_RENDER_MODE_MONO)) continue;
-
-        FT_GlyphSlot g = impl_->face->glyph;
-        const FT_Bitmap& bm = g->bitmap;
+        FT_UInt gi = FT_Get_Char_Index(face, cp);
+        if (FT_Load_Glyph(face, gi, FT_LOAD_DEFAULT)) continue;
+        const FT_Glyph_Metrics& m = face->glyph->metrics;
 
-        int gx = pen_x + g->bitmap_left;
-        int gy = base_y - g->bitmap_top;
+        if (is_combining_mark(cp) && base_adv > 0) {
+            // Center the mark's ink over the base glyph's advance box.
+            int ink_w = (int)(m.width >> 6);
+            int bearing = (int)(m.horiBearingX >> 6);
+            run.glyphs.push_back({gi, base_x + (base_adv - ink_w) / 2 - bearing, pen_y});
+            continue;
+        }
 
-        // Copy MONO bitmap (1bpp, MSB first per byte)
-        for (int row = 0; row < (int)bm.rows; ++row) {
-            const unsigned char* src = bm.buffer + (size_t)row * (size_t)bm.pitch;
-            for (int col = 0; col < (int)bm.width; ++col) {
-                int byte = col >> 3;
-                int bit = 7 - (col & 7);
-                bool pix = (src[byte] >> bit) & 1;
-                if (pix) fb_set(fb, width, height, gx + col, gy + row, on);
+        if (use_kerning && prev && gi) {
+            FT_Vector delta;
+            if (!FT_Get_Kerning(face, prev, gi, FT_KERNING_DEFAULT, &delta)) {
+                pen_x += (int)(delta.x >> 6);
             }
         }
 
-        pen_x += (int)(g->advance.x >> 6);
+        run.glyphs.push_back({gi, pen_x, pen_y});
+        base_x = pen_x;
+        base_adv = (int)(face->glyph->advance.x >> 6);
+        pen_x += base_adv;
+        prev = gi;
+        if (pen_x > run.width) run.width = pen_x;
+    }
+
+    slot.used = true;
+    slot.ref = true;
+    return run;
+}
+
+const GlyphSlot* FtText::Impl::glyph(FT_UInt index) {
+    const uint64_t key = (static_cast<uint64_t>(px) << 32) | index;
+    for (GlyphSlot& g : glyphs) {
+        if (g.used && g.key == key) {
+            g.ref = true;
+            return &g;
+        }
+    }
+
+    if (FT_Load_Glyph(face, index, FT_LOAD_DEFAULT)) return nullptr;
+    if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_MONO)) return nullptr;
+    const FT_GlyphSlot fg = face->glyph;
+    const FT_Bitmap& bm = fg->bitmap;
+    GlyphSlot& g = evict(glyphs, glyph_hand);
+    g.key = key;
+    g.used = true;
+    g.ref = true;
+    g.left = fg->bitmap_left;
+    g.top = fg->bitmap_top;
+    g.width = static_cast<int>(bm.width);
+    g.rows = static_cast<int>(bm.rows);
+    // MONO bitmaps flow down (positive pitch)
+    g.pitch = bm.pitch;
+    g.bits.assign(bm.buffer, bm.buffer + static_cast<size_t>(bm.rows) * static_cast<size_t>(bm.pitch));
+    return &g;
+}
+
+// Rasterize a shaped run; blit(bitmap, x, y) receives each glyph with its
+// top-left in logical pixel coordinates. keep(pen_x, pen_y) can skip
+// glyphs before they are rendered.
+template <class Keep, class Blit>
+void FtText::Impl::render_run(const ShapedRun& run, int clip_width, int x, int y, Keep&& keep,
+                              Blit&& blit) {
+    // Use baseline: place glyphs so that top aligns roughly to y by using ascender
+    int asc = (int)(face->size->metrics.ascender >> 6); // pixels
+
+    for (const ShapedGlyph& sg : run.glyphs) {
+        int pen_x = x + sg.x;
+        // simple clipping: nothing of this glyph starts inside the framebuffer
+        if (pen_x >= clip_width) continue;
+        if (!keep(pen_x, y + sg.y)) continue;
+
+        const GlyphSlot* g = glyph(sg.index);
+        if (!g) continue;
+        // MONO bitmap: 1bpp, MSB first per byte
+        blit(MonoBitmap{g->bits.data(), g->pitch, g->width, g->rows}, pen_x + g->left,
+             y + sg.y + asc - g->top);
+    }
+}
+
+const std::u32string& FtText::decode(const std::string& utf8) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    utf8_decode(utf8, impl_->scratch);
+    return impl_->scratch;
+}
+
+void FtText::for_each_glyph(const std::u32string& text, int x, int y, int clip_width,
+                            const GlyphSink& sink) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    impl_->render_run(impl_->shape(text), clip_width, x, y, keep_all, sink);
+}
+
+void FtText::draw_utf8(std::vector<unsigned char>& fb, int width, int height,
+                       int x, int y, const std::string& utf8, bool on) {
+    draw_codepoints(fb, width, height, x, y, decode(utf8), on);
+}
+
+void FtText::draw_codepoints(std::vector<unsigned char>& fb, int width, int height,
+                             int x, int y, const std::u32string& text, bool on) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    if (width <= 0) return;
+    // Never past the end of a short buffer
+    const int h = std::min(height, (int)(fb.size() / (size_t)width) * 8);
+    impl_->render_run(impl_->shape(text), width, x, y, keep_all,
+                      [&](const MonoBitmap& bm, int gx, int gy) {
+                          mono_blit(fb.data(), width, h, bm, gx, gy, on);
+                      });
+}
 
-        // simple clipping/stop
-        if (pen_x >= width) break;
+void FtText::draw_utf8(MonoGfx& gfx, int x, int y, const std::string& utf8, bool on) {
+    draw_codepoints(gfx, x, y, decode(utf8), on);
+}
+
+void FtText::draw_codepoints(MonoGfx& gfx, int x, int y, const std::u32string& text, bool on) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    const ShapedRun& run = impl_->shape(text);
+    if (gfx.pixel_map().identity) {
+        std::vector<unsigned char>& fb = gfx.fb();
+        const int w = gfx.native_width();
+        const int h = gfx.native_height();
+        impl_->render_run(run, w, x, y, keep_all, [&](const MonoBitmap& bm, int gx, int gy) {
+            mono_blit(fb.data(), w, h, bm, gx, gy, on);
+        });
+    } else {
+        impl_->render_run(run, gfx.width(), x, y, keep_all, [&](const MonoBitmap& bm, int gx, int gy) {
+            plot_bitmap(bm, gx, gy, [&](int px, int py) { gfx.pixel(px, py, on); });
+        });
     }
 }
+
+// Ink extents of any glyph at the face's current size (advance left 0)
+static FtText::CellMetrics ink_extents(FT_Face face, int px) {
+    const int asc = (int)(face->size->metrics.ascender >> 6);
+    FtText::CellMetrics m{0, -px, 2 * px, asc - 2 * px, asc + px};
+    if (FT_IS_SCALABLE(face)) {
+        // Font bounding box, scaled, with slack for hinting and rounding
+        const FT_Fixed xs = face->size->metrics.x_scale;
+        const FT_Fixed ys = face->size->metrics.y_scale;
+        m.ink_left = (int)(FT_MulFix(face->bbox.xMin, xs) >> 6) - 1;
+        m.ink_right = (int)((FT_MulFix(face->bbox.xMax, xs) + 63) >> 6) + 2;
+        m.ink_top = asc - (int)((FT_MulFix(face->bbox.yMax, ys) + 63) >> 6) - 1;
+        m.ink_bottom = asc - (int)(FT_MulFix(face->bbox.yMin, ys) >> 6) + 2;
+    }
+    return m;
+}
+
+FtText::CellMetrics FtText::cell_metrics() {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    FT_Face face = impl_->face;
+    CellMetrics m = ink_extents(face, impl_->px);
+    if (FT_IS_FIXED_WIDTH(face) && !(impl_->kerning && FT_HAS_KERNING(face)) &&
+        !FT_Load_Glyph(face, FT_Get_Char_Index(face, '0'), FT_LOAD_DEFAULT)) {
+        m.advance = (int)(face->glyph->advance.x >> 6);  // as shape() steps the pen
+    }
+    return m;
+}
+
+Rect FtText::glyph_box(char32_t cp) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    FT_Face face = impl_->face;
+    if (FT_Load_Glyph(face, FT_Get_Char_Index(face, cp), FT_LOAD_DEFAULT)) return {};
+    const FT_Glyph_Metrics& m = face->glyph->metrics;
+    if (m.width <= 0 || m.height <= 0) return {};
+    const int asc = (int)(face->size->metrics.ascender >> 6);
+    const int x0 = (int)(m.horiBearingX >> 6) - 1;
+    const int x1 = (int)((m.horiBearingX + m.width + 63) >> 6) + 1;
+    const int y0 = asc - (int)((m.horiBearingY + 63) >> 6) - 1;
+    const int y1 = asc - (int)((m.horiBearingY - m.height) >> 6) + 1;
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+void FtText::draw_codepoints(MonoGfx& gfx, int x, int y, const std::u32string& text, bool on,
+                             const Rect& clip) {
+    if (!impl_->face) throw std::runtime_error("Font not loaded");
+    const Rect area = clip.intersected(Rect{0, 0, gfx.width(), gfx.height()});
+    if (area.empty()) return;
+    const CellMetrics m = ink_extents(impl_->face, impl_->px);
+    const ShapedRun& run = impl_->shape(text);
+    auto reaches = [&](int pen_x, int pen_y) {
+        return pen_x + m.ink_right > area.x && pen_x + m.ink_left < area.x + area.w &&
+               pen_y + m.ink_bottom > area.y && pen_y + m.ink_top < area.y + area.h;
+    };
+    auto inside = [&](int px, int py) {
+        return px >= area.x && px < area.x + area.w && py >= area.y && py < area.y + area.h;
+    };
+    impl_->render_run(run, gfx.width(), x, y, reaches, [&](const MonoBitmap& bm, int gx, int gy) {
+        plot_bitmap(bm, gx, gy, [&](int px, int py) {
+            if (inside(px, py)) gfx.pixel(px, py, on);
+        });
+    });
+}
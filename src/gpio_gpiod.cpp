@@ -1,17 +1,28 @@
 #include "gpio_gpiod.h"
 #include <gpiod.h>
+#include <algorithm>
 #include <stdexcept>
 #include <thread>
 #include <chrono>
-#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <cerrno>
 #include <cstring>
 #include <sstream>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 struct GpioLine::Impl {
     gpiod_chip* chip{nullptr};
     gpiod_line* line{nullptr};
     bool is_output{false};
+    bool events{false};
+    GpioBulk* bulk{nullptr};  // member of a bulk request: set() goes through it
+    size_t index{0};
+    int level{-1};  // last value set, -1 until the first set()
+    BusRecorder* recorder{nullptr};
+    BusChannel channel{BusChannel::Other};
 };
 
 static std::runtime_error gpiod_err(const std::string& what) {
@@ -37,6 +48,7 @@ GpioLine::GpioLine(int line_offset, bool output, bool initial_value,
         if (gpiod_line_request_output(impl_->line, consumer.c_str(), initial_value ? 1 : 0) != 0) {
             throw gpiod_err("Failed to request output line " + std::to_string(line_offset));
         }
+        impl_->level = initial_value ? 1 : 0;
     } else {
         errno = 0;
         if (gpiod_line_request_input(impl_->line, consumer.c_str()) != 0) {
@@ -45,6 +57,24 @@ GpioLine::GpioLine(int line_offset, bool output, bool initial_value,
     }
 }
 
+GpioLine::GpioLine(int line_offset, GpioEdge edges, std::string chip_path, std::string consumer) {
+    impl_ = new Impl();
+    errno = 0;
+    impl_->chip = gpiod_chip_open(chip_path.c_str());
+    if (!impl_->chip) throw gpiod_err("Failed to open gpio chip " + chip_path);
+
+    errno = 0;
+    impl_->line = gpiod_chip_get_line(impl_->chip, line_offset);
+    if (!impl_->line) throw gpiod_err("Failed to get gpio line offset " + std::to_string(line_offset));
+
+    errno = 0;
+    const int rc = edges == GpioEdge::Rising   ? gpiod_line_request_rising_edge_events(impl_->line, consumer.c_str())
+                   : edges == GpioEdge::Falling ? gpiod_line_request_falling_edge_events(impl_->line, consumer.c_str())
+                                                : gpiod_line_request_both_edges_events(impl_->line, consumer.c_str());
+    if (rc != 0) throw gpiod_err("Failed to request edge events on line " + std::to_string(line_offset));
+    impl_->events = true;
+}
+
 GpioLine::~GpioLine() {
     if (!impl_) return;
     if (impl_->line) gpiod_line_release(impl_->line);
@@ -53,24 +83,329 @@ GpioLine::~GpioLine() {
     impl_ = nullptr;
 }
 
+GpioLine::GpioLine(GpioBulk& bulk, size_t index) {
+    impl_ = new Impl();
+    impl_->is_output = true;
+    impl_->bulk = &bulk;
+    impl_->index = index;
+}
+
 void GpioLine::set(bool value) {
     if (!impl_->is_output) throw std::runtime_error("GPIO line is not output");
+    if (impl_->bulk) {
+        // The bulk keeps the levels: set_mask() may have changed this line
+        if (impl_->bulk->get(impl_->index) == value) return;
+        impl_->bulk->set(impl_->index, value);
+        if (impl_->recorder) impl_->recorder->record_gpio(impl_->channel, value);
+        return;
+    }
+    // The line is requested exclusively, so an unchanged level needs no ioctl
+    // (drivers set D/C before every write)
+    if (impl_->level == (value ? 1 : 0)) return;
     errno = 0;
     if (gpiod_line_set_value(impl_->line, value ? 1 : 0) != 0) throw gpiod_err("Failed to set gpio value");
+    impl_->level = value ? 1 : 0;
+    if (impl_->recorder) impl_->recorder->record_gpio(impl_->channel, value);
+}
+
+void GpioLine::set_recorder(BusRecorder* recorder, BusChannel channel) {
+    impl_->recorder = recorder;
+    impl_->channel = channel;
 }
 
 bool GpioLine::get() const {
+    if (impl_->bulk) return impl_->bulk->get(impl_->index);
     errno = 0;
     int v = gpiod_line_get_value(impl_->line);
     if (v < 0) throw gpiod_err("Failed to read gpio value");
     return v != 0;
 }
 
+bool GpioLine::wait_edge(std::chrono::nanoseconds timeout) {
+    if (!impl_->events) throw std::runtime_error("GPIO line is not requested for edge events");
+    const long long ns = std::max<long long>(0, timeout.count());
+    const timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+    errno = 0;
+    const int rc = gpiod_line_event_wait(impl_->line, &ts);
+    if (rc < 0) throw gpiod_err("Failed to wait for gpio event");
+    return rc > 0;
+}
+
+GpioEdgeEvent GpioLine::read_edge() {
+    if (!impl_->events) throw std::runtime_error("GPIO line is not requested for edge events");
+    gpiod_line_event ev{};
+    errno = 0;
+    if (gpiod_line_event_read(impl_->line, &ev) != 0) throw gpiod_err("Failed to read gpio event");
+    GpioEdgeEvent out;
+    out.rising = ev.event_type == GPIOD_LINE_EVENT_RISING_EDGE;
+    out.time = std::chrono::seconds(ev.ts.tv_sec) + std::chrono::nanoseconds(ev.ts.tv_nsec);
+    return out;
+}
+
+int GpioLine::event_fd() const {
+    if (!impl_->events) throw std::runtime_error("GPIO line is not requested for edge events");
+    errno = 0;
+    const int fd = gpiod_line_event_get_fd(impl_->line);
+    if (fd < 0) throw gpiod_err("Failed to get gpio event fd");
+    return fd;
+}
+
+struct GpioBulk::Impl {
+    gpiod_chip* chip{nullptr};
+    gpiod_line_bulk lines;
+    bool requested{false};
+    std::vector<int> values;
+    std::vector<std::unique_ptr<GpioLine>> views;
+
+    void write() {
+        errno = 0;
+        if (gpiod_line_set_value_bulk(&lines, values.data()) != 0) throw gpiod_err("Failed to set gpio values");
+    }
+
+    ~Impl() {
+        if (requested) gpiod_line_release_bulk(&lines);
+        if (chip) gpiod_chip_close(chip);
+    }
+};
+
+GpioBulk::GpioBulk(const std::vector<int>& line_offsets, const std::vector<bool>& initial_values,
+                   std::string chip_path, std::string consumer) {
+    if (line_offsets.empty() || line_offsets.size() > GPIOD_LINE_BULK_MAX_LINES ||
+        initial_values.size() != line_offsets.size()) {
+        throw std::runtime_error("Invalid gpio bulk request");
+    }
+    auto impl = std::make_unique<Impl>();
+    errno = 0;
+    impl->chip = gpiod_chip_open(chip_path.c_str());
+    if (!impl->chip) throw gpiod_err("Failed to open gpio chip " + chip_path);
+
+    std::vector<unsigned int> offsets(line_offsets.begin(), line_offsets.end());
+    errno = 0;
+    if (gpiod_chip_get_lines(impl->chip, offsets.data(), static_cast<unsigned int>(offsets.size()),
+                             &impl->lines) != 0) {
+        throw gpiod_err("Failed to get gpio lines on " + chip_path);
+    }
+    impl->values.assign(initial_values.begin(), initial_values.end());
+    errno = 0;
+    if (gpiod_line_request_bulk_output(&impl->lines, consumer.c_str(), impl->values.data()) != 0) {
+        throw gpiod_err("Failed to request output lines on " + chip_path);
+    }
+    impl->requested = true;
+    for (size_t i = 0; i < line_offsets.size(); ++i) {
+        impl->views.emplace_back(new GpioLine(*this, i));
+    }
+    impl_ = impl.release();
+}
+
+GpioBulk::~GpioBulk() {
+    delete impl_;
+}
+
+size_t GpioBulk::size() const {
+    return impl_->values.size();
+}
+
+GpioLine& GpioBulk::line(size_t index) {
+    return *impl_->views.at(index);
+}
+
+bool GpioBulk::get(size_t index) const {
+    return impl_->values.at(index) != 0;
+}
+
+void GpioBulk::set(size_t index, bool value) {
+    // The handle sets all of its lines at once, so the others are resent
+    // with their cached levels
+    impl_->values.at(index) = value ? 1 : 0;
+    impl_->write();
+}
+
+void GpioBulk::set_mask(uint64_t mask, uint64_t values) {
+    for (size_t i = 0; i < impl_->values.size(); ++i) {
+        if (mask & (uint64_t{1} << i)) impl_->values[i] = (values >> i) & 1 ? 1 : 0;
+    }
+    impl_->write();
+}
+
+void GpioBulk::set_all(const std::vector<bool>& values) {
+    if (values.size() != impl_->values.size()) throw std::runtime_error("gpio bulk size mismatch");
+    impl_->values.assign(values.begin(), values.end());
+    impl_->write();
+}
+
+struct GpioInputs::Input {
+    int id{0};
+    int fd{-1};
+    ReadEdge read;
+    Handler handler;
+    std::chrono::nanoseconds window{0};
+    bool stable{false};   // last reported level
+    bool latest{false};   // level after the newest edge
+    std::chrono::nanoseconds latest_time{0};
+    bool pending{false};  // window running
+    std::chrono::steady_clock::time_point deadline{};
+};
+
+GpioInputs::GpioInputs() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) throw gpiod_err("epoll_create1 failed");
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer_fd_ < 0) {
+        close(epoll_fd_);
+        throw gpiod_err("timerfd_create failed");
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;  // ids start at 1
+    errno = 0;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &ev) != 0) {
+        // Without the timer no debounce window would ever settle
+        const std::runtime_error err = gpiod_err("epoll_ctl failed");
+        close(timer_fd_);
+        close(epoll_fd_);
+        throw err;
+    }
+}
+
+GpioInputs::~GpioInputs() {
+    close(timer_fd_);
+    close(epoll_fd_);
+}
+
+int GpioInputs::add(GpioLine& line, std::chrono::milliseconds debounce, Handler handler) {
+    GpioLine* l = &line;
+    return add(line.event_fd(), line.get(),
+               [l](GpioEdgeEvent& ev) {
+                   if (!l->wait_edge(std::chrono::nanoseconds(0))) return false;
+                   ev = l->read_edge();
+                   return true;
+               },
+               debounce, std::move(handler));
+}
+
+int GpioInputs::add(int fd, bool level, ReadEdge read_edge, std::chrono::milliseconds debounce,
+                    Handler handler) {
+    auto in = std::make_unique<Input>();
+    in->id = next_id_++;
+    in->fd = fd;
+    in->read = std::move(read_edge);
+    in->handler = std::move(handler);
+    in->window = debounce;
+    in->stable = in->latest = level;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = static_cast<uint64_t>(in->id);
+    errno = 0;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) throw gpiod_err("epoll_ctl failed");
+    inputs_.push_back(std::move(in));
+    return inputs_.back()->id;
+}
+
+void GpioInputs::remove(int id) {
+    for (auto it = inputs_.begin(); it != inputs_.end(); ++it) {
+        if ((*it)->id != id) continue;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, (*it)->fd, nullptr);
+        inputs_.erase(it);
+        arm_timer();
+        return;
+    }
+}
+
+GpioInputs::Input* GpioInputs::find(int id) const {
+    for (const auto& in : inputs_) {
+        if (in->id == id) return in.get();
+    }
+    return nullptr;
+}
+
+bool GpioInputs::level(int id) const {
+    const Input* in = find(id);
+    if (!in) throw std::runtime_error("Unknown GPIO input id " + std::to_string(id));
+    return in->stable;
+}
+
+void GpioInputs::arm_timer() {
+    // One timer for all inputs, at the earliest running window
+    bool any = false;
+    std::chrono::steady_clock::time_point next{};
+    for (const auto& in : inputs_) {
+        if (in->pending && (!any || in->deadline < next)) {
+            next = in->deadline;
+            any = true;
+        }
+    }
+    itimerspec spec{};
+    if (any) {
+        // steady_clock is CLOCK_MONOTONIC; a zero value would disarm
+        const auto ns = std::max<long long>(
+            1, std::chrono::duration_cast<std::chrono::nanoseconds>(next.time_since_epoch()).count());
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+int GpioInputs::dispatch(std::chrono::milliseconds timeout) {
+    epoll_event evs[16];
+    int n;
+    do {
+        n = epoll_wait(epoll_fd_, evs, 16, static_cast<int>(timeout.count()));
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) throw gpiod_err("epoll_wait failed");
+
+    // Handlers run once the state is consistent, so they may add or
+    // remove inputs
+    std::vector<std::pair<Handler, GpioInputEvent>> fired;
+    const auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+        if (evs[i].data.u64 == 0) {
+            uint64_t expirations;
+            ssize_t r = read(timer_fd_, &expirations, sizeof(expirations));
+            (void)r;
+            continue;
+        }
+        Input* in = find(static_cast<int>(evs[i].data.u64));
+        if (!in) continue;
+        GpioEdgeEvent edge;
+        while (in->read(edge)) {
+            in->latest = edge.rising;
+            in->latest_time = edge.time;
+            if (in->window.count() == 0) {
+                // No debouncing: every change, even within one batch
+                if (in->latest != in->stable) {
+                    in->stable = in->latest;
+                    fired.emplace_back(in->handler, GpioInputEvent{in->id, in->stable, edge.time});
+                }
+                continue;
+            }
+            in->pending = true;
+            in->deadline = now + in->window;
+        }
+    }
+
+    // Settle the windows that ran out
+    for (const auto& in : inputs_) {
+        if (!in->pending || in->deadline > now) continue;
+        in->pending = false;
+        if (in->latest == in->stable) continue;  // bounced back: a glitch
+        in->stable = in->latest;
+        fired.emplace_back(in->handler, GpioInputEvent{in->id, in->stable, in->latest_time});
+    }
+    arm_timer();
+    for (auto& f : fired) {
+        if (f.first) f.first(f.second);
+    }
+    return static_cast<int>(fired.size());
+}
+
 // Soft PWM helper
 struct SoftPwmThread {
     std::thread t;
-    std::atomic<bool> stop{false};
-    std::atomic<int> duty{0};
+    std::mutex m;
+    std::condition_variable cv;
+    bool stop{false};
+    int duty{0};
     GpioLine* line{nullptr};
     int freq{1000};
 };
@@ -78,12 +413,21 @@ struct SoftPwmThread {
 static void pwm_loop(SoftPwmThread* th) {
     using namespace std::chrono;
     const double period = 1.0 / (th->freq > 0 ? th->freq : 500);
-    while (!th->stop.load()) {
-        int d = th->duty.load();
-        double on = period * (double)d / 100.0;
-        double off = period - on;
-        if (on > 0) { th->line->set(true); std::this_thread::sleep_for(duration<double>(on)); }
-        if (off > 0) { th->line->set(false); std::this_thread::sleep_for(duration<double>(off)); }
+    std::unique_lock<std::mutex> lock(th->m);
+    while (!th->stop) {
+        const int d = th->duty;
+        if (d == 0 || d == 100) {
+            // Steady level: park until the duty changes, so a backlight
+            // that is off (or fully on) costs no wakeups
+            th->line->set(d == 100);
+            th->cv.wait(lock, [th, d] { return th->stop || th->duty != d; });
+            continue;
+        }
+        lock.unlock();
+        const double on = period * (double)d / 100.0;
+        th->line->set(true); std::this_thread::sleep_for(duration<double>(on));
+        th->line->set(false); std::this_thread::sleep_for(duration<double>(period - on));
+        lock.lock();
     }
     th->line->set(false);
 }
@@ -102,7 +446,7 @@ void SoftPwm::start(int duty_percent) {
     auto* th = new SoftPwmThread();
     th->line = &line_;
     th->freq = freq_;
-    th->duty.store(duty_);
+    th->duty = duty_;
     thread_ = th;
     running_ = true;
     th->t = std::thread(pwm_loop, th);
@@ -110,13 +454,23 @@ void SoftPwm::start(int duty_percent) {
 
 void SoftPwm::set_duty(int duty_percent) {
     duty_ = duty_percent; clamp();
-    if (thread_) static_cast<SoftPwmThread*>(thread_)->duty.store(duty_);
+    if (!thread_) return;
+    auto* th = static_cast<SoftPwmThread*>(thread_);
+    {
+        std::lock_guard<std::mutex> lock(th->m);
+        th->duty = duty_;
+    }
+    th->cv.notify_one();
 }
 
 void SoftPwm::stop() {
     if (!running_ || !thread_) return;
     auto* th = static_cast<SoftPwmThread*>(thread_);
-    th->stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(th->m);
+        th->stop = true;
+    }
+    th->cv.notify_one();
     if (th->t.joinable()) th->t.join();
     delete th;
     thread_ = nullptr;
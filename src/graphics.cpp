@@ -1,35 +1,101 @@
 #include "graphics.h"
+#include "mono_kernels.h"
 #include <algorithm>
 #include <cstdint>
 
-MonoGfx::MonoGfx(int width, int height) : w_(width), h_(height) {
+Rect Rect::united(const Rect& o) const {
+    if (o.empty()) return *this;
+    if (empty()) return o;
+    const int x0 = std::min(x, o.x);
+    const int y0 = std::min(y, o.y);
+    const int x1 = std::max(x + w, o.x + o.w);
+    const int y1 = std::max(y + h, o.y + o.h);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+Rect Rect::intersected(const Rect& o) const {
+    const int x0 = std::max(x, o.x);
+    const int y0 = std::max(y, o.y);
+    const int x1 = std::min(x + w, o.x + o.w);
+    const int y1 = std::min(y + h, o.y + o.h);
+    if (x1 <= x0 || y1 <= y0) return {};
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+Rect PixelMap::native_rect(const Rect& r) const {
+    if (r.empty()) return {};
+    const int ax = native_x(r.x, r.y);
+    const int ay = native_y(r.x, r.y);
+    const int bx = native_x(r.x + r.w - 1, r.y + r.h - 1);
+    const int by = native_y(r.x + r.w - 1, r.y + r.h - 1);
+    const int x0 = std::min(ax, bx);
+    const int y0 = std::min(ay, by);
+    return {x0, y0, std::max(ax, bx) - x0 + 1, std::max(ay, by) - y0 + 1};
+}
+
+PixelMap PixelMap::make(int native_w, int native_h, Rotation r,
+                        bool mirror_x, bool mirror_y) {
+    PixelMap m;
+    const bool swap = (r == Rotation::Deg90 || r == Rotation::Deg270);
+    const int lw = swap ? native_h : native_w;
+    const int lh = swap ? native_w : native_h;
+
+    // Rotation part (clockwise) in terms of logical x/y
+    switch (r) {
+        case Rotation::Deg0:   m = {1, 0, 0,  0, 1, 0, false}; break;
+        case Rotation::Deg90:  m = {0, -1, native_w - 1,  1, 0, 0, false}; break;
+        case Rotation::Deg180: m = {-1, 0, native_w - 1,  0, -1, native_h - 1, false}; break;
+        case Rotation::Deg270: m = {0, 1, 0,  -1, 0, native_h - 1, false}; break;
+    }
+    // Logical mirror: x -> lw-1-x, y -> lh-1-y, folded into the offsets
+    if (mirror_x) {
+        m.x0 += m.xx * (lw - 1); m.xx = -m.xx;
+        m.y0 += m.yx * (lw - 1); m.yx = -m.yx;
+    }
+    if (mirror_y) {
+        m.x0 += m.xy * (lh - 1); m.xy = -m.xy;
+        m.y0 += m.yy * (lh - 1); m.yy = -m.yy;
+    }
+    m.identity = (m.xx == 1 && m.xy == 0 && m.x0 == 0 &&
+                  m.yx == 0 && m.yy == 1 && m.y0 == 0);
+    return m;
+}
+
+MonoGfx::MonoGfx(int width, int height) : w_(width), h_(height), lw_(width), lh_(height) {
     fb_.assign(static_cast<size_t>(w_ * (h_/8)), 0x00);
 }
 
+void MonoGfx::set_orientation(Rotation r, bool mirror_x, bool mirror_y) {
+    rot_ = r;
+    const bool swap = (r == Rotation::Deg90 || r == Rotation::Deg270);
+    lw_ = swap ? h_ : w_;
+    lh_ = swap ? w_ : h_;
+    map_ = PixelMap::make(w_, h_, r, mirror_x, mirror_y);
+}
+
 void MonoGfx::clear() { std::fill(fb_.begin(), fb_.end(), 0x00); }
 
 void MonoGfx::pixel(int x, int y, bool on) {
-    if (x < 0 || y < 0 || x >= w_ || y >= h_) return;
-    int page = y / 8;
-    int bit = y % 8;
-    size_t idx = static_cast<size_t>(page * w_ + x);
-    unsigned char mask = static_cast<unsigned char>(1u << bit);
-    if (on) fb_[idx] |= mask;
-    else fb_[idx] &= static_cast<unsigned char>(~mask);
+    if (x < 0 || y < 0 || x >= lw_ || y >= lh_) return;
+    if (map_.identity) mono_set(fb_.data(), w_, x, y, on);
+    else mono_set(fb_.data(), w_, map_.native_x(x, y), map_.native_y(x, y), on);
+}
+
+void MonoGfx::fill_span(int x0, int y0, int x1, int y1, bool on) {
+    // Quarter turns and mirrors map rects to rects
+    const Rect r = Rect{x0, y0, x1 - x0 + 1, y1 - y0 + 1}.intersected(Rect{0, 0, lw_, lh_});
+    if (r.empty()) return;
+    mono_fill(fb_.data(), w_, map_.identity ? r : map_.native_rect(r), on);
 }
 
 void MonoGfx::hline(int x0, int x1, int y, bool on) {
-    if (y < 0 || y >= h_) return;
     if (x0 > x1) std::swap(x0, x1);
-    x0 = std::max(0, x0); x1 = std::min(w_-1, x1);
-    for (int x = x0; x <= x1; ++x) pixel(x, y, on);
+    fill_span(x0, y, x1, y, on);
 }
 
 void MonoGfx::vline(int x, int y0, int y1, bool on) {
-    if (x < 0 || x >= w_) return;
     if (y0 > y1) std::swap(y0, y1);
-    y0 = std::max(0, y0); y1 = std::min(h_-1, y1);
-    for (int y = y0; y <= y1; ++y) pixel(x, y, on);
+    fill_span(x, y0, x, y1, on);
 }
 
 void MonoGfx::rect(int x0, int y0, int x1, int y1, bool on) {
@@ -44,7 +110,7 @@ void MonoGfx::rect(int x0, int y0, int x1, int y1, bool on) {
 void MonoGfx::fill_rect(int x0, int y0, int x1, int y1, bool on) {
     if (x0 > x1) std::swap(x0, x1);
     if (y0 > y1) std::swap(y0, y1);
-    for (int y = y0; y <= y1; ++y) hline(x0, x1, y, on);
+    fill_span(x0, y0, x1, y1, on);
 }
 
 // 5x7 font, ASCII 32..127, column-major
@@ -75,10 +141,14 @@ static const uint8_t font5x7[96][5] = {
     {0x00,0x00,0x7F,0x00,0x00},{0x00,0x41,0x36,0x08,0x00},{0x08,0x08,0x2A,0x1C,0x08},{0x00,0x00,0x00,0x00,0x00},
 };
 
-void MonoGfx::draw_char(int x, int y, char c, bool on) {
+const uint8_t* font5x7_glyph(char c) {
     unsigned char uc = static_cast<unsigned char>(c);
     if (uc < 32 || uc > 127) uc = '?';
-    const uint8_t* g = font5x7[uc - 32];
+    return font5x7[uc - 32];
+}
+
+void MonoGfx::draw_char(int x, int y, char c, bool on) {
+    const uint8_t* g = font5x7_glyph(c);
     for (int col = 0; col < 5; ++col) {
         uint8_t bits = g[col];
         for (int row = 0; row < 7; ++row) {
@@ -92,6 +162,6 @@ void MonoGfx::text(int x, int y, const std::string& s, bool on) {
     for (char c : s) {
         draw_char(cx, y, c, on);
         cx += 6;
-        if (cx >= w_) break;
+        if (cx >= lw_) break;
     }
 }
@@ -0,0 +1,77 @@
+#include "idle_policy.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+IdlePolicy::IdlePolicy(std::chrono::milliseconds dim_after, std::chrono::milliseconds sleep_after,
+                       Change on_change)
+    : dim_after_(dim_after), sleep_after_(sleep_after), on_change_(std::move(on_change)),
+      last_activity_(Clock::now()) {
+    fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd_ < 0) throw std::runtime_error("IdlePolicy: eventfd failed");
+}
+
+IdlePolicy::~IdlePolicy() { close(fd_); }
+
+void IdlePolicy::activity() {
+    // The flag first: update() drains the fd before taking it
+    active_.store(true);
+    wake();
+}
+
+void IdlePolicy::wake() {
+    const uint64_t one = 1;
+    ssize_t r = write(fd_, &one, sizeof(one));
+    (void)r;
+}
+
+IdlePolicy::Clock::time_point IdlePolicy::next_transition() const {
+    const bool dim = dim_after_.count() > 0;
+    const bool sleep = sleep_after_.count() > 0;
+    if (state_ == IdleState::Active && dim) return last_activity_ + dim_after_;
+    if (state_ != IdleState::Asleep && sleep) return last_activity_ + std::max(sleep_after_, dim_after_);
+    return Clock::time_point::max();
+}
+
+void IdlePolicy::enter(IdleState s) {
+    const IdleState from = state_;
+    state_ = s;
+    if (on_change_) on_change_(from, s);
+}
+
+bool IdlePolicy::update() {
+    uint64_t count = 0;
+    ssize_t r = read(fd_, &count, sizeof(count));
+    (void)r;
+    const Clock::time_point now = Clock::now();
+    if (active_.exchange(false)) {
+        last_activity_ = now;
+        if (state_ != IdleState::Active) enter(IdleState::Active);
+        return true;
+    }
+    // Possibly both steps at once, e.g. after the loop was busy
+    while (next_transition() <= now) {
+        const bool to_sleep = state_ == IdleState::Dimmed || dim_after_.count() <= 0 ||
+                              (sleep_after_.count() > 0 && sleep_after_ <= dim_after_);
+        enter(to_sleep ? IdleState::Asleep : IdleState::Dimmed);
+    }
+    return false;
+}
+
+void IdlePolicy::wait(std::chrono::milliseconds timeout) {
+    const Clock::time_point due = next_transition();
+    int ms = -1;
+    if (due != Clock::time_point::max()) {
+        // Rounded up, so the transition is due when poll() returns
+        const auto left = std::chrono::ceil<std::chrono::milliseconds>(due - Clock::now());
+        ms = static_cast<int>(std::max<int64_t>(0, left.count()));
+    }
+    if (timeout.count() >= 0 && (ms < 0 || timeout.count() < ms)) ms = static_cast<int>(timeout.count());
+    pollfd p{fd_, POLLIN, 0};
+    while (poll(&p, 1, ms) < 0 && errno == EINTR) {
+    }
+}
@@ -0,0 +1,28 @@
+#include "ili9341.h"
+
+#include <iterator>
+
+namespace {
+// Default configuration, replaceable with set_init_sequence(). Power and
+// gamma are left at their reset values; modules that need tuning take a
+// script (see scripts/init).
+constexpr InitStep kConfig[] = {
+    {0x3A, 1, {0x55}, 0},  // COLMOD: 16 bit/pixel (RGB565)
+};
+}
+
+// ILI9341 datasheet: 120 ms after reset/SWRESET before Sleep Out, 5 ms after
+// Sleep Out before the next command.
+const TftController Ili9341::kController = {
+    "ILI9341",
+    240, 320,
+    2,
+    {0x48, 0x28, 0x88, 0xE8},  // MX+BGR, MV+BGR, MY+BGR, MY+MX+MV+BGR
+    kConfig, std::size(kConfig),
+    120,
+    5,
+};
+
+Ili9341::Ili9341(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width, int height,
+                 uint8_t rotation)
+    : TftPanel(kController, spi, dc, rst, width, height, rotation) {}
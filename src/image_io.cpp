@@ -0,0 +1,338 @@
+#include "image_io.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+uint32_t crc32(const uint8_t* p, size_t n, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void put_be32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void put_chunk(std::vector<uint8_t>& out, const char type[4], const std::vector<uint8_t>& data) {
+    put_be32(out, static_cast<uint32_t>(data.size()));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put_be32(out, crc32(out.data() + start, out.size() - start));
+}
+
+// zlib stream of stored deflate blocks (max 65535 bytes each)
+std::vector<uint8_t> zlib_stored(const std::vector<uint8_t>& raw) {
+    std::vector<uint8_t> z;
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    z.push_back(0x78);
+    z.push_back(0x01);
+    size_t pos = 0;
+    do {
+        const size_t n = std::min<size_t>(65535, raw.size() - pos);
+        const bool last = pos + n == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(static_cast<uint8_t>(n));
+        z.push_back(static_cast<uint8_t>(n >> 8));
+        z.push_back(static_cast<uint8_t>(~n));
+        z.push_back(static_cast<uint8_t>(~n >> 8));
+        z.insert(z.end(), raw.begin() + static_cast<std::ptrdiff_t>(pos),
+                 raw.begin() + static_cast<std::ptrdiff_t>(pos + n));
+        pos += n;
+    } while (pos < raw.size());
+
+    uint32_t a = 1, b = 0;  // Adler-32
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(z, (b << 16) | a);
+    return z;
+}
+
+void write_file(const std::string& path, const std::vector<uint8_t>& bytes, const char* what) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error(std::string("Failed to open ") + what + " file: " + path);
+    f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!f) throw std::runtime_error(std::string("Failed to write ") + what + " file: " + path);
+}
+
+// Gray expands to RGB for comparisons
+void rgb_at(const Image& img, int x, int y, int out[3]) {
+    const uint8_t* p = img.at(x, y);
+    for (int c = 0; c < 3; ++c) out[c] = p[img.channels == 3 ? c : 0];
+}
+
+int luma(const int c[3]) { return (c[0] * 299 + c[1] * 587 + c[2] * 114) / 1000; }
+
+} // namespace
+
+Image::Image(int w, int h, int ch, uint8_t fill)
+    : width(w), height(h), channels(ch),
+      pixels(static_cast<size_t>(std::max(w, 0)) * static_cast<size_t>(std::max(h, 0)) *
+                 static_cast<size_t>(ch), fill) {}
+
+bool Image::bilevel() const {
+    if (channels != 1) return false;
+    return std::all_of(pixels.begin(), pixels.end(), [](uint8_t v) { return v == 0 || v == 255; });
+}
+
+Image image_from_mono(const std::vector<uint8_t>& pages, int width, int height) {
+    if (width <= 0 || height <= 0 ||
+        pages.size() < static_cast<size_t>(width) * static_cast<size_t>((height + 7) / 8)) {
+        throw std::runtime_error("Framebuffer size mismatch");
+    }
+    Image img(width, height, 1, 255);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* page = pages.data() + static_cast<size_t>(y / 8) * static_cast<size_t>(width);
+        const uint8_t bit = static_cast<uint8_t>(1u << (y % 8));
+        uint8_t* row = img.at(0, y);
+        for (int x = 0; x < width; ++x) {
+            if (page[x] & bit) row[x] = 0;
+        }
+    }
+    return img;
+}
+
+Image image_from_mono(const MonoGfx& gfx) {
+    return image_from_mono(gfx.fb(), gfx.native_width(), gfx.native_height());
+}
+
+Image image_from_rgb666(const std::vector<uint8_t>& rgb666, int width, int height) {
+    if (width <= 0 || height <= 0 ||
+        rgb666.size() < static_cast<size_t>(width) * static_cast<size_t>(height) * 3) {
+        throw std::runtime_error("RGB666 buffer size mismatch");
+    }
+    Image img(width, height, 3);
+    for (size_t i = 0; i < img.pixels.size(); ++i) {
+        const uint8_t v = rgb666[i] & 0xFC;
+        img.pixels[i] = static_cast<uint8_t>(v | (v >> 6));
+    }
+    return img;
+}
+
+std::vector<uint8_t> encode_png(int width, int height, int channels, const uint8_t* pixels) {
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 3)) {
+        throw std::runtime_error("Invalid PNG geometry");
+    }
+
+    // Filter type 0 (None) before every row
+    const size_t stride = static_cast<size_t>(width) * static_cast<size_t>(channels);
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * static_cast<size_t>(height));
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        const uint8_t* row = pixels + stride * static_cast<size_t>(y);
+        raw.insert(raw.end(), row, row + stride);
+    }
+
+    std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, static_cast<uint32_t>(width));
+    put_be32(ihdr, static_cast<uint32_t>(height));
+    ihdr.push_back(8);                        // bit depth
+    ihdr.push_back(channels == 3 ? 2 : 0);    // color type: RGB / gray
+    ihdr.push_back(0);                        // deflate
+    ihdr.push_back(0);                        // adaptive filtering
+    ihdr.push_back(0);                        // no interlace
+    put_chunk(out, "IHDR", ihdr);
+    put_chunk(out, "IDAT", zlib_stored(raw));
+    put_chunk(out, "IEND", {});
+    return out;
+}
+
+std::vector<uint8_t> encode_png(const Image& img) {
+    return encode_png(img.width, img.height, img.channels, img.pixels.data());
+}
+
+std::vector<uint8_t> encode_pnm(const Image& img) {
+    if (img.empty() || (img.channels != 1 && img.channels != 3)) {
+        throw std::runtime_error("Invalid PNM geometry");
+    }
+    const bool bits = img.bilevel();
+    char header[48];
+    const int n = std::snprintf(header, sizeof(header), "P%c\n%d %d\n%s",
+                                bits ? '4' : (img.channels == 1 ? '5' : '6'),
+                                img.width, img.height, bits ? "" : "255\n");
+    std::vector<uint8_t> out(header, header + n);
+    if (!bits) {
+        out.insert(out.end(), img.pixels.begin(), img.pixels.end());
+        return out;
+    }
+    // P4: rows padded to whole bytes, MSB first, 1 = black
+    const size_t stride = static_cast<size_t>((img.width + 7) / 8);
+    const size_t start = out.size();
+    out.resize(start + stride * static_cast<size_t>(img.height), 0);
+    for (int y = 0; y < img.height; ++y) {
+        uint8_t* row = out.data() + start + stride * static_cast<size_t>(y);
+        const uint8_t* src = img.at(0, y);
+        for (int x = 0; x < img.width; ++x) {
+            if (src[x] == 0) row[x / 8] |= static_cast<uint8_t>(0x80u >> (x % 8));
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> encode_pbm(const std::vector<uint8_t>& pages, int width, int height) {
+    return encode_pnm(image_from_mono(pages, width, height));
+}
+
+Image decode_pnm(const std::vector<uint8_t>& data) {
+    size_t pos = 0;
+    // Whitespace-separated header fields; '#' starts a comment
+    auto field = [&]() -> long {
+        while (pos < data.size()) {
+            if (data[pos] == '#') {
+                while (pos < data.size() && data[pos] != '\n') ++pos;
+            } else if (std::isspace(data[pos])) {
+                ++pos;
+            } else {
+                break;
+            }
+        }
+        long v = 0;
+        size_t digits = 0;
+        while (pos < data.size() && data[pos] >= '0' && data[pos] <= '9' && digits < 9) {
+            v = v * 10 + (data[pos++] - '0');
+            ++digits;
+        }
+        if (digits == 0) throw std::runtime_error("Malformed PNM header");
+        return v;
+    };
+
+    if (data.size() < 2 || data[0] != 'P' || data[1] < '4' || data[1] > '6') {
+        throw std::runtime_error("Not a binary PNM image");
+    }
+    const char kind = static_cast<char>(data[1]);
+    pos = 2;
+    const long w = field();
+    const long h = field();
+    const long maxval = (kind == '4') ? 1 : field();
+    if (w <= 0 || h <= 0 || w > 65535 || h > 65535 || maxval != (kind == '4' ? 1 : 255)) {
+        throw std::runtime_error("Unsupported PNM geometry");
+    }
+    ++pos;  // single whitespace before the raster
+
+    Image img(static_cast<int>(w), static_cast<int>(h), kind == '6' ? 3 : 1);
+    if (kind == '4') {
+        const size_t stride = static_cast<size_t>((w + 7) / 8);
+        if (data.size() < pos + stride * static_cast<size_t>(h)) {
+            throw std::runtime_error("Truncated PNM image");
+        }
+        for (int y = 0; y < img.height; ++y) {
+            const uint8_t* row = data.data() + pos + stride * static_cast<size_t>(y);
+            uint8_t* dst = img.at(0, y);
+            for (int x = 0; x < img.width; ++x) {
+                dst[x] = (row[x / 8] & (0x80u >> (x % 8))) ? 0 : 255;
+            }
+        }
+        return img;
+    }
+    if (data.size() < pos + img.pixels.size()) throw std::runtime_error("Truncated PNM image");
+    std::memcpy(img.pixels.data(), data.data() + pos, img.pixels.size());
+    return img;
+}
+
+void write_png(const std::string& path, int width, int height, int channels,
+               const uint8_t* pixels) {
+    write_file(path, encode_png(width, height, channels, pixels), "PNG");
+}
+
+void write_png(const std::string& path, const Image& img) {
+    write_file(path, encode_png(img), "PNG");
+}
+
+void write_pnm(const std::string& path, const Image& img) {
+    write_file(path, encode_pnm(img), "PNM");
+}
+
+void write_pbm(const std::string& path, const std::vector<uint8_t>& pages, int width, int height) {
+    write_file(path, encode_pbm(pages, width, height), "PNM");
+}
+
+Image read_pnm(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("Failed to open PNM file: " + path);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    return decode_pnm(data);
+}
+
+std::string ImageDiff::summary() const {
+    if (size_mismatch) return "image size differs";
+    if (differing == 0) return "identical";
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "%llu of %llu pixels differ (max delta %d) in %dx%d at (%d,%d)",
+                  static_cast<unsigned long long>(differing), static_cast<unsigned long long>(pixels),
+                  max_delta, bounds.w, bounds.h, bounds.x, bounds.y);
+    return buf;
+}
+
+ImageDiff compare_images(const Image& expected, const Image& actual, int tolerance) {
+    ImageDiff d;
+    if (expected.width != actual.width || expected.height != actual.height) {
+        d.size_mismatch = true;
+        return d;
+    }
+    d.pixels = static_cast<uint64_t>(expected.width) * static_cast<uint64_t>(expected.height);
+    int e[3], a[3];
+    for (int y = 0; y < expected.height; ++y) {
+        for (int x = 0; x < expected.width; ++x) {
+            rgb_at(expected, x, y, e);
+            rgb_at(actual, x, y, a);
+            int delta = 0;
+            for (int c = 0; c < 3; ++c) delta = std::max(delta, std::abs(e[c] - a[c]));
+            if (delta <= tolerance) continue;
+            ++d.differing;
+            d.max_delta = std::max(d.max_delta, delta);
+            d.bounds = d.bounds.united(Rect{x, y, 1, 1});
+        }
+    }
+    return d;
+}
+
+Image diff_image(const Image& expected, const Image& actual, int tolerance) {
+    Image out(expected.width, expected.height, 3);
+    const bool comparable = expected.width == actual.width && expected.height == actual.height;
+    int e[3], a[3];
+    for (int y = 0; y < expected.height; ++y) {
+        for (int x = 0; x < expected.width; ++x) {
+            rgb_at(expected, x, y, e);
+            uint8_t* px = out.at(x, y);
+            int delta = 0;
+            if (comparable) {
+                rgb_at(actual, x, y, a);
+                for (int c = 0; c < 3; ++c) delta = std::max(delta, std::abs(e[c] - a[c]));
+            }
+            if (delta <= tolerance) {
+                // Faded towards white so the marks stand out
+                for (int c = 0; c < 3; ++c) px[c] = static_cast<uint8_t>(192 + e[c] / 4);
+                continue;
+            }
+            const int le = luma(e), la = luma(a);
+            px[0] = la <= le ? 255 : 0;
+            px[1] = 0;
+            px[2] = la >= le ? 255 : 0;
+        }
+    }
+    return out;
+}
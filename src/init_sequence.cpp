@@ -0,0 +1,133 @@
+#include "init_sequence.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+void CommandPacer::delay(std::chrono::milliseconds d) {
+    const Clock::time_point t = Clock::now() + d;
+    if (!pending_ || t > ready_at_) ready_at_ = t;
+    pending_ = true;
+}
+
+void CommandPacer::wait() {
+    if (!pending_) return;
+    std::this_thread::sleep_until(ready_at_);
+    pending_ = false;
+}
+
+size_t run_init_steps(const InitStep* steps, size_t count, ParamPath path,
+                      CommandPacer& pacer, const BusWrite& write) {
+    // Pending run of bytes at one D/C level
+    uint8_t run[256];
+    size_t len = 0;
+    bool level = false;
+    size_t writes = 0;
+
+    auto flush = [&]() {
+        if (len == 0) return;
+        pacer.wait();
+        write(level, run, len);
+        ++writes;
+        len = 0;
+    };
+    auto put = [&](bool dc, const uint8_t* p, size_t n) {
+        if (n == 0) return;
+        if (len && (dc != level || len + n > sizeof(run))) flush();
+        level = dc;
+        for (size_t i = 0; i < n; ++i) run[len++] = p[i];
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        const InitStep& s = steps[i];
+        put(false, &s.cmd, 1);
+        put(path == ParamPath::Data, s.params, s.n);
+        if (s.delay_ms) {
+            flush();
+            pacer.delay(std::chrono::milliseconds(s.delay_ms));
+        }
+    }
+    flush();
+    return writes;
+}
+
+std::vector<InitStep> resend_steps(const std::vector<InitStep>& steps, uint8_t reset_cmd,
+                                   bool keep_delays) {
+    std::vector<InitStep> out;
+    out.reserve(steps.size());
+    for (const InitStep& s : steps) {
+        if (s.cmd == reset_cmd) continue;
+        out.push_back(s);
+        if (!keep_delays) out.back().delay_ms = 0;
+    }
+    return out;
+}
+
+std::vector<InitStep> parse_init_script(const std::string& text) {
+    std::vector<InitStep> steps;
+    std::istringstream in(text);
+    std::string line;
+    int line_no = 0;
+
+    auto fail = [&](const std::string& why) {
+        return std::runtime_error("Init script line " + std::to_string(line_no) + ": " + why);
+    };
+    auto parse_byte = [&](const std::string& tok) {
+        size_t used = 0;
+        unsigned long v = 0;
+        try {
+            v = std::stoul(tok, &used, 16);
+        } catch (const std::exception&) {
+            throw fail("bad byte '" + tok + "'");
+        }
+        if (used != tok.size() || v > 0xFF) throw fail("bad byte '" + tok + "'");
+        return static_cast<uint8_t>(v);
+    };
+
+    while (std::getline(in, line)) {
+        ++line_no;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream words(line);
+        std::string tok;
+        InitStep step{};
+        bool have_cmd = false;
+        while (words >> tok) {
+            if (tok == "delay") {
+                std::string ms;
+                if (!have_cmd || !(words >> ms)) throw fail("delay needs a command and a value");
+                size_t used = 0;
+                unsigned long v = 0;
+                try {
+                    v = std::stoul(ms, &used, 10);
+                } catch (const std::exception&) {
+                    throw fail("bad delay '" + ms + "'");
+                }
+                if (used != ms.size() || v > 0xFFFF) throw fail("bad delay '" + ms + "'");
+                step.delay_ms = static_cast<uint16_t>(v);
+                if (words >> tok) throw fail("unexpected '" + tok + "' after delay");
+                break;
+            }
+            const uint8_t b = parse_byte(tok);
+            if (!have_cmd) {
+                step.cmd = b;
+                have_cmd = true;
+            } else {
+                if (step.n == InitStep::kMaxParams) throw fail("too many parameters");
+                step.params[step.n++] = b;
+            }
+        }
+        if (have_cmd) steps.push_back(step);
+    }
+    return steps;
+}
+
+std::vector<InitStep> load_init_script(const std::string& path) {
+    std::ifstream f(path);
+    if (!f) throw std::runtime_error("Failed to open init script: " + path);
+    std::ostringstream text;
+    text << f.rdbuf();
+    return parse_init_script(text.str());
+}
@@ -0,0 +1,126 @@
+// Display server: owns the panel's SPI device and GPIO lines and composes
+// the surfaces of its clients (see display_server.h) onto it.
+
+#include "display_server.h"
+#include "gpio_gpiod.h"
+#include "ili9341.h"
+#include "ili9488.h"
+#include "init_sequence.h"
+#include "spi_linux.h"
+#include "st7565.h"
+#include "st7789.h"
+#include "tft_presenter.h"
+
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+
+static const char* argval(int argc, char** argv, const char* key, const char* defv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == key && i + 1 < argc) return argv[i + 1];
+    }
+    return defv;
+}
+
+static int argint(int argc, char** argv, const char* key, int defv) {
+    const char* v = argval(argc, argv, key, nullptr);
+    return v ? std::stoi(v) : defv;
+}
+
+static DisplayServer* g_server = nullptr;
+static void on_signal(int) {
+    if (g_server) g_server->stop();
+}
+
+static const TftController* tft_controller(const std::string& model) {
+    if (model == "ili9488" || model == "msp3520") return &Ili9488::kController;
+    if (model == "st7789") return &St7789::kController;
+    if (model == "ili9341") return &Ili9341::kController;
+    return nullptr;
+}
+
+static std::unique_ptr<TftPanel> make_tft(const TftController* ctl, SpiLinux& spi, GpioLine& dc,
+                                          GpioLine& rst, int width, int height, uint8_t rotation) {
+    if (ctl == &Ili9488::kController) return std::make_unique<Ili9488>(spi, dc, rst, width, height, rotation);
+    if (ctl == &St7789::kController) return std::make_unique<St7789>(spi, dc, rst, width, height, rotation);
+    return std::make_unique<Ili9341>(spi, dc, rst, width, height, rotation);
+}
+
+static void serve(DisplayServer& server, const std::string& socket_path) {
+    g_server = &server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cout << "Serving " << server.width() << "x" << server.height() << " on " << socket_path << "\n";
+    server.run();
+    g_server = nullptr;
+}
+
+int main(int argc, char** argv) {
+    const std::string socket_path = argval(argc, argv, "--socket", "/run/lcd_display.sock");
+    const std::string dev = argval(argc, argv, "--spidev", "/dev/spidev1.0");
+    const std::string chip = argval(argc, argv, "--chip", "/dev/gpiochip0");
+    const std::string model = argval(argc, argv, "--model", "st7565");
+    const std::string init_script = argval(argc, argv, "--init-script", "");
+    const int dc = argint(argc, argv, "--dc", 271);
+    const int rst = argint(argc, argv, "--rst", 256);
+
+    const TftController* tft = tft_controller(model);
+    if (!tft && model != "st7565") {
+        std::cerr << "Unknown model: " << model << "\n";
+        std::cerr << "Supported models: st7565, ili9488 (alias: msp3520), st7789, ili9341\n";
+        return 1;
+    }
+    const int spi_hz = argint(argc, argv, "--spi-hz", tft ? 32000000 : 8000000);
+
+    try {
+        SpiLinux spi(dev);
+        spi.open(static_cast<uint32_t>(spi_hz), 0);
+        // D/C and RST in one request: one chip handle, one line handle
+        GpioBulk pins({dc, rst}, {false, true}, chip, "displayd");
+        GpioLine& dcLine = pins.line(0);
+        GpioLine& rstLine = pins.line(1);
+        std::vector<InitStep> custom_init;
+        if (!init_script.empty()) custom_init = load_init_script(init_script);
+
+        if (tft) {
+            // Same default orientation as lcd_demo: ILI9488 landscape, the
+            // 240x320 modules portrait
+            const bool ili9488 = tft == &Ili9488::kController;
+            const uint8_t rotation = ili9488 ? 3 : 0;
+            const int width = ili9488 ? tft->gram_height : tft->gram_width;
+            const int height = ili9488 ? tft->gram_width : tft->gram_height;
+            std::unique_ptr<TftPanel> lcd = make_tft(tft, spi, dcLine, rstLine, width, height, rotation);
+            if (!custom_init.empty()) lcd->set_init_sequence(custom_init);
+            lcd->reset();
+            lcd->init(false);
+            lcd->fill(0x0000);
+            lcd->display_on(true);
+
+            // Only the damaged rect goes over SPI
+            TftPresenter presenter(*lcd);
+            DisplayServer server(socket_path, width, height,
+                                 [&](const std::vector<unsigned char>& fb, const Rect& r) {
+                                     presenter.present_region(fb, r);
+                                 });
+            serve(server, socket_path);
+            return 0;
+        }
+
+        St7565 lcd(spi, dcLine, rstLine);
+        if (!custom_init.empty()) lcd.set_init_sequence(custom_init);
+        lcd.reset();
+        lcd.init(true);
+        lcd.clear();
+        // A whole ST7565 frame is 1 KB; sent in full on every damage
+        DisplayServer server(socket_path, 128, 64,
+                             [&](const std::vector<unsigned char>& fb, const Rect&) {
+                                 lcd.set_framebuffer(fb);
+                             });
+        serve(server, socket_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "bus_recorder.h"
+#include "image_io.h"
+#include "panel_sim.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Offline replay of a BusRecorder dump: feeds the captured SPI and D/C
+// stream into a panel model, writes the frames as PNG and prints timing.
+
+static const char* argval(int argc, char** argv, const char* key, const char* defv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == key && i + 1 < argc) return argv[i + 1];
+    }
+    return defv;
+}
+
+static bool hasflag(int argc, char** argv, const char* key) {
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == key) return true;
+    }
+    return false;
+}
+
+static void usage() {
+    std::cerr << "Usage: lcd_replay <dump> [--model st7565|ili9488] [--out <dir>] [--every <n>] [--no-png]\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage();
+        return 1;
+    }
+    const std::string path = argv[1];
+    const std::string model = argval(argc, argv, "--model", "st7565");
+    const std::string out_dir = argval(argc, argv, "--out", ".");
+    const long every = std::max(1L, std::stol(argval(argc, argv, "--every", "1")));
+    const bool write_frames = !hasflag(argc, argv, "--no-png");
+
+    std::unique_ptr<PanelSim> sim;
+    if (model == "st7565") {
+        sim = std::make_unique<St7565Sim>();
+    } else if (model == "ili9488" || model == "msp3520") {
+        sim = std::make_unique<Ili9488Sim>();
+    } else {
+        std::cerr << "Unknown model: " << model << "\n";
+        usage();
+        return 1;
+    }
+
+    try {
+        const std::vector<BusEvent> events = BusRecorder::load(path);
+        std::vector<uint8_t> rgb;
+        uint64_t written = 0;
+
+        const ReplayStats st = replay_bus(events, *sim, [&](uint64_t index, uint64_t) {
+            if (!write_frames || index % static_cast<uint64_t>(every) != 0) return;
+            sim->render_rgb(rgb);
+            char name[64];
+            std::snprintf(name, sizeof(name), "/frame_%05llu.png", static_cast<unsigned long long>(index));
+            write_png(out_dir + name, sim->width(), sim->height(), 3, rgb.data());
+            ++written;
+        });
+
+        std::printf("events:          %llu\n", static_cast<unsigned long long>(st.events));
+        std::printf("duration:        %.1f ms\n", st.duration_ms);
+        std::printf("spi writes:      %llu (%llu bytes, %.0f kbit/s average)\n",
+                    static_cast<unsigned long long>(st.spi_writes),
+                    static_cast<unsigned long long>(st.spi_bytes), st.throughput_kbps());
+        std::printf("dc toggles:      %llu\n", static_cast<unsigned long long>(st.dc_toggles));
+        std::printf("resets:          %llu\n", static_cast<unsigned long long>(st.resets));
+        std::printf("frames:          %llu (%llu written)\n",
+                    static_cast<unsigned long long>(st.frames), static_cast<unsigned long long>(written));
+        if (st.frames > 1) {
+            std::printf("frame interval:  min %.2f / avg %.2f / max %.2f ms (%.1f fps)\n",
+                        st.frame_interval_min_ms, st.frame_interval_avg_ms,
+                        st.frame_interval_max_ms, st.fps());
+        }
+        if (st.frames > 0) {
+            std::printf("frame write:     avg %.2f / max %.2f ms\n",
+                        st.frame_write_avg_ms, st.frame_write_max_ms);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
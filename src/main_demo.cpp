@@ -1,13 +1,33 @@
+#include "animation.h"
+#include "bus_recorder.h"
 #include "four_line_display.h"
+#include "frame_scheduler.h"
 #include "gpio_gpiod.h"
+#include "idle_policy.h"
+#include "ili9341.h"
 #include "ili9488.h"
+#include "panel_watchdog.h"
 #include "spi_linux.h"
 #include "st7565.h"
+#include "st7789.h"
+#include "startup_trace.h"
+#include "tft_presenter.h"
+#include "xpt2046.h"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
-#include <thread>
+#include <vector>
 
 static const char* argval(int argc, char** argv, const char* key, const char* defv) {
     for (int i = 1; i < argc; i++) {
@@ -21,52 +41,380 @@ static int argint(int argc, char** argv, const char* key, int defv) {
     return v ? std::stoi(v) : defv;
 }
 
-static bool is_ili9488_model(const std::string& model) {
-    return model == "ili9488" || model == "msp3520";
+// --idle: SIGUSR2 (kill -USR2 <pid>) stands for new content to show
+static IdlePolicy* g_idle = nullptr;
+static void on_sigusr2(int) {
+    if (g_idle) g_idle->activity();
+}
+
+// --record: keep the recent bus traffic in memory, dump it on SIGUSR1.
+// The demo loop dumps between frames; while idle, wake() gets it out of
+// wait() for that without waking the panel.
+static std::atomic<bool> g_dump_requested{false};
+static const BusRecorder* g_recorder = nullptr;
+static std::string g_record_path;
+static void on_sigusr1(int) {
+    g_dump_requested.store(true);
+    if (g_idle) g_idle->wake();
+}
+
+static void dump_if_requested() {
+    if (!g_recorder || !g_dump_requested.exchange(false)) return;
+    try {
+        g_recorder->dump(g_record_path);
+        std::cerr << "Bus capture written to " << g_record_path << " (" << g_recorder->records()
+                  << " records)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Bus capture failed: " << e.what() << "\n";
+    }
+}
+
+// --fast-resume: a marker in /run (tmpfs, cleared on reboot) says the panel
+// was configured with this rotation since boot, so reset and SWRESET can
+// be skipped.
+static std::string resume_marker(const std::string& model) {
+    return "/run/lcd_demo." + model + ".ready";
+}
+
+static bool panel_configured(const std::string& model, int rotate_steps) {
+    std::ifstream f(resume_marker(model));
+    int steps = -1;
+    return f && (f >> steps) && steps == rotate_steps;
+}
+
+static void mark_panel_configured(const std::string& model, int rotate_steps) {
+    std::ofstream f(resume_marker(model), std::ios::trunc);
+    if (f) f << rotate_steps << "\n";  // best effort: /run may not be writable
+}
+
+// Flush wrapper for the first frame: waits for the panel bring-up thread
+// (rethrowing its errors), writes the frame while the panel is still dark,
+// turns it on and prints the startup timeline.
+template <class Write, class TurnOn>
+static auto first_frame_gate(std::future<void>& bring_up, StartupTrace& trace,
+                             Write write, TurnOn turn_on) {
+    return [&bring_up, &trace, write, turn_on, lit = false](const std::vector<unsigned char>& fb,
+                                                             const std::vector<Rect>& dirty) mutable {
+        if (!lit) bring_up.get();
+        write(fb, dirty);
+        if (lit) return;
+        turn_on();
+        lit = true;
+        trace.mark("first frame on glass");
+        trace.print(std::cout);
+    };
+}
+
+struct DemoText {
+    std::string status;
+    std::string counter;  // prefix, the count is appended
+    std::string name;
+    std::string version;
+};
+
+// Paced demo loop. Text is re-rendered only when the counter changes
+// (every 500 ms of frame time); in between only marquee windows and the
+// blink indicator are redrawn, and frames where nothing changed are not
+// flushed at all. flush(fb, dirty) gets the changed areas in native
+// coordinates. maintain() runs after every frame, e.g. the panel
+// watchdog, which must not interleave with a flush.
+//
+// With an idle policy the counter counts updates (its activity) instead,
+// and once dimmed or asleep the loop renders nothing and blocks until the
+// next update.
+template <class Flush, class Maintain>
+static void run_demo(FourLineDisplay& display, int width, int height, double fps,
+                     const DemoText& text, Flush flush, Maintain maintain, IdlePolicy* idle) {
+    // Names that do not fit scroll instead of being cut off
+    display.set_marquee(0, true);
+    display.set_marquee(2, true);
+    display.set_marquee(3, true);
+    display.puts(0, text.status);
+    display.puts(2, text.name);
+    display.puts(3, text.version);
+
+    MonoGfx screen(width, height);
+    screen.set_orientation(display.get_rotation());
+    const PixelMap& map = screen.pixel_map();
+    std::vector<Rect> dirty;  // native, reused every frame
+    const auto add_dirty = [&](const std::vector<Rect>& rects) {
+        for (const Rect& r : rects) dirty.push_back(map.native_rect(r));
+    };
+
+    const int dot = std::max(4, display.get_layout_height() / 16);
+    MonoSprite dot_sprite(dot, dot);
+    for (int y = 0; y < dot; ++y)
+        for (int x = 0; x < dot; ++x) dot_sprite.set(x, y, true);
+
+    Animator animator;
+    animator.emplace<BlinkAnimation>(std::move(dot_sprite),
+                                     display.get_layout_width() - dot - 1, 1, 1.0);
+
+    // The counter line is formatted into one buffer, no temporaries
+    std::string counter_line;
+    counter_line.reserve(text.counter.size() + 16);
+
+    FrameScheduler scheduler(fps);
+    int counter = -1;
+    int updates = 0;
+    while (true) {
+        while (idle && idle->state() != IdleState::Active) {
+            idle->wait();
+            if (idle->update()) ++updates;
+            dump_if_requested();
+        }
+        // Periods spent blocked are skipped, not rendered
+        const FrameTick tick = scheduler.wait_next();
+        if (idle && idle->update()) ++updates;
+
+        dirty.clear();
+        const int count = idle ? updates : static_cast<int>(tick.time / 0.5);
+        if (count != counter) {
+            counter = count;
+            char digits[16];
+            const std::to_chars_result n = std::to_chars(digits, digits + sizeof(digits), counter);
+            counter_line.assign(text.counter).append(digits, n.ptr);
+            display.puts(1, counter_line);
+            screen.fb() = display.render();
+            add_dirty(display.get_dirty_rects());
+            animator.invalidate();
+        } else if (display.tick(tick.time)) {
+            screen.fb() = display.get_framebuffer();
+            add_dirty(display.get_dirty_rects());
+            animator.invalidate();
+        }
+        add_dirty(animator.tick(tick.time, screen));
+        if (!dirty.empty()) flush(screen.fb(), dirty);
+        maintain();
+        dump_if_requested();
+
+        scheduler.end_frame();
+    }
+}
+
+// SPI TFT models; nullptr for the ST7565
+static const TftController* tft_controller(const std::string& model) {
+    if (model == "ili9488" || model == "msp3520") return &Ili9488::kController;
+    if (model == "st7789") return &St7789::kController;
+    if (model == "ili9341") return &Ili9341::kController;
+    return nullptr;
+}
+
+static std::unique_ptr<TftPanel> make_tft(const TftController* ctl, SpiLinux& spi, GpioLine& dc,
+                                          GpioLine& rst, int width, int height, uint8_t rotation) {
+    if (ctl == &Ili9488::kController) return std::make_unique<Ili9488>(spi, dc, rst, width, height, rotation);
+    if (ctl == &St7789::kController) return std::make_unique<St7789>(spi, dc, rst, width, height, rotation);
+    return std::make_unique<Ili9341>(spi, dc, rst, width, height, rotation);
+}
+
+// Where RDDST reads back, a healthy panel costs one status read per
+// period; a write-only bus gets its registers re-sent every period and
+// the frame repainted every 30th
+static std::unique_ptr<PanelWatchdog> tft_watchdog(TftPanel& lcd, int period_ms, bool readable) {
+    PanelWatchdog::Check check;
+    if (readable) check = [&lcd] { return lcd.check_health(); };
+    return std::make_unique<PanelWatchdog>(std::chrono::milliseconds(period_ms), check,
+                                           [&lcd] { lcd.reassert(); }, [&lcd] { lcd.restore(); },
+                                           readable ? 0 : 30);
+}
+
+static void report_health(PanelHealth h) {
+    if (h == PanelHealth::Registers) std::cerr << "Panel settings were off; re-sent\n";
+    if (h == PanelHealth::Lost) std::cerr << "Panel was reset; restored\n";
 }
 
 int main(int argc, char** argv) {
+    StartupTrace trace;
     std::string dev = argval(argc, argv, "--spidev", "/dev/spidev1.0");
     std::string chip = argval(argc, argv, "--chip", "/dev/gpiochip0");
     std::string model = argval(argc, argv, "--model", "st7565");
 
     int dc = argint(argc, argv, "--dc", 271);
     int rst = argint(argc, argv, "--rst", 256);
+    const int te = argint(argc, argv, "--te", -1);  // TFT TE output, optional
+    const int touch_irq = argint(argc, argv, "--touch", -1);  // XPT2046 PENIRQ, optional
+    const std::string touch_dev = argval(argc, argv, "--touch-spidev", "/dev/spidev1.1");
+    const std::string touch_cal = argval(argc, argv, "--touch-cal", "200,3900,200,3900");
+    // Panel health check period; 0 turns the watchdog off
+    const int watchdog_ms = argint(argc, argv, "--watchdog", 1000);
+    // Seconds without an update before dimming; asleep at twice that
+    const int idle_s = argint(argc, argv, "--idle", 0);
+    const int backlight = argint(argc, argv, "--backlight", -1);  // PWM backlight line, optional
+
+    // Clockwise panel rotation in degrees. Done by the controller where it
+    // can (ILI9488 MADCTL, ST7565 SEG/COM flip for 180), otherwise while
+    // rasterizing.
+    const int rotate_steps = ((argint(argc, argv, "--rotate", 0) / 90) % 4 + 4) % 4;
 
-    const bool use_ili9488 = is_ili9488_model(model);
-    int spi_hz = argint(argc, argv, "--spi-hz", use_ili9488 ? 32000000 : 8000000);
+    const TftController* tft = tft_controller(model);
+    int spi_hz = argint(argc, argv, "--spi-hz", tft ? 32000000 : 8000000);
 
     // The other suggested option is: "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf"
     std::string font = argval(argc, argv, "--font", "/usr/share/fonts/truetype/ubuntu/UbuntuMono-B.ttf");
 
-    const int width = use_ili9488 ? 480 : 128;
-    const int height = use_ili9488 ? 320 : 64;
-    const int small_font = use_ili9488 ? 40 : 12;
-    const int large_font = use_ili9488 ? 80 : 28;
+    // TFT MADCTL rotation: the ILI9488 module is landscape by default
+    // (rotation 3), the 240x320 ones portrait. Odd rotations swap the GRAM
+    // geometry.
+    const bool ili9488 = tft == &Ili9488::kController;
+    const uint8_t tft_rotation = static_cast<uint8_t>(((ili9488 ? 3 : 0) + rotate_steps) % 4);
+    const bool tft_swapped = (tft_rotation % 2) != 0;
+    const int width = tft ? (tft_swapped ? tft->gram_height : tft->gram_width) : 128;
+    const int height = tft ? (tft_swapped ? tft->gram_width : tft->gram_height) : 64;
+    const int small_font = tft ? (ili9488 ? 40 : 24) : 12;
+    const int large_font = tft ? (ili9488 ? 80 : 48) : 28;
+
+    const std::string record_path = argval(argc, argv, "--record", "");
+    const std::string init_script = argval(argc, argv, "--init-script", "");
+    bool fast_resume = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--fast-resume") fast_resume = true;
+    }
 
     try {
         SpiLinux spi(dev);
         spi.open(static_cast<uint32_t>(spi_hz), 0);
 
-        GpioLine dcLine(dc, true, false, chip, "demo-dc");
-        GpioLine rstLine(rst, true, true, chip, "demo-rst");
+        // D/C and RST in one request: one chip handle, one line handle
+        GpioBulk pins({dc, rst}, {false, true}, chip, "demo");
+        GpioLine& dcLine = pins.line(0);
+        GpioLine& rstLine = pins.line(1);
+        trace.mark("spi and gpio open");
+
+        std::unique_ptr<BusRecorder> recorder;
+        if (!record_path.empty()) {
+            recorder = std::make_unique<BusRecorder>();
+            spi.set_recorder(recorder.get());
+            dcLine.set_recorder(recorder.get(), BusChannel::Dc);
+            rstLine.set_recorder(recorder.get(), BusChannel::Reset);
+            g_recorder = recorder.get();
+            g_record_path = record_path;
+            std::signal(SIGUSR1, on_sigusr1);
+        }
+
+        // --backlight: software PWM, parked (no wakeups) while fully on or off
+        std::unique_ptr<GpioLine> blLine;
+        std::unique_ptr<SoftPwm> blPwm;
+        if (backlight >= 0) {
+            blLine = std::make_unique<GpioLine>(backlight, true, true, chip, "demo-bl");
+            blPwm = std::make_unique<SoftPwm>(*blLine, 200);
+            blPwm->start(100);
+        }
+
+        // --idle: dimmed after idle_s without an update, panel asleep after
+        // 2 * idle_s; `sleep` puts the panel in and out of its sleep mode
+        std::function<void(bool)> sleep;
+        std::unique_ptr<IdlePolicy> idle;
+        if (idle_s > 0) {
+            idle = std::make_unique<IdlePolicy>(
+                std::chrono::seconds(idle_s), std::chrono::seconds(2 * idle_s),
+                [&](IdleState from, IdleState to) {
+                    if (blPwm) blPwm->set_duty(to == IdleState::Active ? 100 : to == IdleState::Dimmed ? 20 : 0);
+                    if (sleep && to == IdleState::Asleep) sleep(true);
+                    if (sleep && from == IdleState::Asleep) sleep(false);
+                });
+            g_idle = idle.get();
+            std::signal(SIGUSR2, on_sigusr2);
+        }
+
+        const bool resume = fast_resume && panel_configured(model, rotate_steps);
+        std::vector<InitStep> custom_init;
+        if (!init_script.empty()) custom_init = load_init_script(init_script);
+
+        if (tft) {
+            // Panel bring-up (reset and controller delays, ~130 ms) runs on
+            // its own thread while the fonts load and the first frame is
+            // rasterized; the first flush joins it.
+            std::unique_ptr<TftPanel> lcd_ptr =
+                make_tft(tft, spi, dcLine, rstLine, width, height, tft_rotation);
+            TftPanel& lcd = *lcd_ptr;
+            if (!custom_init.empty()) lcd.set_init_sequence(custom_init);
+            sleep = [&lcd](bool on) { lcd.sleep(on); };
+
+            // Expands band N + 1 while band N is on the wire
+            TftPresenter presenter(lcd);
+
+            // --te: writes follow the panel's TE output; without a usable
+            // line the frames simply go out unsynchronized
+            std::unique_ptr<GpioLine> teLine;
+            std::unique_ptr<GpioVsync> vsync;
+            if (te >= 0) {
+                try {
+                    teLine = std::make_unique<GpioLine>(te, GpioEdge::Rising, chip, "demo-te");
+                    vsync = std::make_unique<GpioVsync>(*teLine);
+                } catch (const std::exception& e) {
+                    std::cerr << "TE line unavailable, not synchronizing: " << e.what() << "\n";
+                }
+            }
+
+            // --touch: XPT2046 on its own chip select of the same bus;
+            // touches are printed
+            std::unique_ptr<SpiLinux> touchSpi;
+            std::unique_ptr<GpioLine> penirq;
+            std::unique_ptr<Xpt2046> touch;
+            if (touch_irq >= 0) {
+                try {
+                    touchSpi = std::make_unique<SpiLinux>(touch_dev);
+                    touchSpi->open(Xpt2046::kMaxSpiHz, 0);
+                    penirq = std::make_unique<GpioLine>(touch_irq, GpioEdge::Falling, chip, "demo-touch");
+                    touch = std::make_unique<Xpt2046>(*touchSpi, penirq.get());
+                    // Raw plate range in portrait (rotation 0) terms
+                    int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+                    if (std::sscanf(touch_cal.c_str(), "%d,%d,%d,%d", &x0, &x1, &y0, &y1) != 4) {
+                        throw std::runtime_error("--touch-cal wants x0,x1,y0,y1");
+                    }
+                    touch->set_calibration(
+                        TouchCalibration::from_range(x0, x1, y0, y1, tft->gram_width, tft->gram_height)
+                            .rotated(*tft, 0, tft_rotation));
+                    // A reading waits behind at most 2 ms of frame data
+                    spi.set_max_transfer(std::min(
+                        spi.max_transfer(),
+                        Xpt2046::max_shared_message(static_cast<uint32_t>(spi_hz), std::chrono::microseconds(2000))));
+                    touch->start([&idle](const TouchEvent& e) {
+                        if (idle) idle->activity();
+                        static const char* const kActions[] = {"down", "move", "up"};
+                        std::printf("touch %s %d,%d\n", kActions[static_cast<int>(e.action)], e.pos.x, e.pos.y);
+                    });
+                } catch (const std::exception& e) {
+                    touch.reset();
+                    std::cerr << "Touch unavailable: " << e.what() << "\n";
+                }
+            }
+
+            bool status_readable = false;  // set by bring-up
+            std::unique_ptr<PanelWatchdog> watchdog;
 
-        if (use_ili9488) {
-            Ili9488 lcd(spi, dcLine, rstLine, width, height);
-            lcd.reset();
-            lcd.init();
-            // lcd.fill(0xF800);  // Red screen - should appear immediately
-            std::this_thread::sleep_for(std::chrono::milliseconds(2000));  // Wait 2 sec to see it
-            //lcd.fill(0x0000);
+            std::future<void> bring_up = std::async(std::launch::async, [&] {
+                if (!resume) lcd.reset();
+                if (resume) {
+                    lcd.resume(false);
+                } else {
+                    lcd.init(false);
+                }
+                if (vsync) presenter.set_vsync(vsync.get());  // TEON
+                lcd.wait_ready();
+                // A freshly configured panel reads back healthy, unless
+                // its SDO is not wired
+                if (watchdog_ms > 0) {
+                    try {
+                        status_readable = lcd.check_health() == PanelHealth::Ok;
+                    } catch (const std::exception&) {
+                        status_readable = false;
+                    }
+                }
+                mark_panel_configured(model, rotate_steps);
+                trace.mark(resume ? "panel resumed" : "panel reset and configured");
+            });
 
             FourLineDisplay display(width, height, small_font, large_font);
+            display.set_render_threads(0); // large glyphs: rasterize lines on all cores
             if (!display.initialize(font)) {
                 std::cerr << "Failed to initialize FourLineDisplay library\n";
                 std::cerr << "  - Verify font exists: " << font << "\n";
                 return 1;
             }
+            trace.mark("fonts loaded");
 
-            std::cout << "Four Line Display Demo [ILI9488 480x320]\n";
+            std::cout << "Four Line Display Demo [" << tft->name << " " << width << "x" << height << "]\n";
             std::cout << "==========================================\n";
             std::cout << "Line 0 (small): max " << display.length(0) << " chars\n";
             std::cout << "Line 1 (large): max " << display.length(1) << " chars\n";
@@ -74,38 +422,63 @@ int main(int argc, char** argv) {
             std::cout << "Line 3 (small): max " << display.length(3) << " chars\n";
             std::cout << "\nPress Ctrl+C to exit...\n\n";
 
-            int counter = 0;
-            while (true) {
-                display.puts(0, "Статус: Выполняется");
-                display.puts(1, "Счётчик: " + std::to_string(counter));
-                display.puts(2, "FuelFlux ILI9488");
-                display.puts(3, "Версия 2.1");
-
-                const auto& fb = display.render();
-                lcd.set_mono_framebuffer(fb, 0xFFFF, 0x0000);
-
-                ++counter;
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            }
+            // A full RGB666 frame is ~460 KB on the wire, so pace ILI9488
+            // slowly; a 240x320 RGB565 frame is a third of that
+            run_demo(display, width, height, ili9488 ? 5.0 : 10.0,
+                     {"Статус: Выполняется", "Счётчик: ", std::string("FuelFlux ") + tft->name,
+                      "Версия 2.1"},
+                     first_frame_gate(bring_up, trace,
+                                      [&, painted = false](const std::vector<unsigned char>& fb,
+                                                           const std::vector<Rect>& dirty) mutable {
+                                          // The first frame covers whatever GRAM held,
+                                          // later only the changed areas go over the bus
+                                          if (!painted) {
+                                              presenter.present(fb, 0xFFFF, 0x0000);
+                                              painted = true;
+                                              return;
+                                          }
+                                          for (const Rect& r : dirty)
+                                              presenter.present_region(fb, r, 0xFFFF, 0x0000);
+                                      },
+                                      [&] { lcd.display_on(true); }),
+                     [&] {
+                         // Created after the first frame, which joined bring-up
+                         if (watchdog_ms <= 0) return;
+                         if (!watchdog) watchdog = tft_watchdog(lcd, watchdog_ms, status_readable);
+                         report_health(watchdog->poll());
+                     },
+                     idle.get());
         }
 
         if (model != "st7565") {
             std::cerr << "Unknown model: " << model << "\n";
-            std::cerr << "Supported models: st7565, ili9488 (alias: msp3520)\n";
+            std::cerr << "Supported models: st7565, ili9488 (alias: msp3520), st7789, ili9341\n";
             return 1;
         }
 
         St7565 lcd(spi, dcLine, rstLine);
-        lcd.reset();
-        lcd.init();
+        if (!custom_init.empty()) lcd.set_init_sequence(custom_init);
+        sleep = [&lcd](bool on) { lcd.sleep(on); };
+        std::future<void> bring_up = std::async(std::launch::async, [&] {
+            if (!resume) lcd.reset();
+            if (rotate_steps == 2) {
+                lcd.set_scan_direction(true, false, 4); // 180 degrees in hardware
+            }
+            lcd.init(false);
+            mark_panel_configured(model, rotate_steps);
+            trace.mark(resume ? "panel resumed" : "panel reset and configured");
+        });
 
         FourLineDisplay display(width, height, small_font, large_font);
+        if (rotate_steps == 1) display.set_orientation(Rotation::Deg90);
+        if (rotate_steps == 3) display.set_orientation(Rotation::Deg270);
 
         if (!display.initialize(font)) {
             std::cerr << "Failed to initialize FourLineDisplay library\n";
             std::cerr << "  - Verify font exists: " << font << "\n";
             return 1;
         }
+        trace.mark("fonts loaded");
 
         std::cout << "Four Line Display Demo [ST7565 128x64]\n";
         std::cout << "=======================================\n";
@@ -115,20 +488,28 @@ int main(int argc, char** argv) {
         std::cout << "Line 3 (small): max " << display.length(3) << " chars\n";
         std::cout << "\nPress Ctrl+C to exit...\n\n";
 
-        int counter = 0;
-        while (true) {
-            display.puts(0, "Status: Running");
-            display.puts(1, "Count: " + std::to_string(counter));
-            display.puts(2, "FuelFlux NHD");
-            display.puts(3, "Ver 2.0");
-
-            const auto& fb = display.render();
-            lcd.set_framebuffer(fb);
-
-            ++counter;
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        // Write-only: re-send the registers and the 1 KB frame every period
+        std::unique_ptr<PanelWatchdog> watchdog;
+        if (watchdog_ms > 0) {
+            watchdog = std::make_unique<PanelWatchdog>(std::chrono::milliseconds(watchdog_ms), nullptr,
+                                                       [&lcd] { lcd.reassert(); },
+                                                       [&lcd] { lcd.restore(); }, 1);
         }
 
+        run_demo(display, width, height, 25.0,
+                 {"Status: Running", "Count: ", "FuelFlux NHD", "Ver 2.0"},
+                 first_frame_gate(bring_up, trace,
+                                  [&](const std::vector<unsigned char>& fb,
+                                      const std::vector<Rect>&) {
+                                      // The whole frame is 1 KB
+                                      lcd.set_framebuffer(fb);
+                                  },
+                                  [&] { lcd.display_on(true); }),
+                 [&] {
+                     if (watchdog) watchdog->poll();
+                 },
+                 idle.get());
+
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         std::cerr << "Hints:\n";
@@ -0,0 +1,271 @@
+#include "panel_sim.h"
+#include <algorithm>
+#include <cstring>
+
+// St7565Sim
+
+St7565Sim::St7565Sim(int width, int height)
+    : w_(std::min(width, kCols)), h_(std::min(height, 64)),
+      gram_(static_cast<size_t>(kCols * kPages), 0) {}
+
+void St7565Sim::reset() {
+    page_ = col_ = start_line_ = 0;
+    on_ = seg_reverse_ = com_reverse_ = inverse_ = all_on_ = false;
+    contrast_ = 0x20;
+    pending_ = 0;
+}
+
+void St7565Sim::command(uint8_t c) {
+    if (pending_) {
+        // Parameter byte of a two-byte command
+        if (pending_ == 0x81) contrast_ = c & 0x3F;
+        pending_ = 0;
+        return;
+    }
+    if (c == 0x81 || c == 0xF8) { pending_ = c; return; }  // volume, booster ratio
+    if ((c & 0xF0) == 0xB0) { page_ = c & 0x0F; return; }
+    if ((c & 0xF0) == 0x10) { col_ = ((c & 0x0F) << 4) | (col_ & 0x0F); return; }
+    if ((c & 0xF0) == 0x00) { col_ = (col_ & 0xF0) | (c & 0x0F); return; }
+    if ((c & 0xC0) == 0x40) { start_line_ = c & 0x3F; return; }
+    switch (c) {
+        case 0xAE: on_ = false; break;
+        case 0xAF: on_ = true; break;
+        case 0xA0: seg_reverse_ = false; break;
+        case 0xA1: seg_reverse_ = true; break;
+        case 0xA6: inverse_ = false; break;
+        case 0xA7: inverse_ = true; break;
+        case 0xA4: all_on_ = false; break;
+        case 0xA5: all_on_ = true; break;
+        case 0xE2: reset(); break;
+        default:
+            if ((c & 0xF0) == 0xC0) com_reverse_ = (c & 0x08) != 0;
+            break;  // bias, power control, resistor ratio: no visible effect
+    }
+}
+
+int St7565Sim::feed(bool dc, const uint8_t* p, size_t n) {
+    int frames = 0;
+    const int last_page = h_ / 8 - 1;
+    const int last_col = seg_reverse_ ? kCols - 1 : w_ - 1;
+    for (size_t i = 0; i < n; ++i) {
+        if (!dc) {
+            command(p[i]);
+            continue;
+        }
+        if (page_ < kPages && col_ < kCols) {
+            gram_[static_cast<size_t>(page_ * kCols + col_)] = p[i];
+            if (page_ == last_page && col_ == last_col) ++frames;
+        }
+        if (col_ < kCols) ++col_;  // the column address stops at the end
+    }
+    return frames;
+}
+
+void St7565Sim::render_rgb(std::vector<uint8_t>& rgb) const {
+    rgb.assign(static_cast<size_t>(w_ * h_ * 3), 0xFF);
+    if (!on_) return;  // blank glass
+    for (int col = 0; col < kCols; ++col) {
+        const int seg = seg_reverse_ ? kCols - 1 - col : col;
+        if (seg >= w_) continue;
+        for (int line = 0; line < 64; ++line) {
+            // COM n shows line (n + start); St7565 drives COM reversed by default
+            const int com = (line - start_line_ + 64) % 64;
+            const int y = com_reverse_ ? com : 63 - com;
+            if (y >= h_) continue;
+            const bool bit = (gram_[static_cast<size_t>((line / 8) * kCols + col)] >> (line % 8)) & 1u;
+            if (!(all_on_ || (bit != inverse_))) continue;
+            uint8_t* px = rgb.data() + static_cast<size_t>((y * w_ + seg) * 3);
+            px[0] = px[1] = px[2] = 0x00;
+        }
+    }
+}
+
+// Ili9488Sim
+
+Ili9488Sim::Ili9488Sim() : gram_(static_cast<size_t>(kW * kH * 3), 0) {}
+
+void Ili9488Sim::reset() {
+    cmd_ = 0;
+    param_ = 0;
+    madctl_ = 0;
+    colmod_ = 0x66;
+    on_ = false;
+    writing_ = false;
+    partial_len_ = 0;
+    x0_ = 0; x1_ = kW - 1; y0_ = 0; y1_ = kH - 1;
+    cx_ = cy_ = 0;
+}
+
+int Ili9488Sim::width() const { return (madctl_ & 0x20) ? kH : kW; }
+int Ili9488Sim::height() const { return (madctl_ & 0x20) ? kW : kH; }
+
+void Ili9488Sim::physical(int x, int y, int& px, int& py) const {
+    // MV exchanges rows and columns, then MX/MY mirror them
+    px = (madctl_ & 0x20) ? y : x;
+    py = (madctl_ & 0x20) ? x : y;
+    if (madctl_ & 0x40) px = kW - 1 - px;
+    if (madctl_ & 0x80) py = kH - 1 - py;
+}
+
+bool Ili9488Sim::write_pixel(const uint8_t* src) {
+    uint8_t r, g, b;
+    if (colmod_ == 0x55) {
+        const unsigned v = (static_cast<unsigned>(src[0]) << 8) | src[1];
+        r = static_cast<uint8_t>(((v >> 11) & 0x1F) << 3);
+        g = static_cast<uint8_t>(((v >> 5) & 0x3F) << 2);
+        b = static_cast<uint8_t>((v & 0x1F) << 3);
+    } else {
+        r = src[0] & 0xFC;
+        g = src[1] & 0xFC;
+        b = src[2] & 0xFC;
+    }
+    // Expand 6/5-bit channels to full scale
+    r = static_cast<uint8_t>(r | (r >> 6));
+    g = static_cast<uint8_t>(g | (g >> 6));
+    b = static_cast<uint8_t>(b | (b >> 6));
+
+    if (cx_ < width() && cy_ < height()) {
+        int px, py;
+        physical(cx_, cy_, px, py);
+        uint8_t* dst = gram_.data() + static_cast<size_t>((py * kW + px) * 3);
+        dst[0] = r; dst[1] = g; dst[2] = b;
+    }
+
+    if (++cx_ > x1_) {
+        cx_ = x0_;
+        if (++cy_ > y1_) {
+            cy_ = y0_;
+            return true;  // window filled
+        }
+    }
+    return false;
+}
+
+int Ili9488Sim::feed(bool dc, const uint8_t* p, size_t n) {
+    int frames = 0;
+    if (!dc) {
+        for (size_t i = 0; i < n; ++i) {
+            cmd_ = p[i];
+            param_ = 0;
+            writing_ = false;
+            partial_len_ = 0;
+            switch (cmd_) {
+                case 0x01: reset(); break;  // SWRESET
+                case 0x28: on_ = false; break;
+                case 0x29: on_ = true; break;
+                case 0x2C: writing_ = true; cx_ = x0_; cy_ = y0_; break;  // RAMWR
+                case 0x3C: writing_ = true; break;                         // RAMWRC
+                default: break;  // sleep, inversion etc.: no visible effect here
+            }
+        }
+        return 0;
+    }
+
+    if (writing_) {
+        const size_t bpp = (colmod_ == 0x55) ? 2 : 3;
+        size_t i = 0;
+        if (partial_len_) {
+            while (partial_len_ < bpp && i < n) partial_[partial_len_++] = p[i++];
+            if (partial_len_ < bpp) return 0;
+            frames += write_pixel(partial_) ? 1 : 0;
+            partial_len_ = 0;
+        }
+        for (; i + bpp <= n; i += bpp) frames += write_pixel(p + i) ? 1 : 0;
+        while (i < n) partial_[partial_len_++] = p[i++];
+        return frames;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (param_ < sizeof(params_)) params_[param_] = p[i];
+        ++param_;
+        if (cmd_ == 0x36 && param_ == 1) madctl_ = params_[0];
+        if (cmd_ == 0x3A && param_ == 1) colmod_ = params_[0];
+        if ((cmd_ == 0x2A || cmd_ == 0x2B) && param_ == 4) {
+            const int a = (params_[0] << 8) | params_[1];
+            const int b = (params_[2] << 8) | params_[3];
+            if (cmd_ == 0x2A) { x0_ = a; x1_ = b; } else { y0_ = a; y1_ = b; }
+        }
+    }
+    return 0;
+}
+
+void Ili9488Sim::render_rgb(std::vector<uint8_t>& rgb) const {
+    const int w = width();
+    const int h = height();
+    rgb.assign(static_cast<size_t>(w * h * 3), 0);
+    if (!on_) return;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            int px, py;
+            physical(x, y, px, py);
+            std::memcpy(rgb.data() + static_cast<size_t>((y * w + x) * 3),
+                        gram_.data() + static_cast<size_t>((py * kW + px) * 3), 3);
+        }
+    }
+}
+
+// Replay
+
+ReplayStats replay_bus(const std::vector<BusEvent>& events, PanelSim& sim,
+                       const std::function<void(uint64_t, uint64_t)>& on_frame) {
+    ReplayStats st;
+    if (events.empty()) return st;
+
+    bool dc = false;
+    bool have_dc = false;
+    bool frame_open = false;
+    uint64_t frame_start = 0;
+    uint64_t last_frame_end = 0;
+    double interval_sum = 0.0;
+    double write_sum = 0.0;
+
+    for (const BusEvent& e : events) {
+        ++st.events;
+        switch (e.channel) {
+            case BusChannel::Dc:
+                if (have_dc && e.level != dc) ++st.dc_toggles;
+                dc = e.level;
+                have_dc = true;
+                break;
+            case BusChannel::Reset:
+                if (!e.level) {
+                    sim.reset();
+                    ++st.resets;
+                }
+                break;
+            case BusChannel::Spi: {
+                ++st.spi_writes;
+                st.spi_bytes += e.data.size();
+                if (!frame_open) {
+                    frame_start = e.t_ns;
+                    frame_open = true;
+                }
+                const int done = sim.feed(dc, e.data.data(), e.data.size());
+                for (int k = 0; k < done; ++k) {
+                    const double write_ms = static_cast<double>(e.t_ns - frame_start) / 1e6;
+                    write_sum += write_ms;
+                    st.frame_write_max_ms = std::max(st.frame_write_max_ms, write_ms);
+                    if (st.frames > 0) {
+                        const double iv = static_cast<double>(e.t_ns - last_frame_end) / 1e6;
+                        interval_sum += iv;
+                        st.frame_interval_min_ms =
+                            (st.frames == 1) ? iv : std::min(st.frame_interval_min_ms, iv);
+                        st.frame_interval_max_ms = std::max(st.frame_interval_max_ms, iv);
+                    }
+                    last_frame_end = e.t_ns;
+                    if (on_frame) on_frame(st.frames, e.t_ns);
+                    ++st.frames;
+                    frame_open = false;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    st.duration_ms = static_cast<double>(events.back().t_ns - events.front().t_ns) / 1e6;
+    if (st.frames > 0) st.frame_write_avg_ms = write_sum / static_cast<double>(st.frames);
+    if (st.frames > 1) st.frame_interval_avg_ms = interval_sum / static_cast<double>(st.frames - 1);
+    return st;
+}
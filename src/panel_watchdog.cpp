@@ -0,0 +1,41 @@
+#include "panel_watchdog.h"
+#include <stdexcept>
+
+PanelWatchdog::PanelWatchdog(std::chrono::milliseconds period, Check check, Action reassert,
+                             Action restore, unsigned repaint_every)
+    : period_(period), check_(std::move(check)), reassert_(std::move(reassert)),
+      restore_(std::move(restore)), repaint_every_(repaint_every),
+      next_(Clock::now() + period) {
+    if (!reassert_ || !restore_) throw std::runtime_error("PanelWatchdog needs reassert and restore");
+}
+
+PanelHealth PanelWatchdog::poll() {
+    const Clock::time_point now = Clock::now();
+    if (now < next_) return PanelHealth::Ok;
+    // From now, not from the missed due time: a long frame must not cause
+    // a burst of catch-up checks
+    next_ = now + period_;
+    ++stats_.checks;
+
+    if (!check_) {
+        if (repaint_every_ != 0 && ++blind_count_ >= repaint_every_) {
+            blind_count_ = 0;
+            ++stats_.restores;
+            restore_();
+        } else {
+            ++stats_.reasserts;
+            reassert_();
+        }
+        return PanelHealth::Ok;
+    }
+
+    const PanelHealth health = check_();
+    if (health == PanelHealth::Registers) {
+        ++stats_.reasserts;
+        reassert_();
+    } else if (health == PanelHealth::Lost) {
+        ++stats_.restores;
+        restore_();
+    }
+    return health;
+}
@@ -1,8 +1,12 @@
 #include "spi_linux.h"
+#include "bus_recorder.h"
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <stdexcept>
 
 SpiLinux::SpiLinux(std::string dev) : dev_(std::move(dev)) {}
@@ -18,14 +22,96 @@ void SpiLinux::open(uint32_t speed_hz, uint8_t mode) {
 
     uint8_t bits = 8;
     if (ioctl(fd_, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) throw std::runtime_error("SPI_IOC_WR_BITS_PER_WORD failed");
+
+    speed_hz_ = speed_hz;
+    max_transfer_ = query_spidev_bufsiz();
 }
 
 void SpiLinux::close() {
     if (fd_ >= 0) { ::close(fd_); fd_ = -1; }
 }
 
+size_t SpiLinux::query_spidev_bufsiz() {
+    std::ifstream f("/sys/module/spidev/parameters/bufsiz");
+    unsigned long v = 0;
+    if (f >> v && v > 0) return static_cast<size_t>(v);
+    return kDefaultMaxTransfer;
+}
+
+void SpiLinux::set_max_transfer(size_t bytes) {
+    if (bytes == 0) throw std::runtime_error("SPI max transfer must be non-zero");
+    max_transfer_ = bytes;
+}
+
+void SpiLinux::set_segment_size(size_t bytes) {
+    if (bytes == 0) throw std::runtime_error("SPI segment size must be non-zero");
+    segment_size_ = bytes;
+}
+
 void SpiLinux::write(const uint8_t* data, size_t len) {
+    const SpiSegment seg{data, len};
+    write_segments(&seg, 1);
+}
+
+void SpiLinux::write_segments(const SpiSegment* segs, size_t n) {
+    if (recorder_) recorder_->record_spi(segs, n);
+
+    SpiSegment batch[kMaxSegmentsPerMessage];
+    size_t count = 0;
+    size_t total = 0;
+
+    auto flush = [&]() {
+        if (count == 0) return;
+        transfer_message(batch, count);
+        stats_.messages += 1;
+        stats_.transfers += count;
+        stats_.bytes += total;
+        count = 0;
+        total = 0;
+    };
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* p = segs[i].tx;
+        size_t left = segs[i].len;
+        while (left > 0) {
+            // Fill each message up to max_transfer, segment by segment
+            const size_t room = max_transfer_ - total;
+            const size_t chunk = std::min({left, segment_size_, room});
+            batch[count++] = {p, chunk};
+            total += chunk;
+            p += chunk;
+            left -= chunk;
+            if (count == kMaxSegmentsPerMessage || total == max_transfer_) flush();
+        }
+    }
+    flush();
+}
+
+void SpiLinux::transfer(const uint8_t* tx, uint8_t* rx, size_t len, uint32_t speed_hz) {
+    if (len > max_transfer_) throw std::runtime_error("SPI transfer exceeds max transfer");
+    const SpiSegment seg{tx, len, rx, speed_hz};
+    if (recorder_) recorder_->record_spi(&seg, 1);
+    transfer_message(&seg, 1);
+    stats_.messages += 1;
+    stats_.transfers += 1;
+    stats_.bytes += len;
+}
+
+void SpiLinux::transfer_message(const SpiSegment* segs, size_t n) {
     if (fd_ < 0) throw std::runtime_error("SPI not open");
-    ssize_t rc = ::write(fd_, data, len);
-    if (rc < 0 || static_cast<size_t>(rc) != len) throw std::runtime_error("SPI write failed");
+
+    spi_ioc_transfer xfers[kMaxSegmentsPerMessage];
+    std::memset(xfers, 0, sizeof(spi_ioc_transfer) * n);
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        xfers[i].tx_buf = reinterpret_cast<uintptr_t>(segs[i].tx);
+        xfers[i].rx_buf = reinterpret_cast<uintptr_t>(segs[i].rx);
+        xfers[i].len = static_cast<uint32_t>(segs[i].len);
+        xfers[i].speed_hz = segs[i].speed_hz ? segs[i].speed_hz : speed_hz_;
+        xfers[i].bits_per_word = 8;
+        total += segs[i].len;
+    }
+
+    int rc = ioctl(fd_, SPI_IOC_MESSAGE(n), xfers);
+    if (rc < 0 || static_cast<size_t>(rc) != total) throw std::runtime_error("SPI write failed");
 }
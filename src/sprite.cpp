@@ -0,0 +1,263 @@
+#include "sprite.h"
+#include "ft_text.h"
+#include "graphics.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+inline uint8_t combine(uint8_t dst, uint8_t val, uint8_t mask) {
+    return static_cast<uint8_t>((dst & ~mask) | (val & mask));
+}
+
+inline void rgb565_to_666(uint16_t c, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(((c >> 11) & 0x1F) << 3);
+    out[1] = static_cast<uint8_t>(((c >> 5) & 0x3F) << 2);
+    out[2] = static_cast<uint8_t>((c & 0x1F) << 3);
+}
+
+} // namespace
+
+MonoSprite::MonoSprite(int width, int height)
+    : w_(std::max(0, width)), h_(std::max(0, height)) {
+    pix_.assign(static_cast<size_t>(w_ * pages()), 0x00);
+}
+
+MonoSprite MonoSprite::from_pages(int width, int height, const uint8_t* pages) {
+    MonoSprite s(width, height);
+    std::memcpy(s.pix_.data(), pages, s.pix_.size());
+    // Keep rows beyond the height clear so Transparent blits stay exact
+    if (s.h_ % 8) {
+        const uint8_t keep = s.rows_mask(s.pages() - 1);
+        uint8_t* last = s.pix_.data() + static_cast<size_t>((s.pages() - 1) * s.w_);
+        for (int x = 0; x < s.w_; ++x) last[x] &= keep;
+    }
+    return s;
+}
+
+MonoSprite MonoSprite::from_rows(int width, int height, const uint8_t* rows, int stride,
+                                 bool lsb_first) {
+    MonoSprite s(width, height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = rows + static_cast<size_t>(y) * static_cast<size_t>(stride);
+        for (int x = 0; x < width; ++x) {
+            const int bit = lsb_first ? (x & 7) : 7 - (x & 7);
+            if ((row[x >> 3] >> bit) & 1u) s.set(x, y);
+        }
+    }
+    return s;
+}
+
+MonoSprite MonoSprite::from_gfx(const MonoGfx& gfx) {
+    return from_pages(gfx.native_width(), gfx.native_height(), gfx.fb().data());
+}
+
+MonoSprite MonoSprite::from_text(FtText& ft, const std::string& utf8) {
+    const int w = ft.measure_utf8(utf8);
+    const int h = ft.line_height();
+    if (w <= 0 || h <= 0) return MonoSprite();
+
+    MonoGfx canvas(w, ((h + 7) / 8) * 8);
+    ft.draw_utf8(canvas, 0, 0, utf8);
+    return from_pages(w, h, canvas.fb().data());
+}
+
+void MonoSprite::set_mask(std::vector<uint8_t> mask) {
+    if (!mask.empty() && mask.size() != pix_.size()) {
+        throw std::runtime_error("Sprite mask size mismatch");
+    }
+    mask_ = std::move(mask);
+}
+
+void MonoSprite::mask_from_pixels(int outline) {
+    MonoSprite m(w_, h_);
+    for (int y = 0; y < h_; ++y) {
+        for (int x = 0; x < w_; ++x) {
+            if (!get(x, y)) continue;
+            for (int dy = -outline; dy <= outline; ++dy)
+                for (int dx = -outline; dx <= outline; ++dx)
+                    m.set(x + dx, y + dy);
+        }
+    }
+    mask_ = std::move(m.pix_);
+}
+
+uint8_t MonoSprite::rows_mask(int page) const {
+    const int rows = h_ - page * 8;
+    return rows >= 8 ? 0xFF : static_cast<uint8_t>((1u << rows) - 1u);
+}
+
+bool MonoSprite::get(int x, int y) const {
+    if (x < 0 || y < 0 || x >= w_ || y >= h_) return false;
+    return (pix_[static_cast<size_t>((y / 8) * w_ + x)] >> (y % 8)) & 1u;
+}
+
+void MonoSprite::set(int x, int y, bool on) {
+    if (x < 0 || y < 0 || x >= w_ || y >= h_) return;
+    const size_t idx = static_cast<size_t>((y / 8) * w_ + x);
+    const uint8_t bit = static_cast<uint8_t>(1u << (y % 8));
+    if (on) pix_[idx] |= bit;
+    else pix_[idx] &= static_cast<uint8_t>(~bit);
+}
+
+void MonoSprite::blit(MonoGfx& dst, int x, int y, BlitMode mode) const {
+    blit_region(dst, x, y, 0, w_, mode);
+}
+
+void MonoSprite::blit_region(MonoGfx& dst, int x, int y, int src_x, int w, BlitMode mode) const {
+    // Clip the source window to the sprite
+    if (src_x < 0) { x -= src_x; w += src_x; src_x = 0; }
+    w = std::min(w, w_ - src_x);
+    if (w <= 0 || h_ <= 0) return;
+
+    const bool use_mask = (mode == BlitMode::Masked) && has_mask();
+
+    if (!dst.pixel_map().identity) {
+        // Rotated/mirrored target: go through the pixel map
+        for (int sy = 0; sy < h_; ++sy) {
+            for (int sx = src_x; sx < src_x + w; ++sx) {
+                const bool on = get(sx, sy);
+                if (mode == BlitMode::Transparent && !on) continue;
+                if (use_mask && !((mask_[static_cast<size_t>((sy / 8) * w_ + sx)] >> (sy % 8)) & 1u)) continue;
+                dst.pixel(x + sx - src_x, sy + y, on);
+            }
+        }
+        return;
+    }
+
+    std::vector<uint8_t>& fb = dst.fb();
+    const int dw = dst.native_width();
+    const int dpages = static_cast<int>(fb.size()) / std::max(1, dw);
+
+    // Horizontal clip against the destination
+    int dx0 = x;
+    int sx0 = src_x;
+    int cols = w;
+    if (dx0 < 0) { sx0 -= dx0; cols += dx0; dx0 = 0; }
+    cols = std::min(cols, dw - dx0);
+    if (cols <= 0) return;
+
+    // Vertical placement: source page p lands on pages page0+p (low bits)
+    // and page0+p+1 (high bits) when y is not page aligned.
+    const int shift = ((y % 8) + 8) % 8;
+    const int page0 = (y - shift) / 8;
+
+    for (int sp = 0; sp < pages(); ++sp) {
+        const int dp = page0 + sp;
+        if (dp + 1 < 0 || dp >= dpages) continue;
+        const bool lo_ok = dp >= 0;
+        const bool hi_ok = shift != 0 && dp + 1 < dpages;
+        const uint8_t rows = rows_mask(sp);
+        const uint8_t* src = pix_.data() + static_cast<size_t>(sp * w_ + sx0);
+        const uint8_t* msk = use_mask ? mask_.data() + static_cast<size_t>(sp * w_ + sx0) : nullptr;
+        uint8_t* lo = lo_ok ? fb.data() + static_cast<size_t>(dp * dw + dx0) : nullptr;
+        uint8_t* hi = hi_ok ? fb.data() + static_cast<size_t>((dp + 1) * dw + dx0) : nullptr;
+
+        if (mode == BlitMode::Opaque && shift == 0 && rows == 0xFF && lo_ok) {
+            // Full page, aligned: a straight column copy
+            std::memcpy(lo, src, static_cast<size_t>(cols));
+            continue;
+        }
+        for (int c = 0; c < cols; ++c) {
+            const uint8_t v = src[c];
+            uint8_t m = rows;
+            if (mode == BlitMode::Transparent) m &= v;
+            else if (msk) m &= msk[c];
+            if (!m) continue;
+            const unsigned v16 = static_cast<unsigned>(v) << shift;
+            const unsigned m16 = static_cast<unsigned>(m) << shift;
+            if (lo_ok) lo[c] = combine(lo[c], static_cast<uint8_t>(v16), static_cast<uint8_t>(m16));
+            if (hi_ok) hi[c] = combine(hi[c], static_cast<uint8_t>(v16 >> 8), static_cast<uint8_t>(m16 >> 8));
+        }
+    }
+}
+
+ColorSprite::ColorSprite(int width, int height)
+    : w_(std::max(0, width)), h_(std::max(0, height)) {
+    rgb_.assign(static_cast<size_t>(w_ * h_ * 3), 0x00);
+    alpha_.assign(static_cast<size_t>(w_ * h_), 1);
+    row_opaque_.assign(static_cast<size_t>(h_), 1);
+}
+
+ColorSprite ColorSprite::from_mono(const MonoSprite& mono, uint16_t fg_color565,
+                                   uint16_t bg_color565, bool transparent_bg) {
+    ColorSprite s(mono.width(), mono.height());
+    for (int y = 0; y < s.h_; ++y) {
+        for (int x = 0; x < s.w_; ++x) {
+            if (mono.get(x, y)) s.set_pixel(x, y, fg_color565);
+            else if (transparent_bg) s.set_transparent(x, y);
+            else s.set_pixel(x, y, bg_color565);
+        }
+    }
+    return s;
+}
+
+void ColorSprite::set_pixel(int x, int y, uint16_t color565) {
+    if (x < 0 || y < 0 || x >= w_ || y >= h_) return;
+    const size_t idx = static_cast<size_t>(y * w_ + x);
+    rgb565_to_666(color565, &rgb_[idx * 3]);
+    if (!alpha_[idx]) {
+        alpha_[idx] = 1;
+        const uint8_t* row = &alpha_[static_cast<size_t>(y * w_)];
+        row_opaque_[static_cast<size_t>(y)] = std::all_of(row, row + w_, [](uint8_t a) { return a != 0; }) ? 1 : 0;
+    }
+}
+
+void ColorSprite::set_transparent(int x, int y) {
+    if (x < 0 || y < 0 || x >= w_ || y >= h_) return;
+    alpha_[static_cast<size_t>(y * w_ + x)] = 0;
+    row_opaque_[static_cast<size_t>(y)] = 0;
+}
+
+void ColorSprite::blit(std::vector<uint8_t>& rgb666, int width, int height, int x, int y) const {
+    if (rgb666.size() < static_cast<size_t>(width * height * 3)) {
+        throw std::runtime_error("RGB666 buffer too small for blit");
+    }
+    const int sx0 = std::max(0, -x);
+    const int sx1 = std::min(w_, width - x);
+    const int sy0 = std::max(0, -y);
+    const int sy1 = std::min(h_, height - y);
+    if (sx0 >= sx1 || sy0 >= sy1) return;
+
+    for (int sy = sy0; sy < sy1; ++sy) {
+        const size_t src_idx = static_cast<size_t>(sy * w_ + sx0);
+        const size_t dst_idx = static_cast<size_t>((y + sy) * width + x + sx0);
+        if (row_opaque_[static_cast<size_t>(sy)]) {
+            std::memcpy(&rgb666[dst_idx * 3], &rgb_[src_idx * 3], static_cast<size_t>(sx1 - sx0) * 3);
+            continue;
+        }
+        for (int k = 0; k < sx1 - sx0; ++k) {
+            if (!alpha_[src_idx + k]) continue;
+            std::memcpy(&rgb666[(dst_idx + k) * 3], &rgb_[(src_idx + k) * 3], 3);
+        }
+    }
+}
+
+TextSpriteCache::TextSpriteCache(FtText& ft, size_t capacity)
+    : ft_(ft), capacity_(std::max<size_t>(1, capacity)) {}
+
+const MonoSprite& TextSpriteCache::get(const std::string& utf8) {
+    std::string key = std::to_string(ft_.pixel_size());
+    key += '\0';
+    key += utf8;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->sprite;
+    }
+
+    lru_.push_front({key, MonoSprite::from_text(ft_, utf8)});
+    index_[key] = lru_.begin();
+    if (lru_.size() > capacity_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+    return lru_.front().sprite;
+}
+
+void TextSpriteCache::clear() {
+    index_.clear();
+    lru_.clear();
+}
@@ -2,48 +2,130 @@
 #include <thread>
 #include <chrono>
 #include <stdexcept>
+#include <iterator>
+
+namespace {
+// ST7565-class init (good default for ST7565/ST7567 family). Commands and
+// their parameters all go out with A0 low, so with no delays the whole
+// sequence is a single SPI write.
+constexpr InitStep kConfig[] = {
+    {0xA2, 0, {}, 0},          // bias 1/9
+    {0x2F, 0, {}, 0},          // power: booster+regulator+follower ON
+    {0x26, 0, {}, 0},          // resistor ratio
+    {0x81, 1, {0x16}, 0},      // electronic volume: contrast (00..3F)
+};
+} // namespace
 
 St7565::St7565(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width, int height)
-    : spi_(spi), dc_(dc), rst_(rst), w_(width), h_(height) {}
+    : spi_(spi), dc_(dc), rst_(rst), w_(width), h_(height),
+      config_(std::begin(kConfig), std::end(kConfig)) {
+    // Frames are copied into it, so writing one never allocates
+    shadow_.reserve(static_cast<size_t>(w_ * (h_/8)));
+}
 
-void St7565::cmd(uint8_t b) { dc_.set(false); spi_.write(&b, 1); }
+void St7565::cmd(uint8_t b) { pacer_.wait(); dc_.set(false); spi_.write(&b, 1); }
+void St7565::cmds(const uint8_t* p, size_t n) { pacer_.wait(); dc_.set(false); spi_.write(p, n); }
 void St7565::data(const uint8_t* p, size_t n) { dc_.set(true); spi_.write(p, n); }
 
 void St7565::reset() {
     rst_.set(false);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1)); // datasheet: >= 1-5 us
     rst_.set(true);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pacer_.delay(std::chrono::milliseconds(5));
+}
+
+void St7565::init(bool on) {
+    std::vector<InitStep> steps;
+    steps.push_back({0xAE, 0, {}, 0});                        // display OFF
+    steps.insert(steps.end(), config_.begin(), config_.end());
+    steps.push_back({static_cast<uint8_t>(seg_reverse_ ? 0xA1 : 0xA0), 0, {}, 0}); // SEG direction
+    steps.push_back({static_cast<uint8_t>(com_reverse_ ? 0xC8 : 0xC0), 0, {}, 0}); // COM direction
+    if (on) steps.push_back({0xAF, 0, {}, 0});                // display ON
+    run_init_steps(steps, ParamPath::Command, pacer_, [this](bool dc, const uint8_t* p, size_t n) {
+        dc_.set(dc);
+        spi_.write(p, n);
+    });
+    on_ = on;
+    sleeping_ = false;
+}
+
+void St7565::reassert() {
+    if (sleeping_) return;
+    // Without the script's software reset and power-up delays: the panel
+    // must not flicker through defaults, nor the caller block, every period
+    std::vector<InitStep> steps = resend_steps(config_, 0xE2, false);
+    if (contrast_ >= 0) steps.push_back({0x81, 1, {static_cast<uint8_t>(contrast_)}, 0});
+    steps.push_back({static_cast<uint8_t>(seg_reverse_ ? 0xA1 : 0xA0), 0, {}, 0});
+    steps.push_back({static_cast<uint8_t>(com_reverse_ ? 0xC8 : 0xC0), 0, {}, 0});
+    steps.push_back({0x40, 0, {}, 0});  // display start line 0
+    steps.push_back({0xA6, 0, {}, 0});  // normal, not inverted
+    steps.push_back({0xA4, 0, {}, 0});  // all points off: show RAM
+    steps.push_back({static_cast<uint8_t>(on_ ? 0xAF : 0xAE), 0, {}, 0});
+    run_init_steps(steps, ParamPath::Command, pacer_, [this](bool dc, const uint8_t* p, size_t n) {
+        dc_.set(dc);
+        spi_.write(p, n);
+    });
+}
+
+void St7565::restore() {
+    if (sleeping_) return;
+    reassert();
+    if (!shadow_.empty()) set_framebuffer(shadow_);
 }
 
-void St7565::init() {
-    // ST7565-class init (good default for ST7565/ST7567 family)
-    cmd(0xAE); // display OFF
-    cmd(0xA2); // bias 1/9
-    cmd(0xA0); // SEG normal (A0/A1 flips)
-    cmd(0xC8); // COM reversed (C0/C8 flips)
-    cmd(0x2F); // power: booster+regulator+follower ON
-    cmd(0x26); // resistor ratio
-    cmd(0x81); // electronic volume
-    cmd(0x16); // contrast (00..3F)
-    cmd(0xAF); // display ON
+void St7565::set_init_sequence(std::vector<InitStep> steps) {
+    config_ = std::move(steps);
 }
 
-void St7565::set_contrast(uint8_t v) { cmd(0x81); cmd(v & 0x3F); }
-void St7565::display_on(bool on) { cmd(on ? 0xAF : 0xAE); }
+void St7565::set_scan_direction(bool seg_reverse, bool com_reverse, uint8_t column_offset) {
+    seg_reverse_ = seg_reverse;
+    com_reverse_ = com_reverse;
+    col_offset_ = column_offset;
+    cmd(seg_reverse_ ? 0xA1 : 0xA0);
+    cmd(com_reverse_ ? 0xC8 : 0xC0);
+}
+
+void St7565::set_contrast(uint8_t v) {
+    contrast_ = v & 0x3F;
+    cmd(0x81);
+    cmd(v & 0x3F);
+}
+
+void St7565::display_on(bool on) {
+    cmd(on ? 0xAF : 0xAE);
+    on_ = on;
+}
+
+void St7565::sleep(bool on) {
+    if (on == sleeping_) return;
+    if (on) {
+        const uint8_t seq[] = {0xAE, 0xA5};  // display off + all points on = sleep
+        cmds(seq, sizeof(seq));
+    } else {
+        const uint8_t seq[] = {0xA4, static_cast<uint8_t>(on_ ? 0xAF : 0xAE)};
+        cmds(seq, sizeof(seq));
+    }
+    sleeping_ = on;
+}
 
 void St7565::clear() {
-    std::vector<uint8_t> zeros(static_cast<size_t>(w_ * (h_/8)), 0x00);
-    set_framebuffer(zeros);
+    // Blanked in place: the shadow is what a blank panel shows
+    shadow_.assign(static_cast<size_t>(w_ * (h_/8)), 0x00);
+    set_framebuffer(shadow_);
 }
 
 void St7565::set_framebuffer(const std::vector<uint8_t>& fb) {
     if ((int)fb.size() != w_ * (h_/8)) throw std::runtime_error("Framebuffer size mismatch");
     for (int page = 0; page < (h_/8); ++page) {
-        cmd(0xB0 | page);
-        cmd(0x10);
-        cmd(0x00);
+        // Page and column address in one write (all on the command path)
+        const uint8_t addr[] = {
+            static_cast<uint8_t>(0xB0 | page),
+            static_cast<uint8_t>(0x10 | ((col_offset_ >> 4) & 0x0F)), // column address high nibble
+            static_cast<uint8_t>(0x00 | (col_offset_ & 0x0F)),        // column address low nibble
+        };
+        cmds(addr, sizeof(addr));
         const uint8_t* row = fb.data() + (page * w_);
         data(row, (size_t)w_);
     }
+    if (&fb != &shadow_) shadow_ = fb;
 }
@@ -0,0 +1,28 @@
+#include "st7789.h"
+
+#include <iterator>
+
+namespace {
+// Default configuration, replaceable with set_init_sequence()
+constexpr InitStep kConfig[] = {
+    {0x3A, 1, {0x55}, 0},  // COLMOD: 16 bit/pixel (RGB565)
+    {0x21, 0, {}, 0},      // Display inversion on (IPS modules are wired inverted)
+    {0x13, 0, {}, 0},      // Normal display mode
+};
+}
+
+// ST7789 datasheet: 120 ms after reset/SWRESET before Sleep Out, 5 ms after
+// Sleep Out before the next command.
+const TftController St7789::kController = {
+    "ST7789",
+    240, 320,
+    2,
+    {0x00, 0x60, 0xC0, 0xA0},  // RGB order; MX+MV; MY+MX; MY+MV
+    kConfig, std::size(kConfig),
+    120,
+    5,
+};
+
+St7789::St7789(SpiLinux& spi, GpioLine& dc, GpioLine& rst, int width, int height,
+               uint8_t rotation)
+    : TftPanel(kController, spi, dc, rst, width, height, rotation) {}
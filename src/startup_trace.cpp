@@ -0,0 +1,81 @@
+#include "startup_trace.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+// Seconds since boot at which this process started, -1 if unknown
+double process_start_s() {
+    std::ifstream f("/proc/self/stat");
+    std::string stat;
+    if (!f || !std::getline(f, stat)) return -1.0;
+    // The command name may contain spaces; fields restart after its ')'
+    const size_t close = stat.rfind(')');
+    if (close == std::string::npos) return -1.0;
+    std::istringstream rest(stat.substr(close + 2));
+    std::string field;
+    // starttime is field 22; field 3 (state) is the first after the name
+    for (int i = 3; i < 22 && rest >> field; ++i) {}
+    unsigned long long ticks = 0;
+    if (!(rest >> ticks)) return -1.0;
+    const long hz = sysconf(_SC_CLK_TCK);
+    return hz > 0 ? static_cast<double>(ticks) / static_cast<double>(hz) : -1.0;
+}
+
+double boottime_s() {
+    timespec ts{};
+    if (clock_gettime(CLOCK_BOOTTIME, &ts) != 0) return -1.0;
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+} // namespace
+
+StartupTrace::StartupTrace() : origin_(Clock::now()) {
+    const double start = process_start_s();
+    const double now = boottime_s();
+    if (start >= 0.0 && now >= start) {
+        construct_ms_ = (now - start) * 1000.0;
+        origin_ -= std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(construct_ms_));
+    }
+}
+
+double StartupTrace::elapsed_ms() const {
+    return std::chrono::duration<double, std::milli>(Clock::now() - origin_).count();
+}
+
+void StartupTrace::mark(const std::string& what) {
+    const double t = elapsed_ms();
+    std::lock_guard<std::mutex> lock(mutex_);
+    marks_.push_back({t, what});
+}
+
+std::vector<StartupTrace::Mark> StartupTrace::marks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return marks_;
+}
+
+double StartupTrace::time_of(const std::string& what) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Mark& m : marks_) {
+        if (m.what == what) return m.t_ms;
+    }
+    return -1.0;
+}
+
+void StartupTrace::print(std::ostream& os) const {
+    const std::vector<Mark> ms = marks();
+    char line[160];
+    std::snprintf(line, sizeof(line), "%9.1f ms            process start -> main\n", construct_ms_);
+    os << "Startup timeline\n" << line;
+    double prev = construct_ms_;
+    for (const Mark& m : ms) {
+        std::snprintf(line, sizeof(line), "%9.1f ms  %+8.1f  %s\n", m.t_ms, m.t_ms - prev, m.what.c_str());
+        os << line;
+        prev = m.t_ms;
+    }
+}
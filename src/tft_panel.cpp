@@ -0,0 +1,370 @@
+#include "tft_panel.h"
+#include "mono_kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr uint8_t kMadctlMY = 0x80;
+constexpr uint8_t kMadctlMX = 0x40;
+constexpr uint8_t kMadctlMV = 0x20;
+
+// Read cycle limit of the DCS controllers here (150 ns SCL period)
+constexpr uint32_t kReadHz = 6000000;
+
+// Sleep In to Sleep Out (or anything else): the supply settles and the
+// next SLPOUT is only accepted 120 ms after SLPIN
+constexpr uint16_t kSleepInMs = 120;
+
+// RDDST bits
+constexpr uint32_t kStatusMadctlShift = 25;  // D30..D25: MY MX MV ML BGR MH
+constexpr uint32_t kStatusPixelShift = 20;   // D22..D20: interface pixel format
+constexpr uint32_t kStatusIdle = 1u << 19;
+constexpr uint32_t kStatusPartial = 1u << 18;
+constexpr uint32_t kStatusSleepOut = 1u << 17;
+constexpr uint32_t kStatusNormal = 1u << 16;
+constexpr uint32_t kStatusAllOn = 1u << 12;
+constexpr uint32_t kStatusAllOff = 1u << 11;
+constexpr uint32_t kStatusDisplayOn = 1u << 10;
+constexpr uint32_t kStatusTearOn = 1u << 9;
+
+} // namespace
+
+TftPanel::TftPanel(const TftController& controller, SpiLinux& spi, GpioLine& dc, GpioLine& rst,
+                   int width, int height, uint8_t rotation)
+    : ctl_(controller), spi_(spi), dc_(dc), rst_(rst), w_(width), h_(height),
+      rotation_(static_cast<uint8_t>(rotation % 4)),
+      config_(controller.config, controller.config + controller.config_count) {}
+
+void TftPanel::cmd(uint8_t b) {
+    pacer_.wait();
+    dc_.set(false);
+    spi_.write(&b, 1);
+}
+
+void TftPanel::data(const uint8_t* p, size_t n) {
+    dc_.set(true);
+    spi_.write(p, n);
+}
+
+void TftPanel::reset() {
+    rst_.set(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1)); // >= 10 us pulse
+    rst_.set(true);
+    // Reset cancel: a few ms before commands, longer before Sleep Out,
+    // which init() sends first
+    pacer_.delay(std::chrono::milliseconds(ctl_.reset_ms));
+    hw_reset_ = true;
+}
+
+void TftPanel::init(bool on) {
+    std::vector<InitStep> steps;
+    if (!hw_reset_) steps.push_back({0x01, 0, {}, ctl_.reset_ms});  // SWRESET
+    hw_reset_ = false;
+    steps.push_back({0x11, 0, {}, ctl_.sleep_out_ms});              // Sleep out
+    steps.insert(steps.end(), config_.begin(), config_.end());
+    steps.push_back(madctl_step());
+    if (tear_effect_) steps.push_back(tear_step());
+    if (on) steps.push_back({0x29, 0, {}, 0});                      // Display on
+    run_steps(steps);
+    on_ = on;
+    sleeping_ = false;
+}
+
+void TftPanel::resume(bool on) {
+    std::vector<InitStep> steps(config_);
+    steps.push_back(madctl_step());
+    if (tear_effect_) steps.push_back(tear_step());
+    // Ignored when the panel is awake; wakes it if something put it to sleep
+    steps.push_back({0x11, 0, {}, ctl_.sleep_out_ms});
+    if (on) steps.push_back({0x29, 0, {}, 0});
+    run_steps(steps);
+    on_ = on;
+    sleeping_ = false;
+}
+
+void TftPanel::set_init_sequence(std::vector<InitStep> steps) {
+    config_ = std::move(steps);
+}
+
+void TftPanel::run_steps(const std::vector<InitStep>& steps) {
+    run_init_steps(steps, ParamPath::Data, pacer_, [this](bool dc, const uint8_t* p, size_t n) {
+        dc_.set(dc);
+        spi_.write(p, n);
+    });
+}
+
+void TftPanel::display_on(bool on) {
+    cmd(on ? 0x29 : 0x28); // Display on / off
+    on_ = on;
+}
+
+void TftPanel::sleep(bool on) {
+    if (on == sleeping_) return;
+    std::vector<InitStep> steps;
+    if (on) {
+        steps.push_back({0x28, 0, {}, 0});                  // Display off
+        steps.push_back({0x10, 0, {}, kSleepInMs});         // Sleep in
+    } else {
+        steps.push_back({0x11, 0, {}, ctl_.sleep_out_ms});  // Sleep out
+        if (on_) steps.push_back({0x29, 0, {}, 0});
+    }
+    run_steps(steps);
+    sleeping_ = on;
+}
+
+uint32_t TftPanel::read_status() {
+    // The 32 status bits follow the command byte after one dummy clock
+    pacer_.wait();
+    dc_.set(false);
+    const uint8_t tx[6] = {0x09, 0, 0, 0, 0, 0};  // RDDST
+    uint8_t rx[6] = {};
+    spi_.transfer(tx, rx, sizeof(tx), kReadHz);
+    uint64_t bits = 0;
+    for (size_t i = 1; i < sizeof(rx); ++i) bits = (bits << 8) | rx[i];
+    return static_cast<uint32_t>(bits >> 7);
+}
+
+PanelHealth TftPanel::health(const TftController& ctl, uint8_t rotation, bool on,
+                             bool tear_effect, uint32_t status) {
+    // A reset controller is back in Sleep In with GRAM undefined
+    if (!(status & kStatusSleepOut)) return PanelHealth::Lost;
+
+    const uint32_t madctl = (ctl.madctl[rotation % 4] >> 2) & 0x3F;
+    const uint32_t pixel = ctl.bytes_per_pixel == 3 ? 0x6 : 0x5;
+    const uint32_t mask = (0x3Fu << kStatusMadctlShift) | (0x7u << kStatusPixelShift) |
+                          kStatusIdle | kStatusPartial | kStatusNormal | kStatusAllOn |
+                          kStatusAllOff | kStatusDisplayOn | kStatusTearOn;
+    const uint32_t expected = (madctl << kStatusMadctlShift) | (pixel << kStatusPixelShift) |
+                              kStatusNormal | (on ? kStatusDisplayOn : 0) |
+                              (tear_effect ? kStatusTearOn : 0);
+    return (status & mask) == expected ? PanelHealth::Ok : PanelHealth::Registers;
+}
+
+void TftPanel::reassert() {
+    if (sleeping_) return;
+    // Registers only: no SWRESET, no waits (see resend_steps)
+    std::vector<InitStep> steps = resend_steps(config_, 0x01, false);
+    steps.push_back(madctl_step());
+    steps.push_back(tear_step());
+    steps.push_back({0x13, 0, {}, 0});  // Normal display mode
+    steps.push_back({0x38, 0, {}, 0});  // Idle mode off
+    steps.push_back({static_cast<uint8_t>(on_ ? 0x29 : 0x28), 0, {}, 0});
+    run_steps(steps);
+}
+
+void TftPanel::restore() {
+    if (sleeping_) return;
+    std::vector<InitStep> steps;
+    steps.push_back({0x11, 0, {}, ctl_.sleep_out_ms});  // Sleep out
+    // A SWRESET here would put it back to sleep; the delays stay, the
+    // controller is coming up from a reset
+    const std::vector<InitStep> config = resend_steps(config_, 0x01, true);
+    steps.insert(steps.end(), config.begin(), config.end());
+    steps.push_back(madctl_step());
+    if (tear_effect_) steps.push_back(tear_step());
+    run_steps(steps);
+    // GRAM before Display On, so the glass never shows what the reset left
+    if (!shadow_.empty()) set_mono_framebuffer(shadow_, shadow_fg_, shadow_bg_);
+    if (on_) display_on(true);
+}
+
+void TftPanel::keep_shadow(const std::vector<uint8_t>& fb, const Rect& rect, uint16_t fg_color565,
+                           uint16_t bg_color565) {
+    shadow_fg_ = fg_color565;
+    shadow_bg_ = bg_color565;
+    if (&fb == &shadow_) return;
+    check_mono_geometry(fb, w_, h_, "keep_shadow");
+    const Rect r = rect.intersected(Rect{0, 0, w_, h_});
+    if (r.empty()) return;
+    if (shadow_.size() != fb.size()) shadow_.assign(fb.size(), 0x00);
+    // The pages the rect spans, its columns only
+    for (int page = r.y / 8; page <= (r.y + r.h - 1) / 8; ++page) {
+        const size_t at = static_cast<size_t>(page) * static_cast<size_t>(w_) + static_cast<size_t>(r.x);
+        std::memcpy(shadow_.data() + at, fb.data() + at, static_cast<size_t>(r.w));
+    }
+}
+
+InitStep TftPanel::madctl_step() const {
+    return InitStep{0x36, 1, {ctl_.madctl[rotation_]}, 0}; // MADCTL
+}
+
+InitStep TftPanel::tear_step() const {
+    if (tear_effect_) return InitStep{0x35, 1, {0x00}, 0};  // TEON, V-blank only
+    return InitStep{0x34, 0, {}, 0};                         // TEOFF
+}
+
+void TftPanel::set_tear_effect(bool on) {
+    tear_effect_ = on;
+    run_steps({tear_step()});
+}
+
+ScanSpan TftPanel::scan_span(const TftController& ctl, uint8_t rotation, int width, int height,
+                             const Rect& r) {
+    // Same row mapping as set_addr_window(): the row address is the
+    // logical y (x with MV), moved past the unused GRAM when MY mirrors it
+    const uint8_t m = ctl.madctl[rotation % 4];
+    const bool mv = (m & kMadctlMV) != 0;
+    const bool my = (m & kMadctlMY) != 0;
+    const int gap = std::max(0, ctl.gram_height - (mv ? width : height));
+    const int a0 = (mv ? r.x : r.y) + (my ? gap : 0);
+    const int a1 = a0 + (mv ? r.w : r.h) - 1;
+    ScanSpan s;
+    s.along_y = !mv;
+    s.reversed = my;
+    s.first = my ? ctl.gram_height - 1 - a1 : a0;
+    s.last = my ? ctl.gram_height - 1 - a0 : a1;
+    return s;
+}
+
+void TftPanel::set_rotation(uint8_t rotation) {
+    rotation_ = static_cast<uint8_t>(rotation % 4);
+    run_steps({madctl_step()});
+}
+
+void TftPanel::set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    // A glass smaller than the GRAM sits at GRAM row/column 0; mirrored
+    // axes move it to the far end of the address range.
+    const uint8_t m = ctl_.madctl[rotation_];
+    const bool mv = (m & kMadctlMV) != 0;
+    const int gap_x = std::max(0, ctl_.gram_width - (mv ? h_ : w_));
+    const int gap_y = std::max(0, ctl_.gram_height - (mv ? w_ : h_));
+    const int dx = mv ? ((m & kMadctlMY) ? gap_y : 0) : ((m & kMadctlMX) ? gap_x : 0);
+    const int dy = mv ? ((m & kMadctlMX) ? gap_x : 0) : ((m & kMadctlMY) ? gap_y : 0);
+    x0 = static_cast<uint16_t>(x0 + dx);
+    x1 = static_cast<uint16_t>(x1 + dx);
+    y0 = static_cast<uint16_t>(y0 + dy);
+    y1 = static_cast<uint16_t>(y1 + dy);
+
+    cmd(0x2A); // CASET
+    uint8_t col[] = {
+        static_cast<uint8_t>((x0 >> 8) & 0xFF),
+        static_cast<uint8_t>(x0 & 0xFF),
+        static_cast<uint8_t>((x1 >> 8) & 0xFF),
+        static_cast<uint8_t>(x1 & 0xFF),
+    };
+    data(col, sizeof(col));
+
+    cmd(0x2B); // PASET
+    uint8_t row[] = {
+        static_cast<uint8_t>((y0 >> 8) & 0xFF),
+        static_cast<uint8_t>(y0 & 0xFF),
+        static_cast<uint8_t>((y1 >> 8) & 0xFF),
+        static_cast<uint8_t>(y1 & 0xFF),
+    };
+    data(row, sizeof(row));
+
+    cmd(0x2C); // RAMWR
+}
+
+void TftPanel::fill(uint16_t color565) {
+    fill_rect(Rect{0, 0, w_, h_}, color565);
+}
+
+void TftPanel::fill_rect(const Rect& rect, uint16_t color565) {
+    const Rect r = rect.intersected(Rect{0, 0, w_, h_});
+    if (r.empty()) return;
+    const int bpp = ctl_.bytes_per_pixel;
+    uint8_t px[3];
+    mono_encode_pixel(color565, bpp, px);
+
+    std::vector<uint8_t> line(static_cast<size_t>(r.w) * static_cast<size_t>(bpp));
+    for (size_t i = 0; i < line.size(); i += static_cast<size_t>(bpp)) {
+        std::memcpy(line.data() + i, px, static_cast<size_t>(bpp));
+    }
+
+    set_addr_window(static_cast<uint16_t>(r.x), static_cast<uint16_t>(r.y),
+                    static_cast<uint16_t>(r.x + r.w - 1), static_cast<uint16_t>(r.y + r.h - 1));
+
+    // Queue the same scanline r.h times; SpiLinux packs them into as few
+    // SPI_IOC_MESSAGE calls as the spidev buffer allows.
+    std::vector<SpiSegment> lines(static_cast<size_t>(r.h), SpiSegment{line.data(), line.size()});
+    dc_.set(true);
+    spi_.write_segments(lines.data(), lines.size());
+}
+
+void TftPanel::check_mono_geometry(const std::vector<uint8_t>& mono_fb, int width, int height,
+                                   const char* who) {
+    if (width <= 0 || height <= 0 || (height % 8) != 0) {
+        throw std::runtime_error(std::string("Invalid framebuffer geometry for ") + who);
+    }
+    const size_t expected_size = static_cast<size_t>(width * (height / 8));
+    if (mono_fb.size() != expected_size) {
+        throw std::runtime_error(std::string("Framebuffer size mismatch in ") + who);
+    }
+}
+
+void TftPanel::expand_mono(const uint8_t* fb, int fb_width, const Rect& r, int bytes_per_pixel,
+                           uint16_t fg_color565, uint16_t bg_color565, uint8_t* out) {
+    if (r.empty()) return;
+    uint8_t fg[3], bg[3];
+    mono_encode_pixel(fg_color565, bytes_per_pixel, fg);
+    mono_encode_pixel(bg_color565, bytes_per_pixel, bg);
+    if (bytes_per_pixel == 2) {
+        mono_expand<2>(fb, fb_width, r, fg, bg, out);
+    } else if (bytes_per_pixel == 3) {
+        mono_expand<3>(fb, fb_width, r, fg, bg, out);
+    } else {
+        throw std::runtime_error("Unsupported TFT pixel size");
+    }
+}
+
+std::vector<uint8_t> TftPanel::mono_to_rgb565(const std::vector<uint8_t>& mono_fb,
+                                              int width,
+                                              int height,
+                                              uint16_t fg_color565,
+                                              uint16_t bg_color565) {
+    std::vector<uint8_t> out;
+    mono_to_rgb565(mono_fb, width, height, out, fg_color565, bg_color565);
+    return out;
+}
+
+void TftPanel::mono_to_rgb565(const std::vector<uint8_t>& mono_fb, int width, int height,
+                              std::vector<uint8_t>& out, uint16_t fg_color565,
+                              uint16_t bg_color565) {
+    check_mono_geometry(mono_fb, width, height, "mono_to_rgb565");
+    out.resize(static_cast<size_t>(width * height * 2));
+    expand_mono(mono_fb.data(), width, Rect{0, 0, width, height}, 2, fg_color565, bg_color565,
+                out.data());
+}
+
+void TftPanel::set_mono_framebuffer(const std::vector<uint8_t>& fb,
+                                    uint16_t fg_color565,
+                                    uint16_t bg_color565) {
+    check_mono_geometry(fb, w_, h_, "set_mono_framebuffer");
+    set_mono_region(fb, Rect{0, 0, w_, h_}, fg_color565, bg_color565);
+}
+
+void TftPanel::set_mono_region(const std::vector<uint8_t>& fb, const Rect& rect,
+                               uint16_t fg_color565, uint16_t bg_color565) {
+    check_mono_geometry(fb, w_, h_, "set_mono_region");
+    const Rect r = rect.intersected(Rect{0, 0, w_, h_});
+    if (r.empty()) return;
+    const int bpp = ctl_.bytes_per_pixel;
+    scratch_.resize(static_cast<size_t>(r.w) * static_cast<size_t>(r.h) * static_cast<size_t>(bpp));
+    expand_mono(fb.data(), w_, r, bpp, fg_color565, bg_color565, scratch_.data());
+    write_pixels(r, scratch_.data(), scratch_.size());
+    keep_shadow(fb, r, fg_color565, bg_color565);
+}
+
+void TftPanel::begin_pixels(const Rect& r) {
+    if (r.empty() || r.x < 0 || r.y < 0 || r.x + r.w > w_ || r.y + r.h > h_) {
+        throw std::runtime_error("Pixel window outside the panel");
+    }
+    set_addr_window(static_cast<uint16_t>(r.x), static_cast<uint16_t>(r.y),
+                    static_cast<uint16_t>(r.x + r.w - 1), static_cast<uint16_t>(r.y + r.h - 1));
+}
+
+void TftPanel::write_pixels(const Rect& r, const uint8_t* pixels, size_t n) {
+    if (n != static_cast<size_t>(std::max(r.w, 0)) * static_cast<size_t>(std::max(r.h, 0)) *
+                 static_cast<size_t>(ctl_.bytes_per_pixel)) {
+        throw std::runtime_error("Pixel data size mismatch");
+    }
+    begin_pixels(r);
+    // One write for the whole window; SpiLinux splits it to the spidev limit.
+    data(pixels, n);
+}
@@ -0,0 +1,335 @@
+#include "tft_presenter.h"
+#include "gpio_gpiod.h"
+#include "tft_panel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+} // namespace
+
+BandPipeline::BandPipeline(size_t band_capacity, Send send)
+    : capacity_(band_capacity), send_(std::move(send)) {
+    staging_[0].resize(capacity_);
+    staging_[1].resize(capacity_);
+    thread_ = std::thread([this] { loop(); });
+}
+
+BandPipeline::~BandPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    filled_.notify_all();
+    thread_.join();
+}
+
+void BandPipeline::loop() {
+    // Consumes the staging buffers in the order run() fills them
+    size_t slot = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        filled_.wait(lock, [&] { return stop_ || full_[slot]; });
+        if (stop_) return;
+
+        const bool skip = error_ != nullptr;  // an earlier band failed
+        lock.unlock();
+        const Clock::time_point t = Clock::now();
+        std::exception_ptr error;
+        if (!skip) {
+            try {
+                send_(staging_[slot].data(), len_[slot]);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        const double ms = ms_since(t);
+        lock.lock();
+
+        send_ms_ += ms;
+        if (error && !error_) error_ = error;
+        full_[slot] = false;
+        slot ^= 1;
+        drained_.notify_all();
+    }
+}
+
+void BandPipeline::run(size_t bands, const Convert& convert) {
+    const Clock::time_point start = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = nullptr;
+        send_ms_ = 0.0;
+    }
+
+    double convert_ms = 0.0;
+    std::exception_ptr error;
+    for (size_t i = 0; i < bands; ++i) {
+        {
+            // Wait for the sender to finish with this buffer
+            std::unique_lock<std::mutex> lock(mutex_);
+            drained_.wait(lock, [&] { return !full_[slot_] || error_; });
+            if (error_) break;
+        }
+
+        size_t n = 0;
+        const Clock::time_point t = Clock::now();
+        try {
+            n = convert(i, staging_[slot_].data());
+            if (n > capacity_) throw std::runtime_error("Band larger than the staging buffer");
+        } catch (...) {
+            error = std::current_exception();
+            break;
+        }
+        convert_ms += ms_since(t);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            len_[slot_] = n;
+            full_[slot_] = true;
+        }
+        filled_.notify_one();
+        slot_ ^= 1;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [&] { return !full_[0] && !full_[1]; });
+    if (!error) error = error_;
+    error_ = nullptr;
+
+    stats_.bands = bands;
+    stats_.convert_ms = convert_ms;
+    stats_.send_ms = send_ms_;
+    stats_.total_ms = ms_since(start);
+    lock.unlock();
+
+    if (error) std::rethrow_exception(error);
+}
+
+bool GpioVsync::next_edge(std::chrono::milliseconds timeout, Clock::time_point& at) {
+    // Queued edges are stale; the time is taken on wake-up because the
+    // kernel stamps v1 line events with CLOCK_REALTIME on older kernels
+    while (te_.wait_edge(std::chrono::nanoseconds(0))) te_.read_edge();
+    if (!te_.wait_edge(timeout)) return false;
+    at = Clock::now();
+    te_.read_edge();
+    return true;
+}
+
+TearSync::TearSync(VsyncSource& source, int scan_rows, Timing timing)
+    : source_(source), scan_rows_(std::max(1, scan_rows)), timing_(std::move(timing)) {
+    if (!timing_.now) timing_.now = [] { return Clock::now(); };
+    if (!timing_.sleep_until) timing_.sleep_until = [](Clock::time_point t) { std::this_thread::sleep_until(t); };
+}
+
+bool TearSync::measure_period(Clock::time_point& edge, std::chrono::milliseconds timeout) {
+    // A descheduled thread misses edges and sees a multiple of the
+    // period; the smallest of several gaps is the period itself
+    Clock::duration best = Clock::duration::max();
+    for (int i = 1; i < kMeasureEdges; ++i) {
+        Clock::time_point next;
+        if (!source_.next_edge(timeout, next) || next <= edge) return false;
+        best = std::min(best, next - edge);
+        edge = next;
+    }
+    period_ = best;
+    off_grid_ = 0;
+    return true;
+}
+
+bool TearSync::begin_frame(std::chrono::milliseconds timeout) {
+    Clock::time_point edge;
+    synced_ = source_.next_edge(timeout, edge);
+    if (!synced_) {
+        ++stats_.unsynced_frames;
+        return false;
+    }
+    if (period_ == Clock::duration::zero()) {
+        if (!measure_period(edge, timeout)) {
+            period_ = Clock::duration::zero();
+            synced_ = false;
+            ++stats_.unsynced_frames;
+            return false;
+        }
+    } else if (edge_ != Clock::time_point{}) {
+        // Whole periods since the last frame's edge refine the estimate;
+        // anything off the grid (a missed or spurious edge) is ignored,
+        // unless it keeps happening: then the estimate is the one off
+        // (a multiple of the period) and is measured again
+        const double gap = std::chrono::duration<double>(edge - edge_).count();
+        const double period = std::chrono::duration<double>(period_).count();
+        const double m = std::round(gap / period);
+        if (m >= 1.0 && m <= 64.0 && std::fabs(gap - m * period) < period / 8.0) {
+            const double refined = 0.875 * period + 0.125 * (gap / m);
+            period_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(refined));
+            off_grid_ = 0;
+        } else if (++off_grid_ >= 3 && !measure_period(edge, timeout)) {
+            period_ = Clock::duration::zero();
+            synced_ = false;
+            ++stats_.unsynced_frames;
+            return false;
+        }
+    }
+    edge_ = edge;
+    stats_.period_ms = std::chrono::duration<double, std::milli>(period_).count();
+    ++stats_.synced_frames;
+    return true;
+}
+
+std::optional<TearSync::Clock::time_point> TearSync::band_start(
+    Clock::time_point now, Clock::time_point edge, Clock::duration period, int scan_rows, int first,
+    int last, Clock::duration write, Clock::duration margin) {
+    if (period <= Clock::duration::zero() || scan_rows <= 0) return std::nullopt;
+    first = std::max(0, first);
+    last = std::min(scan_rows - 1, last);
+    auto row_time = [&](int row) { return period * row / scan_rows; };
+
+    // Scan k passes row r at edge + k * period + row_time(r). The write
+    // fits after scan k leaves `last` and before scan k + 1 reaches `first`.
+    const Clock::duration open = row_time(last + 1) + margin;
+    const Clock::duration close = period + row_time(first) - write - margin;
+    if (close < open) return std::nullopt;
+
+    long long k = (now - edge) / period - 1;
+    for (;; ++k) {
+        const Clock::time_point lo = edge + period * k + open;
+        const Clock::time_point hi = edge + period * k + close;
+        const Clock::time_point start = std::max(lo, now);
+        if (start <= hi) return start;
+    }
+}
+
+void TearSync::wait_band(int first, int last, size_t bytes) {
+    if (!synced_) return;
+    const auto write = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::nano>(ns_per_byte_ * static_cast<double>(bytes)));
+    const Clock::time_point now = timing_.now();
+    const auto start = band_start(now, edge_, period_, scan_rows_, first, last, write, period_ / 32);
+    if (!start) {
+        ++stats_.missed_bands;
+        return;
+    }
+    if (*start > now) {
+        ++stats_.delayed_bands;
+        timing_.sleep_until(*start);
+    }
+}
+
+void TearSync::band_sent(size_t bytes, Clock::duration took) {
+    if (bytes == 0) return;
+    const double ns = std::chrono::duration<double, std::nano>(took).count() / static_cast<double>(bytes);
+    // The slowest recent band sets the pace: underestimating tears
+    ns_per_byte_ = ns_per_byte_ == 0.0 ? ns : std::max(ns, 0.9 * ns_per_byte_ + 0.1 * ns);
+}
+
+TftPresenter::TftPresenter(TftPanel& panel, int band_rows)
+    : panel_(panel),
+      band_rows_(std::max(1, band_rows)),
+      // Row bands, or column bands for a synced panel scanning along x
+      pipeline_(static_cast<size_t>(std::max(panel.width(), panel.height())) *
+                    static_cast<size_t>(band_rows_) * static_cast<size_t>(panel.bytes_per_pixel()),
+                [this](const uint8_t* p, size_t n) { send(p, n); }) {}
+
+void TftPresenter::set_vsync(VsyncSource* source) {
+    panel_.set_tear_effect(source != nullptr);
+    if (source) {
+        tear_ = std::make_unique<TearSync>(*source, panel_.controller().gram_height);
+    } else {
+        tear_.reset();
+    }
+}
+
+void TftPresenter::send(const uint8_t* p, size_t n) {
+    if (!tear_) {
+        panel_.stream_pixels(p, n);
+        return;
+    }
+    // Synced frame: bands are separate windows, written when the scan
+    // allows; the frame's edge is taken while the caller converts band 0
+    if (next_band_ == 0) tear_->begin_frame();
+    const Band& band = plan_[next_band_++];
+    tear_->wait_band(band.scan.first, band.scan.last, n);
+    const auto t = std::chrono::steady_clock::now();
+    panel_.begin_pixels(band.rect);
+    panel_.stream_pixels(p, n);
+    tear_->band_sent(n, std::chrono::steady_clock::now() - t);
+}
+
+void TftPresenter::present(const std::vector<uint8_t>& fb,
+                           uint16_t fg_color565,
+                           uint16_t bg_color565) {
+    present_region(fb, Rect{0, 0, panel_.width(), panel_.height()}, fg_color565, bg_color565);
+}
+
+void TftPresenter::present_region(const std::vector<uint8_t>& fb, const Rect& rect,
+                                  uint16_t fg_color565, uint16_t bg_color565) {
+    const int w = panel_.width();
+    const int h = panel_.height();
+    if ((h % 8) != 0 || fb.size() != static_cast<size_t>(w * (h / 8))) {
+        throw std::runtime_error("Framebuffer size mismatch in TftPresenter");
+    }
+    const Rect r = rect.intersected(Rect{0, 0, w, h});
+    if (r.empty()) return;
+
+    if (tear_) {
+        present_synced(fb, r, fg_color565, bg_color565);
+    } else {
+        const int bpp = panel_.bytes_per_pixel();
+        const size_t bands = static_cast<size_t>((r.h + band_rows_ - 1) / band_rows_);
+        panel_.begin_pixels(r);
+        // The lambda captures one reference, small enough for std::function
+        // to hold without a heap block on every frame
+        const struct {
+            const uint8_t* fb;
+            Rect r;
+            int w, bpp, rows;
+            uint16_t fg, bg;
+        } job{fb.data(), r, w, bpp, band_rows_, fg_color565, bg_color565};
+        pipeline_.run(bands, [&job](size_t i, uint8_t* out) {
+            const int y = job.r.y + static_cast<int>(i) * job.rows;
+            const Rect band{job.r.x, y, job.r.w, std::min(job.rows, job.r.y + job.r.h - y)};
+            TftPanel::expand_mono(job.fb, job.w, band, job.bpp, job.fg, job.bg, out);
+            return static_cast<size_t>(band.w) * static_cast<size_t>(band.h) * static_cast<size_t>(job.bpp);
+        });
+    }
+    // What restore() writes back after a discharge
+    panel_.keep_shadow(fb, r, fg_color565, bg_color565);
+}
+
+void TftPresenter::present_synced(const std::vector<uint8_t>& fb, const Rect& r,
+                                  uint16_t fg_color565, uint16_t bg_color565) {
+    // Bands across the scan axis, sent in the order the scan meets them
+    const bool along_y = panel_.scan_span(r).along_y;
+    const int extent = along_y ? r.h : r.w;
+    plan_.clear();
+    for (int o = 0; o < extent; o += band_rows_) {
+        const int n = std::min(band_rows_, extent - o);
+        const Rect band = along_y ? Rect{r.x, r.y + o, r.w, n} : Rect{r.x + o, r.y, n, r.h};
+        plan_.push_back(Band{band, panel_.scan_span(band)});
+    }
+    std::sort(plan_.begin(), plan_.end(),
+              [](const Band& a, const Band& b) { return a.scan.first < b.scan.first; });
+    next_band_ = 0;
+
+    // One captured reference, as in present_region()
+    const struct {
+        const uint8_t* fb;
+        const std::vector<Band>& plan;
+        int w, bpp;
+        uint16_t fg, bg;
+    } job{fb.data(), plan_, panel_.width(), panel_.bytes_per_pixel(), fg_color565, bg_color565};
+    pipeline_.run(plan_.size(), [&job](size_t i, uint8_t* out) {
+        const Rect& band = job.plan[i].rect;
+        TftPanel::expand_mono(job.fb, job.w, band, job.bpp, job.fg, job.bg, out);
+        return static_cast<size_t>(band.w) * static_cast<size_t>(band.h) * static_cast<size_t>(job.bpp);
+    });
+}
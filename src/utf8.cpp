@@ -0,0 +1,160 @@
+#include "utf8.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+#if !defined(__SSE2__) && defined(__ARM_NEON)
+// Any byte of v >= 0x80. vmaxvq_u8 is AArch64 only; 32-bit ARMv7 ORs the
+// two halves and tests the bits as one 64-bit lane.
+inline bool any_non_ascii(uint8x16_t v) {
+#if defined(__aarch64__)
+    return vmaxvq_u8(v) >= 0x80;
+#else
+    const uint8x8_t any = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+    return (vget_lane_u64(vreinterpret_u64_u8(any), 0) & 0x8080808080808080ULL) != 0;
+#endif
+}
+#endif
+
+// Length of the ASCII prefix of [p, end), widened into dst as it goes.
+size_t copy_ascii(const unsigned char* p, const unsigned char* end, char32_t* dst) {
+    const unsigned char* start = p;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if (_mm_movemask_epi8(v) != 0) break;
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        char32_t* d = dst + (p - start);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 0), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 12), _mm_unpackhi_epi16(hi, zero));
+        p += 16;
+    }
+#elif defined(__ARM_NEON)
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8(p);
+        if (any_non_ascii(v)) break;
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        uint32_t* d = reinterpret_cast<uint32_t*>(dst + (p - start));
+        vst1q_u32(d + 0, vmovl_u16(vget_low_u16(lo)));
+        vst1q_u32(d + 4, vmovl_u16(vget_high_u16(lo)));
+        vst1q_u32(d + 8, vmovl_u16(vget_low_u16(hi)));
+        vst1q_u32(d + 12, vmovl_u16(vget_high_u16(hi)));
+        p += 16;
+    }
+#else
+    while (end - p >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, sizeof(w));
+        if (w & 0x8080808080808080ULL) break;
+        char32_t* d = dst + (p - start);
+        for (int k = 0; k < 8; ++k) d[k] = p[k];
+        p += 8;
+    }
+#endif
+    while (p < end && *p < 0x80) {
+        dst[p - start] = *p;
+        ++p;
+    }
+    return static_cast<size_t>(p - start);
+}
+
+inline bool is_cont(unsigned char b) { return (b & 0xC0) == 0x80; }
+
+// Decode one non-ASCII sequence at p (p < end, *p >= 0x80).
+// On success stores the codepoint and the sequence length in `used`.
+// On failure stores U+FFFD and the length of the maximal ill-formed
+// subpart (>= 1), and returns false.
+bool decode_seq(const unsigned char* p, const unsigned char* end, char32_t& cp, size_t& used) {
+    const unsigned char c = p[0];
+    size_t need;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    uint32_t v;
+
+    if (c >= 0xC2 && c <= 0xDF) {
+        need = 1; v = c & 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        need = 2; v = c & 0x0F;
+        if (c == 0xE0) lo = 0xA0;        // overlong
+        else if (c == 0xED) hi = 0x9F;   // surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        need = 3; v = c & 0x07;
+        if (c == 0xF0) lo = 0x90;        // overlong
+        else if (c == 0xF4) hi = 0x8F;   // above U+10FFFF
+    } else {
+        // Stray continuation byte, C0/C1 (always overlong) or F5..FF
+        cp = kUtf8Replacement;
+        used = 1;
+        return false;
+    }
+
+    size_t i = 1;
+    for (; i <= need; ++i) {
+        if (p + i >= end) break;
+        const unsigned char b = p[i];
+        if (i == 1 ? (b < lo || b > hi) : !is_cont(b)) break;
+        v = (v << 6) | (b & 0x3F);
+    }
+    if (i <= need) {
+        cp = kUtf8Replacement;
+        used = i;
+        return false;
+    }
+    cp = v;
+    used = need + 1;
+    return true;
+}
+
+} // namespace
+
+size_t utf8_decode(const char* data, size_t len, std::u32string& out) {
+    // Never more codepoints than bytes; shrink once at the end.
+    out.resize(len);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    char32_t* dst = &out[0];
+    size_t n = 0;
+    size_t errors = 0;
+
+    while (p < end) {
+        size_t ascii = copy_ascii(p, end, dst + n);
+        p += ascii;
+        n += ascii;
+        // Non-ASCII runs (e.g. Cyrillic) are decoded until ASCII resumes.
+        while (p < end && *p >= 0x80) {
+            char32_t cp;
+            size_t used;
+            if (!decode_seq(p, end, cp, used)) ++errors;
+            dst[n++] = cp;
+            p += used;
+        }
+    }
+
+    out.resize(n);
+    return errors;
+}
+
+bool utf8_valid(const char* data, size_t len) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    while (p < end) {
+        if (*p < 0x80) { ++p; continue; }
+        char32_t cp;
+        size_t used;
+        if (!decode_seq(p, end, cp, used)) return false;
+        p += used;
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(size_t workers) {
+    threads_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) threads_.emplace_back([this] { loop(); });
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void WorkerPool::work(std::unique_lock<std::mutex>& lock) {
+    // Takes indices until none are left; `lock` is held on entry and exit
+    while (next_ < count_) {
+        const size_t i = next_++;
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            (*task_)(i);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error && !error_) error_ = error;
+        ++finished_;
+    }
+}
+
+void WorkerPool::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t seen = generation_;
+    while (true) {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        ++busy_;
+        work(lock);
+        --busy_;
+        if (finished_ == count_ && busy_ == 0) done_.notify_all();
+    }
+}
+
+void WorkerPool::run(size_t n, const std::function<void(size_t)>& task) {
+    if (n == 0) return;
+    if (threads_.empty() || n == 1) {
+        for (size_t i = 0; i < n; ++i) task(i);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = n;
+    next_ = 0;
+    finished_ = 0;
+    error_ = nullptr;
+    ++generation_;
+    wake_.notify_all();
+
+    // The caller takes indices too, then waits for the workers to let go
+    // of `task`, which dies with this call
+    work(lock);
+    done_.wait(lock, [&] { return finished_ == count_ && busy_ == 0; });
+    task_ = nullptr;
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    lock.unlock();
+    if (error) std::rethrow_exception(error);
+}
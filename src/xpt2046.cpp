@@ -0,0 +1,296 @@
+#include "xpt2046.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+// Control byte: S | A2..A0 | 12-bit | differential | PD1..PD0. PD = 01
+// keeps the ADC on and PENIRQ off between the conversions of a burst;
+// the last one powers down (PD = 00), which re-enables PENIRQ.
+constexpr uint8_t kReadZ1 = 0xB1;
+constexpr uint8_t kReadZ2 = 0xC1;
+constexpr uint8_t kReadX = 0xD1;
+constexpr uint8_t kReadY = 0x91;
+constexpr uint8_t kPowerDown = 0xFC;  // clears PD on the last command
+constexpr int kFullScale = 4095;
+
+constexpr uint8_t kMadctlMY = 0x80;
+constexpr uint8_t kMadctlMX = 0x40;
+constexpr uint8_t kMadctlMV = 0x20;
+
+// x' = a*x + b*y + c, y' = d*x + e*y + f
+struct Affine {
+    double a, b, c;
+    double d, e, f;
+};
+
+Affine compose(const Affine& outer, const Affine& inner) {
+    return {outer.a * inner.a + outer.b * inner.d, outer.a * inner.b + outer.b * inner.e,
+            outer.a * inner.c + outer.b * inner.f + outer.c,
+            outer.d * inner.a + outer.e * inner.d, outer.d * inner.b + outer.e * inner.e,
+            outer.d * inner.c + outer.e * inner.f + outer.f};
+}
+
+Affine invert(const Affine& m) {
+    const double det = m.a * m.e - m.b * m.d;
+    const double a = m.e / det, b = -m.b / det, d = -m.d / det, e = m.a / det;
+    return {a, b, -(a * m.c + b * m.f), d, e, -(d * m.c + e * m.f)};
+}
+
+// Logical pixel to glass pixel (GRAM orientation) for one MADCTL value;
+// the same exchange and mirroring as TftPanel's address window
+Affine logical_to_glass(uint8_t madctl, int glass_w, int glass_h) {
+    const bool mv = (madctl & kMadctlMV) != 0;
+    // Column address c and row address a from logical x, y
+    Affine m = mv ? Affine{0, 1, 0, 1, 0, 0} : Affine{1, 0, 0, 0, 1, 0};
+    if (madctl & kMadctlMX) m = compose(Affine{-1, 0, glass_w - 1.0, 0, 1, 0}, m);
+    if (madctl & kMadctlMY) m = compose(Affine{1, 0, 0, 0, -1, glass_h - 1.0}, m);
+    return m;
+}
+
+double det3(double a, double b, double c, double d, double e, double f, double g, double h,
+            double i) {
+    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+} // namespace
+
+TouchCalibration TouchCalibration::from_range(int raw_x0, int raw_x1, int raw_y0, int raw_y1,
+                                              int width, int height, bool swap_xy) {
+    if (raw_x0 == raw_x1 || raw_y0 == raw_y1 || width <= 0 || height <= 0) {
+        throw std::runtime_error("Touch calibration range is empty");
+    }
+    // Raw X spans columns, or rows with swap_xy; raw Y the other axis
+    const int span_x = swap_xy ? height : width;
+    const int span_y = swap_xy ? width : height;
+    const double sx = (span_x - 1.0) / (raw_x1 - raw_x0);
+    const double sy = (span_y - 1.0) / (raw_y1 - raw_y0);
+    TouchCalibration c;
+    c.width = width;
+    c.height = height;
+    if (swap_xy) {
+        c.ax = 0.0; c.bx = sy; c.cx = -sy * raw_y0;
+        c.ay = sx; c.by = 0.0; c.cy = -sx * raw_x0;
+    } else {
+        c.ax = sx; c.bx = 0.0; c.cx = -sx * raw_x0;
+        c.ay = 0.0; c.by = sy; c.cy = -sy * raw_y0;
+    }
+    return c;
+}
+
+TouchCalibration TouchCalibration::from_points(const TouchPoint raw[3], const TouchPoint screen[3],
+                                               int width, int height) {
+    // Solve [rx ry 1] * (a, b, c) = s for each screen axis (Cramer's rule)
+    const double det = det3(raw[0].x, raw[0].y, 1, raw[1].x, raw[1].y, 1, raw[2].x, raw[2].y, 1);
+    if (std::fabs(det) < 1.0 || width <= 0 || height <= 0) {
+        throw std::runtime_error("Touch calibration points are in a line");
+    }
+    auto solve = [&](double s0, double s1, double s2, double& a, double& b, double& c) {
+        a = det3(s0, raw[0].y, 1, s1, raw[1].y, 1, s2, raw[2].y, 1) / det;
+        b = det3(raw[0].x, s0, 1, raw[1].x, s1, 1, raw[2].x, s2, 1) / det;
+        c = det3(raw[0].x, raw[0].y, s0, raw[1].x, raw[1].y, s1, raw[2].x, raw[2].y, s2) / det;
+    };
+    TouchCalibration c;
+    c.width = width;
+    c.height = height;
+    solve(screen[0].x, screen[1].x, screen[2].x, c.ax, c.bx, c.cx);
+    solve(screen[0].y, screen[1].y, screen[2].y, c.ay, c.by, c.cy);
+    return c;
+}
+
+TouchCalibration TouchCalibration::rotated(const TftController& ctl, uint8_t from, uint8_t to) const {
+    const uint8_t m_from = ctl.madctl[from % 4];
+    const uint8_t m_to = ctl.madctl[to % 4];
+    const bool mv_from = (m_from & kMadctlMV) != 0;
+    const bool mv_to = (m_to & kMadctlMV) != 0;
+    const int glass_w = mv_from ? height : width;
+    const int glass_h = mv_from ? width : height;
+
+    // raw -> logical(from) -> glass -> logical(to)
+    const Affine raw{ax, bx, cx, ay, by, cy};
+    const Affine to_glass = logical_to_glass(m_from, glass_w, glass_h);
+    const Affine from_glass = invert(logical_to_glass(m_to, glass_w, glass_h));
+    const Affine m = compose(from_glass, compose(to_glass, raw));
+
+    TouchCalibration c;
+    c.ax = m.a; c.bx = m.b; c.cx = m.c;
+    c.ay = m.d; c.by = m.e; c.cy = m.f;
+    c.width = mv_to ? glass_h : glass_w;
+    c.height = mv_to ? glass_w : glass_h;
+    return c;
+}
+
+TouchPoint TouchCalibration::map(int raw_x, int raw_y) const {
+    const long x = std::lround(ax * raw_x + bx * raw_y + cx);
+    const long y = std::lround(ay * raw_x + by * raw_y + cy);
+    return TouchPoint{static_cast<int>(std::clamp(x, 0L, static_cast<long>(width - 1))),
+                      static_cast<int>(std::clamp(y, 0L, static_cast<long>(height - 1)))};
+}
+
+Xpt2046::Xpt2046(SpiLinux& spi, GpioLine* penirq) : spi_(spi), penirq_(penirq) {
+    set_samples(samples_);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0) throw std::runtime_error("XPT2046: eventfd failed");
+}
+
+Xpt2046::~Xpt2046() {
+    try {
+        stop();
+    } catch (...) {
+        // An SPI error nobody collected; nothing to report it to
+    }
+    close(stop_fd_);
+}
+
+void Xpt2046::set_calibration(const TouchCalibration& cal) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cal_ = cal;
+}
+
+TouchCalibration Xpt2046::calibration() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cal_;
+}
+
+void Xpt2046::set_samples(int n) {
+    if (n < 1 || n > kMaxSamples) throw std::runtime_error("XPT2046 samples out of range");
+    samples_ = n;
+
+    // Z1, Z2, then X and Y each once more than n: the first conversion
+    // after a channel switch is still settling and is thrown away. Three
+    // bytes per conversion: the command, then 12 bits and 3 padding bits.
+    std::vector<uint8_t> cmds{kReadZ1, kReadZ2};
+    cmds.insert(cmds.end(), static_cast<size_t>(n + 1), kReadX);
+    cmds.insert(cmds.end(), static_cast<size_t>(n + 1), kReadY);
+    cmds.back() &= kPowerDown;
+    tx_.assign(cmds.size() * 3, 0x00);
+    rx_.assign(tx_.size(), 0x00);
+    for (size_t i = 0; i < cmds.size(); ++i) tx_[i * 3] = cmds[i];
+}
+
+TouchState Xpt2046::read(TouchSample& out) {
+    spi_.transfer(tx_.data(), rx_.data(), tx_.size());
+    auto value = [this](size_t conversion) {
+        const size_t i = conversion * 3;
+        return ((rx_[i + 1] << 8) | rx_[i + 2]) >> 3 & kFullScale;
+    };
+
+    // Plate resistance falls as Z1 rises and Z2 drops
+    const int z = value(0) + kFullScale - value(1);
+    if (z < threshold_) return TouchState::Released;
+
+    // Sort each axis and average the middle half; a wide spread there
+    // means the pen moved or lifted during the burst
+    const size_t n = static_cast<size_t>(samples_);
+    const size_t drop = n / 4;
+    bool stable = true;
+    auto axis = [&](size_t first) {
+        int v[kMaxSamples];
+        for (size_t i = 0; i < n; ++i) v[i] = value(first + 1 + i);
+        std::sort(v, v + n);
+        int sum = 0;
+        for (size_t i = drop; i < n - drop; ++i) sum += v[i];
+        if (v[n - drop - 1] - v[drop] > max_spread_) stable = false;
+        const int kept = static_cast<int>(n - 2 * drop);
+        return (sum + kept / 2) / kept;
+    };
+    const int x = axis(2);
+    const int y = axis(2 + n + 1);
+    if (!stable) return TouchState::Unstable;
+    out.x = x;
+    out.y = y;
+    out.z = z;
+    return TouchState::Pressed;
+}
+
+void Xpt2046::start(Handler handler) {
+    if (running()) throw std::runtime_error("XPT2046 reader already running");
+    handler_ = std::move(handler);
+    stop_ = false;
+    error_ = nullptr;
+    uint64_t stale = 0;
+    while (::read(stop_fd_, &stale, sizeof(stale)) > 0) {
+    }
+    thread_ = std::thread([this] { loop(); });
+}
+
+void Xpt2046::stop() {
+    if (!running()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    const uint64_t one = 1;
+    ssize_t r = ::write(stop_fd_, &one, sizeof(one));
+    (void)r;
+    thread_.join();
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    if (error) std::rethrow_exception(error);
+}
+
+void Xpt2046::loop() {
+    bool pen = false;   // on the plate at the last reading
+    bool down = false;  // Down reported, Up not yet
+    TouchPoint last;
+    try {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) return;
+            }
+            if (!pen && penirq_) {
+                // Idle until pen-down or stop(), with no timeout: an idle
+                // panel costs no wakeups. Edges queued meanwhile are one touch
+                pollfd fds[2] = {{penirq_->event_fd(), POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+                if (poll(fds, 2, -1) < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error("XPT2046: poll on PENIRQ failed");
+                }
+                if (!(fds[0].revents & POLLIN)) continue;
+                while (penirq_->wait_edge(std::chrono::nanoseconds(0))) penirq_->read_edge();
+            }
+
+            TouchSample s;
+            const TouchState state = read(s);
+            TouchEvent ev;
+            ev.time = std::chrono::steady_clock::now();
+            bool emit = false;
+            if (state == TouchState::Pressed) {
+                const TouchPoint p = calibration().map(s.x, s.y);
+                emit = !down || p.x != last.x || p.y != last.y;
+                ev.action = down ? TouchAction::Move : TouchAction::Down;
+                ev.pos = p;
+                ev.pressure = s.z;
+                last = p;
+                down = true;
+            } else if (state == TouchState::Released && down) {
+                ev.action = TouchAction::Up;
+                ev.pos = last;
+                emit = true;
+                down = false;
+            }
+            pen = state != TouchState::Released;
+            if (emit) handler_(ev);
+
+            if (pen || !penirq_) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait_for(lock, interval_, [this] { return stop_; });
+            }
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::current_exception();
+    }
+}
+
+size_t Xpt2046::max_shared_message(uint32_t display_hz, std::chrono::microseconds wait) {
+    const double bytes = static_cast<double>(display_hz) / 8.0 * wait.count() / 1e6;
+    return std::max<size_t>(1, static_cast<size_t>(bytes));
+}
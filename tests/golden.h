@@ -0,0 +1,77 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "image_io.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Golden-image checks for gtest.
+//
+// EXPECT_TRUE(MatchesGolden("name", image)) compares against
+// tests/golden/<name>.pbm (mono) or .ppm (RGB). On a mismatch it writes
+// <name>.actual.png, <name>.expected.png and <name>.diff.png into
+// LCD_GOLDEN_OUT and reports where the pixels differ.
+//
+// Run the test with LCD_UPDATE_GOLDEN=1 to (re)write the golden files after
+// an intended rendering change; review them before committing.
+
+#ifndef LCD_GOLDEN_DIR
+#define LCD_GOLDEN_DIR "tests/golden"
+#endif
+#ifndef LCD_GOLDEN_OUT
+#define LCD_GOLDEN_OUT "golden_out"
+#endif
+
+namespace golden {
+
+inline std::string path_for(const std::string& name, const Image& img) {
+    return std::string(LCD_GOLDEN_DIR) + "/" + name + (img.channels == 3 ? ".ppm" : ".pbm");
+}
+
+inline bool update_requested() {
+    const char* v = std::getenv("LCD_UPDATE_GOLDEN");
+    return v != nullptr && *v != '\0' && std::string(v) != "0";
+}
+
+inline std::string write_artifacts(const std::string& name, const Image& actual, const Image* expected) {
+    const std::string dir = LCD_GOLDEN_OUT;
+    std::filesystem::create_directories(dir);
+    write_png(dir + "/" + name + ".actual.png", actual);
+    if (expected) {
+        write_png(dir + "/" + name + ".expected.png", *expected);
+        write_png(dir + "/" + name + ".diff.png", diff_image(*expected, actual));
+    }
+    return dir + "/" + name + ".*.png";
+}
+
+} // namespace golden
+
+inline ::testing::AssertionResult MatchesGolden(const std::string& name, const Image& actual,
+                                                int tolerance = 0) {
+    const std::string path = golden::path_for(name, actual);
+    if (golden::update_requested()) {
+        write_pnm(path, actual);
+        return ::testing::AssertionSuccess() << "updated " << path;
+    }
+    if (!std::ifstream(path).good()) {
+        const std::string out = golden::write_artifacts(name, actual, nullptr);
+        return ::testing::AssertionFailure()
+               << "no golden image " << path << " (actual written to " << out
+               << "; run with LCD_UPDATE_GOLDEN=1 to create it)";
+    }
+
+    const Image expected = read_pnm(path);
+    const ImageDiff d = compare_images(expected, actual, tolerance);
+    if (d.identical()) return ::testing::AssertionSuccess();
+
+    const std::string out = golden::write_artifacts(name, actual, &expected);
+    ::testing::AssertionResult r = ::testing::AssertionFailure();
+    r << name << ": " << d.summary();
+    if (d.size_mismatch) {
+        r << " (golden " << expected.width << "x" << expected.height << ", actual "
+          << actual.width << "x" << actual.height << ")";
+    }
+    return r << "; see " << out;
+}
@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include "animation.h"
+#include "frame_scheduler.h"
+#include "graphics.h"
+#include "sprite.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Scheduler on a fake clock: sleeping jumps straight to the deadline and
+// "work" advances the clock by hand.
+class FakeClockScheduler : public FrameScheduler {
+public:
+    explicit FakeClockScheduler(double fps) : FrameScheduler(fps) {}
+
+    int64_t clock{1000000000};
+    std::vector<int64_t> sleeps;
+
+    void work_ms(double ms) { clock += static_cast<int64_t>(ms * 1e6); }
+
+protected:
+    int64_t now_ns() const override { return clock; }
+    void sleep_until_ns(int64_t deadline_ns) override {
+        sleeps.push_back(deadline_ns);
+        if (deadline_ns > clock) clock = deadline_ns;
+    }
+};
+
+MonoSprite solid(int w, int h) {
+    MonoSprite s(w, h);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) s.set(x, y, true);
+    return s;
+}
+
+int count_on(const MonoGfx& g, const Rect& r) {
+    int n = 0;
+    for (int y = r.y; y < r.y + r.h; ++y)
+        for (int x = r.x; x < r.x + r.w; ++x) {
+            const auto& fb = g.fb();
+            if ((fb[static_cast<size_t>((y / 8) * g.width() + x)] >> (y % 8)) & 1u) ++n;
+        }
+    return n;
+}
+
+} // namespace
+
+TEST(FrameSchedulerTest, DeadlinesDoNotDriftWithWorkTime) {
+    FakeClockScheduler s(25.0);  // 40 ms period
+    const int64_t t0 = s.clock;
+    for (int i = 0; i < 50; ++i) {
+        FrameTick tick = s.wait_next();
+        EXPECT_EQ(tick.frame, static_cast<uint64_t>(i));
+        EXPECT_EQ(tick.skipped, 0u);
+        EXPECT_DOUBLE_EQ(tick.time, i * 0.04);
+        s.work_ms(7.3);  // odd render time must not accumulate
+        s.end_frame();
+    }
+    EXPECT_EQ(s.clock, t0 + 49 * 40000000LL + 7300000LL);
+    EXPECT_EQ(s.stats().frames, 50u);
+    EXPECT_EQ(s.stats().skipped, 0u);
+    EXPECT_EQ(s.stats().over_budget, 0u);
+    EXPECT_NEAR(s.stats().avg_busy_ms, 7.3, 1e-6);
+}
+
+TEST(FrameSchedulerTest, SkipsFramesWhenLate) {
+    FakeClockScheduler s(10.0);  // 100 ms period
+    s.wait_next();
+    s.work_ms(350.0);  // frames 1..3 are already past
+    s.end_frame();
+
+    FrameTick tick = s.wait_next();
+    EXPECT_EQ(tick.skipped, 3u);
+    EXPECT_EQ(tick.frame, 4u);
+    EXPECT_DOUBLE_EQ(tick.time, 0.4);
+    EXPECT_EQ(s.stats().skipped, 3u);
+    EXPECT_EQ(s.stats().over_budget, 1u);
+    EXPECT_NEAR(s.stats().max_busy_ms, 350.0, 1e-6);
+
+    // Back on schedule afterwards
+    s.work_ms(10.0);
+    tick = s.wait_next();
+    EXPECT_EQ(tick.skipped, 0u);
+    EXPECT_EQ(tick.frame, 5u);
+}
+
+TEST(FrameSchedulerTest, SlightlyLateFrameIsRenderedNotSkipped) {
+    FakeClockScheduler s(10.0);
+    s.wait_next();
+    s.work_ms(130.0);  // 30 ms into frame 1's slot
+    FrameTick tick = s.wait_next();
+    EXPECT_EQ(tick.skipped, 0u);
+    EXPECT_EQ(tick.frame, 1u);
+}
+
+TEST(FrameSchedulerTest, ChangingFpsKeepsTimeContinuous) {
+    FakeClockScheduler s(25.0);  // 40 ms period
+    FrameTick tick;
+    for (int i = 0; i <= 100; ++i) tick = s.wait_next();
+    EXPECT_DOUBLE_EQ(tick.time, 4.0);
+
+    // Frame 101 keeps its deadline; the 200 ms spacing starts after it
+    s.set_fps(5.0);
+    tick = s.wait_next();
+    EXPECT_EQ(tick.frame, 101u);
+    EXPECT_DOUBLE_EQ(tick.time, 4.04);
+    tick = s.wait_next();
+    EXPECT_EQ(tick.frame, 102u);
+    EXPECT_DOUBLE_EQ(tick.time, 4.24);
+
+    // And back, mid-run again
+    s.set_fps(25.0);
+    s.wait_next();
+    tick = s.wait_next();
+    EXPECT_EQ(tick.frame, 104u);
+    EXPECT_DOUBLE_EQ(tick.time, 4.48);
+    EXPECT_EQ(s.stats().skipped, 0u);
+}
+
+TEST(FrameSchedulerTest, RejectsNonPositiveFps) {
+    EXPECT_THROW(FrameScheduler(0.0), std::runtime_error);
+    FrameScheduler s(5.0);
+    EXPECT_THROW(s.set_fps(-1.0), std::runtime_error);
+    EXPECT_DOUBLE_EQ(s.budget_ms(), 200.0);
+}
+
+TEST(AnimationTest, EasingEndpointsAndTween) {
+    for (Easing e : {Easing::Linear, Easing::EaseIn, Easing::EaseOut, Easing::EaseInOut}) {
+        EXPECT_DOUBLE_EQ(ease(e, 0.0), 0.0);
+        EXPECT_DOUBLE_EQ(ease(e, 1.0), 1.0);
+        EXPECT_DOUBLE_EQ(ease(e, -3.0), 0.0);
+        EXPECT_DOUBLE_EQ(ease(e, 7.0), 1.0);
+    }
+    EXPECT_DOUBLE_EQ(ease(Easing::EaseInOut, 0.5), 0.5);
+
+    Tween tw{10.0, 30.0, 2.0, 4.0, Easing::Linear};
+    EXPECT_DOUBLE_EQ(tw.value(0.0), 10.0);
+    EXPECT_DOUBLE_EQ(tw.value(4.0), 20.0);
+    EXPECT_DOUBLE_EQ(tw.value(9.0), 30.0);
+    EXPECT_FALSE(tw.done(5.9));
+    EXPECT_TRUE(tw.done(6.0));
+}
+
+TEST(AnimationTest, MarqueeOffsetWraps) {
+    EXPECT_EQ(marquee_offset(0.0, 20.0, 100), 0);
+    EXPECT_EQ(marquee_offset(1.0, 20.0, 100), 20);
+    EXPECT_EQ(marquee_offset(5.5, 20.0, 100), 10);
+    EXPECT_EQ(marquee_offset(3.0, 20.0, 0), 0);
+}
+
+TEST(AnimationTest, BlinkChangesOnlyOnEdges) {
+    BlinkAnimation blink(solid(4, 4), 2, 3, 1.0);
+    MonoGfx g(16, 16);
+    EXPECT_TRUE(blink.update(0.0));  // first update always draws
+    blink.draw(g);
+    EXPECT_EQ(count_on(g, blink.bounds()), 16);
+
+    EXPECT_FALSE(blink.update(0.2));
+    EXPECT_TRUE(blink.update(0.6));
+    blink.draw(g);
+    EXPECT_EQ(count_on(g, blink.bounds()), 0);
+    EXPECT_FALSE(blink.update(0.9));
+    EXPECT_TRUE(blink.update(1.1));
+}
+
+TEST(AnimationTest, MarqueeShowsWindowOfStripAndWraps) {
+    // Strip: a single lit column at x = 0, 40 px wide, gap 10 => period 50
+    MonoSprite strip(40, 8);
+    for (int y = 0; y < 8; ++y) strip.set(0, y, true);
+    const Rect window{4, 8, 20, 8};
+    MarqueeAnimation m(strip, window, 10.0, 10);
+    MonoGfx g(32, 16);
+
+    ASSERT_TRUE(m.update(0.0));
+    m.draw(g);
+    EXPECT_EQ(count_on(g, {4, 8, 1, 8}), 8);
+    EXPECT_EQ(count_on(g, window), 8);
+
+    // 4.5 s at 10 px/s => offset 45: the wrapped copy starts at 40 + 10 - 45 = 5
+    ASSERT_TRUE(m.update(4.5));
+    EXPECT_EQ(m.offset(), 45);
+    m.draw(g);
+    EXPECT_EQ(count_on(g, {9, 8, 1, 8}), 8);
+    EXPECT_EQ(count_on(g, window), 8);
+    EXPECT_FALSE(m.update(4.51));
+}
+
+TEST(AnimationTest, MarqueeThatFitsStaysStill) {
+    MarqueeAnimation m(solid(10, 8), {0, 0, 20, 8}, 30.0);
+    EXPECT_TRUE(m.update(0.0));
+    EXPECT_FALSE(m.update(10.0));
+    EXPECT_EQ(m.offset(), 0);
+}
+
+TEST(AnimationTest, SlideMovesBetweenSprites) {
+    const Rect area{0, 0, 20, 8};
+    SlideAnimation slide(area, 1.0, SlideDirection::Left, Easing::Linear);
+    slide.show(solid(20, 8));
+    MonoGfx g(20, 8);
+
+    ASSERT_TRUE(slide.update(0.0));
+    slide.draw(g);
+    EXPECT_EQ(count_on(g, area), 160);
+
+    slide.slide_to(MonoSprite(20, 8), 1.0);  // blank sprite slides in
+    ASSERT_TRUE(slide.update(1.5));
+    slide.draw(g);
+    // Halfway: left half still shows the outgoing sprite
+    EXPECT_EQ(count_on(g, {0, 0, 10, 8}), 80);
+    EXPECT_EQ(count_on(g, {10, 0, 10, 8}), 0);
+
+    ASSERT_TRUE(slide.update(2.0));
+    EXPECT_FALSE(slide.sliding());
+    slide.draw(g);
+    EXPECT_EQ(count_on(g, area), 0);
+    EXPECT_FALSE(slide.update(3.0));
+}
+
+TEST(AnimationTest, AnimatorReportsOnlyChangedRegions) {
+    Animator anim;
+    anim.emplace<BlinkAnimation>(solid(4, 4), 0, 0, 1.0);
+    anim.emplace<MarqueeAnimation>(solid(10, 8), Rect{0, 8, 20, 8}, 30.0);
+    MonoGfx g(32, 16);
+
+    EXPECT_EQ(anim.tick(0.0, g).size(), 2u);  // first frame draws everything
+    EXPECT_TRUE(anim.tick(0.1, g).empty());   // nothing moved: no flush needed
+
+    const auto& dirty = anim.tick(0.7, g);    // blink turned off
+    ASSERT_EQ(dirty.size(), 1u);
+    EXPECT_EQ(dirty[0].w, 4);
+
+    anim.invalidate();
+    EXPECT_EQ(anim.tick(0.8, g).size(), 2u);
+}
+
+TEST(RectTest, UnionAndIntersection) {
+    const Rect a{0, 0, 10, 10};
+    const Rect b{5, 5, 10, 10};
+    const Rect u = a.united(b);
+    EXPECT_EQ(u.x, 0); EXPECT_EQ(u.y, 0); EXPECT_EQ(u.w, 15); EXPECT_EQ(u.h, 15);
+    const Rect i = a.intersected(b);
+    EXPECT_EQ(i.x, 5); EXPECT_EQ(i.w, 5); EXPECT_EQ(i.h, 5);
+    EXPECT_TRUE(a.intersected({20, 20, 5, 5}).empty());
+    const Rect e = Rect{}.united(b);
+    EXPECT_EQ(e.x, 5); EXPECT_EQ(e.w, 10);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include "bus_recorder.h"
+#include "ili9488.h"
+#include "image_io.h"
+#include "panel_sim.h"
+#include "spi_linux.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+class NullSpi : public SpiLinux {
+public:
+    NullSpi() : SpiLinux("/dev/null") {}
+
+protected:
+    void transfer_message(const SpiSegment*, size_t) override {}
+};
+
+// Builds a bus event stream by hand, the way the drivers would emit it
+struct StreamBuilder {
+    std::vector<BusEvent> events;
+    uint64_t t{0};
+    bool dc{true};
+
+    void gpio(BusChannel ch, bool level) {
+        BusEvent e;
+        e.t_ns = t;
+        e.channel = ch;
+        e.level = level;
+        events.push_back(e);
+    }
+    void spi(bool want_dc, std::vector<uint8_t> bytes) {
+        if (want_dc != dc || events.empty()) {
+            gpio(BusChannel::Dc, want_dc);
+            dc = want_dc;
+        }
+        BusEvent e;
+        e.t_ns = t;
+        e.channel = BusChannel::Spi;
+        e.data = std::move(bytes);
+        events.push_back(std::move(e));
+    }
+    void cmd(uint8_t c) { spi(false, {c}); }
+    void data(std::vector<uint8_t> d) { spi(true, std::move(d)); }
+
+    // Mirrors St7565::set_framebuffer
+    void st7565_frame(const std::vector<uint8_t>& fb, int col_offset = 0) {
+        for (int page = 0; page < 8; ++page) {
+            cmd(static_cast<uint8_t>(0xB0 | page));
+            cmd(static_cast<uint8_t>(0x10 | ((col_offset >> 4) & 0x0F)));
+            cmd(static_cast<uint8_t>(col_offset & 0x0F));
+            data(std::vector<uint8_t>(fb.begin() + page * 128, fb.begin() + (page + 1) * 128));
+        }
+    }
+};
+
+std::vector<uint8_t> random_fb(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> fb(n);
+    for (auto& b : fb) b = static_cast<uint8_t>(rng());
+    return fb;
+}
+
+bool fb_bit(const std::vector<uint8_t>& fb, int w, int x, int y) {
+    return (fb[static_cast<size_t>((y / 8) * w + x)] >> (y % 8)) & 1u;
+}
+
+} // namespace
+
+TEST(BusRecorderTest, RoundTripsThroughDumpFormat) {
+    BusRecorder rec(4096);
+    const uint8_t payload[] = {0xB0, 0x10, 0x00};
+    rec.record_gpio(BusChannel::Dc, false);
+    rec.record_spi(payload, sizeof(payload));
+    rec.record_gpio(BusChannel::Dc, true);
+    EXPECT_EQ(rec.records(), 3u);
+
+    const std::vector<BusEvent> ev = BusRecorder::parse(rec.snapshot());
+    ASSERT_EQ(ev.size(), 3u);
+    EXPECT_EQ(ev[0].channel, BusChannel::Dc);
+    EXPECT_FALSE(ev[0].level);
+    EXPECT_EQ(ev[1].channel, BusChannel::Spi);
+    EXPECT_EQ(ev[1].data, std::vector<uint8_t>(payload, payload + 3));
+    EXPECT_TRUE(ev[2].level);
+    EXPECT_LE(ev[0].t_ns, ev[1].t_ns);
+    EXPECT_LE(ev[1].t_ns, ev[2].t_ns);
+}
+
+TEST(BusRecorderTest, RingKeepsNewestRecords) {
+    BusRecorder rec(256);
+    std::vector<uint8_t> chunk(40);
+    for (int i = 0; i < 20; ++i) {
+        chunk[0] = static_cast<uint8_t>(i);
+        rec.record_spi(chunk.data(), chunk.size());
+    }
+    EXPECT_LE(rec.used(), rec.capacity());
+    EXPECT_GT(rec.dropped(), 0u);
+
+    const std::vector<BusEvent> ev = BusRecorder::parse(rec.snapshot());
+    ASSERT_EQ(ev.size(), rec.records());
+    for (size_t i = 0; i < ev.size(); ++i) {
+        EXPECT_EQ(ev[i].data[0], static_cast<uint8_t>(20 - ev.size() + i));
+    }
+
+    // Larger than the whole ring: rejected, ring untouched
+    std::vector<uint8_t> huge(1000);
+    const size_t before = rec.records();
+    rec.record_spi(huge.data(), huge.size());
+    EXPECT_EQ(rec.records(), before);
+}
+
+TEST(BusRecorderTest, RejectsForeignData) {
+    EXPECT_THROW(BusRecorder::parse({1, 2, 3}), std::runtime_error);
+    std::vector<uint8_t> img = BusRecorder().snapshot();
+    img[12] = 5;  // claims records that are not there
+    EXPECT_THROW(BusRecorder::parse(img), std::runtime_error);
+}
+
+TEST(BusRecorderTest, SpiLinuxFeedsAttachedRecorder) {
+    NullSpi spi;
+    BusRecorder rec;
+    spi.set_recorder(&rec);
+    const std::vector<uint8_t> a = {1, 2, 3};
+    const std::vector<uint8_t> b = {4, 5};
+    const SpiSegment segs[] = {{a.data(), a.size()}, {b.data(), b.size()}};
+    spi.write_segments(segs, 2);
+    rec.set_enabled(false);
+    spi.write(a);
+    spi.set_recorder(nullptr);
+    spi.write(a);
+
+    const std::vector<BusEvent> ev = BusRecorder::parse(rec.snapshot());
+    ASSERT_EQ(ev.size(), 1u);
+    EXPECT_EQ(ev[0].data, (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+}
+
+TEST(PanelSimTest, St7565ReplaysFramebuffer) {
+    const std::vector<uint8_t> fb = random_fb(1024, 1);
+    StreamBuilder s;
+    for (uint8_t c : {0xAE, 0xA2, 0xA0, 0xC8, 0x2F, 0x26, 0x81, 0x16, 0xAF}) s.cmd(c);
+    s.st7565_frame(fb);
+
+    St7565Sim sim;
+    const ReplayStats st = replay_bus(s.events, sim);
+    EXPECT_EQ(st.frames, 1u);
+    EXPECT_TRUE(sim.display_on());
+    EXPECT_EQ(sim.contrast(), 0x16);
+
+    std::vector<uint8_t> rgb;
+    sim.render_rgb(rgb);
+    ASSERT_EQ(rgb.size(), 128u * 64u * 3u);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 128; ++x)
+            ASSERT_EQ(rgb[static_cast<size_t>((y * 128 + x) * 3)] == 0, fb_bit(fb, 128, x, y)) << x << "," << y;
+}
+
+TEST(PanelSimTest, St7565HardwareFlipShowsRotatedImage) {
+    const std::vector<uint8_t> fb = random_fb(1024, 2);
+    StreamBuilder s;
+    for (uint8_t c : {0xA1, 0xC0, 0xAF}) s.cmd(c);  // St7565::set_scan_direction(true, false, 4)
+    s.st7565_frame(fb, 4);
+
+    St7565Sim sim;
+    EXPECT_EQ(replay_bus(s.events, sim).frames, 1u);
+    std::vector<uint8_t> rgb;
+    sim.render_rgb(rgb);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 128; ++x)
+            ASSERT_EQ(rgb[static_cast<size_t>((y * 128 + x) * 3)] == 0, fb_bit(fb, 128, 127 - x, 63 - y));
+}
+
+TEST(PanelSimTest, Ili9488ReplaysLandscapeFrameInOddChunks) {
+    const int w = 480, h = 320;
+    const std::vector<uint8_t> mono = random_fb(static_cast<size_t>(w * h / 8), 3);
+    // Pure red on pure blue; 5-bit 0x1F arrives as 6-bit 0x3E, i.e. 0xFB
+    const std::vector<uint8_t> rgb666 = Ili9488::mono_to_rgb666(mono, w, h, 0xF800, 0x001F);
+
+    StreamBuilder s;
+    s.cmd(0x11);
+    s.cmd(0x36); s.data({0xE8});  // rotation 3
+    s.cmd(0x3A); s.data({0x66});
+    s.cmd(0x29);
+    s.cmd(0x2A); s.data({0, 0, (w - 1) >> 8, (w - 1) & 0xFF});
+    s.cmd(0x2B); s.data({0, 0, (h - 1) >> 8, (h - 1) & 0xFF});
+    s.cmd(0x2C);
+    for (size_t pos = 0; pos < rgb666.size(); pos += 4097) {  // splits pixels
+        const size_t end = std::min(rgb666.size(), pos + 4097);
+        s.data(std::vector<uint8_t>(rgb666.begin() + static_cast<std::ptrdiff_t>(pos),
+                                    rgb666.begin() + static_cast<std::ptrdiff_t>(end)));
+    }
+
+    Ili9488Sim sim;
+    EXPECT_EQ(replay_bus(s.events, sim).frames, 1u);
+    EXPECT_EQ(sim.width(), w);
+    EXPECT_EQ(sim.height(), h);
+    std::vector<uint8_t> out;
+    sim.render_rgb(out);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const uint8_t* px = out.data() + static_cast<size_t>((y * w + x) * 3);
+            const bool fg = fb_bit(mono, w, x, y);
+            ASSERT_EQ(px[0], fg ? 0xFB : 0x00) << x << "," << y;
+            ASSERT_EQ(px[2], fg ? 0x00 : 0xFB) << x << "," << y;
+        }
+}
+
+TEST(PanelSimTest, ReplayReportsFrameTiming) {
+    const std::vector<uint8_t> fb(1024, 0);
+    StreamBuilder s;
+    s.cmd(0xAF);
+    for (int i = 0; i < 5; ++i) {
+        s.t = 1000000000ULL + static_cast<uint64_t>(i) * 40000000ULL;  // 25 fps
+        s.st7565_frame(fb);
+    }
+    s.gpio(BusChannel::Reset, false);
+
+    St7565Sim sim;
+    std::vector<uint64_t> seen;
+    const ReplayStats st = replay_bus(s.events, sim, [&](uint64_t i, uint64_t) { seen.push_back(i); });
+    EXPECT_EQ(st.frames, 5u);
+    EXPECT_EQ(seen, (std::vector<uint64_t>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(st.resets, 1u);
+    EXPECT_EQ(st.spi_bytes, 1u + 5u * 8u * (3u + 128u));
+    EXPECT_NEAR(st.frame_interval_avg_ms, 40.0, 1e-6);
+    EXPECT_NEAR(st.fps(), 25.0, 1e-6);
+    EXPECT_GT(st.dc_toggles, 0u);
+}
+
+TEST(ImageIoTest, PngStoresRawRows) {
+    const uint8_t px[] = {0, 255, 10, 20, 30, 40};  // 2x1 RGB
+    const std::vector<uint8_t> png = encode_png(2, 1, 3, px);
+    const uint8_t sig[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    ASSERT_GT(png.size(), 8u);
+    EXPECT_EQ(std::memcmp(png.data(), sig, 8), 0);
+    EXPECT_EQ(std::memcmp(png.data() + 12, "IHDR", 4), 0);
+    EXPECT_EQ(png[25], 2);  // color type RGB
+
+    // IDAT payload: zlib header, one stored block holding filter byte + row
+    const size_t idat = 8 + 25;
+    EXPECT_EQ(std::memcmp(png.data() + idat + 4, "IDAT", 4), 0);
+    const uint8_t* z = png.data() + idat + 8;
+    EXPECT_EQ(z[0], 0x78);
+    EXPECT_EQ(z[2], 1);  // final stored block
+    EXPECT_EQ(z[3] | (z[4] << 8), 7);
+    EXPECT_EQ(z[7], 0);  // filter None
+    EXPECT_EQ(std::memcmp(z + 8, px, sizeof(px)), 0);
+    EXPECT_EQ(std::memcmp(png.data() + png.size() - 8, "IEND", 4), 0);
+    EXPECT_THROW(encode_png(0, 1, 3, px), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "display_queue.h"
+#include "four_line_display.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(DisplayQueueTest, PopsInFifoOrder) {
+    DisplayQueue q(8);
+    EXPECT_EQ(q.capacity(), 8u);
+    EXPECT_TRUE(q.empty());
+    ASSERT_TRUE(q.set_line(0, "first"));
+    ASSERT_TRUE(q.clear_line(2));
+    ASSERT_TRUE(q.set_marquee(3, true, 12.5));
+
+    DisplayCommand c;
+    ASSERT_TRUE(q.pop(c));
+    EXPECT_EQ(c.op, DisplayOp::SetLine);
+    EXPECT_EQ(c.view(), "first");
+    ASSERT_TRUE(q.pop(c));
+    EXPECT_EQ(c.op, DisplayOp::ClearLine);
+    EXPECT_EQ(c.line, 2);
+    ASSERT_TRUE(q.pop(c));
+    EXPECT_EQ(c.op, DisplayOp::SetMarquee);
+    EXPECT_FLOAT_EQ(c.speed, 12.5f);
+    EXPECT_FALSE(q.pop(c));
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(DisplayQueueTest, FullQueueRejectsWithoutBlocking) {
+    DisplayQueue q(4);
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(q.set_line(1, std::to_string(i)));
+    EXPECT_FALSE(q.set_line(1, "overflow"));
+    EXPECT_EQ(q.stats().dropped, 1u);
+    EXPECT_EQ(q.stats().pushed, 4u);
+
+    // Slots are reusable once consumed
+    DisplayCommand c;
+    ASSERT_TRUE(q.pop(c));
+    EXPECT_TRUE(q.set_line(1, "again"));
+}
+
+TEST(DisplayQueueTest, RejectsInvalidLine) {
+    DisplayQueue q;
+    EXPECT_FALSE(q.set_line(4, "x"));
+    EXPECT_FALSE(q.clear_line(7));
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(q.stats().dropped, 0u);
+}
+
+TEST(DisplayQueueTest, LongTextIsCutAtCodePoint) {
+    DisplayQueue q;
+    std::string text;
+    while (text.size() < 2 * DisplayCommand::kMaxText) text += "Ж";  // 2-byte sequences
+    text = "a" + text;  // odd offset so kMaxText falls inside a sequence
+    ASSERT_TRUE(q.set_line(0, text));
+    DisplayCommand c;
+    ASSERT_TRUE(q.pop(c));
+    EXPECT_LE(c.len, DisplayCommand::kMaxText);
+    EXPECT_EQ(c.len % 2, 1);
+    EXPECT_EQ(c.view(), text.substr(0, c.len));
+}
+
+TEST(DisplayQueueTest, DrainCoalescesSupersededUpdates) {
+    DisplayQueue q;
+    FourLineDisplay display;
+    q.set_line(0, "old 0");
+    q.set_line(1, "dropped by clear_all");
+    q.clear_all();
+    q.set_line(0, "zero a");
+    q.set_line(2, "two");
+    q.set_line(0, "zero b");
+    q.set_marquee(2, true);
+    q.set_marquee(2, false);
+
+    EXPECT_EQ(q.drain(display), 4u);  // clear_all, zero b, two, marquee off
+    EXPECT_EQ(display.get_text(0), "zero b");
+    EXPECT_EQ(display.get_text(1), "");
+    EXPECT_EQ(display.get_text(2), "two");
+    EXPECT_FALSE(display.is_marquee(2));
+    EXPECT_EQ(q.stats().coalesced, 4u);
+    EXPECT_EQ(q.drain(display), 0u);
+}
+
+TEST(DisplayQueueTest, ManyProducersKeepPerLineOrder) {
+    DisplayQueue q(64);
+    FourLineDisplay display;
+    constexpr int kPerThread = 5000;
+    std::atomic<int> done{0};
+
+    std::vector<std::thread> producers;
+    for (unsigned int line = 0; line < 4; ++line) {
+        producers.emplace_back([&, line] {
+            for (int i = 0; i < kPerThread; ++i) {
+                const std::string v = std::to_string(i);
+                while (!q.set_line(line, v)) std::this_thread::yield();
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    // Consumer: values per line must only move forward
+    int last[4] = {-1, -1, -1, -1};
+    DisplayCommand c;
+    while (done.load() < 4 || !q.empty()) {
+        if (!q.pop(c)) continue;
+        const int v = std::stoi(std::string(c.view()));
+        ASSERT_GT(v, last[c.line]);
+        last[c.line] = v;
+    }
+    for (auto& t : producers) t.join();
+    for (int line = 0; line < 4; ++line) EXPECT_EQ(last[line], kPerThread - 1);
+}
+
+TEST(DisplayQueueTest, RenderThreadFlushesQueuedUpdates) {
+    DisplayQueue q;
+    FourLineDisplay display;
+    std::atomic<int> flushed{0};
+    DisplayRenderThread renderer(q, display, 200.0,
+                                 [&](const std::vector<unsigned char>&) { flushed.fetch_add(1); });
+    renderer.start();
+    q.set_line(0, "hello");
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (q.stats().applied == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    renderer.stop();
+    EXPECT_EQ(display.get_text(0), "hello");
+    EXPECT_FALSE(renderer.running());
+    EXPECT_GE(flushed.load(), 1);
+    EXPECT_EQ(static_cast<uint64_t>(flushed.load()), renderer.flushes());
+    EXPECT_EQ(q.stats().applied, 1u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
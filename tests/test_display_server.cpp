@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "display_server.h"
+#include <chrono>
+#include <climits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+std::string socket_path(const char* name) {
+    return "/tmp/lcd_test_" + std::string(name) + "." + std::to_string(getpid()) + ".sock";
+}
+
+bool pixel(const std::vector<unsigned char>& fb, int width, int x, int y) {
+    return (fb[static_cast<size_t>(y / 8) * static_cast<size_t>(width) + static_cast<size_t>(x)] >> (y % 8)) & 1;
+}
+
+// Server on its own thread; flushes are recorded under a lock
+struct RunningServer {
+    std::mutex m;
+    std::vector<unsigned char> frame;
+    std::vector<Rect> flushed;
+    DisplayServer server;
+    std::thread thread;
+
+    RunningServer(const std::string& path, int w, int h)
+        : server(path, w, h, [this](const std::vector<unsigned char>& fb, const Rect& r) {
+              std::lock_guard<std::mutex> lock(m);
+              frame = fb;
+              flushed.push_back(r);
+          }),
+          thread([this] { server.run(); }) {}
+
+    ~RunningServer() {
+        server.stop();
+        thread.join();
+    }
+
+    std::vector<unsigned char> snapshot() {
+        std::lock_guard<std::mutex> lock(m);
+        return frame;
+    }
+    std::vector<Rect> flushes() {
+        std::lock_guard<std::mutex> lock(m);
+        return flushed;
+    }
+};
+
+} // namespace
+
+TEST(DisplayServerTest, ClientPixelsReachTheFrameThroughSharedMemory) {
+    RunningServer s(socket_path("shm"), 128, 64);
+    DisplayClient client(socket_path("shm"), Rect{16, 8, 32, 16});
+    EXPECT_EQ(client.size(), 32u * 2u);
+    // Settles the round that composes the new surface, which would merge
+    // with damage sent right after creation
+    client.damage();
+
+    // Written straight into the mapping; only the rect crosses the socket
+    client.pixels()[3] = 0x01;  // surface (3, 0)
+    client.damage(Rect{3, 0, 1, 1});
+    auto fb = s.snapshot();
+    EXPECT_TRUE(pixel(fb, 128, 16 + 3, 8));
+    EXPECT_FALSE(pixel(fb, 128, 16 + 4, 8));
+    ASSERT_FALSE(s.flushes().empty());
+    EXPECT_EQ(s.flushes().back().x, 19);
+    EXPECT_EQ(s.flushes().back().y, 8);
+    EXPECT_EQ(s.flushes().back().w, 1);
+    EXPECT_EQ(s.flushes().back().h, 1);
+    EXPECT_EQ(s.server.stats().damage, 2u);
+}
+
+TEST(DisplayServerTest, CommitCopiesMonoGfxAndClipsDamage) {
+    RunningServer s(socket_path("commit"), 128, 64);
+    DisplayClient client(socket_path("commit"), Rect{0, 32, 128, 32});
+    MonoGfx gfx(128, 32);
+    gfx.fill_rect(10, 10, 20, 20);
+    client.commit(gfx, Rect{0, 0, 64, 32});
+    auto fb = s.snapshot();
+    EXPECT_TRUE(pixel(fb, 128, 10, 42));
+    EXPECT_TRUE(pixel(fb, 128, 20, 52));
+    EXPECT_FALSE(pixel(fb, 128, 21, 52));
+    EXPECT_FALSE(pixel(fb, 128, 10, 41));
+
+    // Damage outside the surface is clipped away but still acknowledged
+    const size_t before = s.flushes().size();
+    client.damage(Rect{200, 0, 10, 10});
+    EXPECT_EQ(s.flushes().size(), before);
+
+    MonoGfx wrong(64, 32);
+    EXPECT_THROW(client.commit(wrong), std::runtime_error);
+}
+
+TEST(DisplayServerTest, LaterSurfacesAreOnTopAndUncoverOnDisconnect) {
+    RunningServer s(socket_path("stack"), 128, 64);
+    DisplayClient below(socket_path("stack"), Rect{0, 0, 128, 64});
+    MonoGfx full(128, 64);
+    full.fill_rect(0, 0, 127, 63);
+    below.commit(full);
+
+    {
+        DisplayClient above(socket_path("stack"), Rect{32, 16, 64, 32});
+        above.damage();  // blank surface hides the one below
+        auto fb = s.snapshot();
+        EXPECT_FALSE(pixel(fb, 128, 40, 20));
+        EXPECT_TRUE(pixel(fb, 128, 10, 20));
+
+        // Damage from the lower surface under the upper one stays hidden
+        below.damage(Rect{30, 10, 20, 20});
+        fb = s.snapshot();
+        EXPECT_FALSE(pixel(fb, 128, 40, 20));
+        EXPECT_TRUE(pixel(fb, 128, 31, 20));
+    }
+
+    // The disconnect damages the upper surface's area; wait for the flush
+    for (int i = 0; i < 200; ++i) {
+        if (pixel(s.snapshot(), 128, 40, 20)) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(pixel(s.snapshot(), 128, 40, 20));
+}
+
+TEST(DisplayServerTest, RefusesSurfacesOutsideTheScreen) {
+    RunningServer s(socket_path("refuse"), 128, 64);
+    EXPECT_THROW(DisplayClient(socket_path("refuse"), Rect{100, 0, 64, 8}), std::runtime_error);
+    EXPECT_THROW(DisplayClient(socket_path("refuse"), Rect{0, 0, 0, 8}), std::runtime_error);
+    DisplayClient ok(socket_path("refuse"), Rect{64, 56, 64, 8});
+    EXPECT_EQ(ok.width(), 64);
+
+    // x + w would overflow int: refused, not wrapped into the screen
+    EXPECT_THROW(DisplayClient(socket_path("refuse"), Rect{INT_MAX - 8, 0, 16, 8}), std::runtime_error);
+    EXPECT_THROW(DisplayClient(socket_path("refuse"), Rect{-8, 0, INT_MAX, 8}), std::runtime_error);
+    EXPECT_THROW(DisplayClient(socket_path("refuse"), Rect{0, 8, 8, INT_MAX}), std::runtime_error);
+}
+
+TEST(DisplayServerTest, ClipsDamageNearIntLimits) {
+    RunningServer s(socket_path("limits"), 128, 64);
+    DisplayClient client(socket_path("limits"), Rect{0, 32, 128, 32});
+    client.damage();  // Done comes after the flush: the surface is shown
+    const size_t before = s.flushes().size();
+    client.damage(Rect{INT_MAX - 4, 0, INT_MAX, 8});
+    client.damage(Rect{0, INT_MIN, 8, -1});
+    EXPECT_EQ(s.flushes().size(), before);
+
+    // A span from far left ends inside the surface
+    client.damage(Rect{-1000, -5, INT_MAX, INT_MAX});
+    const std::vector<Rect> flushed = s.flushes();
+    ASSERT_EQ(flushed.size(), before + 1);
+    EXPECT_EQ(flushed.back().x, 0);
+    EXPECT_EQ(flushed.back().y, 32);
+    EXPECT_EQ(flushed.back().w, 128);
+    EXPECT_EQ(flushed.back().h, 32);
+}
+
+TEST(DisplayServerTest, ConnectWithoutServerThrows) {
+    EXPECT_THROW(DisplayClient(socket_path("absent"), Rect{0, 0, 8, 8}), std::runtime_error);
+}
+
+TEST(DisplayServerTest, PollOnceServesFromTheCallingThread) {
+    const std::string path = socket_path("round");
+    std::vector<Rect> flushed;
+    DisplayServer server(path, 128, 64, [&](const std::vector<unsigned char>&, const Rect& r) {
+        flushed.push_back(r);
+    });
+    std::thread t([&] {
+        DisplayClient a(path, Rect{0, 0, 64, 64});
+        DisplayClient b(path, Rect{32, 0, 64, 64});
+    });
+    while (flushed.empty() || server.clients() > 0) server.poll_once(20);
+    t.join();
+    // Each creation and each disconnect damages the surface's area
+    EXPECT_LE(flushed.size(), 4u);
+    for (const Rect& r : flushed) {
+        EXPECT_LE(r.x + r.w, 96);
+    }
+    server.stop();
+    EXPECT_FALSE(server.poll_once(-1));
+}
@@ -277,6 +277,255 @@ TEST_F(FourLineDisplayTest, LinesAreIndependent) {
     EXPECT_EQ(display->get_text(3), "D");
 }
 
+// Test: Rotated layout uses the rotated width
+TEST(FourLineDisplayOrientationTest, RotationChangesLayoutWidth) {
+    FourLineDisplay display(128, 64, 12, 28);
+    const unsigned int landscape = display.length(0);
+    
+    display.set_orientation(Rotation::Deg90);
+    EXPECT_EQ(display.get_layout_width(), 64);
+    EXPECT_EQ(display.get_layout_height(), 128);
+    EXPECT_LT(display.length(0), landscape);
+    
+    // Framebuffer keeps the native panel layout
+    EXPECT_EQ(display.get_framebuffer().size(), 1024u);
+}
+
+// Test: 180 degree render is the point reflection of the normal render
+TEST(FourLineDisplayOrientationTest, Rotate180RendersReflectedFrame) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    std::ifstream font_file(font_path);
+    if (!font_file.good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    FourLineDisplay plain(128, 64, 12, 28);
+    FourLineDisplay rotated(128, 64, 12, 28);
+    rotated.set_orientation(Rotation::Deg180);
+    ASSERT_TRUE(plain.initialize(font_path));
+    ASSERT_TRUE(rotated.initialize(font_path));
+    
+    for (FourLineDisplay* d : {&plain, &rotated}) {
+        d->puts(0, "Status: OK");
+        d->puts(1, "Count 42");
+        d->puts(3, "Версия 2.1");
+    }
+    const std::vector<unsigned char> a = plain.render();
+    const std::vector<unsigned char> b = rotated.render();
+    
+    auto bit = [](const std::vector<unsigned char>& fb, int x, int y) {
+        return (fb[(y / 8) * 128 + x] >> (y % 8)) & 1;
+    };
+    for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 128; ++x) {
+            ASSERT_EQ(bit(a, x, y), bit(b, 127 - x, 63 - y)) << x << "," << y;
+        }
+    }
+}
+
+// Test: Marquee scrolls over-length lines from a pre-rendered strip
+TEST(FourLineDisplayMarqueeTest, LongLineScrollsOnTick) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    std::ifstream font_file(font_path);
+    if (!font_file.good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    FourLineDisplay display(128, 64, 12, 28);
+    ASSERT_TRUE(display.initialize(font_path));
+    display.set_marquee(3, true, 20.0);
+    EXPECT_TRUE(display.is_marquee(3));
+    EXPECT_FALSE(display.is_marquee(0));
+    
+    display.puts(0, "Short");
+    display.puts(3, "Дизельное топливо ДТ-Л-К5 зимнее");
+    const std::vector<unsigned char> first = display.render();
+    
+    // Sub-pixel advance: nothing moved, nothing to flush
+    EXPECT_FALSE(display.tick(0.01));
+    
+    EXPECT_TRUE(display.tick(1.0));
+    const std::vector<unsigned char>& moved = display.get_framebuffer();
+    
+    // Only line 3 (y 52..63, pages 6-7) changes; line 0 is untouched
+    for (size_t i = 0; i < 6 * 128; ++i) {
+        ASSERT_EQ(first[i], moved[i]) << i;
+    }
+    EXPECT_NE(std::vector<unsigned char>(first.begin() + 6 * 128, first.end()),
+              std::vector<unsigned char>(moved.begin() + 6 * 128, moved.end()));
+    
+    // render() at the same time reproduces the ticked frame
+    const std::vector<unsigned char> rerendered = display.render();
+    EXPECT_EQ(rerendered, moved);
+}
+
+// Test: Lines that fit and lines without marquee never scroll
+TEST(FourLineDisplayMarqueeTest, FittingOrDisabledLinesStayStill) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    std::ifstream font_file(font_path);
+    if (!font_file.good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    FourLineDisplay display(128, 64, 12, 28);
+    ASSERT_TRUE(display.initialize(font_path));
+    display.set_marquee(0, true);
+    display.puts(0, "Fits");
+    display.puts(2, "A very long line without marquee enabled");
+    const std::vector<unsigned char> first = display.render();
+    
+    EXPECT_FALSE(display.tick(5.0));
+    EXPECT_EQ(display.get_framebuffer(), first);
+}
+
+// Test: tick() keeps a later line drawn over the marquee window
+TEST(FourLineDisplayMarqueeTest, TickKeepsLaterLinesOnTop) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    std::ifstream font_file(font_path);
+    if (!font_file.good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    // Line 0 scrolls; the accents of the large line reach up into its window
+    auto setup = [&](FourLineDisplay& d) {
+        ASSERT_TRUE(d.initialize(font_path));
+        d.set_marquee(0, true);
+        d.puts(0, "Дизельное топливо ДТ-Л-К5 зимнее, очень длинная строка");
+        d.puts(1, "ÀÉÅ ЁЙ");
+        d.puts(2, "Name");
+        d.puts(3, "v1.0");
+    };
+    FourLineDisplay display(128, 64, 12, 28);
+    setup(display);
+    display.render();
+    
+    for (double t : {0.7, 1.5, 3.2}) {
+        ASSERT_TRUE(display.tick(t));
+        FourLineDisplay fresh(128, 64, 12, 28);
+        setup(fresh);
+        fresh.tick(t);
+        ASSERT_EQ(display.get_framebuffer(), fresh.render()) << "t=" << t;
+    }
+}
+
+// Test: Parallel rendering produces the same frame as serial rendering
+TEST(FourLineDisplayParallelTest, MatchesSerialByteForByte) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    std::ifstream font_file(font_path);
+    if (!font_file.good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    for (Rotation rot : {Rotation::Deg0, Rotation::Deg90}) {
+        FourLineDisplay serial(480, 320, 40, 80);
+        FourLineDisplay parallel(480, 320, 40, 80);
+        serial.set_orientation(rot);
+        parallel.set_orientation(rot);
+        parallel.set_render_threads(4);
+        EXPECT_EQ(parallel.get_render_threads(), 4u);
+        ASSERT_TRUE(serial.initialize(font_path));
+        ASSERT_TRUE(parallel.initialize(font_path));
+        
+        // Line 2 scrolls; descenders of line 1 reach into line 2's window
+        for (FourLineDisplay* d : {&serial, &parallel}) {
+            d->set_marquee(2, true);
+            d->puts(0, "Статус: Выполняется");
+            d->puts(1, "Счётчик: 42 gjpqy");
+            d->puts(2, "Дизельное топливо ДТ-Л-К5 зимнее, очень длинная строка");
+            d->puts(3, "Версия 2.1");
+        }
+        for (double t : {0.0, 1.5}) {
+            serial.tick(t);
+            parallel.tick(t);
+            ASSERT_EQ(parallel.render(), serial.render()) << static_cast<int>(rot) << " t=" << t;
+        }
+        
+        // Changing the thread count keeps the output
+        parallel.set_render_threads(2);
+        parallel.puts(1, "Счётчик: 43");
+        serial.puts(1, "Счётчик: 43");
+        EXPECT_EQ(parallel.render(), serial.render());
+    }
+}
+
+// Test: Incremental render matches a full render and reports small dirty rects
+TEST(FourLineDisplayDirtyTest, ChangedCellsMatchFullRender) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    std::ifstream font_file(font_path);
+    if (!font_file.good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    struct Geometry { int w, h, small, large; Rotation rot; };
+    for (const Geometry& g : {Geometry{480, 320, 40, 80, Rotation::Deg0},
+                              Geometry{128, 64, 12, 28, Rotation::Deg0},
+                              Geometry{64, 128, 12, 28, Rotation::Deg90}}) {
+        FourLineDisplay display(g.w, g.h, g.small, g.large);
+        display.set_orientation(g.rot);
+        ASSERT_TRUE(display.initialize(font_path));
+        display.set_marquee(3, true);
+        display.puts(0, "Цена: 61.90");
+        display.puts(1, "42.17 л");
+        display.puts(2, "gjpqy ÀÉ");
+        display.puts(3, "Дизельное топливо ДТ-Л-К5 зимнее, класс 2");
+        display.render();
+        ASSERT_EQ(display.get_dirty_rects().size(), 1u);  // first frame: everything
+        
+        const std::vector<std::vector<std::string>> steps = {
+            {"Цена: 61.90", "42.18 л", "gjpqy ÀÉ"},
+            {"Цена: 61.90", "42.19 л", "gjpqy ÀÉ"},
+            {"Цена: 62.05", "43.00 л", "gjpqy ÀÉ"},
+            {"Цена: 62.05", "143.00 л", "gjpqy"},       // longer, shorter
+            {"Цена", "9.5", "e\u0301 combining"},        // off the grid
+            {"Цена: 62.05", "9.50 л", "gjpqy ÀÉ"},
+        };
+        for (size_t k = 0; k < steps.size(); ++k) {
+            for (unsigned int i = 0; i < 3; ++i) {
+                display.puts(i, steps[k][i]);
+            }
+            const std::vector<unsigned char> incremental = display.render();
+            
+            FourLineDisplay fresh(g.w, g.h, g.small, g.large);
+            fresh.set_orientation(g.rot);
+            ASSERT_TRUE(fresh.initialize(font_path));
+            fresh.set_marquee(3, true);
+            for (unsigned int i = 0; i < 4; ++i) {
+                fresh.puts(i, display.get_text(i));
+            }
+            ASSERT_EQ(incremental, fresh.render()) << g.w << "x" << g.h << " step " << k;
+        }
+        
+        // One digit of the large line: one cell-sized rect, nothing else
+        display.puts(1, "9.51 л");
+        display.render();
+        const std::vector<Rect>& dirty = display.get_dirty_rects();
+        ASSERT_EQ(dirty.size(), 1u);
+        EXPECT_LT(dirty[0].w, g.large);
+        EXPECT_LT(dirty[0].w * dirty[0].h, display.get_layout_width() * display.get_layout_height() / 8);
+        
+        // Nothing changed: nothing to flush
+        display.render();
+        EXPECT_TRUE(display.get_dirty_rects().empty());
+    }
+}
+
+TEST(PixelMapTest, NativeRectCoversMappedCorners) {
+    const PixelMap m = PixelMap::make(128, 64, Rotation::Deg90);
+    const Rect r = m.native_rect(Rect{3, 10, 5, 2});
+    // Logical (x, y) -> native (127 - y, x)
+    EXPECT_EQ(r.x, 127 - 11);
+    EXPECT_EQ(r.y, 3);
+    EXPECT_EQ(r.w, 2);
+    EXPECT_EQ(r.h, 5);
+    EXPECT_TRUE(m.native_rect(Rect{}).empty());
+}
+
 // Main function for running tests
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -330,6 +330,36 @@ TEST_F(FtTextTest, ReloadFont) {
     EXPECT_GT(count_nonzero_bytes(fb), 0u);
 }
 
+// Test: A font read into memory once renders like the file and can be shared
+TEST_F(FtTextTest, MemoryFontMatchesFileFont) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    if (!font_exists(font_path)) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    EXPECT_THROW(FtText::read_font_file("/nonexistent/font.ttf"), std::runtime_error);
+    EXPECT_THROW(ft_text->load_font(FtText::FontData{}), std::runtime_error);
+
+    FtText::FontData data = FtText::read_font_file(font_path);
+    FtText small_ft;
+    FtText large_ft;
+    small_ft.load_font(data);
+    large_ft.load_font(data);
+    data.reset();  // the faces keep the bytes alive
+    small_ft.set_pixel_size(12);
+    large_ft.set_pixel_size(28);
+    ft_text->load_font(font_path);
+
+    for (int px : {12, 28}) {
+        ft_text->set_pixel_size(px);
+        std::vector<unsigned char> from_file(128 * 64 / 8, 0);
+        std::vector<unsigned char> from_memory(128 * 64 / 8, 0);
+        ft_text->draw_utf8(from_file, 128, 64, 2, 4, "Цена 52.90");
+        (px == 12 ? small_ft : large_ft).draw_utf8(from_memory, 128, 64, 2, 4, "Цена 52.90");
+        EXPECT_GT(count_nonzero_bytes(from_file), 0u);
+        EXPECT_EQ(from_memory, from_file) << px << " px";
+    }
+}
+
 // Test: Various Cyrillic letters coverage
 TEST_F(FtTextTest, DrawVariousCyrillicLetters) {
     const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
@@ -443,6 +473,102 @@ TEST_F(FtTextTest, DrawWithUndersizedFramebuffer) {
     EXPECT_NO_THROW(ft_text->draw_utf8(fb, 128, 64, 0, 0, "Test"));
 }
 
+// Test: Kerning changes glyph placement for proportional fonts
+TEST_F(FtTextTest, KerningTightensKernedPairs) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+    
+    if (!font_exists(font_path)) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    ft_text->load_font(font_path);
+    ft_text->set_pixel_size(24);
+    EXPECT_TRUE(ft_text->kerning());
+    
+    std::vector<unsigned char> kerned(128 * 64 / 8, 0);
+    ft_text->draw_utf8(kerned, 128, 64, 0, 0, "AVAV");
+    
+    ft_text->set_kerning(false);
+    std::vector<unsigned char> plain(128 * 64 / 8, 0);
+    ft_text->draw_utf8(plain, 128, 64, 0, 0, "AVAV");
+    
+    // Rightmost inked column moves left when the AV pairs are kerned
+    auto rightmost = [](const std::vector<unsigned char>& fb) {
+        int last = -1;
+        for (int x = 0; x < 128; ++x) {
+            for (int page = 0; page < 8; ++page) {
+                if (fb[page * 128 + x]) last = x;
+            }
+        }
+        return last;
+    };
+    EXPECT_LT(rightmost(kerned), rightmost(plain));
+}
+
+// Test: Shaped runs are cached per string and size
+TEST_F(FtTextTest, ShapedRunsAreCached) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    if (!font_exists(font_path)) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    ft_text->load_font(font_path);
+    ft_text->set_pixel_size(16);
+    EXPECT_EQ(ft_text->cached_runs(), 0u);
+    
+    std::vector<unsigned char> fb1(128 * 64 / 8, 0);
+    ft_text->draw_utf8(fb1, 128, 64, 0, 0, "Счётчик: 42");
+    EXPECT_EQ(ft_text->cached_runs(), 1u);
+    
+    // Same label again: served from cache, identical output
+    std::vector<unsigned char> fb2(128 * 64 / 8, 0);
+    ft_text->draw_utf8(fb2, 128, 64, 0, 0, "Счётчик: 42");
+    EXPECT_EQ(ft_text->cached_runs(), 1u);
+    EXPECT_EQ(fb1, fb2);
+    
+    // Same label at another size is a separate run
+    ft_text->set_pixel_size(12);
+    ft_text->draw_utf8(fb2, 128, 64, 0, 0, "Счётчик: 42");
+    EXPECT_EQ(ft_text->cached_runs(), 2u);
+    
+    // Reloading the font invalidates glyph indices
+    ft_text->load_font(font_path);
+    EXPECT_EQ(ft_text->cached_runs(), 0u);
+    
+    ft_text->draw_utf8(fb2, 128, 64, 0, 0, "A");
+    ft_text->clear_cache();
+    EXPECT_EQ(ft_text->cached_runs(), 0u);
+}
+
+// Test: Combining marks do not advance the pen
+TEST_F(FtTextTest, CombiningMarkStaysOnBaseGlyph) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    
+    if (!font_exists(font_path)) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+    
+    ft_text->load_font(font_path);
+    ft_text->set_pixel_size(16);
+    
+    std::vector<unsigned char> base(128 * 64 / 8, 0);
+    ft_text->draw_utf8(base, 128, 64, 0, 0, "ex");
+    
+    // "e" + COMBINING ACUTE ACCENT + "x"
+    std::vector<unsigned char> marked(128 * 64 / 8, 0);
+    ft_text->draw_utf8(marked, 128, 64, 0, 0, "e\xCC\x81x");
+    
+    // The accent adds ink, but "x" lands in the same columns
+    EXPECT_NE(marked, base);
+    for (int x = 10; x < 128; ++x) {
+        for (int y = 0; y < 64; ++y) {
+            EXPECT_EQ(is_pixel_set(base, 128, x, y), is_pixel_set(marked, 128, x, y))
+                << "column " << x << " row " << y;
+        }
+    }
+}
+
 // Main function for running tests
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include "golden.h"
+#include "four_line_display.h"
+#include "graphics.h"
+#include "ili9488.h"
+#include "image_io.h"
+#include "sprite.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kFontPath = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+
+bool font_available() {
+    return std::ifstream(kFontPath).good();
+}
+
+// Font-independent scene: every MonoGfx primitive plus the built-in 5x7 font
+void draw_primitives(MonoGfx& gfx) {
+    gfx.clear();
+    gfx.rect(0, 0, gfx.width() - 1, gfx.height() - 1);
+    gfx.fill_rect(4, 4, 20, 14);
+    gfx.fill_rect(8, 7, 16, 11, false);
+    gfx.hline(24, 60, 6);
+    gfx.vline(62, 3, 30);
+    for (int i = 0; i < 20; ++i) gfx.pixel(24 + i, 10 + i);
+    gfx.text(4, 36, "FUEL 12.34");
+    gfx.text(4, 46, "{ok} #7");
+}
+
+// Arrow icon, 9x7, MSB first
+MonoSprite arrow() {
+    static const uint8_t rows[] = {
+        0x08, 0x00, 0x0C, 0x00, 0xFE, 0x00, 0xFF, 0x00, 0xFE, 0x00, 0x0C, 0x00, 0x08, 0x00,
+    };
+    return MonoSprite::from_rows(9, 7, rows, 2);
+}
+
+} // namespace
+
+// Test: Page-packed pixels map to black-on-white rows
+TEST(ImageIoTest, MonoImageUsesPageLayout) {
+    MonoGfx gfx(16, 16);
+    gfx.pixel(0, 0);
+    gfx.pixel(3, 9);
+    const Image img = image_from_mono(gfx);
+    ASSERT_EQ(img.width, 16);
+    ASSERT_EQ(img.height, 16);
+    EXPECT_EQ(img.channels, 1);
+    EXPECT_EQ(*img.at(0, 0), 0);
+    EXPECT_EQ(*img.at(3, 9), 0);
+    EXPECT_EQ(*img.at(1, 0), 255);
+    EXPECT_TRUE(img.bilevel());
+    EXPECT_THROW(image_from_mono(std::vector<uint8_t>(3), 16, 16), std::runtime_error);
+}
+
+// Test: PNM encode/decode round trips P4, P5 and P6
+TEST(ImageIoTest, PnmRoundTrips) {
+    MonoGfx gfx(13, 16);  // odd width pads P4 rows
+    draw_primitives(gfx);
+    const Image mono = image_from_mono(gfx);
+    const std::vector<uint8_t> p4 = encode_pnm(mono);
+    EXPECT_EQ(std::string(p4.begin(), p4.begin() + 9), "P4\n13 16\n");
+    EXPECT_EQ(p4.size(), 9u + 2u * 16u);
+    EXPECT_EQ(decode_pnm(p4).pixels, mono.pixels);
+    EXPECT_EQ(encode_pbm(gfx.fb(), 13, 16), p4);
+
+    Image gray(3, 2, 1);
+    gray.pixels = {0, 17, 255, 128, 64, 1};
+    const Image g = decode_pnm(encode_pnm(gray));
+    EXPECT_EQ(g.channels, 1);
+    EXPECT_EQ(g.pixels, gray.pixels);
+
+    Image rgb(2, 2, 3);
+    for (size_t i = 0; i < rgb.pixels.size(); ++i) rgb.pixels[i] = static_cast<uint8_t>(i * 20);
+    const Image c = decode_pnm(encode_pnm(rgb));
+    EXPECT_EQ(c.channels, 3);
+    EXPECT_EQ(c.pixels, rgb.pixels);
+
+    // Comments in the header are skipped
+    const std::string commented = "P5\n# made by hand\n2 1\n255\n\x10\x20";
+    EXPECT_EQ(decode_pnm(std::vector<uint8_t>(commented.begin(), commented.end())).pixels,
+              (std::vector<uint8_t>{0x10, 0x20}));
+
+    EXPECT_THROW(decode_pnm({'P', '3'}), std::runtime_error);
+    std::vector<uint8_t> truncated = encode_pnm(rgb);
+    truncated.pop_back();
+    EXPECT_THROW(decode_pnm(truncated), std::runtime_error);
+}
+
+// Test: RGB666 bytes expand to full-scale RGB888
+TEST(ImageIoTest, Rgb666ExpandsChannels) {
+    const std::vector<uint8_t> px = {0xFC, 0x00, 0x80, 0x04, 0xFF, 0x03};
+    const Image img = image_from_rgb666(px, 2, 1);
+    EXPECT_EQ(img.pixels, (std::vector<uint8_t>{0xFF, 0x00, 0x82, 0x04, 0xFF, 0x00}));
+}
+
+// Test: Comparison reports count, bounds and delta; diff marks gains and losses
+TEST(ImageIoTest, CompareReportsDifferences) {
+    MonoGfx gfx(32, 16);
+    draw_primitives(gfx);
+    const Image expected = image_from_mono(gfx);
+    gfx.pixel(5, 2, true);    // gained ink
+    gfx.pixel(0, 0, false);   // lost ink
+    const Image actual = image_from_mono(gfx);
+
+    const ImageDiff d = compare_images(expected, actual);
+    EXPECT_FALSE(d.identical());
+    EXPECT_EQ(d.differing, 2u);
+    EXPECT_EQ(d.pixels, 32u * 16u);
+    EXPECT_EQ(d.max_delta, 255);
+    EXPECT_EQ(d.bounds.x, 0);
+    EXPECT_EQ(d.bounds.y, 0);
+    EXPECT_EQ(d.bounds.w, 6);
+    EXPECT_EQ(d.bounds.h, 3);
+    EXPECT_NE(d.summary().find("2 of 512"), std::string::npos);
+    EXPECT_TRUE(compare_images(expected, expected).identical());
+    EXPECT_TRUE(compare_images(expected, actual, 255).identical());
+    EXPECT_TRUE(compare_images(expected, Image(31, 16, 1)).size_mismatch);
+
+    const Image diff = diff_image(expected, actual);
+    ASSERT_EQ(diff.channels, 3);
+    EXPECT_EQ(diff.at(5, 2)[0], 255);  // red: new ink
+    EXPECT_EQ(diff.at(5, 2)[2], 0);
+    EXPECT_EQ(diff.at(0, 0)[0], 0);    // blue: missing ink
+    EXPECT_EQ(diff.at(0, 0)[2], 255);
+    EXPECT_EQ(diff.at(31, 15)[1], diff.at(31, 15)[0]);  // unchanged: faded gray
+}
+
+// Golden images. Regenerate with LCD_UPDATE_GOLDEN=1 after an intended change.
+
+TEST(GoldenTest, GfxPrimitives) {
+    MonoGfx gfx(128, 64);
+    draw_primitives(gfx);
+    EXPECT_TRUE(MatchesGolden("gfx_primitives", image_from_mono(gfx)));
+}
+
+TEST(GoldenTest, GfxPrimitivesRotated) {
+    // Native framebuffer: what the panel receives for a 90 degree mount
+    MonoGfx gfx(128, 64);
+    gfx.set_orientation(Rotation::Deg90);
+    draw_primitives(gfx);
+    EXPECT_TRUE(MatchesGolden("gfx_primitives_rot90", image_from_mono(gfx)));
+}
+
+TEST(GoldenTest, SpriteBlitModes) {
+    MonoGfx gfx(64, 32);
+    for (int y = 0; y < 32; y += 2) gfx.hline(0, 63, y);  // striped background
+    MonoSprite a = arrow();
+    a.mask_from_pixels(1);
+    a.blit(gfx, 3, 3, BlitMode::Opaque);
+    a.blit(gfx, 20, 5, BlitMode::Transparent);
+    a.blit(gfx, 40, 13, BlitMode::Masked);
+    a.blit_region(gfx, 58, 22, 2, 6, BlitMode::Opaque);  // clipped at the right edge
+    EXPECT_TRUE(MatchesGolden("sprite_blit_modes", image_from_mono(gfx)));
+}
+
+TEST(GoldenTest, Rgb666Conversion) {
+    MonoGfx gfx(128, 64);
+    draw_primitives(gfx);
+    const std::vector<uint8_t> rgb = Ili9488::mono_to_rgb666(gfx.fb(), 128, 64, 0xFFE0, 0x0010);
+    EXPECT_TRUE(MatchesGolden("rgb666_primitives", image_from_rgb666(rgb, 128, 64)));
+}
+
+TEST(GoldenTest, FourLineDisplayLayout) {
+    if (!font_available()) GTEST_SKIP() << "Font file not available: " << kFontPath;
+    FourLineDisplay display;
+    ASSERT_TRUE(display.initialize(kFontPath));
+    display.puts(0, "Колонка 3");
+    display.puts(1, "12.34 L");
+    display.puts(2, "АИ-95  52.90");
+    display.puts(3, "Ready");
+    const std::vector<unsigned char>& fb = display.render();
+    EXPECT_TRUE(MatchesGolden("four_line_128x64", image_from_mono(fb, 128, 64)));
+}
+
+TEST(GoldenTest, FourLineDisplayTftLayout) {
+    if (!font_available()) GTEST_SKIP() << "Font file not available: " << kFontPath;
+    FourLineDisplay display(480, 320, 40, 100);
+    ASSERT_TRUE(display.initialize(kFontPath));
+    display.puts(0, "Pump 3");
+    display.puts(1, "12.34 L");
+    display.puts(2, "Total 652.75");
+    display.puts(3, "Ready");
+    const std::vector<unsigned char>& fb = display.render();
+    EXPECT_TRUE(MatchesGolden("four_line_480x320", image_from_mono(fb, 480, 320)));
+}
+
+TEST(GoldenTest, FourLineDisplayMarqueeFrame) {
+    if (!font_available()) GTEST_SKIP() << "Font file not available: " << kFontPath;
+    FourLineDisplay display;
+    ASSERT_TRUE(display.initialize(kFontPath));
+    display.puts(0, "Payment accepted, thank you for choosing us");
+    display.puts(1, "0.00 L");
+    display.set_marquee(0, true, 40.0);
+    display.render();
+    display.tick(1.25);  // 50 px into the strip
+    EXPECT_TRUE(MatchesGolden("four_line_marquee_t1250", image_from_mono(display.get_framebuffer(), 128, 64)));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
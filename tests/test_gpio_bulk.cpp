@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+#include "gpio_gpiod.h"
+#include <stdexcept>
+#include <vector>
+
+// Line requests need a GPIO chip; without one only the argument checks
+// and error paths can be exercised here.
+
+TEST(GpioBulkTest, RejectsMismatchedRequests) {
+    EXPECT_THROW(GpioBulk({}, {}), std::runtime_error);
+    EXPECT_THROW(GpioBulk({1, 2}, {true}), std::runtime_error);
+    std::vector<int> too_many(65, 0);
+    EXPECT_THROW(GpioBulk(too_many, std::vector<bool>(65, false)), std::runtime_error);
+}
+
+TEST(GpioBulkTest, MissingChipThrowsWithPath) {
+    try {
+        GpioBulk pins({271, 256}, {false, true}, "/dev/no-such-gpiochip", "test");
+        FAIL() << "expected an exception";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("/dev/no-such-gpiochip"), std::string::npos);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
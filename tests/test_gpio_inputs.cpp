@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "gpio_gpiod.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+using std::chrono::milliseconds;
+using Clock = std::chrono::steady_clock;
+
+// Edge source standing in for a GPIO line: one byte per edge on a pipe,
+// 1 = rising, 0 = falling
+struct PipeLine {
+    int fds[2]{-1, -1};
+
+    PipeLine() {
+        if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) throw std::runtime_error("pipe2 failed");
+    }
+    ~PipeLine() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void edges(std::initializer_list<int> levels) {
+        for (int l : levels) {
+            const unsigned char b = static_cast<unsigned char>(l);
+            ASSERT_EQ(write(fds[1], &b, 1), 1);
+        }
+    }
+
+    int add_to(GpioInputs& inputs, milliseconds debounce, std::vector<GpioInputEvent>& out) {
+        const int fd = fds[0];
+        return inputs.add(
+            fd, false,
+            [fd](GpioEdgeEvent& ev) {
+                unsigned char b;
+                if (read(fd, &b, 1) != 1) return false;
+                ev.rising = b != 0;
+                ev.time = Clock::now().time_since_epoch();
+                return true;
+            },
+            debounce, [&out](const GpioInputEvent& e) { out.push_back(e); });
+    }
+};
+
+// Dispatch until `until` or n events
+void pump(GpioInputs& inputs, Clock::duration until, const std::vector<GpioInputEvent>& events,
+          size_t n) {
+    const Clock::time_point end = Clock::now() + until;
+    while (events.size() < n && Clock::now() < end) inputs.dispatch(milliseconds(10));
+}
+
+} // namespace
+
+TEST(GpioInputsTest, WithoutDebounceEveryChangeIsReported) {
+    GpioInputs inputs;
+    PipeLine key;
+    std::vector<GpioInputEvent> events;
+    const int id = key.add_to(inputs, milliseconds(0), events);
+
+    key.edges({1, 0, 0, 1});  // the repeated falling edge is no change
+    pump(inputs, milliseconds(500), events, 3);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_TRUE(events[0].level);
+    EXPECT_FALSE(events[1].level);
+    EXPECT_TRUE(events[2].level);
+    EXPECT_EQ(events[0].id, id);
+    EXPECT_TRUE(inputs.level(id));
+}
+
+TEST(GpioInputsTest, BounceSettlesIntoOneChange) {
+    GpioInputs inputs;
+    PipeLine key;
+    std::vector<GpioInputEvent> events;
+    const int id = key.add_to(inputs, milliseconds(20), events);
+
+    const Clock::time_point t = Clock::now();
+    key.edges({1, 0, 1, 0, 1});
+    EXPECT_EQ(inputs.dispatch(milliseconds(100)), 0);  // edges read, window running
+    pump(inputs, milliseconds(500), events, 1);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_TRUE(events[0].level);
+    EXPECT_GE(Clock::now() - t, milliseconds(20));
+    EXPECT_TRUE(inputs.level(id));
+
+    // Nothing more once it has settled
+    EXPECT_EQ(inputs.dispatch(milliseconds(40)), 0);
+    EXPECT_EQ(events.size(), 1u);
+}
+
+TEST(GpioInputsTest, GlitchShorterThanTheWindowIsSwallowed) {
+    GpioInputs inputs;
+    PipeLine door;
+    std::vector<GpioInputEvent> events;
+    const int id = door.add_to(inputs, milliseconds(15), events);
+
+    door.edges({1});
+    inputs.dispatch(milliseconds(100));
+    std::this_thread::sleep_for(milliseconds(5));
+    door.edges({0});
+    pump(inputs, milliseconds(100), events, 1);
+    EXPECT_TRUE(events.empty());
+    EXPECT_FALSE(inputs.level(id));
+}
+
+TEST(GpioInputsTest, MultiplexesInputsInOneWait) {
+    GpioInputs inputs;
+    PipeLine a, b;
+    std::vector<GpioInputEvent> events;
+    const int ida = a.add_to(inputs, milliseconds(0), events);
+    const int idb = b.add_to(inputs, milliseconds(5), events);
+    EXPECT_EQ(inputs.size(), 2u);
+
+    // The epoll descriptor wakes an outer poll loop
+    pollfd p{inputs.fd(), POLLIN, 0};
+    EXPECT_EQ(poll(&p, 1, 0), 0);
+    b.edges({1});
+    EXPECT_EQ(poll(&p, 1, 100), 1);
+
+    a.edges({1});
+    pump(inputs, milliseconds(500), events, 2);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].id, ida);  // no debounce: first
+    EXPECT_EQ(events[1].id, idb);
+
+    inputs.remove(ida);
+    EXPECT_EQ(inputs.size(), 1u);
+    a.edges({0});
+    EXPECT_EQ(inputs.dispatch(milliseconds(20)), 0);
+    EXPECT_THROW(inputs.level(ida), std::runtime_error);
+}
+
+TEST(GpioInputsTest, IdleDispatchTimesOut) {
+    GpioInputs inputs;
+    PipeLine key;
+    std::vector<GpioInputEvent> events;
+    key.add_to(inputs, milliseconds(10), events);
+    const Clock::time_point t = Clock::now();
+    EXPECT_EQ(inputs.dispatch(milliseconds(30)), 0);
+    EXPECT_GE(Clock::now() - t, milliseconds(25));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
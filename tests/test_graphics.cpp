@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include "graphics.h"
+#include "ft_text.h"
+#include "mono_gfx_fixed.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool native_pixel_set(const MonoGfx& gfx, int x, int y) {
+    const size_t idx = static_cast<size_t>((y / 8) * gfx.native_width() + x);
+    return (gfx.fb()[idx] >> (y % 8)) & 1u;
+}
+
+int count_set(const MonoGfx& gfx) {
+    int n = 0;
+    for (int y = 0; y < gfx.native_height(); ++y)
+        for (int x = 0; x < gfx.native_width(); ++x)
+            n += native_pixel_set(gfx, x, y) ? 1 : 0;
+    return n;
+}
+
+} // namespace
+
+// Test: Default orientation writes straight into the page layout
+TEST(MonoGfxTest, PixelUsesPageLayout) {
+    MonoGfx gfx(16, 16);
+    gfx.pixel(3, 10);
+    EXPECT_EQ(gfx.fb()[1 * 16 + 3], 1u << 2);
+    gfx.pixel(3, 10, false);
+    EXPECT_EQ(gfx.fb()[1 * 16 + 3], 0u);
+}
+
+// Test: Logical size swaps for 90/270 degrees
+TEST(MonoGfxTest, RotationSwapsLogicalSize) {
+    MonoGfx gfx(128, 64);
+    EXPECT_EQ(gfx.width(), 128);
+    EXPECT_EQ(gfx.height(), 64);
+
+    gfx.set_orientation(Rotation::Deg90);
+    EXPECT_EQ(gfx.width(), 64);
+    EXPECT_EQ(gfx.height(), 128);
+    EXPECT_EQ(gfx.native_width(), 128);
+    EXPECT_EQ(gfx.native_height(), 64);
+
+    gfx.set_orientation(Rotation::Deg180);
+    EXPECT_EQ(gfx.width(), 128);
+    EXPECT_EQ(gfx.height(), 64);
+}
+
+// Test: Logical origin lands in the expected native corner
+TEST(MonoGfxTest, OriginMapsToRotatedCorner) {
+    struct Case { Rotation r; bool mx; bool my; int nx; int ny; };
+    const Case cases[] = {
+        {Rotation::Deg0, false, false, 0, 0},
+        {Rotation::Deg90, false, false, 127, 0},
+        {Rotation::Deg180, false, false, 127, 63},
+        {Rotation::Deg270, false, false, 0, 63},
+        {Rotation::Deg0, true, false, 127, 0},
+        {Rotation::Deg0, false, true, 0, 63},
+        {Rotation::Deg90, true, false, 127, 63},
+    };
+    for (const auto& c : cases) {
+        MonoGfx gfx(128, 64);
+        gfx.set_orientation(c.r, c.mx, c.my);
+        gfx.pixel(0, 0);
+        EXPECT_EQ(count_set(gfx), 1);
+        EXPECT_TRUE(native_pixel_set(gfx, c.nx, c.ny))
+            << "rotation " << static_cast<int>(c.r) << " mirror " << c.mx << c.my;
+    }
+}
+
+// Test: Every logical pixel maps to a distinct in-range native pixel
+TEST(MonoGfxTest, RotationIsABijection) {
+    for (int r = 0; r < 4; ++r) {
+        for (int m = 0; m < 4; ++m) {
+            MonoGfx gfx(32, 16);
+            gfx.set_orientation(static_cast<Rotation>(r), (m & 1) != 0, (m & 2) != 0);
+            gfx.fill_rect(0, 0, gfx.width() - 1, gfx.height() - 1);
+            EXPECT_EQ(count_set(gfx), 32 * 16);
+        }
+    }
+}
+
+// Test: 180 degree rotation equals reversing the native image
+TEST(MonoGfxTest, Rotate180MatchesPointReflection) {
+    MonoGfx plain(64, 32);
+    MonoGfx rotated(64, 32);
+    rotated.set_orientation(Rotation::Deg180);
+    for (MonoGfx* g : {&plain, &rotated}) {
+        g->text(2, 3, "Hi 42");
+        g->rect(0, 0, 20, 10);
+        g->hline(5, 60, 25);
+    }
+    for (int y = 0; y < 32; ++y)
+        for (int x = 0; x < 64; ++x)
+            EXPECT_EQ(native_pixel_set(plain, x, y), native_pixel_set(rotated, 63 - x, 31 - y));
+}
+
+// Test: Drawing is clipped to the logical bounds
+TEST(MonoGfxTest, ClipsToLogicalBounds) {
+    MonoGfx gfx(128, 64);
+    gfx.set_orientation(Rotation::Deg90);
+    gfx.pixel(64, 0);   // beyond logical width (64)
+    gfx.pixel(0, 128);  // beyond logical height (128)
+    gfx.hline(-10, 100, 5);
+    EXPECT_EQ(count_set(gfx), 64);
+}
+
+// Test: FreeType text honors the MonoGfx orientation
+TEST(MonoGfxTest, FtTextDrawsPreRotated) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    if (!std::ifstream(font_path).good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+
+    FtText ft;
+    ft.load_font(font_path);
+    ft.set_pixel_size(16);
+
+    MonoGfx plain(128, 64);
+    ft.draw_utf8(plain, 4, 4, "Привет 42");
+
+    MonoGfx rotated(64, 128);
+    rotated.set_orientation(Rotation::Deg270);
+    ASSERT_EQ(rotated.width(), 128);
+    ft.draw_utf8(rotated, 4, 4, "Привет 42");
+
+    // 270 degrees clockwise: logical (x, y) -> native (y, 127 - x)
+    EXPECT_GT(count_set(plain), 0);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 128; ++x)
+            EXPECT_EQ(native_pixel_set(plain, x, y), native_pixel_set(rotated, y, 127 - x));
+}
+
+// Test: Span fills match drawing the same pixels one at a time, across
+// page boundaries and in every orientation
+TEST(MonoGfxTest, FillsMatchPixelByPixel) {
+    for (int r = 0; r < 4; ++r) {
+        MonoGfx filled(40, 24);
+        MonoGfx plotted(40, 24);
+        filled.set_orientation(static_cast<Rotation>(r), r == 1, false);
+        plotted.set_orientation(static_cast<Rotation>(r), r == 1, false);
+        filled.fill_rect(3, 5, 17, 14);
+        filled.rect(-2, 1, 50, 22);
+        filled.fill_rect(6, 7, 9, 9, false);
+        for (int y = 5; y <= 14; ++y)
+            for (int x = 3; x <= 17; ++x) plotted.pixel(x, y);
+        for (int x = -2; x <= 50; ++x) {
+            plotted.pixel(x, 1);
+            plotted.pixel(x, 22);
+        }
+        for (int y = 1; y <= 22; ++y) {
+            plotted.pixel(-2, y);
+            plotted.pixel(50, y);
+        }
+        for (int y = 7; y <= 9; ++y)
+            for (int x = 6; x <= 9; ++x) plotted.pixel(x, y, false);
+        EXPECT_EQ(filled.fb(), plotted.fb()) << "rotation " << r;
+    }
+}
+
+// Test: The fixed-size variant produces the runtime-sized frame, byte for byte
+TEST(MonoGfxTest, FixedSizeMatchesRuntimeSize) {
+    for (int r = 0; r < 4; ++r) {
+        MonoGfx dynamic(128, 64);
+        auto fixed = std::make_unique<MonoGfxT<128, 64>>();
+        dynamic.set_orientation(static_cast<Rotation>(r), false, r == 2);
+        fixed->set_orientation(static_cast<Rotation>(r), false, r == 2);
+        EXPECT_EQ(fixed->width(), dynamic.width());
+        auto draw = [](auto& g) {
+            g.rect(0, 0, g.width() - 1, g.height() - 1);
+            g.fill_rect(10, 3, 40, 20);
+            g.vline(50, -5, 70, false);
+            g.hline(-1, 200, 37);
+            g.text(2, 30, "Count: 42");
+        };
+        draw(dynamic);
+        draw(*fixed);
+        ASSERT_EQ(dynamic.fb().size(), fixed->fb().size());
+        EXPECT_TRUE(std::equal(dynamic.fb().begin(), dynamic.fb().end(), fixed->fb().begin()))
+            << "rotation " << r;
+    }
+}
+
+// Test: FreeType text into a fixed-size frame matches the runtime-sized one
+TEST(MonoGfxTest, FtTextDrawsIntoFixedSize) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    if (!std::ifstream(font_path).good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+
+    FtText ft;
+    ft.load_font(font_path);
+    ft.set_pixel_size(16);
+
+    for (Rotation r : {Rotation::Deg0, Rotation::Deg90}) {
+        MonoGfx dynamic(128, 64);
+        MonoGfxT<128, 64> fixed;
+        dynamic.set_orientation(r);
+        fixed.set_orientation(r);
+        // Partly off the left and bottom edges
+        ft.draw_utf8(dynamic, -3, 52, "Привет 42");
+        ft.draw_utf8(fixed, -3, 52, "Привет 42");
+        EXPECT_GT(count_set(dynamic), 0);
+        EXPECT_TRUE(std::equal(dynamic.fb().begin(), dynamic.fb().end(), fixed.fb().begin()));
+    }
+}
+
+// Main function for running tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "idle_policy.h"
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+using Transition = std::pair<IdleState, IdleState>;
+
+struct Recorder {
+    std::vector<Transition> seen;
+    IdlePolicy::Change change() {
+        return [this](IdleState from, IdleState to) { seen.emplace_back(from, to); };
+    }
+};
+
+} // namespace
+
+TEST(IdlePolicyTest, DimsThenSleepsThenWakesOnActivity) {
+    Recorder rec;
+    // The steps far enough apart that a loaded machine waking late from
+    // the first does not take both at once
+    IdlePolicy idle(milliseconds(20), milliseconds(500), rec.change());
+    EXPECT_EQ(idle.state(), IdleState::Active);
+    EXPECT_FALSE(idle.update());
+    EXPECT_TRUE(rec.seen.empty());
+
+    // Each wait() returns when the next step is due (bounded, so a
+    // failure does not hang the run)
+    idle.wait(milliseconds(5000));
+    idle.update();
+    EXPECT_EQ(idle.state(), IdleState::Dimmed);
+    idle.wait(milliseconds(5000));
+    idle.update();
+    EXPECT_EQ(idle.state(), IdleState::Asleep);
+    EXPECT_EQ(idle.next_transition(), IdlePolicy::Clock::time_point::max());
+
+    idle.activity();
+    idle.wait(milliseconds(5000));  // pending: returns at once
+    EXPECT_TRUE(idle.update());
+    EXPECT_EQ(idle.state(), IdleState::Active);
+
+    const std::vector<Transition> expected = {
+        {IdleState::Active, IdleState::Dimmed},
+        {IdleState::Dimmed, IdleState::Asleep},
+        {IdleState::Asleep, IdleState::Active},
+    };
+    EXPECT_EQ(rec.seen, expected);
+}
+
+TEST(IdlePolicyTest, ActivityPostponesTheTimeouts) {
+    Recorder rec;
+    IdlePolicy idle(milliseconds(60), milliseconds(0), rec.change());
+    const auto first = idle.next_transition();
+    std::this_thread::sleep_for(milliseconds(30));
+    idle.activity();
+    EXPECT_TRUE(idle.update());
+    EXPECT_GT(idle.next_transition(), first);
+    EXPECT_FALSE(idle.update());  // taken once
+    EXPECT_TRUE(rec.seen.empty());
+}
+
+TEST(IdlePolicyTest, WakeReturnsWithoutActivity) {
+    Recorder rec;
+    IdlePolicy idle(milliseconds(0), milliseconds(10), rec.change());
+    idle.wait(milliseconds(5000));
+    idle.update();
+    ASSERT_EQ(idle.state(), IdleState::Asleep);
+
+    const auto start = IdlePolicy::Clock::now();
+    std::thread other([&idle] { idle.wake(); });
+    idle.wait(milliseconds(5000));  // nothing due: only the wake returns it
+    other.join();
+    EXPECT_LT(IdlePolicy::Clock::now() - start, milliseconds(4000));
+    EXPECT_FALSE(idle.update());
+    EXPECT_EQ(idle.state(), IdleState::Asleep);
+    EXPECT_EQ(rec.seen.size(), 1u);
+}
+
+TEST(IdlePolicyTest, LateUpdateAppliesEveryDueStep) {
+    Recorder rec;
+    IdlePolicy idle(milliseconds(5), milliseconds(10), rec.change());
+    std::this_thread::sleep_for(milliseconds(20));
+    idle.update();
+    EXPECT_EQ(idle.state(), IdleState::Asleep);
+    EXPECT_EQ(rec.seen.size(), 2u);
+}
+
+TEST(IdlePolicyTest, ZeroTimeoutsSkipStates) {
+    Recorder straight;
+    IdlePolicy sleep_only(milliseconds(0), milliseconds(10), straight.change());
+    sleep_only.wait(milliseconds(5000));
+    sleep_only.update();
+    ASSERT_EQ(straight.seen.size(), 1u);
+    EXPECT_EQ(straight.seen[0], Transition(IdleState::Active, IdleState::Asleep));
+
+    Recorder dim;
+    IdlePolicy dim_only(milliseconds(10), milliseconds(0), dim.change());
+    dim_only.wait(milliseconds(5000));
+    dim_only.update();
+    EXPECT_EQ(dim_only.state(), IdleState::Dimmed);
+    EXPECT_EQ(dim_only.next_transition(), IdlePolicy::Clock::time_point::max());
+
+    IdlePolicy never(milliseconds(0), milliseconds(0), nullptr);
+    EXPECT_EQ(never.next_transition(), IdlePolicy::Clock::time_point::max());
+}
+
+TEST(IdlePolicyTest, ActivityFromAnotherThreadEndsTheWait) {
+    IdlePolicy idle(milliseconds(0), milliseconds(0), nullptr);
+    std::thread t([&idle] {
+        std::this_thread::sleep_for(milliseconds(20));
+        idle.activity();
+    });
+    const auto t0 = IdlePolicy::Clock::now();
+    idle.wait(milliseconds(5000));
+    EXPECT_LT(IdlePolicy::Clock::now() - t0, milliseconds(2000));
+    EXPECT_TRUE(idle.update());
+    t.join();
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -48,3 +51,16 @@ TEST(Ili9488Test, MonoToRgb666RejectsInvalidGeometry) {
     const std::vector<uint8_t> mono(16, 0x00);
     EXPECT_THROW((void)Ili9488::mono_to_rgb666(mono, 8, 10), std::runtime_error);
 }
+
+TEST(Ili9488Test, FixedSizeMonoToRgb666MatchesRuntimeSize) {
+    MonoGfxT<48, 16> gfx;
+    gfx.fill_rect(3, 2, 20, 11);
+    gfx.text(22, 4, "Hi");
+    const std::vector<uint8_t> mono(gfx.fb().begin(), gfx.fb().end());
+
+    auto out = std::make_unique<std::array<uint8_t, 48 * 16 * 3>>();
+    Ili9488::mono_to_rgb666(gfx, *out, 0x07E0, 0x0010);
+    const auto expected = Ili9488::mono_to_rgb666(mono, 48, 16, 0x07E0, 0x0010);
+    ASSERT_EQ(expected.size(), out->size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out->begin()));
+}
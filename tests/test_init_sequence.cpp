@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include "init_sequence.h"
+#include "startup_trace.h"
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Ms = std::chrono::milliseconds;
+
+// Bus writes as (D/C level, bytes), in order
+using Trace = std::vector<std::pair<bool, std::vector<uint8_t>>>;
+
+struct FakePanel {
+    CommandPacer pacer;
+    Trace bus;
+    std::vector<CommandPacer::Clock::time_point> write_times;
+
+    size_t run(const InitStep* steps, size_t n, ParamPath path = ParamPath::Data) {
+        return run_init_steps(steps, n, path, pacer, [this](bool dc, const uint8_t* p, size_t len) {
+            write_times.push_back(CommandPacer::Clock::now());
+            bus.push_back({dc, std::vector<uint8_t>(p, p + len)});
+        });
+    }
+};
+
+double ms_between(CommandPacer::Clock::time_point a, CommandPacer::Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+} // namespace
+
+// Test: Bytes at one D/C level share a write; parameters go as data for DCS
+TEST(InitSequenceTest, BatchesDcsCommandsAndParameters) {
+    constexpr InitStep steps[] = {
+        {0x01, 0, {}, 0},
+        {0x3A, 1, {0x66}, 0},
+        {0x21, 0, {}, 0},
+        {0x36, 1, {0xE8}, 0},
+        {0x2A, 4, {0x00, 0x00, 0x01, 0xDF}, 0},
+    };
+    FakePanel panel;
+    EXPECT_EQ(panel.run(steps, 5), 6u);
+    const Trace expected = {
+        {false, {0x01, 0x3A}}, {true, {0x66}},
+        {false, {0x21, 0x36}}, {true, {0xE8}},
+        {false, {0x2A}}, {true, {0x00, 0x00, 0x01, 0xDF}},
+    };
+    EXPECT_EQ(panel.bus, expected);
+    EXPECT_FALSE(panel.pacer.pending());
+}
+
+// Test: On the ST756x command path the whole sequence is one write
+TEST(InitSequenceTest, CommandPathIsSingleWrite) {
+    constexpr InitStep steps[] = {
+        {0xAE, 0, {}, 0},
+        {0xA2, 0, {}, 0},
+        {0x2F, 0, {}, 0},
+        {0x81, 1, {0x16}, 0},
+        {0xAF, 0, {}, 0},
+    };
+    FakePanel panel;
+    EXPECT_EQ(panel.run(steps, 5, ParamPath::Command), 1u);
+    const Trace expected = {{false, {0xAE, 0xA2, 0x2F, 0x81, 0x16, 0xAF}}};
+    EXPECT_EQ(panel.bus, expected);
+}
+
+// Test: Long runs are split without losing or reordering bytes
+TEST(InitSequenceTest, LongRunsAreSplit) {
+    std::vector<InitStep> steps;
+    std::vector<uint8_t> sent;
+    for (int i = 0; i < 40; ++i) {
+        InitStep s{static_cast<uint8_t>(0xE0 + (i % 16)), InitStep::kMaxParams, {}, 0};
+        sent.push_back(s.cmd);
+        for (uint8_t k = 0; k < s.n; ++k) {
+            s.params[k] = static_cast<uint8_t>(i + k);
+            sent.push_back(s.params[k]);
+        }
+        steps.push_back(s);
+    }
+    FakePanel panel;
+    const size_t writes = panel.run(steps.data(), steps.size(), ParamPath::Command);
+    EXPECT_GT(writes, 1u);
+    EXPECT_LE(writes, sent.size() / 200 + 2);
+    std::vector<uint8_t> got;
+    for (const auto& w : panel.bus) {
+        EXPECT_FALSE(w.first);
+        got.insert(got.end(), w.second.begin(), w.second.end());
+    }
+    EXPECT_EQ(got, sent);
+}
+
+// Test: Delays split the batch and hold back the next write only; a
+// trailing delay is left pending
+TEST(InitSequenceTest, DelaysArePacedNotSlept) {
+    constexpr InitStep steps[] = {
+        {0x11, 0, {}, 30},
+        {0x29, 0, {}, 40},
+    };
+    FakePanel panel;
+    const auto t0 = CommandPacer::Clock::now();
+    EXPECT_EQ(panel.run(steps, 2), 2u);
+    const auto t1 = CommandPacer::Clock::now();
+
+    ASSERT_EQ(panel.write_times.size(), 2u);
+    EXPECT_GE(ms_between(panel.write_times[0], panel.write_times[1]), 30.0);
+    // The 40 ms after the last step is not spent inside run_init_steps
+    EXPECT_LT(ms_between(t0, t1), 30.0 + 35.0);
+    EXPECT_TRUE(panel.pacer.pending());
+
+    // Work done meanwhile shortens the wait
+    std::this_thread::sleep_for(Ms(25));
+    const auto w0 = CommandPacer::Clock::now();
+    panel.pacer.wait();
+    const auto w1 = CommandPacer::Clock::now();
+    EXPECT_GE(ms_between(panel.write_times[1], w1), 40.0);
+    EXPECT_LT(ms_between(w0, w1), 30.0);
+    EXPECT_FALSE(panel.pacer.pending());
+}
+
+// Test: Scripts parse hex bytes, comments and delays
+TEST(InitSequenceTest, ParsesInitScript) {
+    const std::vector<InitStep> steps = parse_init_script(
+        "# power\n"
+        "C0 17 15\n"
+        "\n"
+        "0x11 delay 5   # sleep out\n"
+        "  e0 00 03 09 08 16 0A 3F 78 4C 09 0A 08 16 1A 0F\n");
+    ASSERT_EQ(steps.size(), 3u);
+    EXPECT_EQ(steps[0].cmd, 0xC0);
+    EXPECT_EQ(steps[0].n, 2);
+    EXPECT_EQ(steps[0].params[1], 0x15);
+    EXPECT_EQ(steps[0].delay_ms, 0);
+    EXPECT_EQ(steps[1].cmd, 0x11);
+    EXPECT_EQ(steps[1].n, 0);
+    EXPECT_EQ(steps[1].delay_ms, 5);
+    EXPECT_EQ(steps[2].cmd, 0xE0);
+    EXPECT_EQ(steps[2].n, 15);
+    EXPECT_EQ(steps[2].params[14], 0x0F);
+}
+
+TEST(InitSequenceTest, RejectsMalformedScript) {
+    EXPECT_THROW(parse_init_script("3A 166"), std::runtime_error);
+    EXPECT_THROW(parse_init_script("3A zz"), std::runtime_error);
+    EXPECT_THROW(parse_init_script("delay 5"), std::runtime_error);
+    EXPECT_THROW(parse_init_script("11 delay"), std::runtime_error);
+    EXPECT_THROW(parse_init_script("11 delay 5 29"), std::runtime_error);
+    EXPECT_THROW(parse_init_script("E0 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F 10"),
+                 std::runtime_error);
+    try {
+        parse_init_script("11\n29\nxx\n");
+        FAIL() << "expected an error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("line 3"), std::string::npos) << e.what();
+    }
+    EXPECT_THROW(load_init_script("/nonexistent/panel.init"), std::runtime_error);
+}
+
+// Test: The scripts shipped with the repository stay valid
+TEST(InitSequenceTest, ShippedScriptsLoad) {
+    for (const char* name : {"st7567.init", "ili9488_msp3520.init"}) {
+        const std::vector<InitStep> steps = load_init_script(std::string(LCD_SCRIPTS_DIR) + "/init/" + name);
+        EXPECT_FALSE(steps.empty()) << name;
+    }
+}
+
+// Test: The watchdog's re-send of a script skips the reset and the delays
+TEST(InitSequenceTest, ResendStepsSkipResetAndDelays) {
+    const std::vector<InitStep> steps = load_init_script(std::string(LCD_SCRIPTS_DIR) + "/init/st7567.init");
+    ASSERT_EQ(steps.front().cmd, 0xE2);
+
+    const std::vector<InitStep> resend = resend_steps(steps, 0xE2, false);
+    ASSERT_EQ(resend.size(), steps.size() - 1);
+    for (const InitStep& s : resend) {
+        EXPECT_NE(s.cmd, 0xE2);
+        EXPECT_EQ(s.delay_ms, 0u) << std::hex << int(s.cmd);
+    }
+    EXPECT_EQ(resend[2].cmd, 0x81);  // parameters kept
+    EXPECT_EQ(resend[2].params[0], 0x27);
+
+    // A reset panel still gets its settling times
+    const std::vector<InitStep> restore = resend_steps(steps, 0xE2, true);
+    EXPECT_EQ(restore[3].cmd, 0x2F);
+    EXPECT_EQ(restore[3].delay_ms, 10u);
+
+    FakePanel panel;
+    panel.run(resend.data(), resend.size(), ParamPath::Command);
+    EXPECT_FALSE(panel.pacer.pending());  // nothing left to wait on
+    EXPECT_EQ(panel.bus.size(), 1u);
+}
+
+// Test: A shorter delay never pulls an earlier deadline in
+TEST(InitSequenceTest, PacerKeepsLatestDeadline) {
+    CommandPacer pacer;
+    pacer.delay(Ms(50));
+    const auto deadline = pacer.ready_at();
+    pacer.delay(Ms(1));
+    EXPECT_EQ(pacer.ready_at(), deadline);
+    pacer.delay(Ms(80));
+    EXPECT_GT(pacer.ready_at(), deadline);
+}
+
+// Test: Marks are ordered, named and printed with steps
+TEST(StartupTraceTest, RecordsMilestones) {
+    StartupTrace trace;
+    EXPECT_GE(trace.construct_ms(), 0.0);
+    trace.mark("spi open");
+    std::thread([&] { trace.mark("panel ready"); }).join();
+    std::this_thread::sleep_for(Ms(5));
+    trace.mark("first frame");
+
+    const auto marks = trace.marks();
+    ASSERT_EQ(marks.size(), 3u);
+    EXPECT_EQ(marks[1].what, "panel ready");
+    EXPECT_LE(marks[0].t_ms, marks[1].t_ms);
+    EXPECT_GE(marks[2].t_ms - marks[1].t_ms, 5.0);
+    EXPECT_GE(marks[0].t_ms, trace.construct_ms());
+    EXPECT_DOUBLE_EQ(trace.time_of("first frame"), marks[2].t_ms);
+    EXPECT_LT(trace.time_of("missing"), 0.0);
+
+    std::ostringstream os;
+    trace.print(os);
+    EXPECT_NE(os.str().find("panel ready"), std::string::npos);
+    EXPECT_NE(os.str().find("first frame"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
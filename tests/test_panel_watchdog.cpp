@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "panel_watchdog.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// Counts the actions and answers checks from a script
+struct FakePanel {
+    std::vector<PanelHealth> script;
+    size_t next{0};
+    int reasserts{0};
+    int restores{0};
+
+    PanelWatchdog::Check check() {
+        return [this] { return next < script.size() ? script[next++] : PanelHealth::Ok; };
+    }
+    PanelWatchdog::Action reassert() {
+        return [this] { ++reasserts; };
+    }
+    PanelWatchdog::Action restore() {
+        return [this] { ++restores; };
+    }
+};
+
+} // namespace
+
+TEST(PanelWatchdogTest, CheckedPanelIsRepairedByWhatWasLost) {
+    FakePanel panel;
+    panel.script = {PanelHealth::Ok, PanelHealth::Registers, PanelHealth::Lost, PanelHealth::Ok};
+    PanelWatchdog dog(milliseconds(0), panel.check(), panel.reassert(), panel.restore());
+
+    EXPECT_EQ(dog.poll(), PanelHealth::Ok);
+    EXPECT_EQ(panel.reasserts + panel.restores, 0);
+
+    // Flipped settings: registers only, the frame stays
+    EXPECT_EQ(dog.poll(), PanelHealth::Registers);
+    EXPECT_EQ(panel.reasserts, 1);
+    EXPECT_EQ(panel.restores, 0);
+
+    // Reset controller: registers and frame
+    EXPECT_EQ(dog.poll(), PanelHealth::Lost);
+    EXPECT_EQ(panel.reasserts, 1);
+    EXPECT_EQ(panel.restores, 1);
+
+    EXPECT_EQ(dog.poll(), PanelHealth::Ok);
+    EXPECT_EQ(dog.stats().checks, 4u);
+    EXPECT_EQ(dog.stats().reasserts, 1u);
+    EXPECT_EQ(dog.stats().restores, 1u);
+}
+
+TEST(PanelWatchdogTest, WriteOnlyPanelIsReassertedAndRepaintedBlindly) {
+    FakePanel panel;
+    PanelWatchdog dog(milliseconds(0), nullptr, panel.reassert(), panel.restore(), 3);
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(dog.poll(), PanelHealth::Ok);
+    EXPECT_EQ(panel.reasserts, 4);
+    EXPECT_EQ(panel.restores, 2);  // every third period
+
+    FakePanel never;
+    PanelWatchdog registers_only(milliseconds(0), nullptr, never.reassert(), never.restore());
+    for (int i = 0; i < 5; ++i) registers_only.poll();
+    EXPECT_EQ(never.reasserts, 5);
+    EXPECT_EQ(never.restores, 0);
+}
+
+TEST(PanelWatchdogTest, ActsOncePerPeriod) {
+    FakePanel panel;
+    panel.script.assign(10, PanelHealth::Registers);
+    PanelWatchdog dog(milliseconds(30), panel.check(), panel.reassert(), panel.restore());
+
+    // Not due yet: the check is not even run
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(dog.poll(), PanelHealth::Ok);
+    EXPECT_EQ(panel.next, 0u);
+    EXPECT_GT(dog.next_due(), PanelWatchdog::Clock::now());
+
+    std::this_thread::sleep_until(dog.next_due());
+    EXPECT_EQ(dog.poll(), PanelHealth::Registers);
+    EXPECT_EQ(dog.poll(), PanelHealth::Ok);
+    EXPECT_EQ(dog.stats().checks, 1u);
+}
+
+TEST(PanelWatchdogTest, NeedsBothActions) {
+    EXPECT_THROW(PanelWatchdog(milliseconds(10), nullptr, nullptr, [] {}), std::runtime_error);
+    EXPECT_THROW(PanelWatchdog(milliseconds(10), nullptr, [] {}, nullptr), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "spi_linux.h"
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Captures messages instead of issuing SPI_IOC_MESSAGE
+class RecordingSpi : public SpiLinux {
+public:
+    RecordingSpi() : SpiLinux("/dev/null") {}
+
+    std::vector<std::vector<size_t>> messages;  // segment lengths per message
+    std::vector<uint8_t> wire;                  // bytes in transmit order
+    uint8_t echo_xor{0};                        // rx = tx ^ echo_xor
+
+protected:
+    void transfer_message(const SpiSegment* segs, size_t n) override {
+        std::vector<size_t> lens;
+        for (size_t i = 0; i < n; ++i) {
+            lens.push_back(segs[i].len);
+            wire.insert(wire.end(), segs[i].tx, segs[i].tx + segs[i].len);
+            if (segs[i].rx) {
+                for (size_t k = 0; k < segs[i].len; ++k) segs[i].rx[k] = segs[i].tx[k] ^ echo_xor;
+            }
+        }
+        messages.push_back(lens);
+    }
+};
+
+std::vector<uint8_t> pattern(size_t n) {
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = static_cast<uint8_t>(i * 7 + 3);
+    return v;
+}
+
+} // namespace
+
+// Test: Writing to a closed device fails
+TEST(SpiLinuxTest, WriteWithoutOpenThrows) {
+    SpiLinux spi("/nonexistent/spidev");
+    const uint8_t b = 0;
+    EXPECT_THROW(spi.write(&b, 1), std::runtime_error);
+}
+
+// Test: Opening a missing device fails
+TEST(SpiLinuxTest, OpenMissingDeviceThrows) {
+    SpiLinux spi("/nonexistent/spidev");
+    EXPECT_THROW(spi.open(), std::runtime_error);
+}
+
+// Test: Defaults and limit validation
+TEST(SpiLinuxTest, LimitsHaveSaneDefaults) {
+    RecordingSpi spi;
+    EXPECT_EQ(spi.max_transfer(), SpiLinux::kDefaultMaxTransfer);
+    EXPECT_EQ(spi.segment_size(), SpiLinux::kDefaultSegmentSize);
+    EXPECT_THROW(spi.set_max_transfer(0), std::runtime_error);
+    EXPECT_THROW(spi.set_segment_size(0), std::runtime_error);
+    EXPECT_GT(SpiLinux::query_spidev_bufsiz(), 0u);
+}
+
+// Test: Small writes are a single message
+TEST(SpiLinuxTest, SmallWriteIsOneMessage) {
+    RecordingSpi spi;
+    const auto data = pattern(10);
+    spi.write(data);
+    ASSERT_EQ(spi.messages.size(), 1u);
+    EXPECT_EQ(spi.messages[0], std::vector<size_t>{10});
+    EXPECT_EQ(spi.wire, data);
+    EXPECT_EQ(spi.stats().messages, 1u);
+    EXPECT_EQ(spi.stats().bytes, 10u);
+}
+
+// Test: A full RGB666 frame fills every message to the spidev limit
+TEST(SpiLinuxTest, FrameIsPackedToMaxTransfer) {
+    RecordingSpi spi;
+    spi.set_max_transfer(65536);
+    const auto frame = pattern(480 * 320 * 3);
+    spi.write(frame);
+
+    EXPECT_EQ(spi.wire, frame);
+    EXPECT_EQ(spi.messages.size(), (frame.size() + 65535) / 65536);
+    for (size_t m = 0; m < spi.messages.size(); ++m) {
+        const auto& lens = spi.messages[m];
+        const size_t total = std::accumulate(lens.begin(), lens.end(), size_t{0});
+        EXPECT_LE(total, 65536u);
+        if (m + 1 < spi.messages.size()) EXPECT_EQ(total, 65536u);
+        for (size_t len : lens) EXPECT_LE(len, SpiLinux::kDefaultSegmentSize);
+    }
+}
+
+// Test: Gathered scanlines coalesce across buffer boundaries
+TEST(SpiLinuxTest, GatheredSegmentsCoalesce) {
+    RecordingSpi spi;
+    spi.set_max_transfer(4096);
+    const auto line = pattern(1440);
+    std::vector<SpiSegment> lines(320, SpiSegment{line.data(), line.size()});
+    spi.write_segments(lines.data(), lines.size());
+
+    // 320 scanlines used to be 320 syscalls; now ceil(460800 / 4096)
+    EXPECT_EQ(spi.stats().messages, 113u);
+    EXPECT_EQ(spi.stats().bytes, 460800u);
+    ASSERT_EQ(spi.wire.size(), 460800u);
+    for (size_t i = 0; i < spi.wire.size(); ++i) {
+        ASSERT_EQ(spi.wire[i], line[i % line.size()]);
+    }
+
+    spi.reset_stats();
+    EXPECT_EQ(spi.stats().messages, 0u);
+}
+
+// Test: Message never exceeds the per-message segment count
+TEST(SpiLinuxTest, SegmentCountPerMessageIsBounded) {
+    RecordingSpi spi;
+    spi.set_max_transfer(1 << 20);
+    spi.set_segment_size(16);
+    const auto data = pattern(16 * 200);
+    spi.write(data);
+    for (const auto& lens : spi.messages) {
+        EXPECT_LE(lens.size(), SpiLinux::kMaxSegmentsPerMessage);
+    }
+    EXPECT_EQ(spi.wire, data);
+}
+
+// Test: Full-duplex transfer is one message and fills rx
+TEST(SpiLinuxTest, TransferReadsBackInOneMessage) {
+    RecordingSpi spi;
+    spi.echo_xor = 0xFF;
+    const std::vector<uint8_t> tx = pattern(40);
+    std::vector<uint8_t> rx(40, 0);
+    spi.transfer(tx.data(), rx.data(), tx.size());
+    ASSERT_EQ(spi.messages.size(), 1u);
+    EXPECT_EQ(spi.wire, tx);
+    for (size_t i = 0; i < tx.size(); ++i) EXPECT_EQ(rx[i], tx[i] ^ 0xFF);
+    EXPECT_EQ(spi.stats().bytes, 40u);
+
+    // A transfer is never split, so it must fit one message
+    std::vector<uint8_t> big(spi.max_transfer() + 1), back(big.size());
+    EXPECT_THROW(spi.transfer(big.data(), back.data(), big.size()), std::runtime_error);
+}
+
+// Main function for running tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "sprite.h"
+#include "ft_text.h"
+#include "graphics.h"
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Pseudo-random sprite with a partial last page (height 13)
+MonoSprite make_pattern(int w, int h, unsigned seed) {
+    std::mt19937 rng(seed);
+    MonoSprite s(w, h);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            s.set(x, y, (rng() & 3) == 0);
+    return s;
+}
+
+void fill_background(MonoGfx& gfx, unsigned seed) {
+    std::mt19937 rng(seed);
+    for (auto& b : gfx.fb()) b = static_cast<unsigned char>(rng());
+}
+
+// Per-pixel reference for blit semantics
+void reference_blit(const MonoSprite& s, MonoGfx& dst, int x, int y, BlitMode mode) {
+    for (int sy = 0; sy < s.height(); ++sy) {
+        for (int sx = 0; sx < s.width(); ++sx) {
+            const bool on = s.get(sx, sy);
+            if (mode == BlitMode::Transparent && !on) continue;
+            if (mode == BlitMode::Masked && s.has_mask()) {
+                const auto& m = s.mask();
+                if (!((m[static_cast<size_t>((sy / 8) * s.width() + sx)] >> (sy % 8)) & 1u)) continue;
+            }
+            dst.pixel(x + sx, y + sy, on);
+        }
+    }
+}
+
+} // namespace
+
+// Test: Page-packed storage matches MonoGfx layout
+TEST(SpriteTest, FromPagesKeepsLayout) {
+    const uint8_t pages[] = {0x01, 0x80, 0xFF, 0x00};
+    MonoSprite s = MonoSprite::from_pages(2, 16, pages);
+    EXPECT_TRUE(s.get(0, 0));
+    EXPECT_TRUE(s.get(1, 7));
+    EXPECT_TRUE(s.get(0, 8));
+    EXPECT_FALSE(s.get(1, 8));
+}
+
+// Test: Row-major icons convert to pages (MSB and LSB first)
+TEST(SpriteTest, FromRowsConvertsIcons) {
+    const uint8_t msb[] = {0x80, 0x01, 0x40, 0x00};
+    MonoSprite a = MonoSprite::from_rows(16, 2, msb, 2);
+    EXPECT_TRUE(a.get(0, 0));
+    EXPECT_TRUE(a.get(15, 0));
+    EXPECT_TRUE(a.get(1, 1));
+    EXPECT_FALSE(a.get(2, 1));
+
+    const uint8_t lsb[] = {0x01};
+    MonoSprite b = MonoSprite::from_rows(8, 1, lsb, 1, true);
+    EXPECT_TRUE(b.get(0, 0));
+    EXPECT_FALSE(b.get(7, 0));
+}
+
+// Test: Byte-shifting blit matches per-pixel reference at every offset
+TEST(SpriteTest, BlitMatchesReferenceAtArbitraryOffsets) {
+    MonoSprite s = make_pattern(21, 13, 7);
+    s.mask_from_pixels(1);
+    for (BlitMode mode : {BlitMode::Opaque, BlitMode::Transparent, BlitMode::Masked}) {
+        for (int y = -15; y <= 66; y += 1) {
+            for (int x : {-25, -3, 0, 50, 110, 127, 130}) {
+                MonoGfx fast(128, 64);
+                MonoGfx ref(128, 64);
+                fill_background(fast, 99);
+                fill_background(ref, 99);
+                s.blit(fast, x, y, mode);
+                reference_blit(s, ref, x, y, mode);
+                ASSERT_EQ(fast.fb(), ref.fb())
+                    << "mode " << static_cast<int>(mode) << " at " << x << "," << y;
+            }
+        }
+    }
+}
+
+// Test: Opaque blit replaces the rectangle, transparent only adds ink
+TEST(SpriteTest, OpaqueAndTransparentModes) {
+    MonoSprite s(4, 4);
+    s.set(0, 0);
+
+    MonoGfx gfx(16, 8);
+    gfx.fill_rect(0, 0, 15, 7);
+    s.blit(gfx, 2, 2, BlitMode::Transparent);
+    EXPECT_EQ(gfx.fb()[3], 0xFF);
+
+    s.blit(gfx, 2, 2, BlitMode::Opaque);
+    // Column 2: row 2 set, rows 3..5 cleared, everything else untouched
+    EXPECT_EQ(gfx.fb()[2], 0xC7);
+    EXPECT_EQ(gfx.fb()[3], 0xC3);
+    EXPECT_EQ(gfx.fb()[6], 0xFF);
+}
+
+// Test: Region blit copies a shifted window of columns (marquee style)
+TEST(SpriteTest, BlitRegionCopiesColumnWindow) {
+    MonoSprite s = make_pattern(300, 16, 3);
+    MonoGfx gfx(128, 64);
+    s.blit_region(gfx, 0, 8, 100, 128);
+    for (int x = 0; x < 128; ++x)
+        for (int y = 0; y < 16; ++y)
+            ASSERT_EQ(s.get(100 + x, y), ((gfx.fb()[static_cast<size_t>(((y + 8) / 8) * 128 + x)] >> (y % 8)) & 1u) != 0);
+}
+
+// Test: Rotated targets fall back to the pixel map
+TEST(SpriteTest, BlitHonorsRotation) {
+    MonoSprite s = make_pattern(10, 9, 11);
+    MonoGfx fast(64, 32);
+    MonoGfx ref(64, 32);
+    fast.set_orientation(Rotation::Deg90);
+    ref.set_orientation(Rotation::Deg90);
+    s.blit(fast, 3, 17);
+    reference_blit(s, ref, 3, 17, BlitMode::Opaque);
+    EXPECT_EQ(fast.fb(), ref.fb());
+}
+
+// Test: Color sprite blits with memcpy rows and transparent pixels
+TEST(SpriteTest, ColorSpriteBlit) {
+    MonoSprite mono(3, 2);
+    mono.set(0, 0);
+    mono.set(2, 1);
+    ColorSprite opaque = ColorSprite::from_mono(mono, 0xF800, 0x001F);
+    ColorSprite keyed = ColorSprite::from_mono(mono, 0xF800, 0x001F, true);
+
+    std::vector<uint8_t> rgb(4 * 3 * 3, 0x11);
+    opaque.blit(rgb, 4, 3, 1, 1);
+    // (1,1) = red, (2,1) = blue
+    EXPECT_EQ(rgb[(1 * 4 + 1) * 3 + 0], 0xF8);
+    EXPECT_EQ(rgb[(1 * 4 + 2) * 3 + 2], 0xF8);
+    EXPECT_EQ(rgb[(0 * 4 + 0) * 3 + 0], 0x11);
+
+    std::vector<uint8_t> rgb2(4 * 3 * 3, 0x11);
+    keyed.blit(rgb2, 4, 3, 2, 1);  // clipped on the right
+    EXPECT_EQ(rgb2[(1 * 4 + 2) * 3 + 0], 0xF8);  // fg
+    EXPECT_EQ(rgb2[(1 * 4 + 3) * 3 + 0], 0x11);  // transparent
+    EXPECT_EQ(rgb2[(2 * 4 + 3) * 3 + 0], 0x11);  // transparent
+}
+
+// Test: Text sprite is pixel-identical to drawing the text directly
+TEST(SpriteTest, TextSpriteMatchesDirectDraw) {
+    const std::string font_path = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+    if (!std::ifstream(font_path).good()) {
+        GTEST_SKIP() << "Font file not available: " << font_path;
+    }
+
+    FtText ft;
+    ft.load_font(font_path);
+    ft.set_pixel_size(12);
+
+    TextSpriteCache cache(ft, 2);
+    const MonoSprite& label = cache.get("АИ-95 Ready");
+    EXPECT_EQ(label.width(), ft.measure_utf8("АИ-95 Ready"));
+    EXPECT_EQ(label.height(), ft.line_height());
+
+    for (int y : {0, 5, 12, 40}) {
+        MonoGfx direct(128, 64);
+        ft.draw_utf8(direct, 7, y, "АИ-95 Ready");
+        MonoGfx sprite(128, 64);
+        label.blit(sprite, 7, y, BlitMode::Transparent);
+        EXPECT_EQ(direct.fb(), sprite.fb()) << "y " << y;
+    }
+
+    EXPECT_EQ(cache.size(), 1u);
+    cache.get("АИ-95 Ready");
+    EXPECT_EQ(cache.size(), 1u);
+    cache.get("A");
+    cache.get("B");
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+// Main function for running tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
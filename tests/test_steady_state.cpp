@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include "animation.h"
+#include "display_queue.h"
+#include "four_line_display.h"
+#include "ft_text.h"
+#include "ili9488.h"
+#include "sprite.h"
+#include "tft_presenter.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every operator new in the process is counted, FreeType's included (FtText
+// routes it through operator new). A frame is steady when the count does
+// not move across it once the buffers have warmed up.
+
+namespace {
+std::atomic<size_t> g_allocations{0};
+
+void* counted_alloc(size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+
+// Allocations made since construction
+class AllocationCount {
+public:
+    AllocationCount() : start_(g_allocations.load()) {}
+    size_t count() const { return g_allocations.load() - start_; }
+
+private:
+    size_t start_;
+};
+
+const char* const kFont = "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf";
+
+bool font_exists(const std::string& path) {
+    std::ifstream f(path);
+    return f.good();
+}
+
+// prefix + n into a reused buffer, as the demo formats its counter line
+void format_counter(std::string& out, const char* prefix, int n) {
+    out.assign(prefix);
+    char digits[16];
+    int len = 0;
+    do {
+        digits[len++] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (len > 0) out.push_back(digits[--len]);
+}
+} // namespace
+
+void* operator new(size_t n) {
+    if (void* p = counted_alloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) {
+    if (void* p = counted_alloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+TEST(SteadyStateTest, CountsAllocations) {
+    AllocationCount allocs;
+    auto p = std::make_unique<int>(1);
+    EXPECT_EQ(allocs.count(), 1u);
+}
+
+TEST(SteadyStateTest, FtTextRedrawsChangingLabels) {
+    if (!font_exists(kFont)) GTEST_SKIP() << "Font file not available: " << kFont;
+    FtText ft;
+    ft.load_font(kFont);
+    ft.set_pixel_size(16);
+    std::vector<unsigned char> fb(128 * 64 / 8);
+    std::string label;
+    label.reserve(32);
+
+    // Warm-up: every digit rasterized once, the run slots grown to length
+    for (int n = 100; n < 200; ++n) {
+        format_counter(label, "Count: ", n);
+        ft.draw_utf8(fb, 128, 64, 0, 0, label);
+    }
+    AllocationCount allocs;
+    for (int n = 200; n < 1000; ++n) {
+        std::fill(fb.begin(), fb.end(), 0);
+        format_counter(label, "Count: ", n);
+        ft.draw_utf8(fb, 128, 64, 0, 0, label);
+        ft.measure_utf8(label);
+    }
+    EXPECT_EQ(allocs.count(), 0u);
+}
+
+TEST(SteadyStateTest, FourLineDisplayFrames) {
+    if (!font_exists(kFont)) GTEST_SKIP() << "Font file not available: " << kFont;
+    FourLineDisplay display(128, 64, 12, 28);
+    ASSERT_TRUE(display.initialize(kFont));
+    display.set_marquee(0, true);
+    display.puts(0, "A status line far too long for one row of the panel");
+    display.puts(2, "Name");
+    display.puts(3, "v1.0");
+
+    std::string line;
+    line.reserve(32);
+    double t = 0.0;
+    // Three 28 px digits fit the line, so warm-up shows each in every cell
+    auto frame = [&](int n) {
+        format_counter(line, "", n);
+        display.puts(1, line);
+        display.render();
+        display.tick(t);
+        t += 0.02;
+    };
+    for (int n = 100; n < 200; ++n) frame(n);
+
+    AllocationCount allocs;
+    for (int n = 200; n < 1000; ++n) frame(n);
+    EXPECT_EQ(allocs.count(), 0u);
+    EXPECT_FALSE(display.get_dirty_rects().empty());
+}
+
+TEST(SteadyStateTest, DisplayQueueFrames) {
+    if (!font_exists(kFont)) GTEST_SKIP() << "Font file not available: " << kFont;
+    FourLineDisplay display(128, 64, 12, 28);
+    ASSERT_TRUE(display.initialize(kFont));
+    DisplayQueue queue(64);
+    display.set_marquee(0, true);
+
+    std::string line;
+    line.reserve(32);
+    double t = 0.0;
+    // Lines past the small-string buffer, as a producer would push them
+    auto frame = [&](int n) {
+        queue.set_line(0, "Статус: Выполняется, строка длиннее экрана");
+        format_counter(line, "", n);
+        queue.set_line(1, line);
+        queue.set_line(2, "FuelFlux ILI9488 (rev. B)");
+        EXPECT_GT(queue.drain(display), 0u);
+        display.render();
+        display.tick(t);
+        t += 0.02;
+    };
+    for (int n = 100; n < 200; ++n) frame(n);
+
+    AllocationCount allocs;
+    for (int n = 200; n < 1000; ++n) frame(n);
+    EXPECT_EQ(allocs.count(), 0u);
+}
+
+TEST(SteadyStateTest, AnimatorTicks) {
+    MonoGfx gfx(128, 64);
+    MonoSprite dot(4, 4);
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x) dot.set(x, y, true);
+    Animator animator;
+    animator.emplace<BlinkAnimation>(std::move(dot), 120, 1, 0.1);
+
+    double t = 0.0;
+    for (int i = 0; i < 50; ++i, t += 0.01) animator.tick(t, gfx);
+    AllocationCount allocs;
+    size_t changed = 0;
+    for (int i = 0; i < 500; ++i, t += 0.01) changed += animator.tick(t, gfx).size();
+    EXPECT_EQ(allocs.count(), 0u);
+    EXPECT_GT(changed, 0u);
+}
+
+TEST(SteadyStateTest, ExpandsIntoKeptBuffers) {
+    const int w = 480, h = 320, rows = 16, bpp = 3;
+    MonoGfx gfx(w, h);
+    gfx.fill_rect(10, 10, 200, 100);
+    std::vector<uint8_t> rgb;
+    std::vector<uint8_t> wire(static_cast<size_t>(w * h * bpp));
+    size_t at = 0;
+    BandPipeline pipeline(static_cast<size_t>(w * rows * bpp), [&](const uint8_t* p, size_t n) {
+        std::memcpy(wire.data() + at, p, n);
+        at += n;
+    });
+
+    // As TftPresenter converts bands: one captured reference
+    const struct {
+        const uint8_t* fb;
+        int w, rows, bpp;
+    } job{gfx.fb().data(), w, rows, bpp};
+    auto frame = [&] {
+        Ili9488::mono_to_rgb666(gfx.fb(), w, h, rgb);
+        at = 0;
+        pipeline.run(h / rows, [&job](size_t i, uint8_t* out) {
+            const Rect band{0, static_cast<int>(i) * job.rows, job.w, job.rows};
+            TftPanel::expand_mono(job.fb, job.w, band, job.bpp, 0xFFFF, 0x0000, out);
+            return static_cast<size_t>(job.w * job.rows * job.bpp);
+        });
+    };
+    frame();
+
+    AllocationCount allocs;
+    for (int i = 0; i < 20; ++i) frame();
+    EXPECT_EQ(allocs.count(), 0u);
+    EXPECT_EQ(wire, rgb);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "ili9341.h"
+#include "ili9488.h"
+#include "panel_sim.h"
+#include "st7789.h"
+#include "tft_panel.h"
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> random_fb(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> fb(n);
+    for (auto& b : fb) b = static_cast<uint8_t>(rng());
+    return fb;
+}
+
+bool fb_bit(const std::vector<uint8_t>& fb, int width, int x, int y) {
+    return (fb[static_cast<size_t>((y / 8) * width + x)] >> (y % 8)) & 1u;
+}
+
+// Per-pixel reference for the expansion kernel
+std::vector<uint8_t> reference_expand(const std::vector<uint8_t>& fb, int width, const Rect& r,
+                                      int bpp, uint16_t fg, uint16_t bg) {
+    std::vector<uint8_t> out;
+    for (int y = r.y; y < r.y + r.h; ++y)
+        for (int x = r.x; x < r.x + r.w; ++x) {
+            const uint16_t c = fb_bit(fb, width, x, y) ? fg : bg;
+            if (bpp == 2) {
+                out.push_back(static_cast<uint8_t>(c >> 8));
+                out.push_back(static_cast<uint8_t>(c & 0xFF));
+            } else {
+                out.push_back(static_cast<uint8_t>(((c >> 11) & 0x1F) << 3));
+                out.push_back(static_cast<uint8_t>(((c >> 5) & 0x3F) << 2));
+                out.push_back(static_cast<uint8_t>((c & 0x1F) << 3));
+            }
+        }
+    return out;
+}
+
+} // namespace
+
+TEST(TftPanelTest, MonoToRgb565IsBigEndianRowMajor) {
+    // x=0: y0 on, x=1: y1 on
+    const std::vector<uint8_t> mono = {0x01, 0x02};
+    const auto px = TftPanel::mono_to_rgb565(mono, 2, 8, 0xF81F, 0x07E0);
+    ASSERT_EQ(px.size(), 2u * 8u * 2u);
+    // y0: [fg, bg]
+    EXPECT_EQ(px[0], 0xF8);
+    EXPECT_EQ(px[1], 0x1F);
+    EXPECT_EQ(px[2], 0x07);
+    EXPECT_EQ(px[3], 0xE0);
+    // y1: [bg, fg]
+    EXPECT_EQ(px[4], 0x07);
+    EXPECT_EQ(px[5], 0xE0);
+    EXPECT_EQ(px[6], 0xF8);
+    EXPECT_EQ(px[7], 0x1F);
+}
+
+TEST(TftPanelTest, MonoToRgb565RejectsBadGeometry) {
+    EXPECT_THROW((void)TftPanel::mono_to_rgb565(std::vector<uint8_t>(16), 8, 10), std::runtime_error);
+    EXPECT_THROW((void)TftPanel::mono_to_rgb565(std::vector<uint8_t>(3), 8, 8), std::runtime_error);
+}
+
+TEST(TftPanelTest, ExpansionMatchesReferenceForBothFormats) {
+    const int w = 480, h = 320;
+    const auto fb = random_fb(static_cast<size_t>(w * h / 8), 11);
+    EXPECT_EQ(Ili9488::mono_to_rgb666(fb, w, h, 0xFFE0, 0x0010),
+              reference_expand(fb, w, Rect{0, 0, w, h}, 3, 0xFFE0, 0x0010));
+    EXPECT_EQ(TftPanel::mono_to_rgb565(fb, w, h, 0xFFE0, 0x0010),
+              reference_expand(fb, w, Rect{0, 0, w, h}, 2, 0xFFE0, 0x0010));
+}
+
+TEST(TftPanelTest, ExpandsRegionOnly) {
+    const int w = 128, h = 64;
+    const auto fb = random_fb(static_cast<size_t>(w * h / 8), 5);
+    for (int bpp : {2, 3}) {
+        const Rect r{13, 5, 21, 19};  // not page aligned
+        std::vector<uint8_t> out(static_cast<size_t>(r.w * r.h * bpp));
+        TftPanel::expand_mono(fb.data(), w, r, bpp, 0xFFFF, 0x0841, out.data());
+        EXPECT_EQ(out, reference_expand(fb, w, r, bpp, 0xFFFF, 0x0841)) << bpp;
+    }
+}
+
+TEST(TftPanelTest, ControllersDescribeTheirPixelFormat) {
+    EXPECT_EQ(Ili9488::kController.bytes_per_pixel, 3);
+    EXPECT_EQ(St7789::kController.bytes_per_pixel, 2);
+    EXPECT_EQ(Ili9341::kController.bytes_per_pixel, 2);
+    // The default configuration selects the matching COLMOD
+    const TftController* ctls[] = {&Ili9488::kController, &St7789::kController, &Ili9341::kController};
+    for (const TftController* c : ctls) {
+        ASSERT_GT(c->config_count, 0u);
+        EXPECT_EQ(c->config[0].cmd, 0x3A) << c->name;
+        EXPECT_EQ(c->config[0].params[0], c->bytes_per_pixel == 2 ? 0x55 : 0x66) << c->name;
+    }
+}
+
+TEST(TftPanelTest, Rgb565FrameRendersOnDcsSim) {
+    // The sim models the DCS RAMWR path, which is the same on all three
+    // controllers; feed it a COLMOD 0x55 landscape frame.
+    const int w = 480, h = 320;
+    const auto fb = random_fb(static_cast<size_t>(w * h / 8), 7);
+    const auto px = TftPanel::mono_to_rgb565(fb, w, h, 0xF800, 0x001F);
+
+    Ili9488Sim sim;
+    auto cmd = [&](uint8_t c, std::vector<uint8_t> params = {}) {
+        sim.feed(false, &c, 1);
+        if (!params.empty()) sim.feed(true, params.data(), params.size());
+    };
+    cmd(0x11);
+    cmd(0x3A, {0x55});
+    cmd(0x36, {0xE8});
+    cmd(0x29);
+    cmd(0x2A, {0, 0, (w - 1) >> 8, (w - 1) & 0xFF});
+    cmd(0x2B, {0, 0, (h - 1) >> 8, (h - 1) & 0xFF});
+    cmd(0x2C);
+    EXPECT_EQ(sim.feed(true, px.data(), px.size()), 1);
+
+    std::vector<uint8_t> out;
+    sim.render_rgb(out);
+    ASSERT_EQ(out.size(), static_cast<size_t>(w * h * 3));
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const uint8_t* p = out.data() + static_cast<size_t>((y * w + x) * 3);
+            const bool fg = fb_bit(fb, w, x, y);
+            ASSERT_EQ(p[0], fg ? 0xFB : 0x00) << x << "," << y;
+            ASSERT_EQ(p[1], 0x00) << x << "," << y;
+            ASSERT_EQ(p[2], fg ? 0x00 : 0xFB) << x << "," << y;
+        }
+}
+
+TEST(TftPanelTest, ScanSpanFollowsMadctl) {
+    // Portrait ST7789 (MADCTL 0x00): logical rows are GRAM rows
+    ScanSpan s = TftPanel::scan_span(St7789::kController, 0, 240, 320, Rect{0, 10, 240, 8});
+    EXPECT_TRUE(s.along_y);
+    EXPECT_FALSE(s.reversed);
+    EXPECT_EQ(s.first, 10);
+    EXPECT_EQ(s.last, 17);
+
+    // Landscape ILI9488 (0xE8: MV, MX, MY): the scan runs along logical x,
+    // from the right edge
+    s = TftPanel::scan_span(Ili9488::kController, 3, 480, 320, Rect{0, 0, 8, 320});
+    EXPECT_FALSE(s.along_y);
+    EXPECT_TRUE(s.reversed);
+    EXPECT_EQ(s.first, 472);
+    EXPECT_EQ(s.last, 479);
+
+    // 240x240 glass in 240x320 GRAM, rotated 180 (0xC0): rows mirrored
+    // past the unused 80 GRAM rows, so the glass still covers rows 0..239
+    s = TftPanel::scan_span(St7789::kController, 2, 240, 240, Rect{0, 0, 240, 240});
+    EXPECT_TRUE(s.reversed);
+    EXPECT_EQ(s.first, 0);
+    EXPECT_EQ(s.last, 239);
+}
+
+TEST(TftPanelTest, HealthFromDisplayStatus) {
+    // Landscape ILI9488 as configured: MADCTL 0xE8, RGB666, normal mode,
+    // sleep out, display on
+    const TftController& ctl = Ili9488::kController;
+    const uint32_t healthy = (0x3Au << 25) | (0x6u << 20) | (1u << 17) | (1u << 16) | (1u << 10);
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, healthy), PanelHealth::Ok);
+    // Booster and gamma bits are not part of the check
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, healthy | (1u << 31) | (1u << 6)),
+              PanelHealth::Ok);
+
+    // Settings flipped, still awake: registers only
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, healthy ^ (1u << 28)), PanelHealth::Registers);
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, healthy & ~(1u << 10)), PanelHealth::Registers);
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, true, healthy), PanelHealth::Registers);  // TE off
+    EXPECT_EQ(TftPanel::health(ctl, 0, true, false, healthy), PanelHealth::Registers);
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, healthy | (1u << 11)), PanelHealth::Registers);
+
+    // Back in Sleep In after a reset, or nothing on MISO
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, healthy & ~(1u << 17)), PanelHealth::Lost);
+    EXPECT_EQ(TftPanel::health(ctl, 3, true, false, 0), PanelHealth::Lost);
+    EXPECT_NE(TftPanel::health(ctl, 3, true, false, 0xFFFFFFFFu), PanelHealth::Ok);
+
+    // RGB565 controllers report pixel format 101
+    const uint32_t st7789 = (0x5u << 20) | (1u << 17) | (1u << 16);
+    EXPECT_EQ(TftPanel::health(St7789::kController, 0, false, false, st7789), PanelHealth::Ok);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
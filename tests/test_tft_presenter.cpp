@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include "ili9488.h"
+#include "tft_presenter.h"
+#include <chrono>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(BandPipelineTest, SendsBandsInOrder) {
+    std::vector<uint8_t> wire;
+    BandPipeline pipeline(16, [&](const uint8_t* p, size_t n) { wire.insert(wire.end(), p, p + n); });
+    EXPECT_EQ(pipeline.band_capacity(), 16u);
+
+    for (size_t bands : {size_t{1}, size_t{7}, size_t{0}, size_t{4}}) {
+        wire.clear();
+        pipeline.run(bands, [](size_t i, uint8_t* out) {
+            const size_t n = 1 + i % 16;  // uneven band sizes
+            for (size_t k = 0; k < n; ++k) out[k] = static_cast<uint8_t>(i * 16 + k);
+            return n;
+        });
+        std::vector<uint8_t> expected;
+        for (size_t i = 0; i < bands; ++i)
+            for (size_t k = 0; k < 1 + i % 16; ++k) expected.push_back(static_cast<uint8_t>(i * 16 + k));
+        EXPECT_EQ(wire, expected) << bands;
+        EXPECT_EQ(pipeline.stats().bands, bands);
+    }
+}
+
+TEST(BandPipelineTest, ReassemblesTheExpandedFrame) {
+    // The band split TftPresenter uses, checked against a one-shot expansion
+    const int w = 480, h = 320, rows = 8, bpp = 3;
+    std::mt19937 rng(3);
+    std::vector<uint8_t> fb(static_cast<size_t>(w * h / 8));
+    for (auto& b : fb) b = static_cast<uint8_t>(rng());
+
+    std::vector<uint8_t> wire;
+    BandPipeline pipeline(static_cast<size_t>(w * rows * bpp),
+                          [&](const uint8_t* p, size_t n) { wire.insert(wire.end(), p, p + n); });
+    pipeline.run(h / rows, [&](size_t i, uint8_t* out) {
+        const Rect band{0, static_cast<int>(i) * rows, w, rows};
+        TftPanel::expand_mono(fb.data(), w, band, bpp, 0xF800, 0x001F, out);
+        return static_cast<size_t>(w * rows * bpp);
+    });
+    EXPECT_EQ(wire, Ili9488::mono_to_rgb666(fb, w, h, 0xF800, 0x001F));
+}
+
+TEST(BandPipelineTest, OverlapsConvertAndSend) {
+    const auto step = std::chrono::milliseconds(4);
+    BandPipeline pipeline(1, [&](const uint8_t*, size_t) { std::this_thread::sleep_for(step); });
+    pipeline.run(10, [&](size_t, uint8_t*) {
+        std::this_thread::sleep_for(step);
+        return size_t{1};
+    });
+    const PipelineStats& st = pipeline.stats();
+    EXPECT_GE(st.convert_ms, 40.0);
+    EXPECT_GE(st.send_ms, 40.0);
+    // Serial would be >= 80 ms; pipelined is about 44
+    EXPECT_LT(st.total_ms, 0.8 * (st.convert_ms + st.send_ms));
+}
+
+TEST(BandPipelineTest, RethrowsSendErrorsAndRecovers) {
+    int sent = 0;
+    bool fail = true;
+    BandPipeline pipeline(4, [&](const uint8_t*, size_t) {
+        if (fail && sent == 2) throw std::runtime_error("SPI write failed");
+        ++sent;
+    });
+    auto convert = [](size_t, uint8_t*) { return size_t{4}; };
+    EXPECT_THROW(pipeline.run(6, convert), std::runtime_error);
+    EXPECT_EQ(sent, 2);  // nothing after the failed band goes out
+
+    fail = false;
+    sent = 0;
+    EXPECT_NO_THROW(pipeline.run(6, convert));
+    EXPECT_EQ(sent, 6);
+}
+
+TEST(BandPipelineTest, RejectsOversizedBand) {
+    BandPipeline pipeline(4, [](const uint8_t*, size_t) {});
+    EXPECT_THROW(pipeline.run(1, [](size_t, uint8_t*) { return size_t{5}; }), std::runtime_error);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+// Simulated time from a fixed base: waiting advances it, so nothing
+// depends on how the test thread is scheduled
+struct SimClock {
+    Clock::time_point t{std::chrono::seconds(1)};
+
+    TearSync::Timing timing() {
+        return {[this] { return t; }, [this](Clock::time_point until) { t = std::max(t, until); }};
+    }
+};
+
+// Edge n at base + n * period, on the simulated clock
+class SimVsync : public VsyncSource {
+public:
+    SimVsync(SimClock& clock, Clock::duration period) : clock_(clock), base_(clock.t), period_(period) {}
+
+    bool next_edge(milliseconds timeout, Clock::time_point& at) override {
+        long long n = (clock_.t - base_) / period_ + 1;
+        while (drop.count(n)) ++n;  // edges the reader misses
+        const Clock::time_point next = base_ + period_ * n;
+        if (next > clock_.t + timeout) return false;
+        clock_.t = next;
+        at = next;
+        edges.push_back(next);
+        return true;
+    }
+
+    std::set<long long> drop;
+    std::vector<Clock::time_point> edges;
+
+private:
+    SimClock& clock_;
+    Clock::time_point base_;
+    Clock::duration period_;
+};
+
+class DeadVsync : public VsyncSource {
+public:
+    bool next_edge(milliseconds timeout, Clock::time_point&) override {
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+};
+
+} // namespace
+
+TEST(TearSyncTest, BandStartStaysBehindTheScan) {
+    const Clock::time_point edge{};
+    const Clock::duration T = milliseconds(16);
+    const Clock::duration none{0};
+
+    // Rows 100..199 of 400: open once the scan leaves row 199 (T / 2),
+    // closed when the next scan reaches row 100 (T + T / 4) minus the
+    // write. At 3 ms the previous scan's window has just closed.
+    auto start = TearSync::band_start(edge + milliseconds(3), edge, T, 400, 100, 199, milliseconds(2), none);
+    ASSERT_TRUE(start);
+    EXPECT_EQ(*start, edge + T / 2);
+
+    // Inside the window: go now
+    start = TearSync::band_start(edge + milliseconds(10), edge, T, 400, 100, 199, milliseconds(2), none);
+    ASSERT_TRUE(start);
+    EXPECT_EQ(*start, edge + milliseconds(10));
+
+    // Too late for this window (the write would meet the next scan): the
+    // next one, a period later
+    start = TearSync::band_start(edge + milliseconds(19), edge, T, 400, 100, 199, milliseconds(2), none);
+    ASSERT_TRUE(start);
+    EXPECT_EQ(*start, edge + T + T / 2);
+
+    // Far past the edge: extrapolated by whole periods
+    start = TearSync::band_start(edge + 10 * T + milliseconds(1), edge, T, 400, 0, 39, milliseconds(1), none);
+    ASSERT_TRUE(start);
+    EXPECT_EQ(*start, edge + 10 * T + T / 10);
+
+    // A write longer than the time the scan leaves the rows alone
+    EXPECT_FALSE(TearSync::band_start(edge, edge, T, 400, 0, 199, milliseconds(9), none));
+}
+
+TEST(TearSyncTest, WritesBandsBetweenSimulatedScans) {
+    const Clock::duration T = milliseconds(10);
+    SimClock clock;
+    SimVsync te(clock, T);
+    TearSync sync(te, 100, clock.timing());
+    ASSERT_TRUE(sync.begin_frame());
+    EXPECT_DOUBLE_EQ(sync.stats().period_ms, 10.0);
+
+    // 1 us per byte: 1000 bytes take 1 ms
+    const Clock::duration write = milliseconds(1);
+    sync.band_sent(1000, write);
+    for (int band = 0; band < 4; ++band) {
+        const int first = band * 20;
+        const int last = first + 19;
+        sync.wait_band(first, last, 1000);
+        // The scan has left the band and does not come back within the
+        // write, in this period or still in the previous one
+        const Clock::duration into = (clock.t - te.edges.back()) % T;
+        const bool behind = into >= T * (last + 1) / 100 && into + write <= T + T * first / 100;
+        const bool ahead_of_next = into + write <= T * first / 100;
+        EXPECT_TRUE(behind || ahead_of_next) << band << " at " << into.count() << " ns";
+        clock.t += write;  // the band goes out
+    }
+    EXPECT_EQ(sync.stats().synced_frames, 1u);
+    EXPECT_EQ(sync.stats().missed_bands, 0u);
+    EXPECT_EQ(sync.stats().delayed_bands, 4u);  // writes outrun the scan: each waits
+
+    // Later frames keep the period
+    ASSERT_TRUE(sync.begin_frame());
+    EXPECT_DOUBLE_EQ(sync.stats().period_ms, 10.0);
+}
+
+TEST(TearSyncTest, MissedEdgeDoesNotDoubleThePeriod) {
+    const Clock::duration T = milliseconds(10);
+    SimClock clock;
+    SimVsync te(clock, T);
+    te.drop = {2};  // descheduled while measuring
+    TearSync sync(te, 100, clock.timing());
+    ASSERT_TRUE(sync.begin_frame());
+    EXPECT_DOUBLE_EQ(sync.stats().period_ms, 10.0);
+}
+
+TEST(TearSyncTest, DoubledPeriodIsMeasuredAgain) {
+    // Every other edge missed while measuring: 2T at first
+    const Clock::duration T = milliseconds(10);
+    SimClock clock;
+    SimVsync te(clock, T);
+    te.drop = {2, 4, 6};
+    TearSync sync(te, 100, clock.timing());
+    ASSERT_TRUE(sync.begin_frame());
+    EXPECT_DOUBLE_EQ(sync.stats().period_ms, 20.0);
+
+    // Frame edges a single period apart do not fit 2T; after a few the
+    // estimate is thrown out
+    for (int i = 0; i < 3; ++i) ASSERT_TRUE(sync.begin_frame());
+    EXPECT_DOUBLE_EQ(sync.stats().period_ms, 10.0);
+    ASSERT_TRUE(sync.begin_frame());
+    EXPECT_DOUBLE_EQ(sync.stats().period_ms, 10.0);
+}
+
+TEST(TearSyncTest, FallsBackWithoutEdges) {
+    DeadVsync te;
+    TearSync sync(te, 320);
+    const Clock::time_point t = Clock::now();
+    EXPECT_FALSE(sync.begin_frame(milliseconds(5)));
+    // Unsynchronized: bands are not held back
+    sync.band_sent(1000, milliseconds(1));
+    sync.wait_band(0, 319, 1000);
+    EXPECT_LT(Clock::now() - t, milliseconds(100));
+    EXPECT_EQ(sync.stats().unsynced_frames, 1u);
+    EXPECT_EQ(sync.stats().delayed_bands, 0u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include "utf8.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Straightforward byte-at-a-time reference decoder (Unicode Table 3-7),
+// used to cross-check the vectorized decoder on random input.
+std::u32string reference_decode(const std::string& s) {
+    std::u32string out;
+    size_t i = 0;
+    const size_t n = s.size();
+    auto at = [&](size_t k) { return static_cast<unsigned char>(s[k]); };
+    while (i < n) {
+        unsigned char c = at(i);
+        if (c < 0x80) { out.push_back(c); ++i; continue; }
+        size_t need = 0;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) need = 1;
+        else if (c == 0xE0) { need = 2; lo = 0xA0; }
+        else if (c >= 0xE1 && c <= 0xEC) need = 2;
+        else if (c == 0xED) { need = 2; hi = 0x9F; }
+        else if (c >= 0xEE && c <= 0xEF) need = 2;
+        else if (c == 0xF0) { need = 3; lo = 0x90; }
+        else if (c >= 0xF1 && c <= 0xF3) need = 3;
+        else if (c == 0xF4) { need = 3; hi = 0x8F; }
+        if (need == 0) { out.push_back(0xFFFD); ++i; continue; }
+
+        char32_t cp = (need == 1) ? (c & 0x1F) : (need == 2) ? (c & 0x0F) : (c & 0x07);
+        size_t k = 1;
+        for (; k <= need && i + k < n; ++k) {
+            unsigned char b = at(i + k);
+            unsigned char l = (k == 1) ? lo : 0x80;
+            unsigned char h = (k == 1) ? hi : 0xBF;
+            if (b < l || b > h) break;
+            cp = (cp << 6) | (b & 0x3F);
+        }
+        if (k <= need) { out.push_back(0xFFFD); i += k; continue; }
+        out.push_back(cp);
+        i += need + 1;
+    }
+    return out;
+}
+
+std::string encode(char32_t cp) {
+    std::string s;
+    if (cp < 0x80) {
+        s += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        s += static_cast<char>(0xC0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        s += static_cast<char>(0xE0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        s += static_cast<char>(0xF0 | (cp >> 18));
+        s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return s;
+}
+
+} // namespace
+
+// Test: ASCII decodes one codepoint per byte
+TEST(Utf8Test, DecodesAscii) {
+    std::u32string out;
+    EXPECT_EQ(utf8_decode("Status: OK", out), 0u);
+    EXPECT_EQ(out, U"Status: OK");
+    EXPECT_TRUE(utf8_valid("Status: OK"));
+}
+
+// Test: Empty input gives empty output
+TEST(Utf8Test, DecodesEmpty) {
+    std::u32string out = U"stale";
+    EXPECT_EQ(utf8_decode("", out), 0u);
+    EXPECT_TRUE(out.empty());
+}
+
+// Test: 2-, 3- and 4-byte sequences
+TEST(Utf8Test, DecodesMultibyte) {
+    std::u32string out;
+    EXPECT_EQ(utf8_decode("Счётчик: 42 €😀", out), 0u);
+    EXPECT_EQ(out, U"Счётчик: 42 €😀");
+}
+
+// Test: Encoded U+FFFD is valid input, not an error
+TEST(Utf8Test, EncodedReplacementIsNotAnError) {
+    std::u32string out;
+    EXPECT_EQ(utf8_decode("\xEF\xBF\xBD", out), 0u);
+    EXPECT_EQ(out, U"�");
+}
+
+// Test: Malformed forms are rejected, never decoded to wrong codepoints
+TEST(Utf8Test, RejectsMalformedSequences) {
+    struct Case { const char* in; std::u32string expected; };
+    const std::vector<Case> cases = {
+        {"\xC0\x80", U"��"},             // overlong NUL
+        {"\xC1\xBF", U"��"},             // overlong
+        {"\xE0\x80\xAF", U"���"},   // overlong 3-byte
+        {"\xED\xA0\x80", U"���"},   // UTF-16 surrogate
+        {"\xF4\x90\x80\x80", U"����"}, // above U+10FFFF
+        {"\xF5\x80", U"��"},             // invalid lead
+        {"\x80", U"�"},                       // stray continuation
+        {"\xD0", U"�"},                       // truncated at end
+        {"\xD0" "A", U"�A"},                  // missing continuation
+        {"\xE2\x82" "A", U"�A"},              // truncated 3-byte, one U+FFFD
+        {"\xF0\x9F\x98", U"�"},               // truncated 4-byte at end
+    };
+    for (const auto& c : cases) {
+        std::u32string out;
+        EXPECT_GT(utf8_decode(c.in, out), 0u) << c.in;
+        EXPECT_EQ(out, c.expected) << c.in;
+        EXPECT_FALSE(utf8_valid(c.in));
+    }
+}
+
+// Test: Maximal subpart substitution example from the Unicode Standard
+TEST(Utf8Test, MaximalSubpartExample) {
+    std::u32string out;
+    const std::string in = "\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64";
+    EXPECT_EQ(utf8_decode(in, out), 6u);
+    EXPECT_EQ(out, U"a���b�c��d");
+}
+
+// Test: ASCII runs of every length/alignment around the vector width
+TEST(Utf8Test, AsciiRunsAtAllAlignments) {
+    std::u32string out;
+    for (size_t prefix = 0; prefix < 20; ++prefix) {
+        for (size_t len = 0; len < 40; ++len) {
+            std::string s(prefix, 'x');
+            s += "Ж";
+            for (size_t k = 0; k < len; ++k) s += static_cast<char>('a' + (k % 26));
+            s += "\x80";
+            const auto expected = reference_decode(s);
+            utf8_decode(s, out);
+            ASSERT_EQ(out, expected) << "prefix " << prefix << " len " << len;
+        }
+    }
+}
+
+// Test: Random valid codepoints round-trip
+TEST(Utf8Test, FuzzValidRoundTrip) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> pick(0, 0x10FFFF);
+    std::u32string out;
+    for (int iter = 0; iter < 2000; ++iter) {
+        std::u32string cps;
+        std::string s;
+        const int n = iter % 37;
+        for (int k = 0; k < n; ++k) {
+            char32_t cp = pick(rng);
+            if (k % 3 == 0) cp &= 0x7F;              // keep ASCII runs common
+            if (cp >= 0xD800 && cp <= 0xDFFF) cp = 'S'; // not encodable
+            cps.push_back(cp);
+            s += encode(cp);
+        }
+        ASSERT_TRUE(utf8_valid(s));
+        ASSERT_EQ(utf8_decode(s, out), 0u);
+        ASSERT_EQ(out, cps);
+    }
+}
+
+// Test: Random bytes match the reference decoder and never yield invalid codepoints
+TEST(Utf8Test, FuzzRandomBytesMatchReference) {
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> biased(0x80, 0xF7);
+    std::u32string out;
+    for (int iter = 0; iter < 5000; ++iter) {
+        std::string s;
+        const int n = iter % 64;
+        for (int k = 0; k < n; ++k) {
+            // Mix plain ASCII, arbitrary bytes and UTF-8-looking bytes
+            int r = byte(rng);
+            int b = (r < 96) ? (r & 0x7F) : (r < 192) ? biased(rng) : byte(rng);
+            s += static_cast<char>(b);
+        }
+        const auto expected = reference_decode(s);
+        const size_t errors = utf8_decode(s, out);
+        ASSERT_EQ(out, expected);
+        ASSERT_EQ(errors == 0, utf8_valid(s));
+        for (char32_t cp : out) {
+            ASSERT_LE(cp, 0x10FFFFu);
+            ASSERT_FALSE(cp >= 0xD800 && cp <= 0xDFFF);
+        }
+    }
+}
+
+// Main function for running tests
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
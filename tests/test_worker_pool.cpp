@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "worker_pool.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(WorkerPoolTest, RunsEveryIndexOnce) {
+    WorkerPool pool(3);
+    EXPECT_EQ(pool.workers(), 3u);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<std::atomic<int>> hits(17);
+        pool.run(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+        for (size_t i = 0; i < hits.size(); ++i) ASSERT_EQ(hits[i].load(), 1) << round << " " << i;
+    }
+}
+
+TEST(WorkerPoolTest, InlineWithoutWorkers) {
+    WorkerPool pool(0);
+    std::vector<size_t> order;
+    pool.run(4, [&](size_t i) { order.push_back(i); });
+    EXPECT_EQ(order, (std::vector<size_t>{0, 1, 2, 3}));
+}
+
+TEST(WorkerPoolTest, RethrowsAfterAllTasksFinish) {
+    WorkerPool pool(2);
+    std::atomic<int> done{0};
+    EXPECT_THROW(pool.run(8, [&](size_t i) {
+        if (i == 3) throw std::runtime_error("task failed");
+        done.fetch_add(1);
+    }), std::runtime_error);
+    EXPECT_EQ(done.load(), 7);
+
+    // Still usable afterwards
+    std::atomic<int> again{0};
+    pool.run(5, [&](size_t) { again.fetch_add(1); });
+    EXPECT_EQ(again.load(), 5);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
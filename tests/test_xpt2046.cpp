@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include "ili9488.h"
+#include "xpt2046.h"
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// Answers conversions like an XPT2046 with the pen at (x, y), or lifted
+class FakeTouch : public SpiLinux {
+public:
+    FakeTouch() : SpiLinux("/dev/null") {}
+
+    void press(int x, int y, int z1 = 1200, int z2 = 2800) {
+        std::lock_guard<std::mutex> lock(m);
+        x_ = x; y_ = y; z1_ = z1; z2_ = z2;
+    }
+    void lift() { press(0, 0, 0, 4095); }
+    // Added to successive X conversions of each message, cycling
+    void x_noise(std::vector<int> noise) {
+        std::lock_guard<std::mutex> lock(m);
+        noise_ = std::move(noise);
+    }
+    std::vector<std::vector<uint8_t>> messages() {
+        std::lock_guard<std::mutex> lock(m);
+        return messages_;
+    }
+
+protected:
+    void transfer_message(const SpiSegment* segs, size_t n) override {
+        std::lock_guard<std::mutex> lock(m);
+        for (size_t s = 0; s < n; ++s) {
+            const SpiSegment& seg = segs[s];
+            messages_.emplace_back(seg.tx, seg.tx + seg.len);
+            ASSERT_NE(seg.rx, nullptr);
+            size_t xs = 0;
+            for (size_t i = 0; i + 2 < seg.len; i += 3) {
+                int v = 0;
+                switch (seg.tx[i] & 0x70) {
+                    case 0x50: v = x_ + (noise_.empty() ? 0 : noise_[xs++ % noise_.size()]); break;
+                    case 0x10: v = y_; break;
+                    case 0x30: v = z1_; break;
+                    case 0x40: v = z2_; break;
+                }
+                seg.rx[i] = 0x00;
+                seg.rx[i + 1] = static_cast<uint8_t>(v >> 5);
+                seg.rx[i + 2] = static_cast<uint8_t>(v << 3);
+            }
+        }
+    }
+
+private:
+    std::mutex m;
+    int x_{0}, y_{0}, z1_{0}, z2_{4095};
+    std::vector<int> noise_;
+    std::vector<std::vector<uint8_t>> messages_;
+};
+
+struct Events {
+    std::mutex m;
+    std::vector<TouchEvent> list;
+
+    void add(const TouchEvent& e) {
+        std::lock_guard<std::mutex> lock(m);
+        list.push_back(e);
+    }
+    std::vector<TouchEvent> wait_for(size_t n, milliseconds timeout) {
+        const auto end = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < end) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (list.size() >= n) return list;
+            }
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        std::lock_guard<std::mutex> lock(m);
+        return list;
+    }
+};
+
+} // namespace
+
+TEST(Xpt2046Test, ReadingIsOneMessageEndingInPowerDown) {
+    FakeTouch spi;
+    Xpt2046 touch(spi);
+    spi.press(1000, 2000);
+    TouchSample s;
+    EXPECT_EQ(touch.read(s), TouchState::Pressed);
+    EXPECT_EQ(s.x, 1000);
+    EXPECT_EQ(s.y, 2000);
+    EXPECT_EQ(s.z, 1200 + 4095 - 2800);
+
+    auto msgs = spi.messages();
+    ASSERT_EQ(msgs.size(), 1u);
+    // Z1, Z2, 6 X, 6 Y (the first of each discarded), three bytes each
+    ASSERT_EQ(msgs[0].size(), (2u + 6u + 6u) * 3u);
+    EXPECT_EQ(msgs[0][0], 0xB1);
+    EXPECT_EQ(msgs[0][3], 0xC1);
+    EXPECT_EQ(msgs[0][6], 0xD1);
+    EXPECT_EQ(msgs[0][msgs[0].size() - 6], 0x91);
+    EXPECT_EQ(msgs[0][msgs[0].size() - 3], 0x90);  // PENIRQ back on
+    EXPECT_EQ(spi.stats().bytes, msgs[0].size());
+}
+
+TEST(Xpt2046Test, OutliersAreTrimmedAndSpreadIsUnstable) {
+    FakeTouch spi;
+    Xpt2046 touch(spi);
+    spi.press(1000, 2000);
+
+    // The settling conversion and the extremes of the rest are dropped
+    spi.x_noise({900, 4, -2, 0, -700, 1});
+    TouchSample s;
+    EXPECT_EQ(touch.read(s), TouchState::Pressed);
+    EXPECT_EQ(s.x, 1000);  // mean of -2, 0, 1, rounded
+
+    spi.x_noise({0, 0, 0, 200, 400, 600});
+    EXPECT_EQ(touch.read(s), TouchState::Unstable);
+
+    spi.lift();
+    EXPECT_EQ(touch.read(s), TouchState::Released);
+    EXPECT_THROW(touch.set_samples(0), std::runtime_error);
+    EXPECT_THROW(touch.set_samples(Xpt2046::kMaxSamples + 1), std::runtime_error);
+}
+
+TEST(Xpt2046Test, CalibrationFromRangeAndPoints) {
+    // Flipped Y axis, clamped to the screen
+    const TouchCalibration r = TouchCalibration::from_range(200, 3900, 3800, 300, 320, 480);
+    EXPECT_EQ(r.map(200, 3800).x, 0);
+    EXPECT_EQ(r.map(200, 3800).y, 0);
+    EXPECT_EQ(r.map(3900, 300).x, 319);
+    EXPECT_EQ(r.map(3900, 300).y, 479);
+    EXPECT_EQ(r.map(0, 4095).x, 0);
+    EXPECT_EQ(r.map(4095, 0).y, 479);
+
+    const TouchCalibration sw = TouchCalibration::from_range(200, 3900, 300, 3800, 480, 320, true);
+    EXPECT_EQ(sw.map(3900, 300).y, 319);
+    EXPECT_EQ(sw.map(3900, 300).x, 0);
+
+    // Three touches recover the same mapping
+    const TouchPoint raw[3] = {{400, 3000}, {3500, 3200}, {1900, 600}};
+    TouchPoint screen[3];
+    for (int i = 0; i < 3; ++i) screen[i] = r.map(raw[i].x, raw[i].y);
+    const TouchCalibration p = TouchCalibration::from_points(raw, screen, 320, 480);
+    for (int rx : {500, 2000, 3600}) {
+        for (int ry : {400, 1800, 3500}) {
+            EXPECT_NEAR(p.map(rx, ry).x, r.map(rx, ry).x, 1);
+            EXPECT_NEAR(p.map(rx, ry).y, r.map(rx, ry).y, 1);
+        }
+    }
+
+    const TouchPoint line[3] = {{100, 100}, {200, 200}, {300, 300}};
+    EXPECT_THROW(TouchCalibration::from_points(line, screen, 320, 480), std::runtime_error);
+}
+
+TEST(Xpt2046Test, RotatedCalibrationFollowsMadctl) {
+    const TftController& ctl = Ili9488::kController;
+    const TouchCalibration portrait = TouchCalibration::from_range(0, 319, 0, 479, 320, 480);
+
+    // 0x48 (MX) to 0xE8 (MV, MX, MY): the portrait top-left corner is the
+    // landscape top-right one
+    const TouchCalibration land = portrait.rotated(ctl, 0, 3);
+    EXPECT_EQ(land.width, 480);
+    EXPECT_EQ(land.height, 320);
+    EXPECT_EQ(land.map(0, 0).x, 479);
+    EXPECT_EQ(land.map(0, 0).y, 0);
+    EXPECT_EQ(land.map(319, 479).x, 0);
+    EXPECT_EQ(land.map(319, 479).y, 319);
+
+    // The other landscape (0x28, MV) is turned 180 degrees from it
+    const TouchCalibration other = portrait.rotated(ctl, 0, 1);
+    EXPECT_EQ(other.map(0, 0).x, 0);
+    EXPECT_EQ(other.map(0, 0).y, 319);
+
+    // There and back again
+    const TouchCalibration back = land.rotated(ctl, 3, 0);
+    for (int rx : {0, 100, 319}) {
+        for (int ry : {0, 250, 479}) {
+            EXPECT_EQ(back.map(rx, ry).x, portrait.map(rx, ry).x);
+            EXPECT_EQ(back.map(rx, ry).y, portrait.map(rx, ry).y);
+        }
+    }
+}
+
+TEST(Xpt2046Test, ReaderReportsDownMoveUp) {
+    FakeTouch spi;
+    Xpt2046 touch(spi);
+    touch.set_calibration(TouchCalibration::from_range(0, 4095, 0, 4095, 4096, 4096));
+    touch.set_interval(milliseconds(2));
+    Events events;
+    touch.start([&](const TouchEvent& e) { events.add(e); });
+    EXPECT_TRUE(touch.running());
+    EXPECT_THROW(touch.start([](const TouchEvent&) {}), std::runtime_error);
+
+    std::this_thread::sleep_for(milliseconds(10));
+    EXPECT_TRUE(events.wait_for(1, milliseconds(0)).empty());  // nothing while lifted
+
+    const auto pressed = std::chrono::steady_clock::now();
+    spi.press(1000, 2000);
+    auto list = events.wait_for(1, milliseconds(500));
+    ASSERT_EQ(list.size(), 1u);
+    EXPECT_EQ(list[0].action, TouchAction::Down);
+    EXPECT_EQ(list[0].pos.x, 1000);
+    EXPECT_EQ(list[0].pos.y, 2000);
+    EXPECT_LT(list[0].time - pressed, milliseconds(20));
+
+    // A steady pen reports nothing more; a moved one does
+    std::this_thread::sleep_for(milliseconds(10));
+    EXPECT_EQ(events.wait_for(2, milliseconds(0)).size(), 1u);
+    spi.press(1100, 2000);
+    list = events.wait_for(2, milliseconds(500));
+    ASSERT_EQ(list.size(), 2u);
+    EXPECT_EQ(list[1].action, TouchAction::Move);
+    EXPECT_EQ(list[1].pos.x, 1100);
+
+    spi.lift();
+    list = events.wait_for(3, milliseconds(500));
+    ASSERT_EQ(list.size(), 3u);
+    EXPECT_EQ(list[2].action, TouchAction::Up);
+    EXPECT_EQ(list[2].pos.x, 1100);
+
+    touch.stop();
+    EXPECT_FALSE(touch.running());
+}
+
+TEST(Xpt2046Test, SpiErrorEndsReaderAndIsRethrown) {
+    SpiLinux closed("/nonexistent/spidev");
+    Xpt2046 touch(closed);
+    touch.start([](const TouchEvent&) {});
+    std::this_thread::sleep_for(milliseconds(20));
+    EXPECT_THROW(touch.stop(), std::runtime_error);
+    EXPECT_FALSE(touch.running());
+}
+
+TEST(Xpt2046Test, SharedMessageLimit) {
+    // 2 ms of a 32 MHz display write
+    EXPECT_EQ(Xpt2046::max_shared_message(32000000, std::chrono::microseconds(2000)), 8000u);
+    EXPECT_EQ(Xpt2046::max_shared_message(8, std::chrono::microseconds(1)), 1u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}